@@ -0,0 +1,59 @@
+// one thread per record (GpuCuller::Record): a record whose box, moved by its
+// translation, is inside the frustum appends its draw to the commands of its bucket.
+layout(local_size_x = 64) in;
+
+struct Record
+{
+	vec3 boundsMin;
+	uint vertexCount;
+	vec3 boundsMax;
+	uint firstVertex;
+	uint translation;
+	uint bucket;
+	uint commandBase;
+	uint pad;
+};
+
+// vertexCount, instanceCount, firstVertex, firstInstance.
+struct Command
+{
+	uint vertexCount;
+	uint instanceCount;
+	uint firstVertex;
+	uint firstInstance;
+};
+
+layout(std430, binding=CULL_RECORDS) readonly buffer records { Record record[]; };
+layout(std430, binding=CULL_COMMANDS) writeonly buffer commands { Command command[]; };
+// draws of every bucket, zeroed before the dispatch.
+layout(std430, binding=CULL_COUNTS) buffer counts { uint count[]; };
+
+// the renderer's translations.
+layout(std430, binding=TRANSLATION) readonly buffer TRANSLATION_NAME { vec4 translations[]; };
+
+// the frustum planes (normals inside), and x the number of records.
+layout(binding=CULL) uniform CULL_NAME
+{
+	vec4 planes[6];
+	uvec4 size;
+};
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= size.x)
+		return;
+	Record r = record[i];
+	vec3 t = translations[r.translation].xyz;
+	vec3 lo = r.boundsMin + t;
+	vec3 hi = r.boundsMax + t;
+	for (int p = 0; p < 6; p++)
+	{
+		// the corner furthest along the normal, outside means the whole box is.
+		vec3 corner = mix(lo, hi, greaterThanEqual(planes[p].xyz, vec3(0.0)));
+		if (dot(planes[p].xyz, corner) + planes[p].w < 0.0)
+			return;
+	}
+	uint slot = atomicAdd(count[r.bucket], 1u);
+	command[r.commandBase + slot] = Command(r.vertexCount, 1u, r.firstVertex, r.translation);
+}
@@ -1,15 +1,96 @@
 
-// buffer inputs
+// gl_BaseInstanceARB, before any declaration.
+#ifdef TRANSLATION_BUFFER
+#extension GL_ARB_shader_draw_parameters : require
+#endif
+
+// VertexLayout::FORMAT, in its order.
+#define FORMAT_FLOAT4 0
+#define FORMAT_FLOAT2 1
+#define FORMAT_HALF4 2
+#define FORMAT_HALF2 3
+#define FORMAT_SNORM_10_10_10_2 4
+#define FORMAT_OCTAHEDRAL 5
+#define FORMAT_UNORM8x4 6
+
+// without a VertexLayout: float4 positions and normals and float2 uvs, a stream each.
+#ifndef VERTEX_LAYOUT
+#define POSITION_FORMAT FORMAT_FLOAT4
+#define POSITION_STREAM POSITION
+#define POSITION_OFFSET 0
+#define POSITION_STRIDE 4
+#define NORMAL_FORMAT FORMAT_FLOAT4
+#define NORMAL_STREAM NORMAL
+#define NORMAL_OFFSET 0
+#define NORMAL_STRIDE 4
+#define TEXTCOORD_FORMAT FORMAT_FLOAT2
+#define TEXTCOORD_STREAM TEXTCOORD
+#define TEXTCOORD_OFFSET 0
+#define TEXTCOORD_STRIDE 2
+#endif
+
+// buffer inputs, pulled as words: one block per stream, attributes sharing a stream share it.
+layout(std430, binding=POSITION_STREAM) readonly buffer pos { uint position_words[]; };
 #ifdef NORMAL
-	layout(binding=NORMAL) buffer nor { vec4 normal_in[]; };
+	#if NORMAL_STREAM == POSITION_STREAM
+		#define normal_words position_words
+	#else
+		layout(std430, binding=NORMAL_STREAM) readonly buffer nor { uint normal_words[]; };
+	#endif
 	layout(location=NORMAL) out vec4 normal_out;
 #endif
 
 #ifdef TEXTCOORD
-	layout(binding=TEXTCOORD) buffer text { vec2 uv_in[]; };
+	#if TEXTCOORD_STREAM == POSITION_STREAM
+		#define uv_words position_words
+	#elif defined(NORMAL)
+		#if TEXTCOORD_STREAM == NORMAL_STREAM
+			#define uv_words normal_words
+		#endif
+	#endif
+	#ifndef uv_words
+		layout(std430, binding=TEXTCOORD_STREAM) readonly buffer text { uint uv_words[]; };
+	#endif
 	layout(location=TEXTCOORD) out vec2 uv_out;
 #endif
-layout(binding=POSITION) buffer pos { vec4 position_in[]; };
+
+vec4 decodeSnorm1010102(uint p)
+{
+	ivec4 v = ivec4(bitfieldExtract(int(p), 0, 10), bitfieldExtract(int(p), 10, 10),
+		bitfieldExtract(int(p), 20, 10), bitfieldExtract(int(p), 30, 2));
+	return max(vec4(v) / vec4(511.0, 511.0, 511.0, 1.0), -1.0);
+}
+
+vec3 decodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+		n.xy = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
+// w holds the attribute's words, as many as its format has.
+vec4 decodeVertex(int format, uvec4 w)
+{
+	if (format == FORMAT_FLOAT4)
+		return uintBitsToFloat(w);
+	if (format == FORMAT_FLOAT2)
+		return vec4(uintBitsToFloat(w.xy), 0.0, 1.0);
+	if (format == FORMAT_HALF4)
+		return vec4(unpackHalf2x16(w.x), unpackHalf2x16(w.y));
+	if (format == FORMAT_HALF2)
+		return vec4(unpackHalf2x16(w.x), 0.0, 1.0);
+	if (format == FORMAT_SNORM_10_10_10_2)
+		return decodeSnorm1010102(w.x);
+	if (format == FORMAT_OCTAHEDRAL)
+		return vec4(decodeOctahedral(unpackSnorm2x16(w.x)), 0.0);
+	return unpackUnorm4x8(w.x);
+}
+
+// the format is a constant, the words past its size are never read.
+#define FORMAT_WORDS(format) (format == FORMAT_FLOAT4 ? 4 : format == FORMAT_FLOAT2 || format == FORMAT_HALF4 ? 2 : 1)
+// the words of vertex word w on.
+#define FETCH(words, format, w) decodeVertex(format, uvec4(words[w], FORMAT_WORDS(format) > 1 ? words[(w) + 1] : 0u, FORMAT_WORDS(format) > 2 ? words[(w) + 2] : 0u, FORMAT_WORDS(format) > 3 ? words[(w) + 3] : 0u))
 
 // uniform block
 // layout(std140, binding = 20) uniform TransformBlock
@@ -17,10 +98,18 @@ layout(binding=POSITION) buffer pos { vec4 position_in[]; };
 //  	vec4 tx;
 // } transform;
 
+#ifdef TRANSLATION_BUFFER
+// the renderer's translations, the draw's is at its base instance.
+layout(std430, binding=TRANSLATION) readonly buffer TRANSLATION_NAME
+{
+	vec4 translations[];
+};
+#else
 layout(binding=TRANSLATION) uniform TRANSLATION_NAME
 {
 	vec4 translate;
 };
+#endif
 
 layout(binding=DIFFUSE_TINT) uniform DIFFUSE_TINT_NAME
 {
@@ -30,12 +119,15 @@ layout(binding=DIFFUSE_TINT) uniform DIFFUSE_TINT_NAME
 void main() {
 
 	#ifdef NORMAL
-		normal_out = normal_in[gl_VertexID];
+		normal_out = FETCH(normal_words, NORMAL_FORMAT, uint(gl_VertexID) * NORMAL_STRIDE + NORMAL_OFFSET);
 	#endif
 
 	#ifdef TEXTCOORD
-		uv_out = uv_in[gl_VertexID];
+		uv_out = FETCH(uv_words, TEXTCOORD_FORMAT, uint(gl_VertexID) * TEXTCOORD_STRIDE + TEXTCOORD_OFFSET).xy;
 	#endif
 
-	gl_Position = position_in[gl_VertexID] + translate;
+	#ifdef TRANSLATION_BUFFER
+		vec4 translate = translations[gl_BaseInstanceARB];
+	#endif
+	gl_Position = FETCH(position_words, POSITION_FORMAT, uint(gl_VertexID) * POSITION_STRIDE + POSITION_OFFSET) + translate;
 };
@@ -0,0 +1,25 @@
+
+// one thread per mesh: the translation of mesh i is place (first + i) % places
+// of the curve, as updateScene computes it on the CPU.
+layout(local_size_x = 64) in;
+
+// x and y of every place of the curve.
+layout(std430, binding=PLACES) readonly buffer curve { vec2 place[]; };
+
+// the renderer's translations, one every stride vec4.
+layout(std430, binding=TRANSLATION) writeonly buffer TRANSLATION_NAME { vec4 translations[]; };
+
+// x: place of mesh 0, y: meshes, z: places, w: stride in vec4.
+layout(push_constant) uniform ANIMATION_NAME
+{
+	uvec4 animation;
+};
+
+void main()
+{
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= animation.y)
+		return;
+	vec2 p = place[(animation.x + i) % animation.z];
+	translations[i * animation.w] = vec4(p, float(i) * (-1.0 / float(animation.z)), 0.0);
+}
@@ -1,7 +1,49 @@
 
+// VertexLayout::FORMAT, in its order.
+#define FORMAT_FLOAT4 0
+#define FORMAT_FLOAT2 1
+#define FORMAT_HALF4 2
+#define FORMAT_HALF2 3
+#define FORMAT_SNORM_10_10_10_2 4
+#define FORMAT_OCTAHEDRAL 5
+#define FORMAT_UNORM8x4 6
+
+// without a VertexLayout: float4 positions and normals, float2 uvs.
+#ifndef VERTEX_LAYOUT
+#define POSITION_FORMAT FORMAT_FLOAT4
+#define NORMAL_FORMAT FORMAT_FLOAT4
+#define TEXTCOORD_FORMAT FORMAT_FLOAT2
+#endif
+
+// the vertex input state converts floats, halves and unorms. 10:10:10:2 comes
+// in as the packed word and octahedral as two snorms, they are decoded here.
+vec4 decodeSnorm1010102(uint p)
+{
+	ivec4 v = ivec4(bitfieldExtract(int(p), 0, 10), bitfieldExtract(int(p), 10, 10),
+		bitfieldExtract(int(p), 20, 10), bitfieldExtract(int(p), 30, 2));
+	return max(vec4(v) / vec4(511.0, 511.0, 511.0, 1.0), -1.0);
+}
+
+vec3 decodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+		n.xy = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
 // buffer inputs
 #ifdef NORMAL
-	layout(location=NORMAL) in vec4 normal_in;
+	#if NORMAL_FORMAT == FORMAT_SNORM_10_10_10_2
+		layout(location=NORMAL) in uint normal_in;
+		#define NORMAL_VALUE decodeSnorm1010102(normal_in)
+	#elif NORMAL_FORMAT == FORMAT_OCTAHEDRAL
+		layout(location=NORMAL) in vec2 normal_in;
+		#define NORMAL_VALUE vec4(decodeOctahedral(normal_in), 0.0)
+	#else
+		layout(location=NORMAL) in vec4 normal_in;
+		#define NORMAL_VALUE normal_in
+	#endif
 	layout(location=NORMAL) out vec4 normal_out;
 #endif
 
@@ -9,8 +51,13 @@
 	layout(location =TEXTCOORD) in vec2 uv_in;
 	layout(location=TEXTCOORD) out vec2 uv_out;
 #endif
-layout(location=POSITION) in vec4 position_in;
-
+#if POSITION_FORMAT == FORMAT_SNORM_10_10_10_2
+	layout(location=POSITION) in uint position_in;
+	#define POSITION_VALUE decodeSnorm1010102(position_in)
+#else
+	layout(location=POSITION) in vec4 position_in;
+	#define POSITION_VALUE position_in
+#endif
 
 // uniform block
 // layout(std140, binding = 20) uniform TransformBlock
@@ -18,10 +65,18 @@ layout(location=POSITION) in vec4 position_in;
 //  	vec4 tx;
 // } transform;
 
+#ifdef TRANSLATION_BUFFER
+// written by a compute pass, one per draw (the first instance).
+layout(std430, binding=TRANSLATION) readonly buffer TRANSLATION_NAME
+{
+	vec4 translations[];
+};
+#else
 layout(push_constant) uniform TRANSLATION_NAME
 {
 	layout(offset = 0) vec4 translate;
 };
+#endif
 
 
 //layout(binding=DIFFUSE_TINT) uniform DIFFUSE_TINT_NAME
@@ -33,13 +88,17 @@ void main()
 {
 
 	#ifdef NORMAL
-		normal_out = normal_in;
+		normal_out = NORMAL_VALUE;
 	#endif
 
 	#ifdef TEXTCOORD
 		uv_out = uv_in;
 	#endif
-	gl_Position = position_in + translate;
+
+	#ifdef TRANSLATION_BUFFER
+		vec4 translate = translations[gl_InstanceIndex];
+	#endif
+	gl_Position = POSITION_VALUE + translate;
 	gl_Position.y = -gl_Position.y; //Flip that shit!
 	gl_Position.z = -gl_Position.z;
 }
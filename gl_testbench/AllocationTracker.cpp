@@ -0,0 +1,322 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include "AllocationTracker.h"
+
+#if defined(TESTBENCH_ALLOCATIONS) && defined(__GLIBC__)
+#define ALLOCATION_HOOKS_MALLOC
+extern "C" {
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* p, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+	void* __libc_valloc(size_t size);
+	void* __libc_pvalloc(size_t size);
+	void __libc_free(void* p);
+}
+#elif defined(TESTBENCH_ALLOCATIONS) && defined(_MSC_VER) && defined(_DEBUG)
+#define ALLOCATION_HOOKS_MALLOC
+#include <crtdbg.h>
+#endif
+
+const uint32_t AllocationTracker::MAX_ZONES;
+
+/*
+ everything here can run before main and inside malloc: plain zero
+ initialized statics only, nothing that allocates.
+*/
+namespace {
+	const char* const NO_ZONE = "(no zone)";
+	const char* const OTHER_ZONES = "(other zones)";
+
+	std::atomic<uint64_t> allocations;
+	std::atomic<uint64_t> frees;
+	std::atomic<uint64_t> bytes;
+	std::atomic<bool> trackZones;
+	thread_local const char* currentZone = nullptr;
+
+	struct ZoneSlot {
+		// nullptr while free, the zone name pointer once claimed.
+		std::atomic<const char*> name;
+		std::atomic<uint64_t> allocations, bytes;
+	};
+	ZoneSlot zoneTable[AllocationTracker::MAX_ZONES];
+	ZoneSlot otherZones;
+
+#ifdef TESTBENCH_ALLOCATIONS
+	// zone names are literals, their addresses are the keys.
+	ZoneSlot& zoneSlot(const char* zone)
+	{
+		const uint32_t hash = (uint32_t)(((uintptr_t)zone >> 3) * 2654435761u);
+		for (uint32_t i = 0; i < AllocationTracker::MAX_ZONES; i++)
+		{
+			ZoneSlot& slot = zoneTable[(hash + i) % AllocationTracker::MAX_ZONES];
+			const char* name = slot.name.load(std::memory_order_acquire);
+			if (name == nullptr)
+			{
+				if (slot.name.compare_exchange_strong(name, zone, std::memory_order_acq_rel) || name == zone)
+					return slot;
+			}
+			else if (name == zone)
+				return slot;
+		}
+		return otherZones;
+	}
+
+	void recordAllocation(size_t size)
+	{
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+		if (!trackZones.load(std::memory_order_relaxed))
+			return;
+		ZoneSlot& slot = zoneSlot(currentZone ? currentZone : NO_ZONE);
+		slot.allocations.fetch_add(1, std::memory_order_relaxed);
+		slot.bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	void recordFree()
+	{
+		frees.fetch_add(1, std::memory_order_relaxed);
+	}
+#endif
+
+#if defined(ALLOCATION_HOOKS_MALLOC) && defined(_MSC_VER)
+	// sees the CRT heap, operator new included. CRT internal blocks are skipped.
+	int __cdecl crtAllocHook(int allocType, void* userData, size_t size, int blockType,
+		long requestNumber, const unsigned char* filename, int lineNumber)
+	{
+		if (blockType == _CRT_BLOCK)
+			return 1;
+		switch (allocType)
+		{
+		case _HOOK_ALLOC: recordAllocation(size); break;
+		case _HOOK_REALLOC: recordAllocation(size); recordFree(); break;
+		case _HOOK_FREE: recordFree(); break;
+		}
+		return 1;
+	}
+
+	struct InstallCrtHook {
+		InstallCrtHook() { _CrtSetAllocHook(crtAllocHook); }
+	} installCrtHook;
+#endif
+}
+
+#if defined(ALLOCATION_HOOKS_MALLOC) && defined(__GLIBC__)
+/*
+ the executable's definitions win over libc's for every library in the
+ process. Every allocating entry point of glibc is here, so each block
+ free() sees was counted when it was made. A realloc of a live block
+ counts as a free and an allocation.
+*/
+extern "C" {
+	void* malloc(size_t size) noexcept
+	{
+		recordAllocation(size);
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t count, size_t size) noexcept
+	{
+		recordAllocation(count * size);
+		return __libc_calloc(count, size);
+	}
+
+	void* realloc(void* p, size_t size) noexcept
+	{
+		if (p)
+			recordFree();
+		if (p == nullptr || size)
+			recordAllocation(size);
+		return __libc_realloc(p, size);
+	}
+
+	void* reallocarray(void* p, size_t count, size_t size) noexcept
+	{
+		if (size && count > (size_t)-1 / size)
+		{
+			errno = ENOMEM;
+			return nullptr;
+		}
+		return realloc(p, count * size);
+	}
+
+	void* memalign(size_t alignment, size_t size) noexcept
+	{
+		recordAllocation(size);
+		return __libc_memalign(alignment, size);
+	}
+
+	void* aligned_alloc(size_t alignment, size_t size) noexcept
+	{
+		recordAllocation(size);
+		return __libc_memalign(alignment, size);
+	}
+
+	int posix_memalign(void** p, size_t alignment, size_t size) noexcept
+	{
+		if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+			return EINVAL;
+		recordAllocation(size);
+		void* block = __libc_memalign(alignment, size);
+		if (block == nullptr)
+			return ENOMEM;
+		*p = block;
+		return 0;
+	}
+
+	void* valloc(size_t size) noexcept
+	{
+		recordAllocation(size);
+		return __libc_valloc(size);
+	}
+
+	void* pvalloc(size_t size) noexcept
+	{
+		recordAllocation(size);
+		return __libc_pvalloc(size);
+	}
+
+	void free(void* p) noexcept
+	{
+		if (p)
+			recordFree();
+		__libc_free(p);
+	}
+}
+#endif
+
+#ifdef TESTBENCH_ALLOCATIONS
+// with the malloc hooks in place the malloc below is what gets counted.
+void* operator new(size_t size)
+{
+#ifndef ALLOCATION_HOOKS_MALLOC
+	recordAllocation(size);
+#endif
+	void* p = malloc(size ? size : 1);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+#ifndef ALLOCATION_HOOKS_MALLOC
+	if (p)
+		recordFree();
+#endif
+	free(p);
+}
+
+// what the compiler calls when it knows the size (C++14 sized deallocation).
+void operator delete(void* p, size_t) noexcept
+{
+	operator delete(p);
+}
+#endif
+
+AllocationTracker::Counters AllocationTracker::total()
+{
+	Counters c;
+	c.allocations = allocations.load(std::memory_order_relaxed);
+	c.frees = frees.load(std::memory_order_relaxed);
+	c.bytes = bytes.load(std::memory_order_relaxed);
+	return c;
+}
+
+bool AllocationTracker::counting()
+{
+#ifdef TESTBENCH_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool AllocationTracker::hooksMalloc()
+{
+#ifdef ALLOCATION_HOOKS_MALLOC
+	return true;
+#else
+	return false;
+#endif
+}
+
+void AllocationTracker::setZoneTracking(bool enabled)
+{
+	trackZones.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::zoneTracking()
+{
+	return trackZones.load(std::memory_order_relaxed);
+}
+
+std::vector<AllocationTracker::Zone> AllocationTracker::zones()
+{
+	std::vector<Zone> list;
+	list.reserve(MAX_ZONES + 1);
+	for (auto& slot : zoneTable)
+	{
+		const char* name = slot.name.load(std::memory_order_acquire);
+		const uint64_t count = slot.allocations.load(std::memory_order_relaxed);
+		if (name && count)
+			list.push_back({ name, count, slot.bytes.load(std::memory_order_relaxed) });
+	}
+	if (otherZones.allocations.load(std::memory_order_relaxed))
+		list.push_back({ OTHER_ZONES, otherZones.allocations.load(std::memory_order_relaxed), otherZones.bytes.load(std::memory_order_relaxed) });
+	std::sort(list.begin(), list.end(), [](const Zone& a, const Zone& b) { return a.allocations > b.allocations; });
+	return list;
+}
+
+void AllocationTracker::resetZones()
+{
+	// slots keep their names: other threads may be charging them right now.
+	for (auto& slot : zoneTable)
+	{
+		slot.allocations.store(0, std::memory_order_relaxed);
+		slot.bytes.store(0, std::memory_order_relaxed);
+	}
+	otherZones.allocations.store(0, std::memory_order_relaxed);
+	otherZones.bytes.store(0, std::memory_order_relaxed);
+}
+
+const char* AllocationTracker::enterZone(const char* name)
+{
+	const char* parent = currentZone;
+	currentZone = name;
+	return parent;
+}
+
+void AllocationTracker::leaveZone(const char* parent)
+{
+	currentZone = parent;
+}
+
+void AllocationTracker::writeReport(FILE* out, uint64_t frames)
+{
+	if (!counting())
+	{
+		fprintf(out, "allocations are not counted, TESTBENCH_ALLOCATIONS is not defined\n");
+		return;
+	}
+	const Counters t = total();
+	fprintf(out, "%llu allocations, %llu frees, %.2f MiB allocated since start%s\n", (unsigned long long)t.allocations,
+		(unsigned long long)t.frees, t.bytes / 1048576.0, hooksMalloc() ? "" : " (operator new and delete only)");
+	if (!zoneTracking())
+		return;
+	std::vector<Zone> list = zones();
+	if (frames)
+		fprintf(out, "\n%-32s %14s %14s\n", "zone", "allocs/frame", "bytes/frame");
+	else
+		fprintf(out, "\n%-32s %14s %14s\n", "zone", "allocations", "bytes");
+	for (auto& z : list)
+	{
+		if (frames)
+			fprintf(out, "%-32s %14.2f %14.1f\n", z.name, (double)z.allocations / frames, (double)z.bytes / frames);
+		else
+			fprintf(out, "%-32s %14llu %14llu\n", z.name, (unsigned long long)z.allocations, (unsigned long long)z.bytes);
+	}
+}
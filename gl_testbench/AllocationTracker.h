@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/*
+ Counts every heap allocation of the process, in builds that define
+ TESTBENCH_ALLOCATIONS (the CMake option of the same name, off by default;
+ add it to the preprocessor definitions of the vcxproj). Then this file
+ replaces the global operator new and delete, and hooks the C allocator:
+
+	glibc				malloc, calloc, realloc, reallocarray, memalign,
+						posix_memalign, aligned_alloc, valloc, pvalloc and
+						free interposed, forwarded to __libc_malloc and friends
+	MSVC debug CRT		_CrtSetAllocHook
+	otherwise			only operator new and delete are counted
+
+ Other builds interpose nothing: the counters stay 0 and counting() is
+ false. With it the totals are always kept (a relaxed atomic add per
+ call). FrameStats takes the difference every frame, so
+ FrameStats::last().allocations is what the last frame allocated, on any
+ thread, driver threads included.
+
+ With zone tracking on, every allocation is also charged to the innermost
+ PROFILE_ZONE of the allocating thread (TESTBENCH_PROFILE builds, the
+ others charge everything to "(no zone)"). The zone table is fixed size and
+ the hooks never allocate themselves.
+
+	AllocationTracker::setZoneTracking(true);
+	... warm up ...
+	AllocationTracker::resetZones();
+	... frames that should not allocate ...
+	AllocationTracker::writeReport(stderr, frames);
+*/
+class AllocationTracker
+{
+public:
+	// distinct zones kept, allocations in zones beyond that go to "(other zones)".
+	static const uint32_t MAX_ZONES = 256;
+
+	struct Counters {
+		uint64_t allocations = 0;
+		uint64_t frees = 0;
+		// requested bytes, frees are not subtracted.
+		uint64_t bytes = 0;
+	};
+
+	struct Zone {
+		const char* name;
+		uint64_t allocations, bytes;
+	};
+
+	// since the start of the process, 0 unless counting().
+	static Counters total();
+	// true in TESTBENCH_ALLOCATIONS builds.
+	static bool counting();
+	// false where only operator new and delete are seen.
+	static bool hooksMalloc();
+
+	static void setZoneTracking(bool enabled);
+	static bool zoneTracking();
+	// zones charged since the last resetZones(), most allocations first.
+	static std::vector<Zone> zones();
+	static void resetZones();
+
+	// used by ProfileZone, returns the zone to restore when it ends.
+	static const char* enterZone(const char* name);
+	static void leaveZone(const char* parent);
+
+	// the zone table, per frame when frames is given.
+	static void writeReport(FILE* out, uint64_t frames = 0);
+};
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <string.h>
+#include "ApiTrace.h"
+
+const uint32_t ApiTrace::MAX_ARGS;
+const uint32_t ApiTrace::BUCKETS;
+ApiTrace* ApiTrace::active = nullptr;
+
+static uint32_t bucket(uint32_t calls)
+{
+	uint32_t b = 0;
+	while (calls > 0 && b < ApiTrace::BUCKETS - 1)
+	{
+		calls >>= 1;
+		b++;
+	}
+	return b;
+}
+
+void ApiTrace::call(const char* function, const void* site, bool redundant, std::initializer_list<uint64_t> args)
+{
+	Function& f = functions[function];
+	f.calls++;
+	f.frameCalls++;
+
+	Site& s = sites[std::make_pair(function, site)];
+	s.function = function;
+	s.address = site;
+	s.calls++;
+	if (redundant)
+	{
+		f.redundant++;
+		s.redundant++;
+	}
+	if (redundant || s.redundant == 0)
+	{
+		s.argCount = 0;
+		for (uint64_t a : args)
+			if (s.argCount < MAX_ARGS)
+				s.args[s.argCount++] = a;
+	}
+}
+
+void ApiTrace::endFrame()
+{
+	for (auto& entry : functions)
+	{
+		Function& f = entry.second;
+		f.histogram[bucket(f.frameCalls)]++;
+		f.maxFrameCalls = std::max(f.maxFrameCalls, f.frameCalls);
+		f.frameCalls = 0;
+	}
+	frames++;
+}
+
+void ApiTrace::writeReport(FILE* out, size_t count) const
+{
+	const double n = frames > 0 ? (double)frames : 1.0;
+	fprintf(out, "API trace, %llu frames\n\n", (unsigned long long)frames);
+	fprintf(out, "%-28s %12s %16s %8s %8s  calls per frame: frames\n", "function", "calls/frame", "redundant/frame", "%", "max");
+
+	std::vector<std::pair<const char*, const Function*>> byName;
+	for (auto& entry : functions)
+		byName.push_back(std::make_pair(entry.first, &entry.second));
+	std::sort(byName.begin(), byName.end(), [](const std::pair<const char*, const Function*>& a, const std::pair<const char*, const Function*>& b) {
+		return strcmp(a.first, b.first) < 0;
+	});
+	for (auto& entry : byName)
+	{
+		const Function& f = *entry.second;
+		fprintf(out, "%-28s %12.1f %16.1f %7.1f%% %8u ", entry.first, f.calls / n, f.redundant / n,
+			f.calls ? 100.0 * f.redundant / f.calls : 0.0, f.maxFrameCalls);
+		// frames that never called the function count as 0 calls.
+		uint64_t counted = 0;
+		for (uint32_t b = 0; b < BUCKETS; b++)
+			counted += f.histogram[b];
+		for (uint32_t b = 0; b < BUCKETS; b++)
+		{
+			uint64_t inBucket = f.histogram[b] + (b == 0 ? frames - counted : 0);
+			if (inBucket == 0)
+				continue;
+			if (b < 2)
+				fprintf(out, " %u:%llu", b, (unsigned long long)inBucket);
+			else
+				fprintf(out, " %u-%u:%llu", 1u << (b - 1), (1u << b) - 1, (unsigned long long)inBucket);
+		}
+		fprintf(out, "\n");
+	}
+
+	std::vector<const Site*> ranked;
+	for (auto& entry : sites)
+		if (entry.second.redundant > 0)
+			ranked.push_back(&entry.second);
+	std::sort(ranked.begin(), ranked.end(), [](const Site* a, const Site* b) {
+		return a->redundant != b->redundant ? a->redundant > b->redundant : a->calls > b->calls;
+	});
+	if (ranked.size() > count)
+		ranked.resize(count);
+
+	fprintf(out, "\nmost redundant call sites\n");
+	fprintf(out, "%-4s %-28s %-18s %12s %12s  last redundant arguments\n", "rank", "function", "site", "redundant", "calls");
+	for (size_t i = 0; i < ranked.size(); i++)
+	{
+		const Site& s = *ranked[i];
+		fprintf(out, "%-4zu %-28s %-18p %12llu %12llu ", i + 1, s.function, s.address,
+			(unsigned long long)s.redundant, (unsigned long long)s.calls);
+		for (uint32_t a = 0; a < s.argCount; a++)
+			fprintf(out, " 0x%llx", (unsigned long long)s.args[a]);
+		fprintf(out, "\n");
+	}
+	if (ranked.empty())
+		fprintf(out, "none\n");
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <initializer_list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define API_CALL_SITE() _ReturnAddress()
+#else
+#define API_CALL_SITE() __builtin_return_address(0)
+#endif
+
+/*
+ Call statistics collected by the API interposers (OpenGL/GLInterposer.h,
+ Vulkan/VulkanInterposer.h). An interposer wraps a driver entry point, works
+ out whether the call changes anything (same program, same buffer range,
+ same sampler value, range mapped twice in a frame, ...) and reports it here
+ together with the address it was called from and its arguments.
+
+ Calls are counted per function and per call site, endFrame() closes a
+ frame. writeReport() prints the calls per frame of every function with a
+ histogram over the frames, then the call sites ranked by redundant calls.
+ Sites are return addresses: resolve them with the debugger (Disassembly,
+ Go To Address) or addr2line.
+
+ Off unless ApiTrace::active is set before the renderer is initialized.
+*/
+class ApiTrace
+{
+public:
+	// arguments kept per call site.
+	static const uint32_t MAX_ARGS = 5;
+	// histogram buckets of calls per frame: 0, 1, 2-3, 4-7, ... 2^(BUCKETS-2)+.
+	static const uint32_t BUCKETS = 16;
+
+	// where the interposers report, nullptr when tracing is off.
+	static ApiTrace* active;
+
+	void call(const char* function, const void* site, bool redundant, std::initializer_list<uint64_t> args = {});
+	void endFrame();
+	// frames closed so far, the interposers use it to scope per-frame state.
+	uint64_t frame() const { return frames; };
+	// sites: length of the ranked list.
+	void writeReport(FILE* out, size_t sites = 20) const;
+private:
+	struct Function {
+		uint64_t calls = 0, redundant = 0;
+		uint32_t frameCalls = 0;
+		uint32_t maxFrameCalls = 0;
+		uint64_t histogram[BUCKETS] = {};
+	};
+	struct Site {
+		const char* function;
+		const void* address;
+		uint64_t calls = 0, redundant = 0;
+		uint32_t argCount = 0;
+		// of the last redundant call, or of the last call when there was none.
+		uint64_t args[MAX_ARGS] = {};
+	};
+
+	uint64_t frames = 0;
+	// keyed by the name literals the interposers pass.
+	std::map<const char*, Function> functions;
+	std::map<std::pair<const char*, const void*>, Site> sites;
+};
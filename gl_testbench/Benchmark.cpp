@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <stdlib.h>
+#include <SDL_timer.h>
+#include <SDL_events.h>
+
+#include "Benchmark.h"
+#include "Null/NullRenderer.h"
+#include "StaticBackend.h"
+
+// fixed animation step, independent of how fast the frames are produced.
+static const double FRAME_STEP = 1.0 / 60.0;
+
+static const char* backendName(Renderer::BACKEND backend)
+{
+	switch (backend)
+	{
+	case Renderer::BACKEND::GL45: return "gl45";
+	case Renderer::BACKEND::VULKAN: return "vulkan";
+	case Renderer::BACKEND::DX11: return "dx11";
+	case Renderer::BACKEND::DX12: return "dx12";
+	case Renderer::BACKEND::NULL_RENDERER: return "null";
+	case Renderer::BACKEND::SOFTWARE: return "software";
+	}
+	return "unknown";
+}
+
+// "static" for the backend of a TESTBENCH_STATIC_ build, see StaticBackend.h.
+static const char* dispatchName(Renderer::BACKEND backend)
+{
+#ifdef TESTBENCH_STATIC_BACKEND
+	if (backend == TESTBENCH_STATIC_BACKEND)
+		return "static";
+#endif
+	return "virtual";
+}
+
+static const char* submissionName(Renderer::SUBMISSION submission)
+{
+	return submission == Renderer::SUBMISSION::UNSORTED ? "unsorted" : "per_technique";
+}
+
+// nearest rank percentile on sorted samples
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	size_t rank = (size_t)(p * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+static void addFrameStats(FrameStats& sum, const FrameStats& f)
+{
+	sum.drawsSubmitted += f.drawsSubmitted;
+	sum.drawsIssued += f.drawsIssued;
+	sum.dispatches += f.dispatches;
+	sum.indirectDraws += f.indirectDraws;
+	sum.pipelineBinds += f.pipelineBinds;
+	sum.vertexBufferBinds += f.vertexBufferBinds;
+	sum.textureBinds += f.textureBinds;
+	sum.descriptorWrites += f.descriptorWrites;
+	sum.pushConstantBytes += f.pushConstantBytes;
+	sum.uniformBytes += f.uniformBytes;
+	sum.bufferMaps += f.bufferMaps;
+	sum.bufferUnmaps += f.bufferUnmaps;
+	sum.stagingBytes += f.stagingBytes;
+	sum.queueSubmits += f.queueSubmits;
+	sum.queueWaits += f.queueWaits;
+	sum.occluderTriangles += f.occluderTriangles;
+	sum.occlusionTests += f.occlusionTests;
+	sum.occlusionCulled += f.occlusionCulled;
+	sum.occlusionMicros += f.occlusionMicros;
+	sum.allocations += f.allocations;
+	sum.frees += f.frees;
+	sum.allocatedBytes += f.allocatedBytes;
+}
+
+BenchmarkResult runBenchmark(const BenchmarkScenario& scenario, bool headless)
+{
+	MemoryTracker::reset();
+	Renderer* renderer = Renderer::makeRenderer(scenario.backend);
+	BenchmarkResult result = {};
+	result.scenario = scenario;
+	if (renderer->initialize(800, 600, headless) != 0)
+	{
+		delete renderer;
+		result.error = "the renderer does not initialize";
+		return result;
+	}
+	renderer->setClearColor(0.0, 0.1, 0.1, 1.0);
+	renderer->setSubmission(scenario.submission);
+	if (initialiseTestbench(renderer, scenario.scene) != 0)
+	{
+		renderer->shutdown();
+		delete renderer;
+		result.error = "the scene does not compile";
+		return result;
+	}
+	// what runs, after the fallbacks.
+	result.scenario.scene = testbenchConfig();
+
+	size_t trianglesPerFrame = 0;
+	for (auto m : scene)
+		trianglesPerFrame += m->geometryBuffers[POSITION].numElements / 3;
+
+	long long frame = 0;
+	for (int i = 0; i < scenario.warmupFrames; i++, frame++)
+	{
+		updateScene(frame * FRAME_STEP);
+		renderScene(renderer);
+	}
+
+	GpuProfiler* gpuProfiler = renderer->getGpuProfiler();
+	if (gpuProfiler)
+		gpuProfiler->resetStats();
+
+	std::vector<double> samples(scenario.measuredFrames);
+	const double toMs = 1000.0 / SDL_GetPerformanceFrequency();
+	for (int i = 0; i < scenario.measuredFrames; i++, frame++)
+	{
+		Uint64 start = SDL_GetPerformanceCounter();
+		updateScene(frame * FRAME_STEP);
+		renderScene(renderer);
+		samples[i] = (SDL_GetPerformanceCounter() - start) * toMs;
+		addFrameStats(result.api, renderer->getFrameStats());
+		// keep the window responsive, input is ignored.
+		SDL_PumpEvents();
+	}
+
+	CommandStream recording;
+	if (scenario.backend == Renderer::BACKEND::NULL_RENDERER)
+	{
+		((NullRenderer*)renderer)->setRecording(&recording);
+		updateScene(frame * FRAME_STEP);
+		renderScene(renderer);
+		((NullRenderer*)renderer)->setRecording(nullptr);
+	}
+
+	if (gpuProfiler)
+		result.gpuScopes = gpuProfiler->getStats();
+	for (size_t c = 0; c < (size_t)MemoryTracker::CATEGORY::COUNT; c++)
+		result.memory.push_back(MemoryTracker::usage((MemoryTracker::CATEGORY)c));
+	result.memory.push_back(MemoryTracker::total());
+
+	shutdownTestbench();
+	renderer->shutdown();
+	delete renderer;
+
+	result.streamBytes = recording.size();
+	result.streamHash = recording.hash();
+	if (samples.empty())
+		return result;
+
+	double total = 0.0;
+	for (double s : samples)
+		total += s;
+	std::sort(samples.begin(), samples.end());
+	result.minMs = samples.front();
+	result.medianMs = percentile(samples, 0.5);
+	result.p95Ms = percentile(samples, 0.95);
+	result.p99Ms = percentile(samples, 0.99);
+	result.maxMs = samples.back();
+	result.meanMs = total / samples.size();
+	double seconds = total / 1000.0;
+	result.drawsPerSecond = seconds > 0.0 ? scenario.scene.meshCount * samples.size() / seconds : 0.0;
+	result.trianglesPerSecond = seconds > 0.0 ? trianglesPerFrame * samples.size() / seconds : 0.0;
+	return result;
+}
+
+void writeBenchmarkJSON(FILE* out, const std::vector<BenchmarkResult>& results)
+{
+	fprintf(out, "{\n  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& r = results[i];
+		const BenchmarkScenario& s = r.scenario;
+		fprintf(out, "    {\n");
+		fprintf(out, "      \"backend\": \"%s\",\n", backendName(s.backend));
+		fprintf(out, "      \"submission\": \"%s\",\n", submissionName(s.submission));
+		fprintf(out, "      \"dispatch\": \"%s\",\n", dispatchName(s.backend));
+		fprintf(out, "      \"meshes\": %d,\n", s.scene.meshCount);
+		fprintf(out, "      \"textured_fraction\": %.3f,\n", s.scene.texturedFraction);
+		fprintf(out, "      \"techniques\": %d,\n", s.scene.techniqueCount);
+		fprintf(out, "      \"retained\": %s,\n", s.scene.retained ? "true" : "false");
+		fprintf(out, "      \"cull\": %s,\n", s.scene.cull ? "true" : "false");
+		fprintf(out, "      \"occluder\": %.3f,\n", s.scene.occluderSize);
+		fprintf(out, "      \"gpu_animation\": %s,\n", s.scene.gpuAnimation ? "true" : "false");
+		fprintf(out, "      \"gpu_cull\": %s,\n", s.scene.gpuCull ? "true" : "false");
+		fprintf(out, "      \"indexed\": %s,\n", s.scene.indexed ? "true" : "false");
+		fprintf(out, "      \"vertex_layout\": \"%s\",\n", s.scene.interleaved ? "interleaved" : "split");
+		fprintf(out, "      \"quantized\": %s,\n", s.scene.quantized ? "true" : "false");
+		fprintf(out, "      \"warmup_frames\": %d,\n", s.warmupFrames);
+		fprintf(out, "      \"measured_frames\": %d,\n", s.measuredFrames);
+		fprintf(out, "      \"frame_ms\": { \"min\": %.4f, \"median\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"mean\": %.4f },\n",
+			r.minMs, r.medianMs, r.p95Ms, r.p99Ms, r.maxMs, r.meanMs);
+		fprintf(out, "      \"draws_per_second\": %.1f,\n", r.drawsPerSecond);
+		if (s.backend == Renderer::BACKEND::NULL_RENDERER)
+			fprintf(out, "      \"stream_bytes\": %zu,\n      \"stream_hash\": \"%016llx\",\n", r.streamBytes, (unsigned long long)r.streamHash);
+		const double frames = s.measuredFrames > 0 ? s.measuredFrames : 1;
+		fprintf(out, "      \"api_per_frame\": { \"draws\": %.1f, \"dispatches\": %.1f, \"indirect_draws\": %.1f, \"pipeline_binds\": %.1f, \"vertex_buffer_binds\": %.1f, \"texture_binds\": %.1f, "
+			"\"descriptor_writes\": %.1f, \"push_constant_bytes\": %.1f, \"uniform_bytes\": %.1f, \"buffer_maps\": %.1f, \"staging_bytes\": %.1f, "
+			"\"queue_submits\": %.2f, \"queue_waits\": %.2f, \"allocations\": %.2f, \"allocated_bytes\": %.1f },\n",
+			r.api.drawsIssued / frames, r.api.dispatches / frames, r.api.indirectDraws / frames, r.api.pipelineBinds / frames, r.api.vertexBufferBinds / frames, r.api.textureBinds / frames,
+			r.api.descriptorWrites / frames, r.api.pushConstantBytes / frames, r.api.uniformBytes / frames, r.api.bufferMaps / frames, r.api.stagingBytes / frames,
+			r.api.queueSubmits / frames, r.api.queueWaits / frames, r.api.allocations / frames, r.api.allocatedBytes / frames);
+		if (s.scene.occluderSize > 0.0f)
+			fprintf(out, "      \"occlusion_per_frame\": { \"occluder_triangles\": %.1f, \"tests\": %.1f, \"culled\": %.1f, \"render_us\": %.2f },\n",
+				r.api.occluderTriangles / frames, r.api.occlusionTests / frames, r.api.occlusionCulled / frames, r.api.occlusionMicros / frames);
+		fprintf(out, "      \"memory_peak_mib\": {");
+		for (size_t c = 0; c < r.memory.size(); c++)
+			fprintf(out, "%s \"%s\": %.3f", c ? "," : "", MemoryTracker::categoryName((MemoryTracker::CATEGORY)c), r.memory[c].peakBytes / 1048576.0);
+		fprintf(out, " },\n");
+		if (!r.gpuScopes.empty())
+		{
+			fprintf(out, "      \"gpu_ms\": [\n");
+			for (size_t g = 0; g < r.gpuScopes.size(); g++)
+			{
+				const GpuProfiler::ScopeStats& gs = r.gpuScopes[g];
+				fprintf(out, "        { \"scope\": \"%s\", \"frames\": %llu, \"mean\": %.4f, \"min\": %.4f, \"max\": %.4f }%s\n",
+					gs.name.c_str(), (unsigned long long)gs.samples, gs.meanMs, gs.minMs, gs.maxMs, g + 1 < r.gpuScopes.size() ? "," : "");
+			}
+			fprintf(out, "      ],\n");
+		}
+		fprintf(out, "      \"triangles_per_second\": %.1f\n", r.trianglesPerSecond);
+		fprintf(out, "    }%s\n", i + 1 < results.size() ? "," : "");
+	}
+	fprintf(out, "  ]\n}\n");
+}
+
+static std::vector<int> parseIntList(const char* text)
+{
+	std::vector<int> values;
+	std::string s = text;
+	size_t start = 0;
+	while (start <= s.size())
+	{
+		size_t end = s.find(',', start);
+		if (end == std::string::npos)
+			end = s.size();
+		if (end > start)
+			values.push_back(atoi(s.substr(start, end - start).c_str()));
+		start = end + 1;
+	}
+	return values;
+}
+
+int benchmarkMain(int argc, char* argv[])
+{
+	BenchmarkScenario base;
+	std::vector<int> meshCounts = { base.scene.meshCount };
+	std::vector<Renderer::SUBMISSION> submissions = { base.submission };
+	bool headless = false;
+	const char* outPath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "gl")
+			base.backend = Renderer::BACKEND::GL45;
+		else if (arg == "vulkan")
+			base.backend = Renderer::BACKEND::VULKAN;
+		else if (arg == "null")
+			base.backend = Renderer::BACKEND::NULL_RENDERER;
+		else if (arg == "software")
+			base.backend = Renderer::BACKEND::SOFTWARE;
+		else if (arg == "--headless")
+			headless = true;
+		else if (arg == "--meshes" && hasValue)
+			meshCounts = parseIntList(argv[++i]);
+		else if (arg == "--textured" && hasValue)
+			base.scene.texturedFraction = (float)atof(argv[++i]);
+		else if (arg == "--techniques" && hasValue)
+			base.scene.techniqueCount = atoi(argv[++i]);
+		else if (arg == "--warmup" && hasValue)
+			base.warmupFrames = atoi(argv[++i]);
+		else if (arg == "--frames" && hasValue)
+			base.measuredFrames = atoi(argv[++i]);
+		else if (arg == "--retained")
+			base.scene.retained = true;
+		else if (arg == "--cull")
+			base.scene.cull = true;
+		else if (arg == "--occluder" && hasValue)
+		{
+			base.scene.cull = true;
+			base.scene.occluderSize = (float)atof(argv[++i]);
+		}
+		else if (arg == "--gpu-animation")
+			base.scene.gpuAnimation = true;
+		else if (arg == "--gpu-cull")
+			base.scene.gpuCull = true;
+		else if (arg == "--indexed")
+			base.scene.indexed = true;
+		else if (arg == "--interleaved")
+			base.scene.interleaved = true;
+		else if (arg == "--quantized")
+			base.scene.quantized = true;
+		else if (arg == "--out" && hasValue)
+			outPath = argv[++i];
+		else if (arg == "--submission" && hasValue)
+		{
+			std::string value = argv[++i];
+			if (value == "unsorted")
+				submissions = { Renderer::SUBMISSION::UNSORTED };
+			else if (value == "per_technique")
+				submissions = { Renderer::SUBMISSION::PER_TECHNIQUE };
+			else
+				submissions = { Renderer::SUBMISSION::UNSORTED, Renderer::SUBMISSION::PER_TECHNIQUE };
+		}
+	}
+
+	std::vector<BenchmarkResult> results;
+	for (int meshCount : meshCounts)
+	{
+		for (auto submission : submissions)
+		{
+			BenchmarkScenario scenario = base;
+			scenario.scene.meshCount = meshCount;
+			scenario.submission = submission;
+			fprintf(stderr, "bench: %s %s %d meshes\n", backendName(scenario.backend), submissionName(submission), meshCount);
+			BenchmarkResult result = runBenchmark(scenario, headless);
+			if (result.error.empty())
+				results.push_back(result);
+			else
+				fprintf(stderr, "bench: skipped, %s\n", result.error.c_str());
+		}
+	}
+
+	FILE* out = stdout;
+	if (outPath && (out = fopen(outPath, "w")) == nullptr)
+	{
+		fprintf(stderr, "Cannot open %s\n", outPath);
+		exit(-1);
+	}
+	writeBenchmarkJSON(out, results);
+	if (out != stdout)
+		fclose(out);
+	return 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include "Renderer.h"
+#include "Testbench.h"
+#include "GpuProfiler.h"
+#include "MemoryTracker.h"
+
+/*
+ Frame benchmark: runs the testbench scene for a fixed number of warm-up and
+ measured frames per scenario and writes the CPU frame-time statistics, the
+ API calls and heap allocations per frame, the peak resource memory (and the GPU timestamp
+ scopes, when the backend has them) as JSON.
+ Animation uses a fixed timestep, so every run renders the same frames.
+ Every mesh is submitted every frame unless --retained adds the scene once
+ (Renderer::addRenderable). --cull submits the meshes inside the camera
+ frustum only (not with --retained), --occluder adds a quad that hides
+ part of the scene and culls the meshes behind it on the CPU (implies
+ --cull, see OcclusionCuller.h): its
+ "occlusion_per_frame" has the boxes tested, those found hidden and the
+ time spent rasterizing the occluders. --gpu-animation computes the
+ translations in a compute pass (gl and vulkan, the others stay on the
+ CPU): "uniform_bytes" drops to one 16 byte uniform and "dispatches" is 1.
+ --gpu-cull (implies --gpu-animation, needs --retained) culls the retained
+ scene in a second dispatch and draws it with "indirect_draws", one per technique, instead of
+ "draws" (gl with ARB_indirect_parameters, vulkan with
+ VK_KHR_draw_indirect_count). --indexed draws the triangles through an
+ index buffer (not with "indirect_draws"). --interleaved puts the vertex
+ attributes in one buffer ("vertex_layout"), --quantized packs them in 16
+ bytes a vertex instead of 40: the "vertex" memory drops by 2.5x.
+ "dispatch" is "static" for the backend of a TESTBENCH_STATIC_ build (see
+ StaticBackend.h): run the same --bench in both builds, e.g.
+ --bench null --meshes 10000,100000,1000000, to compare them.
+*/
+struct BenchmarkScenario {
+	Renderer::BACKEND backend = Renderer::BACKEND::VULKAN;
+	Renderer::SUBMISSION submission = Renderer::SUBMISSION::PER_TECHNIQUE;
+	TestbenchConfig scene;
+	int warmupFrames = 60;
+	int measuredFrames = 600;
+};
+
+struct BenchmarkResult {
+	BenchmarkScenario scenario;
+	// milliseconds, CPU time from updateScene to the end of present()
+	double minMs, medianMs, p95Ms, p99Ms, maxMs, meanMs;
+	double drawsPerSecond;
+	double trianglesPerSecond;
+	// null backend only: size and hash of the command stream of one frame
+	// recorded after the measurement, to compare submission strategies.
+	size_t streamBytes;
+	uint64_t streamHash;
+	// GPU time per scope over the measured frames, empty without a profiler.
+	std::vector<GpuProfiler::ScopeStats> gpuScopes;
+	// counters summed over the measured frames (frame is unused).
+	FrameStats api;
+	// resource memory per category, the total last.
+	std::vector<MemoryTracker::Usage> memory;
+	// why the scenario did not run, empty when it did.
+	std::string error;
+};
+
+BenchmarkResult runBenchmark(const BenchmarkScenario& scenario, bool headless);
+void writeBenchmarkJSON(FILE* out, const std::vector<BenchmarkResult>& results);
+
+/*
+ --bench [gl|vulkan|null|software] [--headless] [--meshes 100,1000,...] [--textured 0.25]
+         [--techniques 4] [--submission unsorted|per_technique|all] [--retained] [--cull] [--occluder 0.4]
+         [--gpu-animation] [--gpu-cull] [--indexed] [--interleaved] [--quantized]
+         [--warmup 60] [--frames 600] [--out results.json]
+*/
+int benchmarkMain(int argc, char* argv[]);
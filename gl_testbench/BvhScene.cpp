@@ -0,0 +1,441 @@
+#include <algorithm>
+#include "BvhScene.h"
+#include "Mesh.h"
+#include "TransformBatch.h"
+#include "OcclusionCuller.h"
+#include "FrameStats.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define BVH_SCENE_SSE
+#include <emmintrin.h>
+#endif
+
+const uint32_t BvhScene::NONE;
+const size_t BvhScene::PARALLEL_MIN;
+const uint32_t BvhScene::LEAF;
+
+namespace {
+	// nodes refit per job.
+	const size_t REFIT_CHUNK = 4096;
+
+	// 10 bits of x, y and z interleaved.
+	uint32_t spread(uint32_t v)
+	{
+		v = (v | (v << 16)) & 0x030000ff;
+		v = (v | (v << 8)) & 0x0300f00f;
+		v = (v | (v << 4)) & 0x030c30c3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	uint32_t morton(const glm::vec3& p)
+	{
+		return spread((uint32_t)p.x) | (spread((uint32_t)p.y) << 1) | (spread((uint32_t)p.z) << 2);
+	}
+}
+
+void BvhScene::setSlot(Node& node, uint32_t slot, const Aabb& box)
+{
+	node.minX[slot] = box.min.x;
+	node.minY[slot] = box.min.y;
+	node.minZ[slot] = box.min.z;
+	node.maxX[slot] = box.max.x;
+	node.maxY[slot] = box.max.y;
+	node.maxZ[slot] = box.max.z;
+}
+
+Aabb BvhScene::nodeBox(const Node& node)
+{
+	Aabb box;
+	for (uint32_t s = 0; s < 4; s++)
+	{
+		if (node.children[s] == NONE)
+			continue;
+		box.min = glm::min(box.min, glm::vec3(node.minX[s], node.minY[s], node.minZ[s]));
+		box.max = glm::max(box.max, glm::vec3(node.maxX[s], node.maxY[s], node.maxZ[s]));
+	}
+	return box;
+}
+
+Aabb BvhScene::slotBox(const Node& node, uint32_t slot)
+{
+	Aabb box;
+	box.min = glm::vec3(node.minX[slot], node.minY[slot], node.minZ[slot]);
+	box.max = glm::vec3(node.maxX[slot], node.maxY[slot], node.maxZ[slot]);
+	return box;
+}
+
+void BvhScene::addMesh(Mesh* mesh)
+{
+	if (ids.find(mesh) != ids.end())
+	{
+		updateMesh(mesh);
+		return;
+	}
+	uint32_t id;
+	if (freeIds.empty())
+	{
+		id = (uint32_t)items.size();
+		items.push_back(Item());
+	}
+	else
+	{
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	items[id] = { mesh, mesh->bounds, glm::vec3(0.0f), NONE, NONE };
+	ids[mesh] = id;
+	live++;
+	dirty = true;
+}
+
+void BvhScene::updateMesh(Mesh* mesh)
+{
+	const uint32_t i = id(mesh);
+	if (i == NONE)
+		return;
+	items[i].bounds = mesh->bounds;
+	refitPath(i);
+}
+
+void BvhScene::removeMesh(Mesh* mesh)
+{
+	auto found = ids.find(mesh);
+	if (found == ids.end())
+		return;
+	items[found->second] = { nullptr, Aabb(), glm::vec3(0.0f), NONE, NONE };
+	freeIds.push_back(found->second);
+	ids.erase(found);
+	live--;
+	dirty = true;
+}
+
+void BvhScene::setTranslation(Mesh* mesh, const glm::vec3& translation)
+{
+	const uint32_t i = id(mesh);
+	if (i == NONE)
+		return;
+	items[i].translation = translation;
+	refitPath(i);
+}
+
+uint32_t BvhScene::id(Mesh* mesh) const
+{
+	auto found = ids.find(mesh);
+	return found != ids.end() ? found->second : NONE;
+}
+
+void BvhScene::refitPath(uint32_t id)
+{
+	// a rebuild is pending, it reads the new box.
+	if (dirty || items[id].node == NONE)
+		return;
+	setSlot(nodes[items[id].node], items[id].slot, itemBox(id));
+	for (uint32_t n = items[id].node; nodes[n].parent != NONE; n = nodes[n].parent)
+	{
+		const Aabb box = nodeBox(nodes[n]);
+		Node& parent = nodes[nodes[n].parent];
+		const uint32_t s = nodes[n].parentSlot;
+		// the boxes above did not change either.
+		if (parent.minX[s] == box.min.x && parent.minY[s] == box.min.y && parent.minZ[s] == box.min.z &&
+			parent.maxX[s] == box.max.x && parent.maxY[s] == box.max.y && parent.maxZ[s] == box.max.z)
+			break;
+		setSlot(parent, s, box);
+	}
+}
+
+void BvhScene::refitNodes(size_t first, size_t end)
+{
+	for (size_t n = first; n < end; n++)
+	{
+		Node& node = nodes[n];
+		for (uint32_t s = 0; s < 4; s++)
+		{
+			const uint32_t child = node.children[s];
+			if (child == NONE)
+				continue;
+			setSlot(node, s, (child & LEAF) ? itemBox(child & ~LEAF) : nodeBox(nodes[child]));
+		}
+	}
+}
+
+void BvhScene::refit(const TransformBatch& translations)
+{
+	PROFILE_ZONE("refitBvh");
+	const size_t count = std::min(translations.size(), items.size());
+	const float* x = translations.x();
+	const float* y = translations.y();
+	const float* z = translations.z();
+	for (size_t i = 0; i < count; i++)
+		items[i].translation = glm::vec3(x[i], y[i], z[i]);
+	if (dirty || nodes.empty())
+		return;
+
+	// deepest level first, a level only reads the one below it.
+	for (size_t depth = levelStart.size() - 1; depth-- > 0;)
+	{
+		const size_t first = levelStart[depth];
+		const size_t end = levelStart[depth + 1];
+		if (end - first < 4 * REFIT_CHUNK)
+		{
+			refitNodes(first, end);
+			continue;
+		}
+		struct Pass {
+			BvhScene* scene;
+			size_t first, end;
+		} pass = { this, first, end };
+		JobSystem::shared().parallelFor((end - first + REFIT_CHUNK - 1) / REFIT_CHUNK, [&pass](size_t chunk) {
+			const size_t from = pass.first + chunk * REFIT_CHUNK;
+			pass.scene->refitNodes(from, std::min(from + REFIT_CHUNK, pass.end));
+		});
+	}
+}
+
+/*
+ The meshes in Morton order of their box centers, grouped in fours into
+ the bottom level, and the nodes of each level grouped in fours into the
+ one above, up to a single root.
+*/
+void BvhScene::rebuild()
+{
+	PROFILE_ZONE("rebuildBvh");
+	dirty = false;
+	nodes.clear();
+	levelStart.clear();
+
+	Aabb centers;
+	for (uint32_t i = 0; i < items.size(); i++)
+	{
+		items[i].node = NONE;
+		if (items[i].mesh != nullptr)
+		{
+			const Aabb box = itemBox(i);
+			centers.add((box.min + box.max) * 0.5f);
+		}
+	}
+	if (live == 0)
+		return;
+	const glm::vec3 scale = 1023.0f / glm::max(centers.max - centers.min, glm::vec3(1e-20f));
+	std::vector<std::pair<uint32_t, uint32_t>> sorted;
+	sorted.reserve(live);
+	for (uint32_t i = 0; i < items.size(); i++)
+	{
+		if (items[i].mesh == nullptr)
+			continue;
+		const Aabb box = itemBox(i);
+		sorted.push_back({ morton(((box.min + box.max) * 0.5f - centers.min) * scale), i });
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	// nodes per level, from the bottom up.
+	std::vector<size_t> counts;
+	size_t count = sorted.size();
+	do
+	{
+		count = (count + 3) / 4;
+		counts.push_back(count);
+	} while (count > 1);
+	const size_t depths = counts.size();
+	levelStart.resize(depths + 1);
+	size_t total = 0;
+	for (size_t depth = 0; depth < depths; depth++)
+	{
+		levelStart[depth] = total;
+		total += counts[depths - 1 - depth];
+	}
+	levelStart[depths] = total;
+
+	Node empty;
+	for (uint32_t s = 0; s < 4; s++)
+		setSlot(empty, s, Aabb());
+	std::fill(empty.children, empty.children + 4, NONE);
+	empty.parent = NONE;
+	empty.parentSlot = 0;
+	nodes.assign(total, empty);
+
+	const size_t bottom = levelStart[depths - 1];
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		const uint32_t id = sorted[i].second;
+		const uint32_t n = (uint32_t)(bottom + i / 4);
+		const uint32_t s = (uint32_t)(i % 4);
+		nodes[n].children[s] = LEAF | id;
+		items[id].node = n;
+		items[id].slot = s;
+		setSlot(nodes[n], s, itemBox(id));
+	}
+	for (size_t depth = depths - 1; depth-- > 0;)
+	{
+		for (size_t i = levelStart[depth + 1]; i < levelStart[depth + 2]; i++)
+		{
+			const size_t k = i - levelStart[depth + 1];
+			const uint32_t n = (uint32_t)(levelStart[depth] + k / 4);
+			const uint32_t s = (uint32_t)(k % 4);
+			nodes[n].children[s] = (uint32_t)i;
+			nodes[i].parent = n;
+			nodes[i].parentSlot = s;
+			setSlot(nodes[n], s, nodeBox(nodes[i]));
+		}
+	}
+}
+
+/*
+ bit s of outside is set when child box s is outside one of the planes,
+ bit s of inside when it is inside all of them.
+*/
+static void testChildren(const float* minX, const float* minY, const float* minZ,
+	const float* maxX, const float* maxY, const float* maxZ, const Frustum& frustum, int& outside, int& inside)
+{
+#ifdef BVH_SCENE_SSE
+	const __m128 x0 = _mm_loadu_ps(minX), y0 = _mm_loadu_ps(minY), z0 = _mm_loadu_ps(minZ);
+	const __m128 x1 = _mm_loadu_ps(maxX), y1 = _mm_loadu_ps(maxY), z1 = _mm_loadu_ps(maxZ);
+	const __m128 zero = _mm_setzero_ps();
+	__m128 out = zero;
+	__m128 in = _mm_cmpeq_ps(zero, zero);
+	for (const auto& p : frustum.planes)
+	{
+		const __m128 nx = _mm_set1_ps(p.x), ny = _mm_set1_ps(p.y), nz = _mm_set1_ps(p.z);
+		const __m128 ax = _mm_mul_ps(nx, x0), bx = _mm_mul_ps(nx, x1);
+		const __m128 ay = _mm_mul_ps(ny, y0), by = _mm_mul_ps(ny, y1);
+		const __m128 az = _mm_mul_ps(nz, z0), bz = _mm_mul_ps(nz, z1);
+		// signed distance of the corner farthest along the normal, and of the nearest one.
+		const __m128 farthest = _mm_add_ps(_mm_add_ps(_mm_max_ps(ax, bx), _mm_max_ps(ay, by)),
+			_mm_add_ps(_mm_max_ps(az, bz), _mm_set1_ps(p.w)));
+		const __m128 nearest = _mm_add_ps(_mm_add_ps(_mm_min_ps(ax, bx), _mm_min_ps(ay, by)),
+			_mm_add_ps(_mm_min_ps(az, bz), _mm_set1_ps(p.w)));
+		out = _mm_or_ps(out, _mm_cmplt_ps(farthest, zero));
+		in = _mm_and_ps(in, _mm_cmpge_ps(nearest, zero));
+	}
+	outside = _mm_movemask_ps(out);
+	inside = _mm_movemask_ps(in);
+#else
+	outside = 0;
+	inside = 0;
+	for (int s = 0; s < 4; s++)
+	{
+		bool in = true;
+		for (const auto& p : frustum.planes)
+		{
+			const float ax = p.x * minX[s], bx = p.x * maxX[s];
+			const float ay = p.y * minY[s], by = p.y * maxY[s];
+			const float az = p.z * minZ[s], bz = p.z * maxZ[s];
+			if (std::max(ax, bx) + std::max(ay, by) + std::max(az, bz) + p.w < 0.0f)
+				outside |= 1 << s;
+			if (std::min(ax, bx) + std::min(ay, by) + std::min(az, bz) + p.w < 0.0f)
+				in = false;
+		}
+		if (in)
+			inside |= 1 << s;
+	}
+#endif
+}
+
+void BvhScene::collect(uint32_t node, std::vector<Mesh*>& out) const
+{
+	const Node& n = nodes[node];
+	for (uint32_t s = 0; s < 4; s++)
+	{
+		const uint32_t child = n.children[s];
+		if (child == NONE)
+			continue;
+		if (child & LEAF)
+			out.push_back(items[child & ~LEAF].mesh);
+		else
+			collect(child, out);
+	}
+}
+
+void BvhScene::cullNode(uint32_t node, uint32_t depth, const Query& query, std::vector<Mesh*>& out, Tally& tally,
+	uint32_t split, std::vector<Task>* tasks) const
+{
+	const Node& n = nodes[node];
+	int outside, inside;
+	testChildren(n.minX, n.minY, n.minZ, n.maxX, n.maxY, n.maxZ, *query.frustum, outside, inside);
+	// hidden boxes can be anywhere below an inside node.
+	if (query.occlusion != nullptr)
+		inside = 0;
+	for (uint32_t s = 0; s < 4; s++)
+	{
+		const uint32_t child = n.children[s];
+		if (child == NONE || (outside & (1 << s)))
+			continue;
+		if (query.occlusion != nullptr)
+		{
+			tally.tests++;
+			if (!query.occlusion->visible(slotBox(n, s)))
+			{
+				tally.culled++;
+				continue;
+			}
+		}
+		if (child & LEAF)
+			out.push_back(items[child & ~LEAF].mesh);
+		else if (tasks != nullptr && depth + 1 == split)
+			tasks->push_back({ child, (inside & (1 << s)) != 0, { 0, 0 } });
+		// above the split the tasks keep the tree order, no shortcut.
+		else if (tasks == nullptr && (inside & (1 << s)))
+			collect(child, out);
+		else
+			cullNode(child, depth + 1, query, out, tally, split, tasks);
+	}
+}
+
+void BvhScene::cull(const Frustum& frustum, std::vector<Mesh*>& visible, const OcclusionCuller* occlusion)
+{
+	PROFILE_ZONE("cull");
+	if (dirty)
+		rebuild();
+	if (nodes.empty())
+		return;
+	const Query query = { &frustum, occlusion };
+	Tally tally = { 0, 0 };
+	const uint32_t depths = (uint32_t)levelStart.size() - 1;
+	if (live < PARALLEL_MIN || depths < 2)
+	{
+		cullNode(0, 0, query, visible, tally, 0, nullptr);
+		FrameStats::current.occlusionTests += tally.tests;
+		FrameStats::current.occlusionCulled += tally.culled;
+		return;
+	}
+
+	// the first depth with a few subtrees per thread (or the bottom one).
+	JobSystem& jobs = JobSystem::shared();
+	uint32_t split = 1;
+	while (split + 1 < depths && levelStart[split + 1] - levelStart[split] < 4 * jobs.threadCount())
+		split++;
+	tasks.clear();
+	cullNode(0, 0, query, visible, tally, split, &tasks);
+	if (taskVisible.size() < tasks.size())
+		taskVisible.resize(tasks.size());
+
+	struct Pass {
+		BvhScene* scene;
+		const Query* query;
+		uint32_t split;
+	} pass = { this, &query, split };
+	jobs.parallelFor(tasks.size(), [&pass](size_t t) {
+		Task& task = pass.scene->tasks[t];
+		std::vector<Mesh*>& out = pass.scene->taskVisible[t];
+		out.clear();
+		if (task.inside)
+			pass.scene->collect(task.node, out);
+		else
+			pass.scene->cullNode(task.node, pass.split, *pass.query, out, task.tally, 0, nullptr);
+	});
+
+	size_t total = visible.size();
+	for (size_t t = 0; t < tasks.size(); t++)
+	{
+		total += taskVisible[t].size();
+		tally.tests += tasks[t].tally.tests;
+		tally.culled += tasks[t].tally.culled;
+	}
+	FrameStats::current.occlusionTests += tally.tests;
+	FrameStats::current.occlusionCulled += tally.culled;
+	visible.reserve(total);
+	for (size_t t = 0; t < tasks.size(); t++)
+		visible.insert(visible.end(), taskVisible[t].begin(), taskVisible[t].end());
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Scene.h"
+#include "Frustum.h"
+
+class TransformBatch;
+class OcclusionCuller;
+
+/*
+ Meshes in a bounding volume hierarchy for frustum culling. Nodes have
+ four children and keep the children's boxes as arrays of min/max x, y
+ and z, so one SSE instruction tests a frustum plane against all four.
+
+	scene.addMesh(mesh);                  // box: Mesh::bounds
+	scene.setTranslation(mesh, t);        // refits the path to the root
+	scene.cull(camera.getFrustum(), visible);
+
+ Adding or removing meshes rebuilds the tree at the next cull(): the
+ meshes sorted by the Morton code of their box centers, grouped in fours
+ from the bottom up. updateMesh and setTranslation only refit, the boxes
+ above the mesh change and the tree keeps its shape; refit(batch) moves
+ every mesh in one bottom-up pass, the translation of mesh m is
+ batch[id(m)]. Call rebuild() when the meshes moved far from where they
+ were at the last one, the boxes of a stale tree overlap a lot.
+
+ cull() splits the tree into subtrees over JobSystem::shared() from
+ PARALLEL_MIN meshes. A node inside the frustum adds all its meshes
+ without testing further down. The visible meshes come out in tree
+ order.
+
+ With an OcclusionCuller (rendered for this frame), the boxes that pass
+ the frustum test are also tested against its depth buffer, so a hidden
+ node drops its whole subtree; the inside shortcut is off then. The
+ tests and the boxes they hid go to FrameStats::current.
+*/
+class BvhScene : public Scene
+{
+public:
+	static const uint32_t NONE = 0xffffffff;
+	static const size_t PARALLEL_MIN = 16384;
+
+	void addMesh(Mesh* mesh);
+	// reads Mesh::bounds again.
+	void updateMesh(Mesh* mesh);
+	void removeMesh(Mesh* mesh);
+	void setTranslation(Mesh* mesh, const glm::vec3& translation);
+	void refit(const TransformBatch& translations);
+	void rebuild();
+
+	// appends the meshes whose box intersects frustum (and is not hidden) to visible.
+	void cull(const Frustum& frustum, std::vector<Mesh*>& visible, const OcclusionCuller* occlusion = nullptr);
+
+	// ids follow addMesh order and are reused after removeMesh, NONE for a mesh that was not added.
+	uint32_t id(Mesh* mesh) const;
+	size_t size() const { return live; };
+private:
+	static const uint32_t LEAF = 0x80000000;
+
+	struct Node {
+		float minX[4], minY[4], minZ[4];
+		float maxX[4], maxY[4], maxZ[4];
+		// child node, LEAF | id for a mesh, NONE for an empty slot.
+		uint32_t children[4];
+		uint32_t parent, parentSlot;
+	};
+
+	struct Item {
+		Mesh* mesh;
+		Aabb bounds;
+		glm::vec3 translation;
+		// slot holding the box, NONE until the next rebuild.
+		uint32_t node, slot;
+	};
+
+	struct Query {
+		const Frustum* frustum;
+		const OcclusionCuller* occlusion;
+	};
+
+	// occlusion tests of one thread.
+	struct Tally {
+		uint32_t tests, culled;
+	};
+
+	struct Task {
+		uint32_t node;
+		bool inside;
+		Tally tally;
+	};
+
+	static void setSlot(Node& node, uint32_t slot, const Aabb& box);
+	static Aabb nodeBox(const Node& node);
+	static Aabb slotBox(const Node& node, uint32_t slot);
+	Aabb itemBox(uint32_t id) const { return items[id].bounds.translated(items[id].translation); };
+	// boxes of the path from the item's node to the root.
+	void refitPath(uint32_t id);
+	// slot boxes of nodes [first, end), from their items and child nodes.
+	void refitNodes(size_t first, size_t end);
+
+	// meshes of the subtree, without tests.
+	void collect(uint32_t node, std::vector<Mesh*>& out) const;
+	/*
+	 tests the children of node, nodes at depth split go to tasks instead
+	 of being descended into (no split with tasks == nullptr).
+	*/
+	void cullNode(uint32_t node, uint32_t depth, const Query& query, std::vector<Mesh*>& out, Tally& tally,
+		uint32_t split, std::vector<Task>* tasks) const;
+
+	std::vector<Item> items;
+	std::vector<uint32_t> freeIds;
+	std::unordered_map<Mesh*, uint32_t> ids;
+	size_t live = 0;
+
+	// root at 0, then level by level: parents before their children.
+	std::vector<Node> nodes;
+	// first node of each depth, and one past the last node.
+	std::vector<size_t> levelStart;
+	bool dirty = false;
+
+	// parallel cull: the subtrees and what each one found.
+	std::vector<Task> tasks;
+	std::vector<std::vector<Mesh*>> taskVisible;
+};
@@ -1,12 +1,61 @@
+#include <glm/gtc/matrix_transform.hpp>
 #include "Camera.h"
 
+Camera::Camera()
+{
+}
 
+Camera::~Camera()
+{
+}
 
-Camera::Camera()
+void Camera::lookAt(const glm::vec3& eye, const glm::vec3& target, const glm::vec3& up)
 {
+	setView(glm::lookAt(eye, target, up));
 }
 
+void Camera::setView(const glm::mat4& view)
+{
+	this->view = view;
+	dirty = true;
+}
 
-Camera::~Camera()
+void Camera::perspective(float fovy, float aspect, float zNear, float zFar)
+{
+	setProjection(glm::perspective(fovy, aspect, zNear, zFar));
+}
+
+void Camera::orthographic(float left, float right, float bottom, float top, float zNear, float zFar)
+{
+	setProjection(glm::ortho(left, right, bottom, top, zNear, zFar));
+}
+
+void Camera::setProjection(const glm::mat4& projection)
+{
+	this->projection = projection;
+	dirty = true;
+}
+
+void Camera::update()
+{
+	constants.view = view;
+	constants.projection = projection;
+	constants.viewProjection = projection * view;
+	constants.position = glm::inverse(view)[3];
+	frustum = Frustum::fromMatrix(constants.viewProjection);
+	dirty = false;
+}
+
+const Camera::Constants& Camera::getConstants()
+{
+	if (dirty)
+		update();
+	return constants;
+}
+
+const Frustum& Camera::getFrustum()
 {
+	if (dirty)
+		update();
+	return frustum;
 }
@@ -1,8 +1,52 @@
 #pragma once
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+/*
+ View and projection of the scene. The default camera is the identity,
+ which is the view the testbench shaders have: they output the vertex
+ positions (plus the translation) as clip space coordinates.
+
+	camera.lookAt(eye, target, glm::vec3(0, 1, 0));
+	camera.perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+	scene.cull(camera.getFrustum(), visible);
+
+ getConstants() has the matrices the CPU passes need (the occlusion
+ culler rasterizes with viewProjection), getFrustum() the planes for
+ culling. Both are recomputed on first use after a change. No shader
+ reads a camera, so nothing is uploaded.
+*/
 class Camera
 {
 public:
+	struct Constants {
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::mat4 viewProjection;
+		// eye position, w is 1.
+		glm::vec4 position;
+	};
+
 	Camera();
 	~Camera();
-};
 
+	void lookAt(const glm::vec3& eye, const glm::vec3& target, const glm::vec3& up);
+	void setView(const glm::mat4& view);
+	// fovy in radians.
+	void perspective(float fovy, float aspect, float zNear, float zFar);
+	void orthographic(float left, float right, float bottom, float top, float zNear, float zFar);
+	void setProjection(const glm::mat4& projection);
+
+	const glm::mat4& getView() const { return view; };
+	const glm::mat4& getProjection() const { return projection; };
+	const Constants& getConstants();
+	const Frustum& getFrustum();
+private:
+	void update();
+
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+	Constants constants;
+	Frustum frustum;
+	bool dirty = true;
+};
@@ -0,0 +1,296 @@
+#include <SDL_timer.h>
+#include "CaptureRenderer.h"
+#include "CaptureResources.h"
+
+const uint8_t CaptureRenderer::VERSION;
+
+CaptureRenderer::CaptureRenderer(Renderer* inner, const std::string& filename) : inner(inner)
+{
+	IMPL = inner->IMPL;
+	file = fopen(filename.c_str(), "wb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Cannot open capture file %s\n", filename.c_str());
+		exit(-1);
+	}
+	fwrite("TBCAP", 1, 5, file);
+	fwrite(&VERSION, 1, 1, file);
+	recordedSubmission = submission;
+	stream.writeOp(CommandStream::CAP_SET_SUBMISSION);
+	stream.writeU32((uint32_t)submission);
+}
+
+CaptureRenderer::~CaptureRenderer()
+{
+	delete inner;
+}
+
+Material* CaptureRenderer::makeMaterial(const std::string& name)
+{
+	return new CaptureMaterial(this, inner->makeMaterial(name), name);
+}
+
+// plain mesh, mirrored in the backend on submit (see syncMesh).
+Mesh* CaptureRenderer::makeMesh()
+{
+	return new Mesh();
+}
+
+VertexBuffer* CaptureRenderer::makeVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	return new CaptureVertexBuffer(this, inner->makeVertexBuffer(size, usage), size, usage);
+}
+
+Texture2D* CaptureRenderer::makeTexture2D()
+{
+	return new CaptureTexture2D(this, inner->makeTexture2D());
+}
+
+Sampler2D* CaptureRenderer::makeSampler2D()
+{
+	return new CaptureSampler2D(this, inner->makeSampler2D());
+}
+
+RenderState* CaptureRenderer::makeRenderState()
+{
+	return new CaptureRenderState(this, inner->makeRenderState());
+}
+
+std::string CaptureRenderer::getShaderPath()
+{
+	return inner->getShaderPath();
+}
+
+std::string CaptureRenderer::getShaderExtension()
+{
+	return inner->getShaderExtension();
+}
+
+ConstantBuffer* CaptureRenderer::makeConstantBuffer(std::string NAME, unsigned int location)
+{
+	return new CaptureConstantBuffer(this, inner->makeConstantBuffer(NAME, location), NAME, location);
+}
+
+Technique* CaptureRenderer::makeTechnique(Material* m, RenderState* r)
+{
+	CaptureMaterial* material = (CaptureMaterial*)m;
+	CaptureRenderState* renderState = (CaptureRenderState*)r;
+	return new CaptureTechnique(this, material, renderState, inner->makeTechnique(material->inner, renderState->inner));
+}
+
+// the wrapped objects are pooled, the backend objects behind them are not.
+MeshHandle CaptureRenderer::createMesh()
+{
+	return meshPool.create<Mesh>();
+}
+
+VertexBufferHandle CaptureRenderer::createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	return vertexBufferPool.create<CaptureVertexBuffer>(this, inner->makeVertexBuffer(size, usage), size, usage);
+}
+
+Texture2DHandle CaptureRenderer::createTexture2D()
+{
+	return texturePool.create<CaptureTexture2D>(this, inner->makeTexture2D());
+}
+
+Sampler2DHandle CaptureRenderer::createSampler2D()
+{
+	return samplerPool.create<CaptureSampler2D>(this, inner->makeSampler2D());
+}
+
+MaterialHandle CaptureRenderer::createMaterial(const std::string& name)
+{
+	return materialPool.create<CaptureMaterial>(this, inner->makeMaterial(name), name);
+}
+
+TechniqueHandle CaptureRenderer::createTechnique(MaterialHandle m, RenderState* r)
+{
+	CaptureMaterial* material = (CaptureMaterial*)get(m);
+	CaptureRenderState* renderState = (CaptureRenderState*)r;
+	return techniquePool.create<CaptureTechnique>(this, material, renderState, inner->makeTechnique(material->inner, renderState->inner));
+}
+
+int CaptureRenderer::initialize(unsigned int width, unsigned int height, bool headless)
+{
+	stream.writeOp(CommandStream::CAP_INITIALIZE);
+	stream.writeU32(width);
+	stream.writeU32(height);
+	int result = inner->initialize(width, height, headless);
+	startCounter = SDL_GetPerformanceCounter();
+	return result;
+}
+
+void CaptureRenderer::setWinTitle(const char* title)
+{
+	inner->setWinTitle(title);
+}
+
+void CaptureRenderer::present()
+{
+	inner->present();
+	uint64_t micros = (SDL_GetPerformanceCounter() - startCounter) * 1000000 / SDL_GetPerformanceFrequency();
+	stream.writeOp(CommandStream::CAP_PRESENT);
+	stream.writeU64(micros);
+	flush();
+}
+
+int CaptureRenderer::shutdown()
+{
+	flush();
+	if (file)
+	{
+		fclose(file);
+		file = nullptr;
+	}
+	// the backend meshes do not own references to the buffers (see syncMesh).
+	for (auto& m : meshes)
+	{
+		m.second.inner->geometryBuffers.clear();
+		delete m.second.inner;
+	}
+	meshes.clear();
+	return inner->shutdown();
+}
+
+void CaptureRenderer::setClearColor(float r, float g, float b, float a)
+{
+	stream.writeOp(CommandStream::CAP_SET_CLEAR_COLOR);
+	stream.writeFloat(r);
+	stream.writeFloat(g);
+	stream.writeFloat(b);
+	stream.writeFloat(a);
+	inner->setClearColor(r, g, b, a);
+}
+
+void CaptureRenderer::clearBuffer(unsigned int flag)
+{
+	stream.writeOp(CommandStream::CLEAR);
+	stream.writeU32(flag);
+	inner->clearBuffer(flag);
+}
+
+void CaptureRenderer::setRenderState(RenderState* ps)
+{
+	CaptureRenderState* renderState = (CaptureRenderState*)ps;
+	stream.writeOp(CommandStream::CAP_SET_RENDER_STATE);
+	stream.writeU32(renderState->id);
+	inner->setRenderState(renderState->inner);
+}
+
+void CaptureRenderer::submit(Mesh* mesh)
+{
+	Mesh* innerMesh = syncMesh(mesh);
+	stream.writeOp(CommandStream::CAP_SUBMIT);
+	stream.writeU32(meshes[mesh].id);
+	inner->submit(innerMesh);
+}
+
+void CaptureRenderer::frame()
+{
+	// recorded as submits, the replay needs no retained state.
+	submitRetained();
+	if (submission != recordedSubmission)
+	{
+		recordedSubmission = submission;
+		stream.writeOp(CommandStream::CAP_SET_SUBMISSION);
+		stream.writeU32((uint32_t)submission);
+	}
+	inner->setSubmission(submission);
+	stream.writeOp(CommandStream::FRAME);
+	inner->frame();
+}
+
+/*
+ returns the backend mesh mirroring mesh, recording a CAP_MESH whenever
+ the technique, translation buffer, vertex bindings or textures differ from
+ what was last recorded for it.
+*/
+Mesh* CaptureRenderer::syncMesh(Mesh* mesh)
+{
+	MeshRecord& record = meshes[mesh];
+	if (record.inner == nullptr)
+	{
+		record.inner = inner->makeMesh();
+		record.id = nextId();
+	}
+
+	for (auto& t : mesh->textures)
+		((CaptureTexture2D*)t.second)->syncSampler();
+
+	bool changed = record.technique != mesh->technique || record.txBuffer != mesh->txBuffer ||
+		record.geometry.size() != mesh->geometryBuffers.size() || record.textures.size() != mesh->textures.size();
+	if (!changed)
+	{
+		for (auto& g : mesh->geometryBuffers)
+		{
+			auto found = record.geometry.find(g.first);
+			if (found == record.geometry.end() || found->second.buffer != g.second.buffer ||
+				found->second.offset != g.second.offset || found->second.numElements != g.second.numElements ||
+				found->second.sizeElement != g.second.sizeElement)
+			{
+				changed = true;
+				break;
+			}
+		}
+		for (auto& t : mesh->textures)
+		{
+			auto found = record.textures.find(t.first);
+			if (found == record.textures.end() || found->second != t.second)
+			{
+				changed = true;
+				break;
+			}
+		}
+	}
+	if (!changed)
+		return record.inner;
+
+	record.technique = mesh->technique;
+	record.txBuffer = mesh->txBuffer;
+	record.geometry = std::map<unsigned int, Mesh::VertexBufferBind>(mesh->geometryBuffers.begin(), mesh->geometryBuffers.end());
+	record.textures = std::map<unsigned int, Texture2D*>(mesh->textures.begin(), mesh->textures.end());
+
+	CaptureTechnique* technique = (CaptureTechnique*)mesh->technique;
+	CaptureConstantBuffer* txBuffer = (CaptureConstantBuffer*)mesh->txBuffer;
+	stream.writeOp(CommandStream::CAP_MESH);
+	stream.writeU32(record.id);
+	stream.writeU32(technique ? technique->id : 0);
+	stream.writeU32(txBuffer ? txBuffer->id : 0);
+	stream.writeU32((uint32_t)record.geometry.size());
+
+	Mesh* m = record.inner;
+	m->technique = technique ? technique->inner : nullptr;
+	m->txBuffer = txBuffer ? txBuffer->inner : nullptr;
+	// assigned directly instead of addIAVertexBufferBinding: the mirror must
+	// not hold references, the application checks refCount on shutdown.
+	m->geometryBuffers.clear();
+	for (auto& g : record.geometry)
+	{
+		CaptureVertexBuffer* vb = (CaptureVertexBuffer*)g.second.buffer;
+		stream.writeU32(g.first);
+		stream.writeU32(vb->id);
+		stream.writeU64(g.second.offset);
+		stream.writeU64(g.second.numElements);
+		stream.writeU64(g.second.sizeElement);
+		m->geometryBuffers[g.first] = { g.second.sizeElement, g.second.numElements, g.second.offset, vb->inner };
+	}
+	stream.writeU32((uint32_t)record.textures.size());
+	m->textures.clear();
+	for (auto& t : record.textures)
+	{
+		CaptureTexture2D* texture = (CaptureTexture2D*)t.second;
+		stream.writeU32(t.first);
+		stream.writeU32(texture->id);
+		m->textures[t.first] = texture->inner;
+	}
+	m->changed();
+	return record.inner;
+}
+
+void CaptureRenderer::flush()
+{
+	if (file && stream.size())
+		fwrite(stream.data(), 1, stream.size(), file);
+	stream.clear();
+}
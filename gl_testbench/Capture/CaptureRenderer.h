@@ -0,0 +1,83 @@
+#pragma once
+#include <stdio.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "../Renderer.h"
+#include "../Mesh.h"
+#include "../CommandStream.h"
+
+/*
+ Decorator recording every resource creation and per-frame call made on
+ the Renderer interface (and on the objects it creates) into a capture
+ file, while forwarding everything to a real backend. The file is replayed
+ by Replay (see Replay.h) on any backend.
+
+ File: "TBCAP" + version byte, then CommandStream opcodes (CAP_*, CLEAR, FRAME).
+ The stream is flushed to disk on every present().
+*/
+class CaptureRenderer : public Renderer
+{
+public:
+	static const uint8_t VERSION = 2;
+
+	// takes ownership of inner.
+	CaptureRenderer(Renderer* inner, const std::string& filename);
+	~CaptureRenderer();
+
+	Material* makeMaterial(const std::string& name);
+	Mesh* makeMesh();
+	VertexBuffer* makeVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage);
+	Texture2D* makeTexture2D();
+	Sampler2D* makeSampler2D();
+	RenderState* makeRenderState();
+	std::string getShaderPath();
+	std::string getShaderExtension();
+	ConstantBuffer* makeConstantBuffer(std::string NAME, unsigned int location);
+	Technique* makeTechnique(Material*, RenderState*);
+	MeshHandle createMesh();
+	VertexBufferHandle createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage);
+	Texture2DHandle createTexture2D();
+	Sampler2DHandle createSampler2D();
+	MaterialHandle createMaterial(const std::string& name);
+	TechniqueHandle createTechnique(MaterialHandle m, RenderState* r);
+
+	int initialize(unsigned int width = 800, unsigned int height = 600, bool headless = false);
+	void setWinTitle(const char* title);
+	void present();
+	int shutdown();
+
+	void setClearColor(float, float, float, float);
+	void clearBuffer(unsigned int);
+	void setRenderState(RenderState* ps);
+	// the MeshHandle and batch overloads of Renderer.
+	using Renderer::submit;
+	void submit(Mesh* mesh);
+	void frame();
+
+	GpuProfiler* getGpuProfiler() { return inner->getGpuProfiler(); };
+
+	uint32_t nextId() { return ++lastId; };
+	CommandStream stream;
+	Renderer* inner;
+private:
+	FILE* file = nullptr;
+	uint32_t lastId = 0;
+	uint64_t startCounter = 0;
+	SUBMISSION recordedSubmission;
+
+	// the application keeps its own Mesh objects (Mesh has no virtuals to
+	// intercept), so each one is mirrored by a mesh of the inner backend
+	// and re-recorded when its bindings change.
+	struct MeshRecord {
+		uint32_t id = 0;
+		Mesh* inner = nullptr;
+		Technique* technique = nullptr;
+		ConstantBuffer* txBuffer = nullptr;
+		std::map<unsigned int, Mesh::VertexBufferBind> geometry;
+		std::map<unsigned int, Texture2D*> textures;
+	};
+	std::unordered_map<Mesh*, MeshRecord> meshes;
+	Mesh* syncMesh(Mesh* mesh);
+	void flush();
+};
@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <vector>
+#include "CaptureResources.h"
+#include "CaptureRenderer.h"
+
+// shader file name without the backend specific path and extension,
+// replay puts back those of the replaying backend.
+static std::string shaderName(const std::string& fileName)
+{
+	size_t start = fileName.find_last_of("\\/");
+	start = start == std::string::npos ? 0 : start + 1;
+	size_t end = fileName.find_last_of('.');
+	if (end == std::string::npos || end < start)
+		end = fileName.size();
+	return fileName.substr(start, end - start);
+}
+
+static void recordDestroy(CaptureRenderer* capture, uint32_t id)
+{
+	capture->stream.writeOp(CommandStream::CAP_DESTROY);
+	capture->stream.writeU32(id);
+}
+
+CaptureMaterial::CaptureMaterial(CaptureRenderer* capture, Material* inner, const std::string& name)
+	: inner(inner), capture(capture)
+{
+	id = capture->nextId();
+	capture->stream.writeOp(CommandStream::CAP_MAKE_MATERIAL);
+	capture->stream.writeU32(id);
+	capture->stream.writeString(name);
+}
+
+CaptureMaterial::~CaptureMaterial()
+{
+	recordDestroy(capture, id);
+	delete inner;
+}
+
+void CaptureMaterial::setShader(const std::string& shaderFileName, ShaderType type)
+{
+	capture->stream.writeOp(CommandStream::CAP_MATERIAL_SHADER);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32((uint32_t)type);
+	capture->stream.writeString(shaderName(shaderFileName));
+	shaderFileNames[type] = shaderFileName;
+	inner->setShader(shaderFileName, type);
+}
+
+void CaptureMaterial::removeShader(ShaderType type)
+{
+	shaderFileNames.erase(type);
+	inner->removeShader(type);
+}
+
+void CaptureMaterial::setDiffuse(Color c)
+{
+	color = c;
+	inner->setDiffuse(c);
+}
+
+/*
+ addDefine is not virtual, so the defines collected by this wrapper are
+ recorded and handed to the backend material right before compiling.
+*/
+int CaptureMaterial::compileMaterial(std::string& errString)
+{
+	// before the defines, they include the layout's.
+	capture->stream.writeOp(CommandStream::CAP_MATERIAL_VERTEX_LAYOUT);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32((uint32_t)vertexLayout.getAttributes().size());
+	for (const VertexLayout::Attribute& a : vertexLayout.getAttributes())
+	{
+		capture->stream.writeU32(a.location);
+		capture->stream.writeU32((uint32_t)a.format);
+		capture->stream.writeU32(a.stream);
+	}
+	inner->setVertexLayout(vertexLayout);
+	for (auto& defines : shaderDefines)
+	{
+		for (auto& define : defines.second)
+		{
+			capture->stream.writeOp(CommandStream::CAP_MATERIAL_DEFINE);
+			capture->stream.writeU32(id);
+			capture->stream.writeU32((uint32_t)defines.first);
+			capture->stream.writeString(define);
+			inner->addDefine(define, defines.first);
+		}
+	}
+	capture->stream.writeOp(CommandStream::CAP_MATERIAL_COMPILE);
+	capture->stream.writeU32(id);
+	int result = inner->compileMaterial(errString);
+	isValid = inner->isValid;
+	return result;
+}
+
+void CaptureMaterial::addConstantBuffer(std::string name, unsigned int location)
+{
+	capture->stream.writeOp(CommandStream::CAP_MATERIAL_ADD_CB);
+	capture->stream.writeU32(id);
+	capture->stream.writeString(name);
+	capture->stream.writeU32(location);
+	inner->addConstantBuffer(name, location);
+}
+
+void CaptureMaterial::updateConstantBuffer(const void* data, size_t size, unsigned int location)
+{
+	capture->stream.writeOp(CommandStream::CAP_MATERIAL_UPDATE_CB);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32(location);
+	capture->stream.writeBytes(data, size);
+	inner->updateConstantBuffer(data, size, location);
+}
+
+int CaptureMaterial::enable()
+{
+	return inner->enable();
+}
+
+void CaptureMaterial::disable()
+{
+	inner->disable();
+}
+
+CaptureRenderState::CaptureRenderState(CaptureRenderer* capture, RenderState* inner)
+	: inner(inner), capture(capture)
+{
+	id = capture->nextId();
+	capture->stream.writeOp(CommandStream::CAP_MAKE_RENDER_STATE);
+	capture->stream.writeU32(id);
+}
+
+void CaptureRenderState::setWireFrame(bool wireframe)
+{
+	capture->stream.writeOp(CommandStream::CAP_RENDER_STATE_WIREFRAME);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32(wireframe);
+	inner->setWireFrame(wireframe);
+}
+
+void CaptureRenderState::set()
+{
+	inner->set();
+}
+
+CaptureTechnique::CaptureTechnique(CaptureRenderer* capture, CaptureMaterial* m, CaptureRenderState* r, Technique* inner)
+	: Technique(m, r), inner(inner), capture(capture)
+{
+	id = capture->nextId();
+	capture->stream.writeOp(CommandStream::CAP_MAKE_TECHNIQUE);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32(m->id);
+	capture->stream.writeU32(r->id);
+}
+
+CaptureTechnique::~CaptureTechnique()
+{
+	recordDestroy(capture, id);
+	delete inner;
+}
+
+void CaptureTechnique::enable(Renderer* renderer)
+{
+	inner->enable(capture->inner);
+}
+
+CaptureVertexBuffer::CaptureVertexBuffer(CaptureRenderer* capture, VertexBuffer* inner, size_t size, DATA_USAGE usage)
+	: inner(inner), capture(capture)
+{
+	id = capture->nextId();
+	capture->stream.writeOp(CommandStream::CAP_MAKE_VERTEX_BUFFER);
+	capture->stream.writeU32(id);
+	capture->stream.writeU64(size);
+	capture->stream.writeU32(usage);
+}
+
+CaptureVertexBuffer::~CaptureVertexBuffer()
+{
+	recordDestroy(capture, id);
+	delete inner;
+}
+
+void CaptureVertexBuffer::setData(const void* data, size_t size, size_t offset)
+{
+	capture->stream.writeOp(CommandStream::CAP_VERTEX_BUFFER_DATA);
+	capture->stream.writeU32(id);
+	capture->stream.writeU64(offset);
+	capture->stream.writeBytes(data, size);
+	inner->setData(data, size, offset);
+}
+
+void CaptureVertexBuffer::bind(size_t offset, size_t size, unsigned int location)
+{
+	inner->bind(offset, size, location);
+}
+
+void CaptureVertexBuffer::unbind()
+{
+	inner->unbind();
+}
+
+size_t CaptureVertexBuffer::getSize()
+{
+	return inner->getSize();
+}
+
+CaptureConstantBuffer::CaptureConstantBuffer(CaptureRenderer* capture, ConstantBuffer* inner, const std::string& name, unsigned int location)
+	: inner(inner), capture(capture)
+{
+	id = capture->nextId();
+	capture->stream.writeOp(CommandStream::CAP_MAKE_CONSTANT_BUFFER);
+	capture->stream.writeU32(id);
+	capture->stream.writeString(name);
+	capture->stream.writeU32(location);
+}
+
+CaptureConstantBuffer::~CaptureConstantBuffer()
+{
+	recordDestroy(capture, id);
+	delete inner;
+}
+
+void CaptureConstantBuffer::setData(const void* data, size_t size, Material* m, unsigned int location)
+{
+	CaptureMaterial* material = (CaptureMaterial*)m;
+	capture->stream.writeOp(CommandStream::CAP_CONSTANT_BUFFER_DATA);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32(location);
+	capture->stream.writeU32(material ? material->id : 0);
+	capture->stream.writeBytes(data, size);
+	inner->setData(data, size, material ? material->inner : nullptr, location);
+}
+
+void CaptureConstantBuffer::bind(Material* m)
+{
+	inner->bind(m ? ((CaptureMaterial*)m)->inner : nullptr);
+}
+
+CaptureSampler2D::CaptureSampler2D(CaptureRenderer* capture, Sampler2D* inner)
+	: inner(inner), capture(capture)
+{
+	id = capture->nextId();
+	capture->stream.writeOp(CommandStream::CAP_MAKE_SAMPLER);
+	capture->stream.writeU32(id);
+}
+
+CaptureSampler2D::~CaptureSampler2D()
+{
+	recordDestroy(capture, id);
+	delete inner;
+}
+
+void CaptureSampler2D::setMagFilter(FILTER filter)
+{
+	capture->stream.writeOp(CommandStream::CAP_SAMPLER_FILTER);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32(0);
+	capture->stream.writeU32(filter);
+	inner->setMagFilter(filter);
+}
+
+void CaptureSampler2D::setMinFilter(FILTER filter)
+{
+	capture->stream.writeOp(CommandStream::CAP_SAMPLER_FILTER);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32(1);
+	capture->stream.writeU32(filter);
+	inner->setMinFilter(filter);
+}
+
+void CaptureSampler2D::setWrap(WRAPPING s, WRAPPING t)
+{
+	capture->stream.writeOp(CommandStream::CAP_SAMPLER_WRAP);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32(s);
+	capture->stream.writeU32(t);
+	inner->setWrap(s, t);
+}
+
+CaptureTexture2D::CaptureTexture2D(CaptureRenderer* capture, Texture2D* inner)
+	: inner(inner), capture(capture)
+{
+	id = capture->nextId();
+	capture->stream.writeOp(CommandStream::CAP_MAKE_TEXTURE);
+	capture->stream.writeU32(id);
+}
+
+CaptureTexture2D::~CaptureTexture2D()
+{
+	recordDestroy(capture, id);
+	delete inner;
+}
+
+int CaptureTexture2D::loadFromFile(std::string filename)
+{
+	std::vector<char> contents;
+	FILE* f = fopen(filename.c_str(), "rb");
+	if (f)
+	{
+		fseek(f, 0, SEEK_END);
+		long size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		contents.resize(size > 0 ? size : 0);
+		contents.resize(fread(contents.data(), 1, contents.size(), f));
+		fclose(f);
+	}
+	capture->stream.writeOp(CommandStream::CAP_TEXTURE_LOAD);
+	capture->stream.writeU32(id);
+	capture->stream.writeString(filename);
+	capture->stream.writeBytes(contents.data(), contents.size());
+	return inner->loadFromFile(filename);
+}
+
+void CaptureTexture2D::bind(unsigned int slot)
+{
+	inner->bind(slot);
+}
+
+void CaptureTexture2D::syncSampler()
+{
+	if (sampler == recordedSampler)
+		return;
+	recordedSampler = sampler;
+	CaptureSampler2D* s = (CaptureSampler2D*)sampler;
+	capture->stream.writeOp(CommandStream::CAP_TEXTURE_SAMPLER);
+	capture->stream.writeU32(id);
+	capture->stream.writeU32(s ? s->id : 0);
+	inner->sampler = s ? s->inner : nullptr;
+}
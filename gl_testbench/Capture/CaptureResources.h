@@ -0,0 +1,128 @@
+#pragma once
+#include <stdint.h>
+#include "../Material.h"
+#include "../Technique.h"
+#include "../RenderState.h"
+#include "../VertexBuffer.h"
+#include "../ConstantBuffer.h"
+#include "../Texture2D.h"
+#include "../Sampler2D.h"
+
+class CaptureRenderer;
+
+/*
+ Wrappers handed to the application by CaptureRenderer. Each call is
+ recorded with the object's capture id, then forwarded to the real
+ object of the wrapped backend (inner).
+*/
+
+class CaptureMaterial : public Material
+{
+public:
+	CaptureMaterial(CaptureRenderer* capture, Material* inner, const std::string& name);
+	~CaptureMaterial();
+
+	void setShader(const std::string& shaderFileName, ShaderType type);
+	void removeShader(ShaderType type);
+	void setDiffuse(Color c);
+	int compileMaterial(std::string& errString);
+	void addConstantBuffer(std::string name, unsigned int location);
+	void updateConstantBuffer(const void* data, size_t size, unsigned int location);
+	int enable();
+	void disable();
+
+	uint32_t id;
+	Material* inner;
+private:
+	CaptureRenderer* capture;
+};
+
+class CaptureRenderState : public RenderState
+{
+public:
+	CaptureRenderState(CaptureRenderer* capture, RenderState* inner);
+	void setWireFrame(bool);
+	void set();
+
+	uint32_t id;
+	RenderState* inner;
+private:
+	CaptureRenderer* capture;
+};
+
+class CaptureTechnique : public Technique
+{
+public:
+	CaptureTechnique(CaptureRenderer* capture, CaptureMaterial* m, CaptureRenderState* r, Technique* inner);
+	~CaptureTechnique();
+	void enable(Renderer* renderer);
+
+	uint32_t id;
+	Technique* inner;
+private:
+	CaptureRenderer* capture;
+};
+
+class CaptureVertexBuffer : public VertexBuffer
+{
+public:
+	CaptureVertexBuffer(CaptureRenderer* capture, VertexBuffer* inner, size_t size, DATA_USAGE usage);
+	~CaptureVertexBuffer();
+	void setData(const void* data, size_t size, size_t offset);
+	void bind(size_t offset, size_t size, unsigned int location);
+	void unbind();
+	size_t getSize();
+
+	uint32_t id;
+	VertexBuffer* inner;
+private:
+	CaptureRenderer* capture;
+};
+
+class CaptureConstantBuffer : public ConstantBuffer
+{
+public:
+	CaptureConstantBuffer(CaptureRenderer* capture, ConstantBuffer* inner, const std::string& name, unsigned int location);
+	~CaptureConstantBuffer();
+	void setData(const void* data, size_t size, Material* m, unsigned int location);
+	void bind(Material*);
+
+	uint32_t id;
+	ConstantBuffer* inner;
+private:
+	CaptureRenderer* capture;
+};
+
+class CaptureSampler2D : public Sampler2D
+{
+public:
+	CaptureSampler2D(CaptureRenderer* capture, Sampler2D* inner);
+	~CaptureSampler2D();
+	void setMagFilter(FILTER filter);
+	void setMinFilter(FILTER filter);
+	void setWrap(WRAPPING s, WRAPPING t);
+
+	uint32_t id;
+	Sampler2D* inner;
+private:
+	CaptureRenderer* capture;
+};
+
+class CaptureTexture2D : public Texture2D
+{
+public:
+	CaptureTexture2D(CaptureRenderer* capture, Texture2D* inner);
+	~CaptureTexture2D();
+	// the file contents are stored in the capture, so replay needs no assets.
+	int loadFromFile(std::string filename);
+	void bind(unsigned int slot);
+	// the sampler is a public field, it is picked up when a mesh using the
+	// texture is submitted.
+	void syncSampler();
+
+	uint32_t id;
+	Texture2D* inner;
+private:
+	CaptureRenderer* capture;
+	Sampler2D* recordedSampler = nullptr;
+};
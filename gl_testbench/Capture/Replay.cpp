@@ -0,0 +1,400 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+#include <SDL_timer.h>
+#include <SDL_events.h>
+
+#include "Replay.h"
+#include "CaptureRenderer.h"
+#include "../Mesh.h"
+#include "../Texture2D.h"
+#include "../Sampler2D.h"
+
+/*
+ objects of the replaying backend, indexed by capture id.
+*/
+struct ReplayObjects {
+	std::unordered_map<uint32_t, Material*> materials;
+	std::unordered_map<uint32_t, RenderState*> renderStates;
+	std::unordered_map<uint32_t, Technique*> techniques;
+	std::unordered_map<uint32_t, VertexBuffer*> vertexBuffers;
+	std::unordered_map<uint32_t, ConstantBuffer*> constantBuffers;
+	std::unordered_map<uint32_t, Texture2D*> textures;
+	std::unordered_map<uint32_t, Sampler2D*> samplers;
+	std::unordered_map<uint32_t, Mesh*> meshes;
+
+	template<typename T>
+	static T* find(std::unordered_map<uint32_t, T*>& objects, uint32_t id)
+	{
+		auto found = objects.find(id);
+		return found == objects.end() ? nullptr : found->second;
+	}
+};
+
+/*
+ texture payloads are written next to the capture's original file name only
+ if that file is missing, backends can only load textures from disk.
+*/
+static int loadTexture(Texture2D* texture, const std::string& filename, const uint8_t* contents, size_t size)
+{
+	FILE* f = fopen(filename.c_str(), "rb");
+	if (f)
+	{
+		fclose(f);
+		return texture->loadFromFile(filename);
+	}
+	size_t dot = filename.find_last_of('.');
+	std::string extracted = "replay_texture" + (dot == std::string::npos ? std::string() : filename.substr(dot));
+	f = fopen(extracted.c_str(), "wb");
+	if (f == nullptr)
+		return -1;
+	fwrite(contents, 1, size, f);
+	fclose(f);
+	int result = texture->loadFromFile(extracted);
+	remove(extracted.c_str());
+	return result;
+}
+
+long long replayCapture(const std::string& filename, Renderer::BACKEND backend, bool headless, bool paced)
+{
+	CommandStream stream;
+	if (stream.load(filename) != 0 || stream.size() < 6 || memcmp(stream.data(), "TBCAP", 5) != 0)
+	{
+		fprintf(stderr, "%s is not a capture file\n", filename.c_str());
+		return -1;
+	}
+	if (stream.data()[5] != CaptureRenderer::VERSION)
+	{
+		fprintf(stderr, "%s: unsupported capture version %d\n", filename.c_str(), stream.data()[5]);
+		return -1;
+	}
+	// skip the header
+	stream.rewind();
+	for (int i = 0; i < 6; i++)
+		stream.readOp();
+
+	Renderer* renderer = Renderer::makeRenderer(backend);
+	ReplayObjects objects;
+	std::string shaderPath = renderer->getShaderPath();
+	std::string shaderExtension = renderer->getShaderExtension();
+	long long frames = 0;
+	uint64_t startCounter = SDL_GetPerformanceCounter();
+	const double frequency = (double)SDL_GetPerformanceFrequency();
+	bool initialized = false;
+
+	while (!stream.atEnd())
+	{
+		CommandStream::OPCODE op = stream.readOp();
+		switch (op)
+		{
+		case CommandStream::CAP_INITIALIZE:
+		{
+			uint32_t width = stream.readU32();
+			uint32_t height = stream.readU32();
+			renderer->initialize(width, height, headless);
+			initialized = true;
+			startCounter = SDL_GetPerformanceCounter();
+			break;
+		}
+		case CommandStream::CAP_SET_CLEAR_COLOR:
+		{
+			float r = stream.readFloat(), g = stream.readFloat(), b = stream.readFloat(), a = stream.readFloat();
+			renderer->setClearColor(r, g, b, a);
+			break;
+		}
+		case CommandStream::CAP_SET_SUBMISSION:
+			renderer->setSubmission((Renderer::SUBMISSION)stream.readU32());
+			break;
+		case CommandStream::CAP_MAKE_MATERIAL:
+		{
+			uint32_t id = stream.readU32();
+			objects.materials[id] = renderer->makeMaterial(stream.readString());
+			break;
+		}
+		case CommandStream::CAP_MATERIAL_SHADER:
+		{
+			Material* m = ReplayObjects::find(objects.materials, stream.readU32());
+			Material::ShaderType type = (Material::ShaderType)stream.readU32();
+			std::string name = stream.readString();
+			if (m)
+				m->setShader(shaderPath + name + shaderExtension, type);
+			break;
+		}
+		case CommandStream::CAP_MATERIAL_DEFINE:
+		{
+			Material* m = ReplayObjects::find(objects.materials, stream.readU32());
+			Material::ShaderType type = (Material::ShaderType)stream.readU32();
+			std::string define = stream.readString();
+			if (m)
+				m->addDefine(define, type);
+			break;
+		}
+		case CommandStream::CAP_MATERIAL_VERTEX_LAYOUT:
+		{
+			Material* m = ReplayObjects::find(objects.materials, stream.readU32());
+			VertexLayout layout;
+			uint32_t count = stream.readU32();
+			for (uint32_t i = 0; i < count; i++)
+			{
+				unsigned int location = stream.readU32();
+				VertexLayout::FORMAT format = (VertexLayout::FORMAT)stream.readU32();
+				layout.add(location, format, stream.readU32());
+			}
+			if (m)
+				m->setVertexLayout(layout);
+			break;
+		}
+		case CommandStream::CAP_MATERIAL_COMPILE:
+		{
+			Material* m = ReplayObjects::find(objects.materials, stream.readU32());
+			std::string err;
+			if (m && m->compileMaterial(err) != 0)
+				fprintf(stderr, "%s\n", err.c_str());
+			break;
+		}
+		case CommandStream::CAP_MATERIAL_ADD_CB:
+		{
+			Material* m = ReplayObjects::find(objects.materials, stream.readU32());
+			std::string name = stream.readString();
+			uint32_t location = stream.readU32();
+			if (m)
+				m->addConstantBuffer(name, location);
+			break;
+		}
+		case CommandStream::CAP_MATERIAL_UPDATE_CB:
+		{
+			Material* m = ReplayObjects::find(objects.materials, stream.readU32());
+			uint32_t location = stream.readU32();
+			size_t size;
+			const uint8_t* data = stream.readPayload(size);
+			if (m)
+				m->updateConstantBuffer(data, size, location);
+			break;
+		}
+		case CommandStream::CAP_MAKE_RENDER_STATE:
+			objects.renderStates[stream.readU32()] = renderer->makeRenderState();
+			break;
+		case CommandStream::CAP_RENDER_STATE_WIREFRAME:
+		{
+			RenderState* r = ReplayObjects::find(objects.renderStates, stream.readU32());
+			bool wireframe = stream.readU32() != 0;
+			if (r)
+				r->setWireFrame(wireframe);
+			break;
+		}
+		case CommandStream::CAP_MAKE_TECHNIQUE:
+		{
+			uint32_t id = stream.readU32();
+			Material* m = ReplayObjects::find(objects.materials, stream.readU32());
+			RenderState* r = ReplayObjects::find(objects.renderStates, stream.readU32());
+			objects.techniques[id] = renderer->makeTechnique(m, r);
+			break;
+		}
+		case CommandStream::CAP_MAKE_VERTEX_BUFFER:
+		{
+			uint32_t id = stream.readU32();
+			size_t size = (size_t)stream.readU64();
+			VertexBuffer::DATA_USAGE usage = (VertexBuffer::DATA_USAGE)stream.readU32();
+			objects.vertexBuffers[id] = renderer->makeVertexBuffer(size, usage);
+			break;
+		}
+		case CommandStream::CAP_VERTEX_BUFFER_DATA:
+		{
+			VertexBuffer* vb = ReplayObjects::find(objects.vertexBuffers, stream.readU32());
+			size_t offset = (size_t)stream.readU64();
+			size_t size;
+			const uint8_t* data = stream.readPayload(size);
+			if (vb)
+				vb->setData(data, size, offset);
+			break;
+		}
+		case CommandStream::CAP_MAKE_CONSTANT_BUFFER:
+		{
+			uint32_t id = stream.readU32();
+			std::string name = stream.readString();
+			objects.constantBuffers[id] = renderer->makeConstantBuffer(name, stream.readU32());
+			break;
+		}
+		case CommandStream::CAP_CONSTANT_BUFFER_DATA:
+		{
+			ConstantBuffer* cb = ReplayObjects::find(objects.constantBuffers, stream.readU32());
+			uint32_t location = stream.readU32();
+			Material* m = ReplayObjects::find(objects.materials, stream.readU32());
+			size_t size;
+			const uint8_t* data = stream.readPayload(size);
+			if (cb)
+				cb->setData(data, size, m, location);
+			break;
+		}
+		case CommandStream::CAP_MAKE_TEXTURE:
+			objects.textures[stream.readU32()] = renderer->makeTexture2D();
+			break;
+		case CommandStream::CAP_TEXTURE_LOAD:
+		{
+			Texture2D* t = ReplayObjects::find(objects.textures, stream.readU32());
+			std::string name = stream.readString();
+			size_t size;
+			const uint8_t* contents = stream.readPayload(size);
+			if (t && loadTexture(t, name, contents, size) != 0)
+				fprintf(stderr, "Replay: cannot load texture %s\n", name.c_str());
+			break;
+		}
+		case CommandStream::CAP_TEXTURE_SAMPLER:
+		{
+			Texture2D* t = ReplayObjects::find(objects.textures, stream.readU32());
+			Sampler2D* s = ReplayObjects::find(objects.samplers, stream.readU32());
+			if (t)
+				t->sampler = s;
+			break;
+		}
+		case CommandStream::CAP_MAKE_SAMPLER:
+			objects.samplers[stream.readU32()] = renderer->makeSampler2D();
+			break;
+		case CommandStream::CAP_SAMPLER_FILTER:
+		{
+			Sampler2D* s = ReplayObjects::find(objects.samplers, stream.readU32());
+			uint32_t which = stream.readU32();
+			FILTER filter = (FILTER)stream.readU32();
+			if (s && which == 0)
+				s->setMagFilter(filter);
+			else if (s)
+				s->setMinFilter(filter);
+			break;
+		}
+		case CommandStream::CAP_SAMPLER_WRAP:
+		{
+			Sampler2D* s = ReplayObjects::find(objects.samplers, stream.readU32());
+			WRAPPING wrapS = (WRAPPING)stream.readU32();
+			WRAPPING wrapT = (WRAPPING)stream.readU32();
+			if (s)
+				s->setWrap(wrapS, wrapT);
+			break;
+		}
+		case CommandStream::CAP_DESTROY:
+		{
+			// same order as the captured application, ids are unique across types.
+			uint32_t id = stream.readU32();
+			if (Material* m = ReplayObjects::find(objects.materials, id)) { delete m; objects.materials.erase(id); }
+			else if (Technique* t = ReplayObjects::find(objects.techniques, id)) { delete t; objects.techniques.erase(id); }
+			else if (VertexBuffer* vb = ReplayObjects::find(objects.vertexBuffers, id)) { delete vb; objects.vertexBuffers.erase(id); }
+			else if (Texture2D* tex = ReplayObjects::find(objects.textures, id)) { delete tex; objects.textures.erase(id); }
+			else if (Sampler2D* s = ReplayObjects::find(objects.samplers, id)) { delete s; objects.samplers.erase(id); }
+			else if (ConstantBuffer* cb = ReplayObjects::find(objects.constantBuffers, id)) { delete cb; objects.constantBuffers.erase(id); }
+			break;
+		}
+		case CommandStream::CAP_MESH:
+		{
+			uint32_t id = stream.readU32();
+			Mesh*& mesh = objects.meshes[id];
+			if (mesh == nullptr)
+				mesh = renderer->makeMesh();
+			mesh->technique = ReplayObjects::find(objects.techniques, stream.readU32());
+			mesh->txBuffer = ReplayObjects::find(objects.constantBuffers, stream.readU32());
+			// no references taken, like the capture side mirror meshes.
+			mesh->geometryBuffers.clear();
+			uint32_t bindings = stream.readU32();
+			for (uint32_t i = 0; i < bindings; i++)
+			{
+				uint32_t location = stream.readU32();
+				VertexBuffer* vb = ReplayObjects::find(objects.vertexBuffers, stream.readU32());
+				size_t offset = (size_t)stream.readU64();
+				size_t numElements = (size_t)stream.readU64();
+				size_t sizeElement = (size_t)stream.readU64();
+				mesh->geometryBuffers[location] = { sizeElement, numElements, offset, vb };
+			}
+			mesh->textures.clear();
+			uint32_t textureCount = stream.readU32();
+			for (uint32_t i = 0; i < textureCount; i++)
+			{
+				uint32_t slot = stream.readU32();
+				mesh->textures[slot] = ReplayObjects::find(objects.textures, stream.readU32());
+			}
+			mesh->changed();
+			break;
+		}
+		case CommandStream::CAP_SUBMIT:
+		{
+			Mesh* mesh = ReplayObjects::find(objects.meshes, stream.readU32());
+			if (mesh)
+				renderer->submit(mesh);
+			break;
+		}
+		case CommandStream::CAP_SET_RENDER_STATE:
+		{
+			RenderState* r = ReplayObjects::find(objects.renderStates, stream.readU32());
+			if (r)
+				renderer->setRenderState(r);
+			break;
+		}
+		case CommandStream::CLEAR:
+			renderer->clearBuffer(stream.readU32());
+			break;
+		case CommandStream::FRAME:
+			renderer->frame();
+			break;
+		case CommandStream::CAP_PRESENT:
+		{
+			uint64_t due = stream.readU64();
+			if (paced)
+			{
+				while ((SDL_GetPerformanceCounter() - startCounter) / frequency * 1000000.0 < due)
+					SDL_Delay(0);
+			}
+			renderer->present();
+			SDL_PumpEvents();
+			frames++;
+			break;
+		}
+		default:
+			fprintf(stderr, "Replay: unknown opcode %d, stopping\n", (int)op);
+			stream.clear();
+			break;
+		}
+	}
+
+	double seconds = (SDL_GetPerformanceCounter() - startCounter) / frequency;
+	fprintf(stderr, "replayed %lld frames in %.3f s (%.3f ms/frame)\n", frames, seconds, frames ? seconds * 1000.0 / frames : 0.0);
+
+	for (auto& m : objects.meshes)
+	{
+		m.second->geometryBuffers.clear();
+		delete m.second;
+	}
+	for (auto& m : objects.materials) delete m.second;
+	for (auto& t : objects.techniques) delete t.second;
+	for (auto& vb : objects.vertexBuffers) delete vb.second;
+	for (auto& t : objects.textures) delete t.second;
+	for (auto& s : objects.samplers) delete s.second;
+	if (initialized)
+		renderer->shutdown();
+	delete renderer;
+	return frames;
+}
+
+int replayMain(int argc, char* argv[])
+{
+	std::string filename;
+	Renderer::BACKEND backend = Renderer::BACKEND::VULKAN;
+	bool headless = false;
+	bool paced = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--replay" && i + 1 < argc)
+			filename = argv[++i];
+		else if (arg == "gl")
+			backend = Renderer::BACKEND::GL45;
+		else if (arg == "vulkan")
+			backend = Renderer::BACKEND::VULKAN;
+		else if (arg == "null")
+			backend = Renderer::BACKEND::NULL_RENDERER;
+		else if (arg == "software")
+			backend = Renderer::BACKEND::SOFTWARE;
+		else if (arg == "--headless")
+			headless = true;
+		else if (arg == "--paced")
+			paced = true;
+	}
+	return replayCapture(filename, backend, headless, paced) < 0 ? -1 : 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include "../Renderer.h"
+
+/*
+ Re-executes a capture written by CaptureRenderer on any backend.
+ paced: wait until each present() is due according to the capture's own
+ timestamps, otherwise run as fast as possible.
+ Returns the number of frames presented, -1 if the file is not a capture.
+*/
+long long replayCapture(const std::string& filename, Renderer::BACKEND backend, bool headless, bool paced);
+
+/*
+ --replay file [gl|vulkan|null|software] [--headless] [--paced]
+*/
+int replayMain(int argc, char* argv[]);
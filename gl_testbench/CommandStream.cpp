@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <string.h>
+#include "CommandStream.h"
+
+void CommandStream::writeU32(uint32_t v)
+{
+	writeU64(v);
+}
+
+void CommandStream::writeU64(uint64_t v)
+{
+	while (v >= 0x80)
+	{
+		buffer.push_back((uint8_t)(v | 0x80));
+		v >>= 7;
+	}
+	buffer.push_back((uint8_t)v);
+}
+
+void CommandStream::writeFloat(float v)
+{
+	uint8_t bytes[sizeof(float)];
+	memcpy(bytes, &v, sizeof(float));
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(float));
+}
+
+void CommandStream::writeBytes(const void* data, size_t size)
+{
+	writeU64(size);
+	const uint8_t* bytes = (const uint8_t*)data;
+	buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+uint64_t CommandStream::readU64()
+{
+	uint64_t v = 0;
+	int shift = 0;
+	while (readPos < buffer.size())
+	{
+		uint8_t b = buffer[readPos++];
+		v |= (uint64_t)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0)
+			break;
+		shift += 7;
+	}
+	return v;
+}
+
+float CommandStream::readFloat()
+{
+	float v = 0.0f;
+	if (readPos + sizeof(float) <= buffer.size())
+		memcpy(&v, &buffer[readPos], sizeof(float));
+	readPos += sizeof(float);
+	return v;
+}
+
+size_t CommandStream::readBytes(void* dest, size_t maxSize)
+{
+	size_t size = (size_t)readU64();
+	size_t available = readPos < buffer.size() ? buffer.size() - readPos : 0;
+	size_t copy = size < maxSize ? size : maxSize;
+	if (copy > available)
+		copy = available;
+	if (dest && copy)
+		memcpy(dest, &buffer[readPos], copy);
+	readPos += size;
+	return size;
+}
+
+const uint8_t* CommandStream::readPayload(size_t& size)
+{
+	size = (size_t)readU64();
+	if (readPos + size > buffer.size())
+		size = readPos < buffer.size() ? buffer.size() - readPos : 0;
+	const uint8_t* payload = size ? &buffer[readPos] : nullptr;
+	readPos += size;
+	return payload;
+}
+
+std::string CommandStream::readString()
+{
+	size_t size;
+	const uint8_t* payload = readPayload(size);
+	return std::string((const char*)payload, size);
+}
+
+uint64_t CommandStream::hash() const
+{
+	uint64_t h = 14695981039346656037ull;
+	for (uint8_t b : buffer)
+	{
+		h ^= b;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+int CommandStream::save(const std::string& filename) const
+{
+	FILE* f = fopen(filename.c_str(), "wb");
+	if (f == nullptr)
+		return -1;
+	fwrite(buffer.data(), 1, buffer.size(), f);
+	fclose(f);
+	return 0;
+}
+
+int CommandStream::load(const std::string& filename)
+{
+	FILE* f = fopen(filename.c_str(), "rb");
+	if (f == nullptr)
+		return -1;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buffer.resize(size > 0 ? size : 0);
+	size_t read = fread(buffer.data(), 1, buffer.size(), f);
+	buffer.resize(read);
+	fclose(f);
+	readPos = 0;
+	return 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ Compact binary command buffer: one opcode byte followed by its arguments.
+ Integers are LEB128 varints, raw payloads are a varint length + bytes.
+ Objects are referred to by small integer ids handed out by the writer.
+*/
+class CommandStream
+{
+public:
+	enum OPCODE : uint8_t {
+		CLEAR = 1,          // flags
+		SET_RENDER_STATE,   // renderState id, wireframe
+		ENABLE_MATERIAL,    // material id
+		BIND_TEXTURE,       // texture id, slot
+		BIND_VERTEX_BUFFER, // buffer id, offset, size, location
+		BIND_CONSTANT,      // buffer id, location, payload
+		DRAW,               // vertex count
+		FRAME,
+		PRESENT,
+		// after PRESENT, so the opcodes before keep their values.
+		BIND_INDEX_BUFFER,  // buffer id, offset, index size
+		DRAW_INDEXED,       // index count
+
+		// capture / replay (Capture/), arguments use capture ids
+		CAP_INITIALIZE = 32,     // width, height
+		CAP_SET_CLEAR_COLOR,     // r, g, b, a
+		CAP_SET_SUBMISSION,      // strategy
+		CAP_MAKE_MATERIAL,       // id, name
+		CAP_MATERIAL_SHADER,     // id, type, shader name without path/extension
+		CAP_MATERIAL_DEFINE,     // id, type, define text
+		CAP_MATERIAL_COMPILE,    // id
+		CAP_MATERIAL_ADD_CB,     // id, name, location
+		CAP_MATERIAL_UPDATE_CB,  // id, location, payload
+		CAP_MAKE_RENDER_STATE,   // id
+		CAP_RENDER_STATE_WIREFRAME, // id, wireframe
+		CAP_MAKE_TECHNIQUE,      // id, material id, render state id
+		CAP_MAKE_VERTEX_BUFFER,  // id, size, usage
+		CAP_VERTEX_BUFFER_DATA,  // id, offset, payload
+		CAP_MAKE_CONSTANT_BUFFER,// id, name, location
+		CAP_CONSTANT_BUFFER_DATA,// id, location, material id, payload
+		CAP_MAKE_TEXTURE,        // id
+		CAP_TEXTURE_LOAD,        // id, file name, file contents
+		CAP_TEXTURE_SAMPLER,     // texture id, sampler id
+		CAP_MAKE_SAMPLER,        // id
+		CAP_SAMPLER_FILTER,      // id, 0 mag / 1 min, filter
+		CAP_SAMPLER_WRAP,        // id, s, t
+		CAP_DESTROY,             // id
+		CAP_MESH,                // id, technique, txBuffer, bindings, textures
+		CAP_SUBMIT,              // mesh id
+		CAP_SET_RENDER_STATE,    // render state id
+		CAP_PRESENT,             // microseconds since the start of the capture
+		CAP_MATERIAL_VERTEX_LAYOUT, // id, attribute count, then location, format, stream of each
+	};
+
+	void clear() { buffer.clear(); readPos = 0; };
+	size_t size() const { return buffer.size(); };
+	const uint8_t* data() const { return buffer.data(); };
+
+	void writeOp(OPCODE op) { buffer.push_back(op); };
+	void writeU32(uint32_t v);
+	void writeU64(uint64_t v);
+	void writeFloat(float v);
+	void writeBytes(const void* data, size_t size);
+	void writeString(const std::string& s) { writeBytes(s.data(), s.size()); };
+
+	bool atEnd() const { return readPos >= buffer.size(); };
+	void rewind() { readPos = 0; };
+	OPCODE readOp() { return (OPCODE)buffer[readPos++]; };
+	uint32_t readU32() { return (uint32_t)readU64(); };
+	uint64_t readU64();
+	float readFloat();
+	// returns the payload size, copies at most maxSize bytes into dest
+	size_t readBytes(void* dest, size_t maxSize);
+	// payload without copying, valid until the stream is modified
+	const uint8_t* readPayload(size_t& size);
+	std::string readString();
+
+	// FNV-1a of the whole stream, cheap way to compare runs.
+	uint64_t hash() const;
+	bool operator==(const CommandStream& other) const { return buffer == other.buffer; };
+
+	// returns 0 on success, -1 if the file cannot be opened.
+	int save(const std::string& filename) const;
+	int load(const std::string& filename);
+private:
+	std::vector<uint8_t> buffer;
+	size_t readPos = 0;
+};
@@ -0,0 +1,25 @@
+#include "ComputeTechnique.h"
+
+const uint32_t ComputeTechnique::NO_SLOT;
+
+ComputeTechnique::~ComputeTechnique()
+{
+	for (auto& s : storage)
+		s.second.buffer->decRef();
+}
+
+void ComputeTechnique::setStorageBuffer(uint32_t slot, VertexBuffer* buffer, size_t offset, size_t size)
+{
+	buffer->incRef();
+	auto found = storage.find(slot);
+	if (found != storage.end())
+		found->second.buffer->decRef();
+	storage[slot] = { buffer, offset, size };
+	revision++;
+}
+
+void ComputeTechnique::setTransformBuffer(uint32_t slot)
+{
+	transformSlot = slot;
+	revision++;
+}
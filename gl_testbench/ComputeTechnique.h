@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include <map>
+#include "Material.h"
+#include "VertexBuffer.h"
+
+/*
+ A compute program (a Material with only a CS compiled) and the storage
+ buffers it reads and writes, by binding slot. Made by
+ Renderer::createComputeTechnique and run by Renderer::dispatch, which
+ also orders its writes before the draws of the frame that read them.
+
+	Material* m = renderer->get(animateMaterial);   // setShader(..., CS), compileMaterial
+	ComputeTechnique* c = renderer->get(renderer->createComputeTechnique(animateMaterial));
+	c->setStorageBuffer(PLACES, curve);
+	c->setTransformBuffer(TRANSLATION);              // the attached translations
+	m->updateConstantBuffer(&params, sizeof(params), ANIMATION);
+	renderer->dispatch(c, (count + 63) / 64);
+
+ The material's constant buffers go with it, as for a draw. The buffers
+ are referenced (see VertexBuffer::refCount) until replaced or until the
+ technique is destroyed.
+*/
+class ComputeTechnique
+{
+public:
+	static const uint32_t NO_SLOT = 0xffffffff;
+
+	struct StorageBinding {
+		VertexBuffer* buffer;
+		size_t offset;
+		// 0 for the rest of the buffer.
+		size_t size;
+	};
+
+	ComputeTechnique(Material* m) : material(m) {};
+	virtual ~ComputeTechnique();
+	Material* getMaterial() { return material; };
+
+	void setStorageBuffer(uint32_t slot, VertexBuffer* buffer, size_t offset = 0, size_t size = 0);
+	/*
+	 the renderer's per-draw translation buffer (see Renderer::attachTransforms)
+	 at slot, one float4 every Renderer::getTransformStride() bytes.
+	*/
+	void setTransformBuffer(uint32_t slot);
+	const std::map<uint32_t, StorageBinding>& getStorageBuffers() const { return storage; };
+	uint32_t getTransformSlot() const { return transformSlot; };
+	// changes with every binding, so backends know when to write their descriptors again.
+	unsigned int getRevision() const { return revision; };
+protected:
+	Material* material = nullptr;
+	std::map<uint32_t, StorageBinding> storage;
+	uint32_t transformSlot = NO_SLOT;
+	unsigned int revision = 0;
+};
@@ -6,13 +6,17 @@ class ConstantBuffer
 {
 public:
 	ConstantBuffer(std::string NAME, unsigned int location) {};
-	~ConstantBuffer();
+	// meshes and materials delete their buffers through this class.
+	virtual ~ConstantBuffer();
 	// set data will update the buffer associated, including whatever is necessary to
 	// update the GPU memory.
 	virtual void setData(const void* data, size_t size, Material* m, unsigned int location) = 0;
 	virtual void bind(Material*) = 0;
+	// changes when the buffer binds different memory (see Mesh::changed).
+	unsigned int getRevision() const { return revision; };
 protected:
 	// don't use this.
 	ConstantBuffer() {};
+	unsigned int revision = 0;
 };
 
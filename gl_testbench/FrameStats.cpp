@@ -0,0 +1,44 @@
+#include "FrameStats.h"
+#include "AllocationTracker.h"
+
+const uint32_t FrameStats::HISTORY;
+FrameStats FrameStats::current;
+
+static FrameStats ring[FrameStats::HISTORY];
+static uint64_t finished = 0;
+static AllocationTracker::Counters heapAtFrameStart;
+
+void FrameStats::endFrame()
+{
+	const AllocationTracker::Counters heap = AllocationTracker::total();
+	current.allocations = (uint32_t)(heap.allocations - heapAtFrameStart.allocations);
+	current.frees = (uint32_t)(heap.frees - heapAtFrameStart.frees);
+	current.allocatedBytes = heap.bytes - heapAtFrameStart.bytes;
+	heapAtFrameStart = heap;
+	current.frame = finished;
+	ring[finished % HISTORY] = current;
+	finished++;
+	current = FrameStats();
+}
+
+const FrameStats& FrameStats::last()
+{
+	static const FrameStats none;
+	return finished ? ring[(finished - 1) % HISTORY] : none;
+}
+
+std::vector<FrameStats> FrameStats::history()
+{
+	std::vector<FrameStats> frames;
+	uint64_t first = finished > HISTORY ? finished - HISTORY : 0;
+	for (uint64_t f = first; f < finished; f++)
+		frames.push_back(ring[f % HISTORY]);
+	return frames;
+}
+
+void FrameStats::resetHistory()
+{
+	finished = 0;
+	current = FrameStats();
+	heapAtFrameStart = AllocationTracker::total();
+}
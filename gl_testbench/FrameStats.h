@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+/*
+ API traffic of one frame. The backends and their resources add to
+ FrameStats::current as they issue the calls, present() closes the frame
+ with endFrame(), which keeps the last HISTORY frames.
+
+ Plain integer adds from the render thread, cheap enough to stay on.
+*/
+struct FrameStats {
+	// frames since start, set by endFrame().
+	uint64_t frame = 0;
+
+	// Renderer::submit calls / draw calls recorded.
+	uint32_t drawsSubmitted = 0;
+	uint32_t drawsIssued = 0;
+	// compute dispatches recorded.
+	uint32_t dispatches = 0;
+	// multi draw indirect count calls (Renderer::setGpuCulling), how many
+	// draws they make is only known on the GPU.
+	uint32_t indirectDraws = 0;
+	// glUseProgram / vkCmdBindPipeline.
+	uint32_t pipelineBinds = 0;
+	uint32_t vertexBufferBinds = 0;
+	uint32_t textureBinds = 0;
+	// vkUpdateDescriptorSets calls.
+	uint32_t descriptorWrites = 0;
+	uint64_t pushConstantBytes = 0;
+	// bytes written into uniform buffers.
+	uint64_t uniformBytes = 0;
+	uint32_t bufferMaps = 0;
+	uint32_t bufferUnmaps = 0;
+	// vertex and texture data copied towards the GPU.
+	uint64_t stagingBytes = 0;
+	uint32_t queueSubmits = 0;
+	uint32_t queueWaits = 0;
+	// OcclusionCuller: triangles rasterized, boxes tested and found hidden,
+	// and the time of rasterizing (the tests run inside the scene's cull).
+	uint32_t occluderTriangles = 0;
+	uint32_t occlusionTests = 0;
+	uint32_t occlusionCulled = 0;
+	uint64_t occlusionMicros = 0;
+	// heap traffic of the whole process since the previous frame, filled in
+	// by endFrame() from AllocationTracker (0 unless it is counting).
+	uint32_t allocations = 0;
+	uint32_t frees = 0;
+	uint64_t allocatedBytes = 0;
+
+	static const uint32_t HISTORY = 120;
+
+	// counters of the frame being recorded.
+	static FrameStats current;
+	static void endFrame();
+	// last finished frame, all zero before the first one.
+	static const FrameStats& last();
+	// up to HISTORY finished frames, oldest first.
+	static std::vector<FrameStats> history();
+	static void resetHistory();
+};
@@ -0,0 +1,43 @@
+#include "Frustum.h"
+
+const int Frustum::PLANES;
+
+/*
+ Gribb/Hartmann: each plane is the last row of the matrix plus or minus
+ one of the other rows. glm is column major, row i is m[0][i]..m[3][i].
+*/
+Frustum Frustum::fromMatrix(const glm::mat4& m)
+{
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+	Frustum f;
+	for (int i = 0; i < 3; i++)
+	{
+		f.planes[2 * i] = rows[3] + rows[i];
+		f.planes[2 * i + 1] = rows[3] - rows[i];
+	}
+	for (auto& p : f.planes)
+	{
+		const float length = glm::length(glm::vec3(p));
+		if (length > 0.0f)
+			p /= length;
+	}
+	return f;
+}
+
+bool Frustum::intersects(const Aabb& box) const
+{
+	for (const auto& p : planes)
+	{
+		// the corner farthest along the normal.
+		const glm::vec3 corner(
+			p.x >= 0.0f ? box.max.x : box.min.x,
+			p.y >= 0.0f ? box.max.y : box.min.y,
+			p.z >= 0.0f ? box.max.z : box.min.z);
+		if (glm::dot(glm::vec3(p), corner) + p.w < 0.0f)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <float.h>
+#include <glm/glm.hpp>
+
+// axis aligned box, empty (min > max) until a point is added.
+struct Aabb {
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	void add(const glm::vec3& p) { min = glm::min(min, p); max = glm::max(max, p); };
+	void add(const Aabb& box) { min = glm::min(min, box.min); max = glm::max(max, box.max); };
+	bool empty() const { return min.x > max.x; };
+	Aabb translated(const glm::vec3& t) const { Aabb box; box.min = min + t; box.max = max + t; return box; };
+};
+
+/*
+ The six planes of a view frustum: left, right, bottom, top, near and far.
+ A point p is inside when dot(plane.xyz, p) + plane.w >= 0 for all of them,
+ the normals point into the frustum.
+*/
+struct Frustum {
+	static const int PLANES = 6;
+	glm::vec4 planes[PLANES];
+
+	// planes of a view projection matrix, GL clip space (-w <= z <= w).
+	static Frustum fromMatrix(const glm::mat4& viewProjection);
+	// false when the box is completely outside one of the planes.
+	bool intersects(const Aabb& box) const;
+};
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <algorithm>
+#include "GpuCuller.h"
+#include "IA.h"
+
+const size_t GpuCuller::COMMAND_SIZE;
+
+GpuCuller::~GpuCuller()
+{
+	shutdown();
+}
+
+bool GpuCuller::initialize(Renderer* renderer)
+{
+	shutdown();
+	this->renderer = renderer;
+	material = renderer->createMaterial("cull");
+	Material* m = renderer->get(material);
+	m->setShader(renderer->getShaderPath() + "CullShader" + renderer->getShaderExtension(), Material::ShaderType::CS);
+	m->addDefine("#define CULL " + std::to_string(CULL) + "\n" +
+		"#define CULL_NAME " + std::string(CULL_NAME) + "\n" +
+		"#define CULL_RECORDS " + std::to_string(CULL_RECORDS) + "\n" +
+		"#define CULL_COMMANDS " + std::to_string(CULL_COMMANDS) + "\n" +
+		"#define CULL_COUNTS " + std::to_string(CULL_COUNTS) + "\n" +
+		"#define TRANSLATION " + std::to_string(TRANSLATION) + "\n" +
+		"#define TRANSLATION_NAME " + std::string(TRANSLATION_NAME) + "\n", Material::ShaderType::CS);
+	std::string err;
+	if (m->compileMaterial(err) != 0)
+	{
+		fprintf(stderr, "cull: %s\n", err.c_str());
+		renderer->destroy(material);
+		material = MaterialHandle();
+		return false;
+	}
+	techniqueHandle = renderer->createComputeTechnique(material);
+	technique = renderer->get(techniqueHandle);
+	if (technique == nullptr)
+	{
+		renderer->destroy(material);
+		material = MaterialHandle();
+		return false;
+	}
+	m->addConstantBuffer(CULL_NAME, CULL);
+	technique->setTransformBuffer(TRANSLATION);
+	return true;
+}
+
+void GpuCuller::shutdown()
+{
+	if (renderer == nullptr)
+		return;
+	if (technique != nullptr)
+	{
+		// releases the buffers first.
+		renderer->destroy(techniqueHandle);
+		renderer->destroy(material);
+		technique = nullptr;
+	}
+	for (VertexBufferHandle* b : { &records, &commands, &counts })
+	{
+		if (*b)
+			renderer->destroy(*b);
+		*b = VertexBufferHandle();
+	}
+	recordCapacity = commandCapacity = countCapacity = 0;
+	recordCount = 0;
+	renderer = nullptr;
+}
+
+void GpuCuller::reserve(VertexBufferHandle& buffer, size_t& capacity, size_t size, uint32_t slot)
+{
+	if (size <= capacity)
+		return;
+	// grows by half again, so adding renderables one by one does not reallocate every time.
+	capacity = std::max(size, capacity + capacity / 2);
+	VertexBufferHandle grown = renderer->createVertexBuffer(capacity, VertexBuffer::DATA_USAGE::DYNAMIC);
+	technique->setStorageBuffer(slot, renderer->get(grown));
+	if (buffer)
+		renderer->destroy(buffer);
+	buffer = grown;
+}
+
+void GpuCuller::setRecords(const std::vector<Record>& records, uint32_t buckets)
+{
+	recordCount = (uint32_t)records.size();
+	// never empty, the technique binds all three.
+	reserve(this->records, recordCapacity, std::max<size_t>(records.size(), 1) * sizeof(Record), CULL_RECORDS);
+	reserve(commands, commandCapacity, std::max<size_t>(records.size(), 1) * COMMAND_SIZE, CULL_COMMANDS);
+	reserve(counts, countCapacity, std::max<size_t>(buckets, 1) * sizeof(uint32_t), CULL_COUNTS);
+	if (!records.empty())
+		renderer->get(this->records)->setData(records.data(), records.size() * sizeof(Record), 0);
+	zeros.assign(std::max<size_t>(buckets, 1), 0);
+}
+
+void GpuCuller::cull(const Frustum& frustum)
+{
+	if (recordCount == 0)
+		return;
+	renderer->get(counts)->setData(zeros.data(), zeros.size() * sizeof(uint32_t), 0);
+	// the planes, then x the number of records.
+	struct {
+		float planes[Frustum::PLANES][4];
+		uint32_t size[4];
+	} constants;
+	for (int p = 0; p < Frustum::PLANES; p++)
+		for (int c = 0; c < 4; c++)
+			constants.planes[p][c] = frustum.planes[p][c];
+	constants.size[0] = recordCount;
+	constants.size[1] = constants.size[2] = constants.size[3] = 0;
+	technique->getMaterial()->updateConstantBuffer(&constants, sizeof(constants), CULL);
+	renderer->dispatch(technique, (recordCount + 63) / 64);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "Renderer.h"
+#include "Frustum.h"
+
+/*
+ Frustum culling and draw compaction on the GPU, for the backends of
+ Renderer::setGpuCulling. The backend describes each renderable it can
+ draw indirectly with a Record, the records of a bucket (one multi draw)
+ next to each other, and cull() runs one CullShader thread per record:
+ when the box of the record, moved by its translation, is inside the
+ frustum, the thread appends the draw to the commands of its bucket and
+ counts it.
+
+	culler.initialize(renderer);                  // false without compute
+	culler.setRecords(records, bucketCount);      // after the renderables change
+	culler.cull(frustum);                         // every frame, before the draws
+	// bucket b: at most n commands from commandBase * COMMAND_SIZE in
+	// getCommands(), how many at b * sizeof(uint32_t) in getCounts().
+
+ A command is { vertexCount, instanceCount, firstVertex, firstInstance },
+ the layout glMultiDrawArraysIndirectCountARB and vkCmdDrawIndirectCountKHR
+ both read. The counts are zeroed from the CPU before every dispatch.
+*/
+class GpuCuller
+{
+public:
+	static const size_t COMMAND_SIZE = 4 * sizeof(uint32_t);
+
+	// std430, as CullShader reads it.
+	struct Record {
+		// Mesh::bounds, and the vertices of the draw.
+		float boundsMin[3];
+		uint32_t vertexCount;
+		float boundsMax[3];
+		uint32_t firstVertex;
+		// float4 index in the translation buffer, and the first instance of the draw.
+		uint32_t translation;
+		uint32_t bucket;
+		// first command of the bucket.
+		uint32_t commandBase;
+		uint32_t pad;
+	};
+
+	~GpuCuller();
+	bool initialize(Renderer* renderer);
+	void shutdown();
+
+	void setRecords(const std::vector<Record>& records, uint32_t buckets);
+	// adds a dispatch, the renderer orders it before the draws.
+	void cull(const Frustum& frustum);
+
+	VertexBuffer* getCommands() const { return renderer->get(commands); };
+	VertexBuffer* getCounts() const { return renderer->get(counts); };
+private:
+	// grows buffer to size bytes and binds it at slot.
+	void reserve(VertexBufferHandle& buffer, size_t& capacity, size_t size, uint32_t slot);
+
+	Renderer* renderer = nullptr;
+	MaterialHandle material;
+	ComputeTechniqueHandle techniqueHandle;
+	ComputeTechnique* technique = nullptr;
+	VertexBufferHandle records, commands, counts;
+	size_t recordCapacity = 0, commandCapacity = 0, countCapacity = 0;
+	uint32_t recordCount = 0;
+	std::vector<uint32_t> zeros;
+};
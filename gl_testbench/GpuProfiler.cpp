@@ -0,0 +1,146 @@
+#include <algorithm>
+#include "GpuProfiler.h"
+
+const uint32_t GpuProfiler::LATENCY;
+const uint32_t GpuProfiler::MAX_MARKS;
+const uint32_t GpuProfiler::WINDOW;
+const uint32_t GpuProfiler::NO_QUERY;
+
+GpuProfiler::GpuProfiler()
+{
+	scope("frame");
+	overflowScope = scope("overflow");
+	for (uint32_t i = 0; i < LATENCY; i++)
+		markScopes[i].resize(MAX_MARKS, NO_QUERY);
+}
+
+uint32_t GpuProfiler::scope(const std::string& name)
+{
+	auto found = scopeIds.find(name);
+	if (found != scopeIds.end())
+		return found->second;
+	uint32_t id = (uint32_t)scopes.size();
+	scopes.push_back(Scope());
+	scopes.back().name = name;
+	scopeIds[name] = id;
+	return id;
+}
+
+uint32_t GpuProfiler::techniqueScope(const Technique* technique)
+{
+	auto found = techniqueIds.find(technique);
+	if (found != techniqueIds.end())
+		return found->second;
+	uint32_t id = scope("technique " + std::to_string(techniqueIds.size()));
+	techniqueIds[technique] = id;
+	return id;
+}
+
+std::vector<GpuProfiler::ScopeStats> GpuProfiler::getStats() const
+{
+	std::vector<ScopeStats> stats;
+	for (auto& s : scopes)
+	{
+		if (s.samples == 0)
+			continue;
+		ScopeStats st;
+		st.name = s.name;
+		st.samples = s.samples;
+		st.meanMs = s.totalMs / s.samples;
+		st.lastMs = s.lastMs;
+		st.minMs = *std::min_element(s.history.begin(), s.history.end());
+		st.maxMs = *std::max_element(s.history.begin(), s.history.end());
+		double sum = 0.0;
+		for (double ms : s.history)
+			sum += ms;
+		st.avgMs = sum / s.history.size();
+		stats.push_back(st);
+	}
+	return stats;
+}
+
+void GpuProfiler::resetStats()
+{
+	for (auto& s : scopes)
+	{
+		s.history.clear();
+		s.samples = 0;
+		s.totalMs = 0.0;
+		s.lastMs = 0.0;
+	}
+	resolvedFrames = 0;
+	dropped = 0;
+}
+
+void GpuProfiler::beginMarks(uint64_t frame)
+{
+	this->frame = frame;
+	used = 0;
+	markCount[currentSlot()] = 0;
+}
+
+uint32_t GpuProfiler::nextMark(uint32_t scope)
+{
+	const uint32_t slot = currentSlot();
+	// the last query of the slot is kept for endMark.
+	if (used + 1 >= MAX_MARKS)
+	{
+		if (used > 0)
+			markScopes[slot][used - 1] = overflowScope;
+		return NO_QUERY;
+	}
+	markScopes[slot][used] = scope;
+	markCount[slot] = ++used;
+	return slot * MAX_MARKS + used - 1;
+}
+
+uint32_t GpuProfiler::endMark()
+{
+	const uint32_t slot = currentSlot();
+	markScopes[slot][used] = NO_QUERY;
+	markCount[slot] = ++used;
+	return slot * MAX_MARKS + used - 1;
+}
+
+void GpuProfiler::resolve(uint32_t slot, const uint64_t* ticks, double nsPerTick)
+{
+	const uint32_t count = markCount[slot];
+	markCount[slot] = 0;
+	if (count < 2)
+		return;
+
+	frameMs.assign(scopes.size(), -1.0);
+	auto interval = [&](uint32_t from, uint32_t to) {
+		return ticks[to] > ticks[from] ? (ticks[to] - ticks[from]) * nsPerTick / 1000000.0 : 0.0;
+	};
+	for (uint32_t i = 0; i + 1 < count; i++)
+	{
+		const uint32_t s = markScopes[slot][i];
+		if (s == NO_QUERY)
+			continue;
+		frameMs[s] = std::max(frameMs[s], 0.0) + interval(i, i + 1);
+	}
+	frameMs[0] = interval(0, count - 1);
+
+	for (size_t s = 0; s < frameMs.size(); s++)
+	{
+		if (frameMs[s] < 0.0)
+			continue;
+		Scope& sc = scopes[s];
+		if (sc.history.size() < WINDOW)
+			sc.history.push_back(frameMs[s]);
+		else
+			sc.history[sc.samples % WINDOW] = frameMs[s];
+		sc.samples++;
+		sc.totalMs += frameMs[s];
+		sc.lastMs = frameMs[s];
+	}
+	resolvedFrames++;
+}
+
+void GpuProfiler::drop(uint32_t slot)
+{
+	if (markCount[slot] > 0)
+		dropped++;
+	markCount[slot] = 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Technique;
+
+/*
+ GPU timing through timestamp queries, shared part of the GL and Vulkan
+ profilers.
+
+ A frame is a sequence of marks (timestamps). Each mark names the scope of
+ the interval that starts at it, the last mark of a frame only closes the
+ previous interval. Scope 0 ("frame") is the time from the first to the
+ last mark. When a scope appears several times in a frame (unsorted
+ submission) its intervals are added up.
+
+ Queries of a frame are read back LATENCY frames later without waiting, so
+ the CPU never stalls on the GPU; frames whose results are not ready by
+ then are dropped (see droppedFrames).
+*/
+class GpuProfiler
+{
+public:
+	// frames between recording a frame's queries and reading them back.
+	static const uint32_t LATENCY = 3;
+	// timestamps per frame, later marks fall into the "overflow" scope.
+	static const uint32_t MAX_MARKS = 128;
+	// frames kept for the rolling statistics.
+	static const uint32_t WINDOW = 120;
+	static const uint32_t NO_QUERY = 0xffffffff;
+
+	struct ScopeStats {
+		std::string name;
+		// frames this scope was measured in, since the last resetStats().
+		uint64_t samples;
+		// mean over all samples since resetStats().
+		double meanMs;
+		// over the last WINDOW samples.
+		double lastMs, avgMs, minMs, maxMs;
+	};
+
+	GpuProfiler();
+	virtual ~GpuProfiler() {};
+
+	// id of a named scope (render pass, upload, ...), created on first use.
+	uint32_t scope(const std::string& name);
+	// one scope per technique, "technique N" in order of first use.
+	uint32_t techniqueScope(const Technique* technique);
+
+	std::vector<ScopeStats> getStats() const;
+	void resetStats();
+	uint64_t measuredFrames() const { return resolvedFrames; };
+	uint64_t droppedFrames() const { return dropped; };
+protected:
+	// starts recording frame "frame" into slot frame % LATENCY.
+	void beginMarks(uint64_t frame);
+	// query index for the next mark of the current slot, NO_QUERY if full.
+	uint32_t nextMark(uint32_t scope);
+	// query index for the closing mark, always available.
+	uint32_t endMark();
+
+	uint32_t currentSlot() const { return (uint32_t)(frame % LATENCY); };
+	// marks recorded in slot, 0 if nothing is pending there.
+	uint32_t pendingMarks(uint32_t slot) const { return markCount[slot]; };
+	// ticks of the pending marks of slot, in query order.
+	void resolve(uint32_t slot, const uint64_t* ticks, double nsPerTick);
+	void drop(uint32_t slot);
+private:
+	struct Scope {
+		std::string name;
+		std::vector<double> history;
+		uint64_t samples = 0;
+		double totalMs = 0.0;
+		double lastMs = 0.0;
+	};
+	std::vector<Scope> scopes;
+	std::unordered_map<std::string, uint32_t> scopeIds;
+	std::unordered_map<const Technique*, uint32_t> techniqueIds;
+	uint32_t overflowScope;
+
+	uint64_t frame = 0;
+	uint32_t used = 0;
+	std::vector<uint32_t> markScopes[LATENCY];
+	uint32_t markCount[LATENCY] = {};
+	// per scope ms of the frame being resolved, reused.
+	std::vector<double> frameMs;
+
+	uint64_t resolvedFrames = 0;
+	uint64_t dropped = 0;
+};
@@ -0,0 +1,191 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+ 32 bit reference to an object of a HandlePool<T>: the slot index and the
+ generation of the slot when the object was created. 0 is no object.
+*/
+template <typename T>
+struct Handle
+{
+	static const uint32_t INDEX_BITS = 22;
+	static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+	static const uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+	uint32_t id = 0;
+
+	uint32_t index() const { return id & INDEX_MASK; };
+	uint32_t generation() const { return id >> INDEX_BITS; };
+	explicit operator bool() const { return id != 0; };
+	bool operator==(const Handle& h) const { return id == h.id; };
+	bool operator!=(const Handle& h) const { return id != h.id; };
+};
+
+/*
+ Objects of one interface T (Mesh, VertexBuffer...) constructed in place,
+ CHUNK slots per allocation, so the objects of a backend sit next to each
+ other and cost no heap block each. The first create<Concrete>() fixes the
+ slot size, a pool holds a single concrete type.
+
+	Handle<Mesh> h = meshes.create<MeshGL>();
+	Mesh* m = meshes.get(h);
+	meshes.destroy(h);
+	meshes.get(h); // nullptr, the slot generation moved on
+
+ Freed slots are reused (last freed first) with the next generation, a
+ stale handle never reaches the new object. Objects do not move, pointers
+ from get() stay valid until destroy().
+
+ create and destroy lock, get does not: handles can be kept and resolved
+ on any thread and in later frames. Destroying an object while another
+ thread uses it is still the caller's problem.
+*/
+template <typename T>
+class HandlePool
+{
+public:
+	static const uint32_t CHUNK = 1024;
+	static const uint32_t MAX_CHUNKS = (Handle<T>::INDEX_MASK + 1) / CHUNK;
+
+	HandlePool() : objects(MAX_CHUNKS, nullptr), generations(MAX_CHUNKS, nullptr) {};
+	~HandlePool()
+	{
+		for (uint32_t c = 0; c < chunkCount; c++)
+		{
+			for (uint32_t s = 0; s < CHUNK; s++)
+				if (generations[c][s].load(std::memory_order_relaxed) & ALIVE)
+					slot(c * CHUNK + s)->~T();
+			::operator delete(objects[c]);
+			delete[] generations[c];
+		}
+	};
+	HandlePool(const HandlePool&) = delete;
+	HandlePool& operator=(const HandlePool&) = delete;
+
+	template <typename Concrete, typename... Args>
+	Handle<T> create(Args&&... args)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (stride == 0)
+			stride = (sizeof(Concrete) + alignof(Concrete) - 1) / alignof(Concrete) * alignof(Concrete);
+		if (stride < sizeof(Concrete) || alignof(Concrete) > alignof(std::max_align_t))
+		{
+			fprintf(stderr, "HandlePool: slots of %zu bytes cannot hold a %zu byte object\n", stride, sizeof(Concrete));
+			exit(-1);
+		}
+		uint32_t index;
+		if (!freeSlots.empty())
+		{
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			if (used == chunkCount * CHUNK)
+				grow();
+			index = used++;
+		}
+		char* at = objects[index / CHUNK] + (size_t)(index % CHUNK) * stride;
+		T* object = static_cast<T*>(new (at) Concrete(std::forward<Args>(args)...));
+		offset = (char*)object - at;
+		std::atomic<uint32_t>& g = generations[index / CHUNK][index % CHUNK];
+		const uint32_t generation = g.load(std::memory_order_relaxed);
+		g.store(generation | ALIVE, std::memory_order_release);
+		live++;
+		Handle<T> h;
+		h.id = (generation << Handle<T>::INDEX_BITS) | index;
+		return h;
+	};
+
+	// nullptr for stale or empty handles.
+	T* get(Handle<T> h) const
+	{
+		const uint32_t chunk = h.index() / CHUNK;
+		if (!h || chunk >= chunkCount.load(std::memory_order_acquire))
+			return nullptr;
+		if (generations[chunk][h.index() % CHUNK].load(std::memory_order_acquire) != (h.generation() | ALIVE))
+			return nullptr;
+		return slot(h.index());
+	};
+
+	bool valid(Handle<T> h) const { return get(h) != nullptr; };
+
+	// runs the destructor, stale handles are ignored.
+	void destroy(Handle<T> h)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		T* object = get(h);
+		if (object == nullptr)
+			return;
+		object->~T();
+		// skip generation 0, so no live object has the handle 0.
+		uint32_t next = (h.generation() + 1) & Handle<T>::GENERATION_MASK;
+		if (next == 0)
+			next = 1;
+		generations[h.index() / CHUNK][h.index() % CHUNK].store(next, std::memory_order_release);
+		freeSlots.push_back(h.index());
+		live--;
+	};
+
+	size_t size() const { return live; };
+
+	// fn(T*) for every live object, in slot order.
+	template <typename F>
+	void forEach(F fn)
+	{
+		for (uint32_t i = 0; i < used; i++)
+			if (generations[i / CHUNK][i % CHUNK].load(std::memory_order_relaxed) & ALIVE)
+				fn(slot(i));
+	};
+private:
+	static const uint32_t ALIVE = 0x80000000;
+
+	T* slot(uint32_t index) const
+	{
+		return (T*)(objects[index / CHUNK] + (size_t)(index % CHUNK) * stride + offset);
+	};
+
+	void grow()
+	{
+		if (chunkCount == MAX_CHUNKS)
+		{
+			fprintf(stderr, "HandlePool: more than %u objects\n", MAX_CHUNKS * CHUNK);
+			exit(-1);
+		}
+		const uint32_t c = chunkCount;
+		objects[c] = (char*)::operator new((size_t)CHUNK * stride);
+		generations[c] = new std::atomic<uint32_t>[CHUNK];
+		// new slots start at generation 1.
+		for (uint32_t s = 0; s < CHUNK; s++)
+			generations[c][s].store(1, std::memory_order_relaxed);
+		chunkCount.store(c + 1, std::memory_order_release);
+	};
+
+	// sized to MAX_CHUNKS up front, get() reads them without the lock.
+	std::vector<char*> objects;
+	std::vector<std::atomic<uint32_t>*> generations;
+	std::atomic<uint32_t> chunkCount{ 0 };
+	// slots handed out so far, and the ones freed since.
+	uint32_t used = 0;
+	std::vector<uint32_t> freeSlots;
+	size_t stride = 0;
+	// of T inside the concrete object.
+	ptrdiff_t offset = 0;
+	size_t live = 0;
+	std::mutex mutex;
+};
+
+template <typename T> const uint32_t Handle<T>::INDEX_BITS;
+template <typename T> const uint32_t Handle<T>::INDEX_MASK;
+template <typename T> const uint32_t Handle<T>::GENERATION_MASK;
+template <typename T> const uint32_t HandlePool<T>::CHUNK;
+template <typename T> const uint32_t HandlePool<T>::MAX_CHUNKS;
+template <typename T> const uint32_t HandlePool<T>::ALIVE;
@@ -9,4 +9,17 @@
 #define DIFFUSE_TINT 6
 #define DIFFUSE_TINT_NAME "DiffuseColor"
 
-#define DIFFUSE_SLOT 7
\ No newline at end of file
+#define DIFFUSE_SLOT 7
+
+// the compute pass of TestbenchConfig::gpuAnimation: its constants and the curve it reads.
+#define ANIMATION 9
+#define ANIMATION_NAME "AnimationBlock"
+#define PLACES 10
+
+// the culling pass of Renderer::setGpuCulling (GpuCuller): its constants, and
+// the records it tests, the indirect commands it writes and the count of each bucket.
+#define CULL 11
+#define CULL_NAME "CullBlock"
+#define CULL_RECORDS 12
+#define CULL_COMMANDS 13
+#define CULL_COUNTS 14
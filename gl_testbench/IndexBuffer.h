@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+/*
+ Triangle list indices of a Mesh, see Mesh::setIndexBuffer. An index
+ counts from the first vertex of every stream binding of the mesh, so the
+ same indices work for all its streams.
+
+	IndexBufferHandle ib = renderer->createIndexBuffer(3 * sizeof(uint16_t), IndexBuffer::FORMAT::UINT16);
+	renderer->get(ib)->setData(indices, 3 * sizeof(uint16_t), 0);
+	mesh->setIndexBuffer(renderer->get(ib), 0, 3);
+
+ The indices are copied by setData, the buffer can not be read back.
+*/
+class IndexBuffer
+{
+public:
+	enum class FORMAT { UINT16, UINT32 };
+
+	IndexBuffer(FORMAT format) : format(format) {};
+	virtual ~IndexBuffer() {}
+	virtual void setData(const void* data, size_t size, size_t offset) = 0;
+	virtual size_t getSize() = 0;
+
+	FORMAT getFormat() const { return format; };
+	size_t getIndexSize() const { return format == FORMAT::UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); };
+
+	void incRef() { refs.fetch_add(1, std::memory_order_relaxed); };
+	void decRef()
+	{
+		unsigned int r = refs.load(std::memory_order_relaxed);
+		while (r > 0 && !refs.compare_exchange_weak(r, r - 1, std::memory_order_relaxed))
+			;
+	};
+	inline unsigned int refCount() { return refs.load(std::memory_order_relaxed); };
+private:
+	FORMAT format;
+	std::atomic<unsigned int> refs{ 0 };
+};
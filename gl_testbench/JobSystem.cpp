@@ -0,0 +1,138 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+static thread_local unsigned int currentThread = 0;
+
+JobSystem::JobSystem(unsigned int workerCount)
+{
+	if (workerCount == 0)
+	{
+		unsigned int hw = std::thread::hardware_concurrency();
+		workerCount = hw > 1 ? hw - 1 : 1;
+	}
+	remaining = 0;
+	for (unsigned int i = 0; i <= workerCount; i++)
+		queues.push_back(new Queue());
+	for (unsigned int i = 1; i <= workerCount; i++)
+		workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(wakeLock);
+		quit = true;
+	}
+	wake.notify_all();
+	for (auto& t : workers)
+		t.join();
+	for (auto q : queues)
+		delete q;
+}
+
+unsigned int JobSystem::threadIndex()
+{
+	return currentThread;
+}
+
+JobSystem& JobSystem::shared()
+{
+	// never deleted: joining workers during static destruction is not safe everywhere.
+	static JobSystem* pool = new JobSystem();
+	return *pool;
+}
+
+void JobSystem::parallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+	if (count == 0)
+		return;
+	if (workers.empty() || count == 1)
+	{
+		for (size_t i = 0; i < count; i++)
+			fn(i);
+		return;
+	}
+
+	std::lock_guard<std::mutex> serial(dispatchLock);
+	// set before the items are queued, a worker only reads it after a successful pop.
+	job = &fn;
+	remaining = count;
+	const size_t queueCount = queues.size();
+	for (size_t q = 0; q < queueCount; q++)
+	{
+		std::lock_guard<std::mutex> lock(queues[q]->lock);
+		for (size_t i = q; i < count; i += queueCount)
+			queues[q]->items.push_back(i);
+	}
+	{
+		std::lock_guard<std::mutex> lock(wakeLock);
+		generation++;
+	}
+	wake.notify_all();
+
+	work(0);
+
+	std::unique_lock<std::mutex> lock(doneLock);
+	done.wait(lock, [this] { return remaining.load() == 0; });
+	job = nullptr;
+}
+
+void JobSystem::workerLoop(unsigned int index)
+{
+	currentThread = index;
+	PROFILE_THREAD("worker");
+	unsigned long long seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(wakeLock);
+			wake.wait(lock, [&] { return quit || generation != seen; });
+			if (quit)
+				return;
+			seen = generation;
+		}
+		work(index);
+	}
+}
+
+void JobSystem::work(unsigned int index)
+{
+	size_t item;
+	while (pop(index, item) || steal(index, item))
+	{
+		(*job)(item);
+		if (--remaining == 0)
+		{
+			std::lock_guard<std::mutex> lock(doneLock);
+			done.notify_all();
+		}
+	}
+}
+
+bool JobSystem::pop(unsigned int index, size_t& item)
+{
+	Queue* q = queues[index];
+	std::lock_guard<std::mutex> lock(q->lock);
+	if (q->items.empty())
+		return false;
+	item = q->items.back();
+	q->items.pop_back();
+	return true;
+}
+
+bool JobSystem::steal(unsigned int index, size_t& item)
+{
+	const unsigned int count = (unsigned int)queues.size();
+	for (unsigned int i = 1; i < count; i++)
+	{
+		Queue* q = queues[(index + i) % count];
+		std::lock_guard<std::mutex> lock(q->lock);
+		if (!q->items.empty())
+		{
+			item = q->items.front();
+			q->items.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ Small work-stealing thread pool. parallelFor spreads the indices over one
+ queue per thread; every thread pops from the back of its own queue and,
+ once that is empty, steals from the front of the others. The calling
+ thread takes part in the work and parallelFor returns when every index
+ has been run.
+
+ Jobs must not call parallelFor themselves.
+*/
+class JobSystem
+{
+public:
+	// workers == 0 picks one worker per hardware thread, minus the caller.
+	JobSystem(unsigned int workers = 0);
+	~JobSystem();
+
+	void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+	// worker threads + the calling thread.
+	unsigned int threadCount() const { return (unsigned int)queues.size(); };
+	// 0 on the thread calling parallelFor, 1..N on the workers.
+	static unsigned int threadIndex();
+	// pool for the batch kernels outside the backends (TransformBatch,
+	// TransformHierarchy), created on first use and kept until exit.
+	static JobSystem& shared();
+private:
+	struct Queue {
+		std::mutex lock;
+		std::deque<size_t> items;
+	};
+
+	void workerLoop(unsigned int index);
+	void work(unsigned int index);
+	bool pop(unsigned int index, size_t& item);
+	bool steal(unsigned int index, size_t& item);
+
+	std::vector<Queue*> queues;
+	std::vector<std::thread> workers;
+
+	const std::function<void(size_t)>* job = nullptr;
+	std::atomic<size_t> remaining;
+
+	std::mutex dispatchLock;
+	std::mutex wakeLock;
+	std::condition_variable wake;
+	unsigned long long generation = 0;
+	bool quit = false;
+
+	std::mutex doneLock;
+	std::condition_variable done;
+};
@@ -6,3 +6,12 @@ Material& Material::addDefine(const std::string& defineText, ShaderType type)
 	shaderDefines[type].insert(defineText);
 	return *this;
 }
+
+Material& Material::setVertexLayout(const VertexLayout& layout)
+{
+	// the defines of the layout it replaces, none for the default (the shaders fall back to it).
+	shaderDefines[ShaderType::VS].erase(vertexLayout.getDefines());
+	vertexLayout = layout;
+	shaderDefines[ShaderType::VS].insert(layout.getDefines());
+	return *this;
+}
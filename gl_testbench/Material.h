@@ -3,14 +3,15 @@
 #include <string>
 #include <set>
 #include <map>
+#include "VertexLayout.h"
 
 /* 
  * extend this class with a concrete implementation,
  * public interface should not change...
  * 
  * A material represents the programmable part of the pipeline:
- * Vertex, Geometry (wont be used), Fragment and Compute Shaders (wont be used)
- * Only need to support Vertex and Fragment for now.
+ * Vertex, Geometry (wont be used), Fragment and Compute Shaders
+ * Vertex and Fragment for draws, Compute alone for a ComputeTechnique.
  * Any extra functionality should be added to a concrete subclass
  */
 struct Color {
@@ -23,12 +24,20 @@ public:
 
 	enum class ShaderType { VS = 0, PS = 1, GS = 2, CS = 3 };
 
-	Material() : isValid(false) {};
+	Material() : isValid(false), vertexLayout(VertexLayout::split()) {};
 	virtual ~Material() {};
 
 	// all defines should be included in the shader before COMPILATION.
 	Material& addDefine(const std::string& defineText, ShaderType type);
 
+	/*
+	 * how the meshes drawn with the material store their vertices, before
+	 * COMPILATION (it adds its defines to the VS) and before the technique
+	 * is created. VertexLayout::split() until set.
+	*/
+	Material& setVertexLayout(const VertexLayout& layout);
+	const VertexLayout& getVertexLayout() const { return vertexLayout; };
+
 	// set shader name, DOES NOT COMPILE
 	virtual void setShader(const std::string& shaderFileName, ShaderType type) = 0;
 
@@ -42,7 +51,8 @@ public:
 	 * Returns 0  if compilation/linking succeeded.
 	 * Returns -1 if compilation/linking fails.
 	 * Error is returned in errString
-	 * A Vertex and a Fragment shader MUST be defined.
+	 * A Vertex and a Fragment shader MUST be defined, or a Compute shader
+ * and nothing else.
 	 * If compileMaterial is called again, it should RE-COMPILE the shader
 	 * In principle, it should only be necessary to re-compile if the defines set 
 	 * has changed.
@@ -66,5 +76,7 @@ public:
 
 	std::map<ShaderType, std::string> shaderFileNames;
 	std::map<ShaderType, std::set<std::string>> shaderDefines;
+protected:
+	VertexLayout vertexLayout;
 };
 
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <map>
+#include "MemoryTracker.h"
+
+const uint32_t MemoryTracker::DRIVER_MEMORY;
+const uint32_t MemoryTracker::SYSTEM_MEMORY;
+const uint32_t MemoryTracker::MEMORY_TYPES;
+const uint32_t MemoryTracker::NO_HEAP;
+
+namespace {
+	typedef MemoryTracker::CATEGORY CATEGORY;
+	const size_t CATEGORIES = (size_t)CATEGORY::COUNT;
+
+	struct Allocation {
+		uint32_t memoryType;
+		uint64_t bytes, requested;
+	};
+
+	struct Budget {
+		uint64_t bytes = 0;
+		MemoryTracker::BudgetCallback callback;
+		bool over = false;
+	};
+
+	std::map<std::pair<CATEGORY, uint64_t>, Allocation> live;
+	MemoryTracker::Usage categories[CATEGORIES];
+	MemoryTracker::Usage types[MemoryTracker::MEMORY_TYPES];
+	MemoryTracker::Usage all;
+
+	uint32_t typeHeaps[MemoryTracker::MEMORY_TYPES];
+	std::string typeNames[MemoryTracker::MEMORY_TYPES];
+	std::vector<MemoryTracker::Heap> heapList;
+
+	// one per category, the last one for the total.
+	Budget budgets[CATEGORIES + 1];
+	double heapFraction = 0.0;
+	MemoryTracker::BudgetCallback heapCallback;
+	std::vector<bool> heapOver;
+
+	bool initialized = false;
+
+	void initialize()
+	{
+		if (initialized)
+			return;
+		for (uint32_t t = 0; t < MemoryTracker::MEMORY_TYPES; t++)
+		{
+			typeHeaps[t] = MemoryTracker::NO_HEAP;
+			typeNames[t] = "type " + std::to_string(t);
+		}
+		typeNames[MemoryTracker::DRIVER_MEMORY] = "driver";
+		typeNames[MemoryTracker::SYSTEM_MEMORY] = "system";
+		initialized = true;
+	}
+
+	void add(MemoryTracker::Usage& u, const Allocation& a)
+	{
+		u.liveBytes += a.bytes;
+		u.requestedBytes += a.requested;
+		u.liveCount++;
+		u.allocations++;
+		u.peakBytes = std::max(u.peakBytes, u.liveBytes);
+		u.peakCount = std::max(u.peakCount, u.liveCount);
+	}
+
+	void remove(MemoryTracker::Usage& u, const Allocation& a)
+	{
+		u.liveBytes -= a.bytes;
+		u.requestedBytes -= a.requested;
+		u.liveCount--;
+	}
+
+	// the callback runs on the way over, the budget re-arms once below.
+	void check(Budget& b, CATEGORY category, uint64_t bytes)
+	{
+		if (b.bytes == 0)
+			return;
+		if (bytes <= b.bytes)
+		{
+			b.over = false;
+			return;
+		}
+		if (b.over)
+			return;
+		b.over = true;
+		if (b.callback)
+		{
+			MemoryTracker::BudgetEvent e = { category, MemoryTracker::NO_HEAP, bytes, b.bytes };
+			b.callback(e);
+		}
+	}
+
+	void checkHeap(uint32_t heap)
+	{
+		if (heapFraction <= 0.0 || heap >= heapList.size())
+			return;
+		const MemoryTracker::Heap& h = heapList[heap];
+		// the driver's usage lags behind allocations made since the last update.
+		uint64_t bytes = std::max(h.usage, MemoryTracker::heapBytes(heap));
+		uint64_t limit = (uint64_t)((h.budget ? h.budget : h.size) * heapFraction);
+		if (bytes <= limit)
+		{
+			heapOver[heap] = false;
+			return;
+		}
+		if (heapOver[heap])
+			return;
+		heapOver[heap] = true;
+		if (heapCallback)
+		{
+			MemoryTracker::BudgetEvent e = { CATEGORY::COUNT, heap, bytes, limit };
+			heapCallback(e);
+		}
+	}
+
+	void checkBudgets(CATEGORY category, uint32_t memoryType)
+	{
+		check(budgets[(size_t)category], category, categories[(size_t)category].liveBytes);
+		check(budgets[CATEGORIES], CATEGORY::COUNT, all.liveBytes);
+		checkHeap(typeHeaps[memoryType]);
+	}
+}
+
+void MemoryTracker::allocate(CATEGORY category, uint64_t handle, uint32_t memoryType, uint64_t bytes, uint64_t requested)
+{
+	initialize();
+	auto key = std::make_pair(category, handle);
+	if (live.find(key) != live.end())
+		release(category, handle);
+	Allocation a;
+	a.memoryType = memoryType < MEMORY_TYPES ? memoryType : SYSTEM_MEMORY;
+	a.bytes = bytes;
+	a.requested = requested ? std::min(requested, bytes) : bytes;
+	live[key] = a;
+	add(categories[(size_t)category], a);
+	add(types[a.memoryType], a);
+	add(all, a);
+	checkBudgets(category, a.memoryType);
+}
+
+void MemoryTracker::release(CATEGORY category, uint64_t handle)
+{
+	auto found = live.find(std::make_pair(category, handle));
+	if (found == live.end())
+		return;
+	Allocation a = found->second;
+	live.erase(found);
+	remove(categories[(size_t)category], a);
+	remove(types[a.memoryType], a);
+	remove(all, a);
+	checkBudgets(category, a.memoryType);
+}
+
+MemoryTracker::Usage MemoryTracker::usage(CATEGORY category)
+{
+	return categories[(size_t)category];
+}
+
+MemoryTracker::Usage MemoryTracker::typeUsage(uint32_t memoryType)
+{
+	return memoryType < MEMORY_TYPES ? types[memoryType] : Usage();
+}
+
+MemoryTracker::Usage MemoryTracker::total()
+{
+	return all;
+}
+
+void MemoryTracker::setMemoryType(uint32_t memoryType, uint32_t heap, const std::string& name)
+{
+	initialize();
+	if (memoryType >= DRIVER_MEMORY)
+		return;
+	typeHeaps[memoryType] = heap;
+	typeNames[memoryType] = name;
+}
+
+void MemoryTracker::setHeaps(const std::vector<Heap>& heaps)
+{
+	heapList = heaps;
+	heapOver.resize(heapList.size(), false);
+	for (uint32_t h = 0; h < heapList.size(); h++)
+		checkHeap(h);
+}
+
+std::vector<MemoryTracker::Heap> MemoryTracker::heaps()
+{
+	return heapList;
+}
+
+uint64_t MemoryTracker::heapBytes(uint32_t heap)
+{
+	uint64_t bytes = 0;
+	for (uint32_t t = 0; t < DRIVER_MEMORY; t++)
+		if (typeHeaps[t] == heap)
+			bytes += types[t].liveBytes;
+	return bytes;
+}
+
+void MemoryTracker::setBudget(CATEGORY category, uint64_t bytes, BudgetCallback callback)
+{
+	Budget& b = budgets[(size_t)category];
+	b.bytes = bytes;
+	b.callback = callback;
+	b.over = false;
+	check(b, category, category == CATEGORY::COUNT ? all.liveBytes : categories[(size_t)category].liveBytes);
+}
+
+void MemoryTracker::setHeapBudget(double fraction, BudgetCallback callback)
+{
+	heapFraction = fraction;
+	heapCallback = callback;
+	heapOver.assign(heapList.size(), false);
+	for (uint32_t h = 0; h < heapList.size(); h++)
+		checkHeap(h);
+}
+
+const char* MemoryTracker::categoryName(CATEGORY category)
+{
+	switch (category)
+	{
+	case CATEGORY::VERTEX: return "vertex";
+	case CATEGORY::CONSTANT: return "constant";
+	case CATEGORY::TEXTURE: return "texture";
+	case CATEGORY::STAGING: return "staging";
+	case CATEGORY::RENDER_TARGET: return "render target";
+	case CATEGORY::PIPELINE: return "pipeline";
+	default: return "total";
+	}
+}
+
+static void writeUsage(FILE* out, const char* name, const MemoryTracker::Usage& u)
+{
+	fprintf(out, "%-24s %12.2f %12.2f %8u %8u %9.1f%%\n", name, u.liveBytes / 1048576.0, u.peakBytes / 1048576.0,
+		u.liveCount, u.peakCount, 100.0 * u.fragmentation());
+}
+
+void MemoryTracker::writeReport(FILE* out)
+{
+	initialize();
+	fprintf(out, "%-24s %12s %12s %8s %8s %10s\n", "category", "live MiB", "peak MiB", "live", "peak", "padding");
+	for (size_t c = 0; c < CATEGORIES; c++)
+		if (categories[c].allocations)
+			writeUsage(out, categoryName((CATEGORY)c), categories[c]);
+	writeUsage(out, "total", all);
+
+	fprintf(out, "\n%-24s %12s %12s %8s %8s %10s\n", "memory type", "live MiB", "peak MiB", "live", "peak", "padding");
+	for (uint32_t t = 0; t < MEMORY_TYPES; t++)
+		if (types[t].allocations)
+			writeUsage(out, typeNames[t].c_str(), types[t]);
+
+	if (heapList.empty())
+		return;
+	fprintf(out, "\n%-6s %12s %12s %12s %12s\n", "heap", "size MiB", "tracked MiB", "usage MiB", "budget MiB");
+	for (uint32_t h = 0; h < heapList.size(); h++)
+	{
+		const Heap& heap = heapList[h];
+		fprintf(out, "%-6u %12.2f %12.2f %12.2f %12.2f%s\n", h, heap.size / 1048576.0, heapBytes(h) / 1048576.0,
+			heap.usage / 1048576.0, heap.budget / 1048576.0, heap.deviceLocal ? "  device local" : "");
+	}
+}
+
+void MemoryTracker::reset()
+{
+	initialized = false;
+	initialize();
+	live.clear();
+	for (auto& u : categories)
+		u = Usage();
+	for (auto& u : types)
+		u = Usage();
+	all = Usage();
+	heapList.clear();
+	heapOver.clear();
+	for (auto& b : budgets)
+		b.over = false;
+}
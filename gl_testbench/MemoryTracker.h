@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ Accounting of the memory the backends allocate for resources. Every
+ allocation is tagged with a category and a memory type and identified by
+ its handle (VkDeviceMemory, GL name, pointer), release() with the same
+ category and handle undoes it.
+
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory,
+		allocInfo.memoryTypeIndex, memRequirements.size, size);
+
+ Memory types are the Vulkan memory type indices, GL allocations use
+ DRIVER_MEMORY (the driver decides where they live) and the CPU backends
+ SYSTEM_MEMORY. The Vulkan backend names its types and reports the device
+ heaps, with usage and budget from VK_EXT_memory_budget where the driver
+ has it (setHeaps).
+
+ Budgets are per category, for the total, or a fraction of each heap's
+ budget. Their callback runs when an allocation (or a heap update) crosses
+ the budget and again only after usage dropped below it, so it can evict
+ or downscale without being flooded.
+
+ Render thread only.
+*/
+class MemoryTracker
+{
+public:
+	enum class CATEGORY { VERTEX, CONSTANT, TEXTURE, STAGING, RENDER_TARGET, PIPELINE, COUNT };
+
+	// Vulkan allows 32 memory types, the two pseudo types follow them.
+	static const uint32_t DRIVER_MEMORY = 32;
+	static const uint32_t SYSTEM_MEMORY = 33;
+	static const uint32_t MEMORY_TYPES = 34;
+	static const uint32_t NO_HEAP = 0xffffffff;
+
+	struct Usage {
+		uint64_t liveBytes = 0, peakBytes = 0;
+		// what the resources asked for, the rest of liveBytes is alignment
+		// and size padding of the allocations.
+		uint64_t requestedBytes = 0;
+		uint32_t liveCount = 0, peakCount = 0;
+		uint64_t allocations = 0;
+		// share of liveBytes that is padding, 0 when nothing is live.
+		double fragmentation() const { return liveBytes ? 1.0 - (double)requestedBytes / liveBytes : 0.0; };
+	};
+
+	struct Heap {
+		uint64_t size = 0;
+		// bytes used by this process and the budget the driver grants it,
+		// 0 without VK_EXT_memory_budget.
+		uint64_t usage = 0, budget = 0;
+		bool deviceLocal = false;
+	};
+
+	struct BudgetEvent {
+		// COUNT for the total and for heap budgets.
+		CATEGORY category;
+		// heap index for heap budgets, NO_HEAP otherwise.
+		uint32_t heap;
+		uint64_t bytes, budget;
+	};
+	typedef std::function<void(const BudgetEvent&)> BudgetCallback;
+
+	// requested defaults to bytes.
+	static void allocate(CATEGORY category, uint64_t handle, uint32_t memoryType, uint64_t bytes, uint64_t requested = 0);
+	static void release(CATEGORY category, uint64_t handle);
+
+	static Usage usage(CATEGORY category);
+	static Usage typeUsage(uint32_t memoryType);
+	static Usage total();
+
+	static void setMemoryType(uint32_t memoryType, uint32_t heap, const std::string& name);
+	// heap list of the device, called by the backend at start and every frame.
+	static void setHeaps(const std::vector<Heap>& heaps);
+	static std::vector<Heap> heaps();
+	// live bytes per heap, from the tracked allocations.
+	static uint64_t heapBytes(uint32_t heap);
+
+	// COUNT sets the budget of the total, bytes 0 removes a budget.
+	static void setBudget(CATEGORY category, uint64_t bytes, BudgetCallback callback);
+	// fires when a heap's usage goes over fraction of its budget (of its size
+	// without VK_EXT_memory_budget).
+	static void setHeapBudget(double fraction, BudgetCallback callback);
+
+	static const char* categoryName(CATEGORY category);
+	static void writeReport(FILE* out);
+	// forgets allocations, types and heaps (a new renderer), keeps the budgets.
+	static void reset();
+};
@@ -20,6 +20,7 @@ void Mesh::addIAVertexBufferBinding(
 	// inputStream is unique (has to be!) for this Mesh
 	buffer->incRef();
 	geometryBuffers[inputStream] = { sizeElement, numElements, offset, buffer };
+	revision++;
 };
 
 void Mesh::bindIAVertexBuffer(unsigned int location)
@@ -34,6 +35,17 @@ void Mesh::addTexture(Texture2D* texture, unsigned int slot)
 {
 	// would override the slot if there is another pointer here.
 	textures[slot] = texture;
+	revision++;
+}
+
+void Mesh::setIndexBuffer(IndexBuffer* buffer, size_t offset, size_t count)
+{
+	if (buffer)
+		buffer->incRef();
+	if (indexBuffer.buffer)
+		indexBuffer.buffer->decRef();
+	indexBuffer = { offset, buffer ? count : 0, buffer };
+	revision++;
 }
 
 Mesh::~Mesh()
@@ -41,4 +53,16 @@ Mesh::~Mesh()
 	for (auto g : geometryBuffers) {
 		g.second.buffer->decRef();
 	}
+	if (indexBuffer.buffer)
+		indexBuffer.buffer->decRef();
+}
+
+void Mesh::setBounds(const void* positions, size_t count, size_t stride)
+{
+	bounds = Aabb();
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* p = (const float*)((const char*)positions + i * stride);
+		bounds.add(glm::vec3(p[0], p[1], p[2]));
+	}
 }
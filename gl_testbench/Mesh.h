@@ -2,16 +2,18 @@
 #include <unordered_map>
 #include "IA.h"
 #include "VertexBuffer.h"
+#include "IndexBuffer.h"
 #include "Technique.h"
 #include "Transform.h"
 #include "ConstantBuffer.h"
 #include "Texture2D.h"
+#include "Frustum.h"
 
 class Mesh
 {
 public:
 	Mesh();
-	~Mesh();
+	virtual ~Mesh();
 
 	// technique has: Material, RenderState, Attachments (color, depth, etc)
 	Technique* technique; 
@@ -38,6 +40,36 @@ public:
 
 	void bindIAVertexBuffer(unsigned int location);
 	std::unordered_map<unsigned int, VertexBufferBind> geometryBuffers;
+
+	struct IndexBufferBind {
+		size_t offset, count;
+		IndexBuffer* buffer;
+	};
+	/*
+	 draws count indices from offset bytes into buffer instead of the
+	 POSITION numElements vertices in order. nullptr draws the streams
+	 unindexed again. Indexed meshes are left out of the GPU culled draws.
+	*/
+	void setIndexBuffer(IndexBuffer* buffer, size_t offset, size_t count);
+	IndexBufferBind indexBuffer = { 0, 0, nullptr };
 	std::unordered_map<unsigned int, Texture2D*> textures;
 
+	/*
+	 box around the POSITION vertices, before the translation. The vertex
+	 buffers are not read back, setBounds takes the data written to the
+	 POSITION buffer: count positions (x, y, z floats) stride bytes apart.
+	*/
+	void setBounds(const void* positions, size_t count, size_t stride);
+	Aabb bounds;
+
+	/*
+	 Backends compile the mesh into a draw packet and keep it until the
+	 revision changes. addTexture and addIAVertexBufferBinding bump it, call
+	 changed() after assigning technique, txBuffer or the maps directly.
+	*/
+	void changed() { revision++; };
+	unsigned int getRevision() const { return revision; };
+private:
+	unsigned int revision = 0;
+
 };
@@ -0,0 +1,407 @@
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <array>
+#include "MeshOptimizer.h"
+
+const uint32_t MeshOptimizer::CACHE_SIZE;
+const uint32_t MeshOptimizer::UNUSED;
+
+namespace {
+	// the constants of Forsyth's article.
+	const float CACHE_DECAY_POWER = 1.5f;
+	const float LAST_TRIANGLE_SCORE = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+	// triangles left on a vertex past which the boost stays the same.
+	const uint32_t MAX_VALENCE = 32;
+
+	struct ScoreTables {
+		float cache[MeshOptimizer::CACHE_SIZE];
+		float valence[MAX_VALENCE + 1];
+		ScoreTables()
+		{
+			for (uint32_t p = 0; p < MeshOptimizer::CACHE_SIZE; p++)
+			{
+				// the vertices of the last triangle score lower, so its neighbours are not always next.
+				const float scaled = 1.0f - (p - 3.0f) / float(MeshOptimizer::CACHE_SIZE - 3);
+				cache[p] = p < 3 ? LAST_TRIANGLE_SCORE : powf(scaled, CACHE_DECAY_POWER);
+			}
+			valence[0] = 0.0f;
+			for (uint32_t v = 1; v <= MAX_VALENCE; v++)
+				valence[v] = VALENCE_BOOST_SCALE * powf((float)v, -VALENCE_BOOST_POWER);
+		}
+	};
+
+	// cachePosition -1 when the vertex is not in the cache, -1 (never picked) when no triangle is left.
+	float vertexScore(const ScoreTables& tables, int cachePosition, uint32_t liveTriangles)
+	{
+		if (liveTriangles == 0)
+			return -1.0f;
+		float score = cachePosition < 0 ? 0.0f : tables.cache[cachePosition];
+		return score + tables.valence[std::min(liveTriangles, MAX_VALENCE)];
+	}
+
+	/*
+	 FIFO cache with timestamps: a vertex is in the cache while fewer than
+	 cacheSize misses happened since it was loaded.
+	*/
+	struct FifoCache {
+		std::vector<uint32_t> loaded;
+		uint32_t time, size;
+		FifoCache(size_t vertexCount, uint32_t size) : loaded(vertexCount, 0), time(size + 1), size(size) {}
+		// true on a miss.
+		bool access(uint32_t v)
+		{
+			if (time - loaded[v] <= size)
+				return false;
+			loaded[v] = time++;
+			return true;
+		}
+		void flush() { time += size + 1; }
+	};
+
+	uint64_t hashVertex(uint32_t v, const MeshOptimizer::Stream* streams, size_t streamCount)
+	{
+		// FNV-1a, as CommandStream::hash.
+		uint64_t h = 14695981039346656037ull;
+		for (size_t s = 0; s < streamCount; s++)
+		{
+			const unsigned char* bytes = (const unsigned char*)streams[s].data + v * streams[s].stride;
+			for (size_t b = 0; b < streams[s].size; b++)
+				h = (h ^ bytes[b]) * 1099511628211ull;
+		}
+		return h;
+	}
+
+	bool equalVertices(uint32_t a, uint32_t b, const MeshOptimizer::Stream* streams, size_t streamCount)
+	{
+		for (size_t s = 0; s < streamCount; s++)
+		{
+			const unsigned char* data = (const unsigned char*)streams[s].data;
+			if (memcmp(data + a * streams[s].stride, data + b * streams[s].stride, streams[s].size) != 0)
+				return false;
+		}
+		return true;
+	}
+}
+
+size_t MeshOptimizer::generateVertexRemap(std::vector<uint32_t>& remap, const uint32_t* indices, size_t indexCount,
+	size_t vertexCount, const Stream* streams, size_t streamCount)
+{
+	remap.assign(vertexCount, UNUSED);
+	// open addressing on the first vertex of each kind, at most half full.
+	size_t tableSize = 16;
+	while (tableSize < vertexCount * 2)
+		tableSize *= 2;
+	std::vector<uint32_t> table(tableSize, UNUSED);
+	const size_t mask = tableSize - 1;
+
+	uint32_t next = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		const uint32_t v = indices ? indices[i] : (uint32_t)i;
+		assert(v < vertexCount);
+		if (remap[v] != UNUSED)
+			continue;
+		size_t slot = (size_t)hashVertex(v, streams, streamCount) & mask;
+		while (table[slot] != UNUSED && !equalVertices(table[slot], v, streams, streamCount))
+			slot = (slot + 1) & mask;
+		if (table[slot] == UNUSED)
+		{
+			table[slot] = v;
+			remap[v] = next++;
+		}
+		else
+			remap[v] = remap[table[slot]];
+	}
+	return next;
+}
+
+void MeshOptimizer::remapIndices(uint32_t* dest, const uint32_t* indices, size_t indexCount, const uint32_t* remap)
+{
+	for (size_t i = 0; i < indexCount; i++)
+		dest[i] = remap[indices ? indices[i] : (uint32_t)i];
+}
+
+void MeshOptimizer::remapVertices(void* dest, const void* vertices, size_t vertexCount, size_t vertexSize, const uint32_t* remap)
+{
+	for (size_t v = 0; v < vertexCount; v++)
+		if (remap[v] != UNUSED)
+			memcpy((char*)dest + remap[v] * vertexSize, (const char*)vertices + v * vertexSize, vertexSize);
+}
+
+void MeshOptimizer::optimizeVertexCache(uint32_t* dest, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	static const ScoreTables tables;
+	const size_t triangleCount = indexCount / 3;
+	// dest may be indices.
+	std::vector<uint32_t> input(indices, indices + triangleCount * 3);
+
+	// the triangles of each vertex not emitted yet, the first live[v] of its range.
+	std::vector<uint32_t> live(vertexCount, 0);
+	for (uint32_t v : input)
+		live[v]++;
+	std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + live[v];
+	std::vector<uint32_t> adjacency(input.size());
+	{
+		std::vector<uint32_t> filled(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t i = 0; i < input.size(); i++)
+			adjacency[filled[input[i]]++] = (uint32_t)(i / 3);
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		vertexScores[v] = vertexScore(tables, -1, live[v]);
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	uint32_t best = UNUSED;
+	float bestScore = -1.0f;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		const uint32_t* tri = &input[t * 3];
+		triangleScores[t] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+		if (triangleScores[t] > bestScore)
+		{
+			bestScore = triangleScores[t];
+			best = (uint32_t)t;
+		}
+	}
+
+	// the 3 vertices of the new triangle can push 3 out.
+	uint32_t cache[CACHE_SIZE + 3], next[CACHE_SIZE + 3];
+	uint32_t cacheCount = 0;
+	size_t cursor = 0;
+	for (size_t out = 0; out < triangleCount; out++)
+	{
+		if (best == UNUSED)
+		{
+			// nothing touches the cache, continue in input order.
+			while (emitted[cursor])
+				cursor++;
+			best = (uint32_t)cursor;
+		}
+		const uint32_t* tri = &input[best * 3];
+		dest[out * 3 + 0] = tri[0];
+		dest[out * 3 + 1] = tri[1];
+		dest[out * 3 + 2] = tri[2];
+		emitted[best] = true;
+
+		uint32_t nextCount = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			const uint32_t v = tri[c];
+			uint32_t* triangles = &adjacency[adjacencyOffset[v]];
+			uint32_t* found = std::find(triangles, triangles + live[v], best);
+			*found = triangles[--live[v]];
+			if (std::find(next, next + nextCount, v) == next + nextCount)
+				next[nextCount++] = v;
+		}
+		for (uint32_t i = 0; i < cacheCount; i++)
+			if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+				next[nextCount++] = cache[i];
+
+		// rescore what moved in the cache (or fell out), and pick the best triangle around it.
+		best = UNUSED;
+		bestScore = -1.0f;
+		for (uint32_t i = 0; i < nextCount; i++)
+		{
+			const uint32_t v = next[i];
+			cachePosition[v] = i < CACHE_SIZE ? (int)i : -1;
+			vertexScores[v] = vertexScore(tables, cachePosition[v], live[v]);
+		}
+		for (uint32_t i = 0; i < nextCount; i++)
+		{
+			const uint32_t v = next[i];
+			const uint32_t* triangles = &adjacency[adjacencyOffset[v]];
+			for (uint32_t k = 0; k < live[v]; k++)
+			{
+				const uint32_t t = triangles[k];
+				const uint32_t* other = &input[t * 3];
+				triangleScores[t] = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+				if (triangleScores[t] > bestScore)
+				{
+					bestScore = triangleScores[t];
+					best = t;
+				}
+			}
+		}
+		cacheCount = std::min(nextCount, CACHE_SIZE);
+		memcpy(cache, next, cacheCount * sizeof(uint32_t));
+	}
+}
+
+void MeshOptimizer::optimizeOverdraw(uint32_t* dest, const uint32_t* indices, size_t indexCount,
+	const float* positions, size_t vertexCount, size_t positionStride, float threshold)
+{
+	const size_t triangleCount = indexCount / 3;
+	std::vector<uint32_t> input(indices, indices + triangleCount * 3);
+	auto position = [&](uint32_t v) { return (const float*)((const char*)positions + v * positionStride); };
+
+	// hard boundaries: every vertex of the triangle misses, the cache restarts there anyway.
+	std::vector<size_t> hard;
+	{
+		FifoCache fifo(vertexCount, 16);
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			const uint32_t* tri = &input[t * 3];
+			const int misses = fifo.access(tri[0]) + fifo.access(tri[1]) + fifo.access(tri[2]);
+			if (misses == 3 || t == 0)
+				hard.push_back(t);
+		}
+		hard.push_back(triangleCount);
+	}
+
+	// soft boundaries: inside each, a new cluster starts once the one so far
+	// is within threshold of the ACMR of the whole hard cluster.
+	std::vector<size_t> clusters;
+	{
+		FifoCache fifo(vertexCount, 16);
+		for (size_t h = 0; h + 1 < hard.size(); h++)
+		{
+			const size_t first = hard[h], end = hard[h + 1];
+			fifo.flush();
+			size_t misses = 0;
+			for (size_t t = first; t < end; t++)
+				for (int c = 0; c < 3; c++)
+					misses += fifo.access(input[t * 3 + c]);
+			const float clusterAcmr = misses / float(end - first);
+
+			fifo.flush();
+			misses = 0;
+			size_t start = first;
+			clusters.push_back(first);
+			for (size_t t = first; t < end; t++)
+			{
+				for (int c = 0; c < 3; c++)
+					misses += fifo.access(input[t * 3 + c]);
+				if (t + 1 < end && misses / float(t + 1 - start) <= threshold * clusterAcmr)
+				{
+					start = t + 1;
+					clusters.push_back(start);
+					fifo.flush();
+					misses = 0;
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+	}
+
+	// area weighted centroid and normal of the mesh and of each cluster.
+	struct Cluster {
+		size_t first, end;
+		float key;
+	};
+	std::vector<Cluster> sorted;
+	std::vector<float> centroids, normals;
+	float meshCentroid[3] = {}, meshArea = 0.0f;
+	for (size_t c = 0; c + 1 < clusters.size(); c++)
+	{
+		float centroid[3] = {}, normal[3] = {}, area = 0.0f;
+		for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const float* p0 = position(input[t * 3]);
+			const float* p1 = position(input[t * 3 + 1]);
+			const float* p2 = position(input[t * 3 + 2]);
+			const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			const float a = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (int k = 0; k < 3; k++)
+			{
+				centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * a;
+				normal[k] += n[k];
+			}
+			area += a;
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			meshCentroid[k] += centroid[k];
+			centroid[k] = area > 0.0f ? centroid[k] / area : 0.0f;
+		}
+		meshArea += area;
+		centroids.insert(centroids.end(), centroid, centroid + 3);
+		normals.insert(normals.end(), normal, normal + 3);
+		sorted.push_back({ clusters[c], clusters[c + 1], 0.0f });
+	}
+	for (int k = 0; k < 3; k++)
+		meshCentroid[k] = meshArea > 0.0f ? meshCentroid[k] / meshArea : 0.0f;
+	for (size_t c = 0; c < sorted.size(); c++)
+	{
+		const float* centroid = &centroids[c * 3];
+		const float* normal = &normals[c * 3];
+		const float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		float key = 0.0f;
+		for (int k = 0; k < 3; k++)
+			key += (centroid[k] - meshCentroid[k]) * normal[k];
+		sorted[c].key = length > 0.0f ? key / length : 0.0f;
+	}
+	// facing away from the middle first.
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+	std::vector<uint32_t> result;
+	result.reserve(input.size());
+	for (auto& c : sorted)
+		result.insert(result.end(), input.begin() + c.first * 3, input.begin() + c.end * 3);
+	const float before = analyzeVertexCache(input.data(), input.size(), vertexCount).acmr;
+	const float after = analyzeVertexCache(result.data(), result.size(), vertexCount).acmr;
+	const std::vector<uint32_t>& kept = after <= threshold * before ? result : input;
+	std::copy(kept.begin(), kept.end(), dest);
+}
+
+bool MeshOptimizer::optimizeTriangleOrder(uint32_t* indices, size_t indexCount,
+	const float* positions, size_t vertexCount, size_t positionStride)
+{
+	std::vector<uint32_t> result(indices, indices + indexCount);
+	optimizeVertexCache(result.data(), result.data(), indexCount, vertexCount);
+	optimizeOverdraw(result.data(), result.data(), indexCount, positions, vertexCount, positionStride);
+	if (!sameTriangles(indices, result.data(), indexCount))
+		return false;
+	if (analyzeVertexCache(result.data(), indexCount, vertexCount).acmr > analyzeVertexCache(indices, indexCount, vertexCount).acmr)
+		return false;
+	std::copy(result.begin(), result.end(), indices);
+	return true;
+}
+
+bool MeshOptimizer::sameTriangles(const uint32_t* a, const uint32_t* b, size_t indexCount)
+{
+	const size_t triangleCount = indexCount / 3;
+	std::vector<std::array<uint32_t, 3>> ta(triangleCount), tb(triangleCount);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		ta[t] = { { a[t * 3], a[t * 3 + 1], a[t * 3 + 2] } };
+		tb[t] = { { b[t * 3], b[t * 3 + 1], b[t * 3 + 2] } };
+	}
+	std::sort(ta.begin(), ta.end());
+	std::sort(tb.begin(), tb.end());
+	return ta == tb;
+}
+
+size_t MeshOptimizer::optimizeVertexFetchRemap(std::vector<uint32_t>& remap, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	remap.assign(vertexCount, UNUSED);
+	uint32_t next = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		assert(indices[i] < vertexCount);
+		if (remap[indices[i]] == UNUSED)
+			remap[indices[i]] = next++;
+	}
+	return next;
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	FifoCache fifo(vertexCount, cacheSize);
+	VertexCacheStats stats = { 0, 0.0f, 0.0f };
+	for (size_t i = 0; i < indexCount; i++)
+		stats.verticesTransformed += fifo.access(indices[i]);
+	const size_t triangleCount = indexCount / 3;
+	stats.acmr = triangleCount ? stats.verticesTransformed / float(triangleCount) : 0.0f;
+	stats.atvr = vertexCount ? stats.verticesTransformed / float(vertexCount) : 0.0f;
+	return stats;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/*
+ Offline passes that reorder indexed triangle lists for the GPU, run once
+ when a mesh is loaded, before its vertex and index buffers are written.
+ Indices are 32 bit here, narrow them for an IndexBuffer::FORMAT::UINT16
+ buffer when the vertex count allows it. A mesh has one vertex stream per
+ binding (POSITION, NORMAL, TEXTCOORD), the passes take all of them.
+
+	// a triangle soup (or an indexed mesh) without duplicate vertices
+	std::vector<uint32_t> remap;
+	size_t count = MeshOptimizer::generateVertexRemap(remap, nullptr, vertexCount, vertexCount, streams, 3);
+	MeshOptimizer::remapIndices(indices, nullptr, vertexCount, remap.data());
+	MeshOptimizer::remapVertices(newPositions, positions, vertexCount, sizeof(float4), remap.data()); // each stream
+	// then the order of the triangles, and of the vertices they use
+	MeshOptimizer::optimizeVertexCache(indices, indices, indexCount, count);
+	MeshOptimizer::optimizeOverdraw(indices, indices, indexCount, newPositions, count, sizeof(float4));
+	count = MeshOptimizer::optimizeVertexFetchRemap(remap, indices, indexCount, count);
+	MeshOptimizer::remapIndices(indices, indices, indexCount, remap.data()); // and remapVertices again
+
+ optimizeVertexCache is Forsyth's "Linear-Speed Vertex Cache Optimisation",
+ for any post-transform cache up to CACHE_SIZE entries. optimizeOverdraw
+ splits that order into clusters where the cache restarts anyway and draws
+ the clusters facing away from the middle of the mesh first (Tipsify,
+ Sander et al.), so the outside tends to hide the inside; it keeps the
+ cache order when the clusters would cost more than threshold times its
+ ACMR. Run it after optimizeVertexCache, and optimizeVertexFetch last.
+
+ optimizeTriangleOrder is the reorder a mesh gets when it is created: the
+ two passes in place, kept only when sameTriangles holds and the ACMR is
+ no worse, so a pass that goes wrong cannot change what the mesh draws.
+
+ dest may be indices for every pass that writes indices. Single thread,
+ they allocate their scratch.
+*/
+class MeshOptimizer
+{
+public:
+	static const uint32_t CACHE_SIZE = 32;
+	// the vertices remap leaves out.
+	static const uint32_t UNUSED = 0xffffffff;
+
+	// one vertex attribute: size bytes per vertex, stride bytes apart.
+	struct Stream {
+		const void* data;
+		size_t size, stride;
+	};
+
+	/*
+	 remap[v] is the new index of vertex v, the same for vertices equal in
+	 every stream, UNUSED for vertices no index references. New indices
+	 follow the order of first use. indices nullptr is the triangle soup
+	 0 .. indexCount - 1. Returns the number of unique vertices.
+	*/
+	static size_t generateVertexRemap(std::vector<uint32_t>& remap, const uint32_t* indices, size_t indexCount,
+		size_t vertexCount, const Stream* streams, size_t streamCount);
+	static void remapIndices(uint32_t* dest, const uint32_t* indices, size_t indexCount, const uint32_t* remap);
+	// dest holds the vertices remap keeps, vertexSize bytes each.
+	static void remapVertices(void* dest, const void* vertices, size_t vertexCount, size_t vertexSize, const uint32_t* remap);
+
+	static void optimizeVertexCache(uint32_t* dest, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+	// positions are 3 floats, positionStride bytes apart.
+	static void optimizeOverdraw(uint32_t* dest, const uint32_t* indices, size_t indexCount,
+		const float* positions, size_t vertexCount, size_t positionStride, float threshold = 1.05f);
+	// optimizeVertexCache then optimizeOverdraw, false (indices untouched) when the result is rejected.
+	static bool optimizeTriangleOrder(uint32_t* indices, size_t indexCount,
+		const float* positions, size_t vertexCount, size_t positionStride);
+	// b is a permutation of the triangles of a, each with the same first vertex.
+	static bool sameTriangles(const uint32_t* a, const uint32_t* b, size_t indexCount);
+	// vertices in the order the triangles first use them, returns how many are used.
+	static size_t optimizeVertexFetchRemap(std::vector<uint32_t>& remap, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	struct VertexCacheStats {
+		size_t verticesTransformed;
+		// vertices transformed per triangle (0.5 at best for a grid, 3 at
+		// worst) and per vertex of the mesh (1 at best).
+		float acmr, atvr;
+	};
+	// FIFO post-transform cache of cacheSize entries.
+	static VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+};
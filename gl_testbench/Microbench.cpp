@@ -0,0 +1,815 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <SDL_timer.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include "Microbench.h"
+#include "AllocationTracker.h"
+#include "Renderer.h"
+#include "Testbench.h"
+#include "TransformBatch.h"
+#include "TransformHierarchy.h"
+#include "RenderableScene.h"
+#include "BvhScene.h"
+#include "OcclusionCuller.h"
+#include "Camera.h"
+#include "MeshOptimizer.h"
+#include "Vulkan/MaterialVulkan.h"
+#include "Vulkan/ConstantBufferVulkan.h"
+
+/*
+ hardware cache misses of the calling thread, -1 if not available
+ (not Linux, no permission, or running in a VM without PMU).
+*/
+class CacheMissCounter
+{
+public:
+	CacheMissCounter()
+	{
+#ifdef __linux__
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	}
+	~CacheMissCounter()
+	{
+#ifdef __linux__
+		if (fd >= 0)
+			close(fd);
+#endif
+	}
+	void start()
+	{
+#ifdef __linux__
+		if (fd < 0)
+			return;
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	}
+	long long stop()
+	{
+#ifdef __linux__
+		long long count = 0;
+		if (fd < 0)
+			return -1;
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(fd, &count, sizeof(count)) != sizeof(count))
+			return -1;
+		return count;
+#else
+		return -1;
+#endif
+	}
+private:
+	int fd = -1;
+};
+
+namespace {
+
+	/*
+	 Stubs with no driver calls, so the real testbench code (Mesh, updateScene)
+	 can run without a device. The backend techniques create pipelines in their
+	 constructor, so sorting works on BenchTechnique which carries the same id.
+	*/
+	class BenchMaterial : public Material
+	{
+	public:
+		void setShader(const std::string& shaderFileName, ShaderType type) { shaderFileNames[type] = shaderFileName; }
+		void removeShader(ShaderType type) {}
+		void setDiffuse(Color c) { color = c; }
+		int compileMaterial(std::string& errString) { isValid = true; return 0; }
+		void addConstantBuffer(std::string name, unsigned int location) {}
+		void updateConstantBuffer(const void* data, size_t size, unsigned int location) {}
+		int enable() { return 0; }
+		void disable() {}
+	};
+
+	class BenchRenderState : public RenderState
+	{
+	public:
+		void setWireFrame(bool) {}
+		void set() {}
+	};
+
+	class BenchTechnique : public Technique
+	{
+	public:
+		BenchTechnique(Material* m, RenderState* r, int id) : Technique(m, r), id(id) {}
+		int id;
+	};
+
+	volatile size_t gSink = 0;
+
+	class BenchVertexBuffer : public VertexBuffer
+	{
+	public:
+		BenchVertexBuffer(size_t size) : size(size) {}
+		void setData(const void* data, size_t size, size_t offset) {}
+		void bind(size_t offset, size_t size, unsigned int location) { gSink = gSink + offset + size + location; }
+		void unbind() {}
+		size_t getSize() { return size; }
+	private:
+		size_t size;
+	};
+
+	class BenchTexture : public Texture2D
+	{
+	public:
+		int loadFromFile(std::string filename) { return 0; }
+		void bind(unsigned int slot) {}
+	};
+
+	class BenchSampler : public Sampler2D
+	{
+	public:
+		void setMagFilter(FILTER filter) {}
+		void setMinFilter(FILTER filter) {}
+		void setWrap(WRAPPING s, WRAPPING t) {}
+	};
+
+	/*
+	 submit()/frame() use the same containers as the backends: a flat vector
+	 (Vulkan, GL unsorted) or per-technique buckets (GL per technique).
+	*/
+	class BenchRenderer final : public Renderer
+	{
+	public:
+		Material* makeMaterial(const std::string& name) { return new BenchMaterial(); }
+		Mesh* makeMesh() { return new Mesh(); }
+		VertexBuffer* makeVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage) { return new BenchVertexBuffer(size); }
+		Texture2D* makeTexture2D() { return new BenchTexture(); }
+		Sampler2D* makeSampler2D() { return new BenchSampler(); }
+		RenderState* makeRenderState() { return new BenchRenderState(); }
+		std::string getShaderPath() { return ""; }
+		std::string getShaderExtension() { return ".glsl"; }
+		// real Vulkan constant buffer, setData is CPU only (push constants).
+		ConstantBuffer* makeConstantBuffer(std::string NAME, unsigned int location) { return new ConstantBufferVulkan(NAME, location); }
+		Technique* makeTechnique(Material* m, RenderState* r) { return new BenchTechnique(m, r, nextId++); }
+		MeshHandle createMesh() { return meshPool.create<Mesh>(); }
+		VertexBufferHandle createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage) { return vertexBufferPool.create<BenchVertexBuffer>(size); }
+		Texture2DHandle createTexture2D() { return texturePool.create<BenchTexture>(); }
+		Sampler2DHandle createSampler2D() { return samplerPool.create<BenchSampler>(); }
+		MaterialHandle createMaterial(const std::string& name) { return materialPool.create<BenchMaterial>(); }
+		TechniqueHandle createTechnique(MaterialHandle m, RenderState* r) { return techniquePool.create<BenchTechnique>(get(m), r, nextId++); }
+
+		int initialize(unsigned int width, unsigned int height, bool headless) { return 0; }
+		void setWinTitle(const char* title) {}
+		void present() {}
+		int shutdown() { return 0; }
+		void setClearColor(float, float, float, float) {}
+		void clearBuffer(unsigned int) {}
+		void setRenderState(RenderState* ps) {}
+		void submit(Mesh* mesh) { drawList.push_back(mesh); }
+		void submit(Mesh* const* meshes, size_t count) { drawList.insert(drawList.end(), meshes, meshes + count); }
+		// sorts PER_TECHNIQUE like the GL and Null renderers.
+		void frame()
+		{
+			submitRetained();
+			if (submission == SUBMISSION::PER_TECHNIQUE)
+				std::stable_sort(drawList.begin(), drawList.end(), [](const Mesh* a, const Mesh* b) {
+					return ((BenchTechnique*)a->technique)->id < ((BenchTechnique*)b->technique)->id;
+				});
+			gSink = gSink + drawList.size();
+			drawList.clear();
+		}
+	private:
+		int nextId = 0;
+		std::vector<Mesh*> drawList;
+	};
+
+	struct MicroResult {
+		double nsPerOp;
+		// -1 when not measured.
+		double allocationsPerOp;
+		double cacheMissesPerOp;
+	};
+
+	/*
+	 runs fn (which performs opsPerCall operations) until at least 20ms
+	 have been measured, after one untimed warm-up call.
+	*/
+	template<typename F>
+	MicroResult measure(size_t opsPerCall, F fn)
+	{
+		static CacheMissCounter cacheMisses;
+		const double minSeconds = 0.02;
+		const double frequency = (double)SDL_GetPerformanceFrequency();
+		fn();
+
+		size_t calls = 0;
+		uint64_t allocations = AllocationTracker::total().allocations;
+		cacheMisses.start();
+		Uint64 start = SDL_GetPerformanceCounter();
+		Uint64 now = start;
+		do
+		{
+			fn();
+			calls++;
+			now = SDL_GetPerformanceCounter();
+		} while ((now - start) / frequency < minSeconds);
+		long long misses = cacheMisses.stop();
+		allocations = AllocationTracker::total().allocations - allocations;
+
+		double ops = (double)calls * opsPerCall;
+		MicroResult r;
+		r.nsPerOp = (now - start) / frequency * 1e9 / ops;
+		r.allocationsPerOp = AllocationTracker::counting() ? allocations / ops : -1.0;
+		r.cacheMissesPerOp = misses < 0 ? -1.0 : misses / ops;
+		return r;
+	}
+
+	void report(const char* name, size_t size, const MicroResult& r)
+	{
+		// n/a: a build without TESTBENCH_ALLOCATIONS, or no access to the cache miss counter.
+		char allocations[16] = "n/a", misses[16] = "n/a";
+		if (r.allocationsPerOp >= 0.0)
+			snprintf(allocations, sizeof(allocations), "%.3f", r.allocationsPerOp);
+		if (r.cacheMissesPerOp >= 0.0)
+			snprintf(misses, sizeof(misses), "%.3f", r.cacheMissesPerOp);
+		printf("%-40s %8zu %12.2f %12s %14s\n", name, size, r.nsPerOp, allocations, misses);
+	}
+
+	bool selected(const std::string& filter, const char* name)
+	{
+		return filter.empty() || std::string(name).find(filter) != std::string::npos;
+	}
+
+	// a scene of meshCount meshes built by the real testbench code on BenchRenderer
+	struct BenchScene {
+		BenchRenderer renderer;
+		BenchScene(int meshCount)
+		{
+			TestbenchConfig config;
+			config.meshCount = meshCount;
+			// the benchmarks submit the scene themselves.
+			config.retained = false;
+			initialiseTestbench(&renderer, config);
+		}
+		~BenchScene() { shutdownTestbench(); }
+	};
+
+	void benchSubmit(const std::string& filter, size_t n)
+	{
+		BenchScene bench((int)n);
+		if (selected(filter, "submit/unsorted"))
+		{
+			bench.renderer.setSubmission(Renderer::SUBMISSION::UNSORTED);
+			report("submit/unsorted", n, measure(n, [&]() {
+				for (auto m : scene)
+					bench.renderer.submit(m);
+				bench.renderer.frame();
+			}));
+		}
+		if (selected(filter, "submit/per_technique"))
+		{
+			bench.renderer.setSubmission(Renderer::SUBMISSION::PER_TECHNIQUE);
+			report("submit/per_technique", n, measure(n, [&]() {
+				for (auto m : scene)
+					bench.renderer.submit(m);
+				bench.renderer.frame();
+			}));
+		}
+	}
+
+	/*
+	 the same unsorted submit through the Renderer interface, on the final
+	 class (the direct calls of a static backend build, see StaticBackend.h)
+	 and as one batch.
+	*/
+	void benchDispatch(const std::string& filter, size_t n)
+	{
+		BenchScene bench((int)n);
+		bench.renderer.setSubmission(Renderer::SUBMISSION::UNSORTED);
+		// volatile, the compiler cannot see the concrete class behind it.
+		Renderer* volatile dynamicRenderer = &bench.renderer;
+		if (selected(filter, "dispatch/virtual"))
+		{
+			report("dispatch/virtual", n, measure(n, [&]() {
+				Renderer* renderer = dynamicRenderer;
+				for (auto m : scene)
+					renderer->submit(m);
+				renderer->frame();
+			}));
+		}
+		if (selected(filter, "dispatch/static"))
+		{
+			report("dispatch/static", n, measure(n, [&]() {
+				BenchRenderer* renderer = &bench.renderer;
+				for (auto m : scene)
+					renderer->submit(m);
+				renderer->frame();
+			}));
+		}
+		if (selected(filter, "dispatch/batch"))
+		{
+			report("dispatch/batch", n, measure(n, [&]() {
+				Renderer* renderer = dynamicRenderer;
+				renderer->submit(scene.data(), scene.size());
+				renderer->frame();
+			}));
+		}
+	}
+
+	/*
+	 frustum culling of n meshes spread over [-1, 1]: testing every box
+	 (through the Mesh objects and as a RenderableStore pass), the
+	 BvhScene, and refitting it after every mesh moved. The camera
+	 sees a quarter of the width and of the height. The occlusion runs add
+	 a quad in front of the middle 60% of the view: rasterizing it, and
+	 the BvhScene testing its boxes against it as well.
+	*/
+	void benchCull(const std::string& filter, size_t n)
+	{
+		BenchScene bench((int)n);
+		TransformBatch batch;
+		batch.resize(n);
+		unsigned int seed = 12345;
+		for (size_t i = 0; i < n; i++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			batch.x()[i] = (seed >> 16) / 32768.0f - 1.0f;
+			seed = seed * 1664525u + 1013904223u;
+			batch.y()[i] = (seed >> 16) / 32768.0f - 1.0f;
+		}
+		BvhScene bvh;
+		for (auto m : scene)
+			bvh.addMesh(m);
+		bvh.refit(batch);
+		Camera camera;
+		camera.orthographic(-0.25f, 0.25f, -0.25f, 0.25f, -1.0f, 1.0f);
+		const Frustum frustum = camera.getFrustum();
+		std::vector<Mesh*> visible;
+		visible.reserve(n);
+
+		if (selected(filter, "cull/brute_force"))
+		{
+			report("cull/brute_force", n, measure(n, [&]() {
+				visible.clear();
+				for (size_t i = 0; i < n; i++)
+				{
+					const glm::vec3 t(batch.x()[i], batch.y()[i], batch.z()[i]);
+					if (frustum.intersects(scene[i]->bounds.translated(t)))
+						visible.push_back(scene[i]);
+				}
+				gSink = gSink + visible.size();
+			}));
+		}
+		if (selected(filter, "cull/bvh"))
+		{
+			report("cull/bvh", n, measure(n, [&]() {
+				visible.clear();
+				bvh.cull(frustum, visible);
+				gSink = gSink + visible.size();
+			}));
+		}
+		// the brute force loop over the BOUNDS and CONSTANTS arrays of a RenderableStore.
+		if (selected(filter, "cull/renderable_store"))
+		{
+			RenderableScene renderables;
+			for (size_t i = 0; i < n; i++)
+			{
+				renderables.addMesh(scene[i]);
+				renderables.store().constants(renderables.entity(scene[i])) = glm::vec4(batch.x()[i], batch.y()[i], batch.z()[i], 0.0f);
+			}
+			report("cull/renderable_store", n, measure(n, [&]() {
+				visible.clear();
+				renderables.cull(frustum, visible);
+				gSink = gSink + visible.size();
+			}));
+		}
+		if (selected(filter, "cull/refit"))
+		{
+			report("cull/refit", n, measure(n, [&]() {
+				bvh.refit(batch);
+			}));
+		}
+
+		OcclusionCuller occlusion;
+		const float s = 0.15f;
+		const glm::vec3 quad[6] = { { -s, -s, 0.5f },{ s, -s, 0.5f },{ s, s, 0.5f },{ -s, -s, 0.5f },{ s, s, 0.5f },{ -s, s, 0.5f } };
+		occlusion.setOccluders(quad, 6);
+		occlusion.render(camera.getConstants().viewProjection);
+		if (selected(filter, "cull/occlusion_render"))
+		{
+			report("cull/occlusion_render", n, measure(n, [&]() {
+				occlusion.render(camera.getConstants().viewProjection);
+			}));
+		}
+		if (selected(filter, "cull/bvh_occlusion"))
+		{
+			report("cull/bvh_occlusion", n, measure(n, [&]() {
+				visible.clear();
+				bvh.cull(frustum, visible, &occlusion);
+				gSink = gSink + visible.size();
+			}));
+		}
+	}
+
+	void benchSort(const std::string& filter, size_t n, int techniqueCount)
+	{
+		std::vector<BenchTechnique*> techs;
+		for (int i = 0; i < techniqueCount; i++)
+			techs.push_back(new BenchTechnique(nullptr, nullptr, i));
+		std::vector<Mesh> meshes(n);
+		unsigned int seed = 12345;
+		for (auto& m : meshes)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			m.technique = techs[(seed >> 16) % techniqueCount];
+		}
+		std::vector<Mesh*> source;
+		for (auto& m : meshes)
+			source.push_back(&m);
+		std::vector<Mesh*> list;
+		list.reserve(n);
+
+		char name[64];
+		// the comparison the Vulkan backend used before draw packets: chase mesh->technique->id
+		sprintf(name, "sort/pointer_chase/%dtech", techniqueCount);
+		if (selected(filter, name))
+		{
+			report(name, n, measure(n, [&]() {
+				list = source;
+				std::sort(list.begin(), list.end(), [](const Mesh* a, const Mesh* b) {
+					return ((BenchTechnique*)a->technique)->id < ((BenchTechnique*)b->technique)->id;
+				});
+			}));
+		}
+
+		// key extracted once, sort on (key, mesh) pairs
+		sprintf(name, "sort/packed_key/%dtech", techniqueCount);
+		if (selected(filter, name))
+		{
+			std::vector<std::pair<int, Mesh*>> keyed;
+			keyed.reserve(n);
+			report(name, n, measure(n, [&]() {
+				keyed.clear();
+				for (auto m : source)
+					keyed.push_back({ ((BenchTechnique*)m->technique)->id, m });
+				std::sort(keyed.begin(), keyed.end(), [](const std::pair<int, Mesh*>& a, const std::pair<int, Mesh*>& b) {
+					return a.first < b.first;
+				});
+				list.clear();
+				for (auto& k : keyed)
+					list.push_back(k.second);
+			}));
+		}
+
+		// technique ids are small and dense: counting sort
+		sprintf(name, "sort/counting/%dtech", techniqueCount);
+		if (selected(filter, name))
+		{
+			std::vector<size_t> offsets(techniqueCount + 1);
+			report(name, n, measure(n, [&]() {
+				std::fill(offsets.begin(), offsets.end(), 0);
+				for (auto m : source)
+					offsets[((BenchTechnique*)m->technique)->id + 1]++;
+				for (int i = 0; i < techniqueCount; i++)
+					offsets[i + 1] += offsets[i];
+				list.resize(source.size());
+				for (auto m : source)
+					list[offsets[((BenchTechnique*)m->technique)->id]++] = m;
+			}));
+		}
+
+		for (auto t : techs)
+			delete t;
+	}
+
+	/*
+	 a pass reading technique, texture and vertex range of every mesh: through
+	 the Mesh objects, and as a RenderableStore query over the same scene.
+	*/
+	void benchScenePass(const std::string& filter, size_t n)
+	{
+		BenchScene bench((int)n);
+		std::vector<size_t> counts(256);
+		if (selected(filter, "scene_pass/mesh_pointers"))
+		{
+			report("scene_pass/mesh_pointers", n, measure(n, [&]() {
+				size_t textured = 0, first = 0;
+				for (auto m : scene)
+				{
+					counts[((BenchTechnique*)m->technique)->id & 255]++;
+					textured += m->textures.find(DIFFUSE_SLOT) != m->textures.end();
+					first += m->geometryBuffers.find(POSITION)->second.offset;
+				}
+				gSink = gSink + textured + first;
+			}));
+		}
+		if (selected(filter, "scene_pass/renderable_store"))
+		{
+			RenderableScene renderables;
+			for (auto m : scene)
+				renderables.addMesh(m);
+			report("scene_pass/renderable_store", n, measure(n, [&]() {
+				size_t textured = 0, first = 0;
+				renderables.store().forEach(RenderableStore::ALWAYS, [&](const RenderableStore::View& v) {
+					for (size_t i = 0; i < v.count; i++)
+					{
+						counts[v.techniques[i] & 255]++;
+						first += v.geometry[i].first;
+					}
+					if (v.textures)
+						textured += v.count;
+				});
+				gSink = gSink + textured + first;
+			}));
+		}
+	}
+
+	void benchBindVertexBuffers(const std::string& filter, size_t n)
+	{
+		BenchScene bench((int)n);
+		// what the backends do in frame(): copy each pair, then look it up again
+		if (selected(filter, "bindIAVertexBuffer/map_lookup"))
+		{
+			report("bindIAVertexBuffer/map_lookup", n, measure(n, [&]() {
+				for (auto mesh : scene)
+					for (auto element : mesh->geometryBuffers)
+						mesh->bindIAVertexBuffer(element.first);
+			}));
+		}
+		// iterate by reference and bind directly, no second lookup
+		if (selected(filter, "bindIAVertexBuffer/iterate"))
+		{
+			report("bindIAVertexBuffer/iterate", n, measure(n, [&]() {
+				for (auto mesh : scene)
+					for (auto& element : mesh->geometryBuffers)
+					{
+						const Mesh::VertexBufferBind& vb = element.second;
+						vb.buffer->bind(vb.offset, vb.numElements * vb.sizeElement, element.first);
+					}
+			}));
+		}
+		// the stream arrays of DrawPacketGL/DrawPacketVulkan, compiled once: a linear loop
+		if (selected(filter, "bindIAVertexBuffer/draw_packet"))
+		{
+			struct Streams {
+				uint32_t count;
+				uint32_t locations[4];
+				size_t offsets[4], sizes[4];
+			};
+			std::vector<Streams> packets(scene.size());
+			for (size_t i = 0; i < scene.size(); i++)
+			{
+				packets[i].count = 0;
+				for (auto& element : scene[i]->geometryBuffers)
+				{
+					const uint32_t s = packets[i].count++;
+					packets[i].locations[s] = element.first;
+					packets[i].offsets[s] = element.second.offset;
+					packets[i].sizes[s] = element.second.numElements * element.second.sizeElement;
+				}
+			}
+			report("bindIAVertexBuffer/draw_packet", n, measure(n, [&]() {
+				for (const Streams& p : packets)
+					for (uint32_t s = 0; s < p.count; s++)
+						gSink = gSink + p.offsets[s] + p.sizes[s] + p.locations[s];
+			}));
+		}
+	}
+
+	void benchConstantBuffers(const std::string& filter, size_t n)
+	{
+		if (selected(filter, "ConstantBuffer::setData"))
+		{
+			std::vector<ConstantBufferVulkan*> buffers;
+			for (size_t i = 0; i < n; i++)
+				buffers.push_back(new ConstantBufferVulkan(TRANSLATION_NAME, TRANSLATION));
+			const float trans[4] = { 0.1f, 0.2f, 0.3f, 0.0f };
+			report("ConstantBuffer::setData", n, measure(n, [&]() {
+				for (auto cb : buffers)
+					cb->setData(trans, sizeof(trans), nullptr, TRANSLATION);
+			}));
+			for (auto cb : buffers)
+				delete cb;
+		}
+		if (selected(filter, "updateScene"))
+		{
+			BenchScene bench((int)n);
+			double time = 0.0;
+			report("updateScene", n, measure(n, [&]() {
+				updateScene(time);
+				time += 1.0 / 60.0;
+			}));
+		}
+		if (selected(filter, "TransformBatch::write"))
+		{
+			TransformBatch batch;
+			batch.resize(n);
+			for (size_t i = 0; i < n; i++)
+				batch.x()[i] = batch.y()[i] = batch.z()[i] = (float)i;
+			// tightly packed as in the Vulkan array, and at a GL uniform buffer offset alignment.
+			std::vector<float> packed(n * 4), aligned(n * 64);
+			report("TransformBatch::write/16", n, measure(n, [&]() {
+				batch.write(packed.data(), 4 * sizeof(float), n);
+			}));
+			report("TransformBatch::write/256", n, measure(n, [&]() {
+				batch.write(aligned.data(), 64 * sizeof(float), n);
+			}));
+			// the GL path's non-temporal stores, here into cached memory.
+			report("TransformBatch::write/256/streaming", n, measure(n, [&]() {
+				batch.write(aligned.data(), 64 * sizeof(float), n, true);
+			}));
+		}
+		if (selected(filter, "TransformHierarchy::update"))
+		{
+			// 10 roots, every node below a random earlier one (depth grows with log n).
+			TransformHierarchy hierarchy;
+			uint32_t seed = 1;
+			for (size_t i = 0; i < n; i++)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				hierarchy.create(i < 10 ? TransformHierarchy::NONE : (uint32_t)((seed >> 8) % i));
+			}
+			hierarchy.update();
+			const glm::mat4 moved(1.0f);
+			report("TransformHierarchy::update/all", n, measure(n, [&]() {
+				for (uint32_t r = 0; r < 10 && r < n; r++)
+					hierarchy.setLocal(r, moved);
+				hierarchy.update();
+			}));
+			// cost per node that moved, not per node of the hierarchy.
+			const size_t movedCount = std::max<size_t>(n / 100, 1);
+			report("TransformHierarchy::update/1%", movedCount, measure(movedCount, [&]() {
+				for (size_t i = 0; i < movedCount; i++)
+					hierarchy.setLocal((uint32_t)(n - 1 - i), moved);
+				hierarchy.update();
+			}));
+		}
+	}
+
+	/*
+	 the MeshOptimizer passes on a grid of about n triangles, loaded as a
+	 triangle soup (3 float4 positions per triangle) in random order. Also
+	 prints the vertex cache (16 entry FIFO) of the soup deduplicated in
+	 random order, after optimizeVertexCache and after optimizeOverdraw.
+	*/
+	void benchMeshOptimizer(const std::string& filter, size_t n)
+	{
+		if (!selected(filter, "MeshOptimizer"))
+			return;
+		const size_t side = std::max<size_t>((size_t)sqrt(n / 2.0), 1);
+		const size_t triangles = side * side * 2;
+		std::vector<float> soup;
+		soup.reserve(triangles * 3 * 4);
+		auto corner = [&](size_t x, size_t y) {
+			const float p[4] = { x / float(side), y / float(side), sinf(x * 0.3f) * cosf(y * 0.3f) * 0.1f, 1.0f };
+			soup.insert(soup.end(), p, p + 4);
+		};
+		for (size_t y = 0; y < side; y++)
+			for (size_t x = 0; x < side; x++)
+			{
+				corner(x, y); corner(x + 1, y); corner(x + 1, y + 1);
+				corner(x, y); corner(x + 1, y + 1); corner(x, y + 1);
+			}
+		// shuffle the triangles, as an exporter without any optimization might.
+		uint32_t seed = 7;
+		for (size_t t = triangles - 1; t > 0; t--)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const size_t other = (seed >> 8) % (t + 1);
+			std::swap_ranges(soup.begin() + t * 12, soup.begin() + t * 12 + 12, soup.begin() + other * 12);
+		}
+
+		const size_t soupVertices = triangles * 3;
+		const MeshOptimizer::Stream stream = { soup.data(), 4 * sizeof(float), 4 * sizeof(float) };
+		std::vector<uint32_t> remap, indices(soupVertices), optimized(soupVertices);
+		size_t vertexCount = 0;
+		report("MeshOptimizer::generateVertexRemap", triangles, measure(soupVertices, [&]() {
+			vertexCount = MeshOptimizer::generateVertexRemap(remap, nullptr, soupVertices, soupVertices, &stream, 1);
+		}));
+		MeshOptimizer::remapIndices(indices.data(), nullptr, soupVertices, remap.data());
+		std::vector<float> vertices(vertexCount * 4);
+		MeshOptimizer::remapVertices(vertices.data(), soup.data(), soupVertices, 4 * sizeof(float), remap.data());
+
+		report("MeshOptimizer::optimizeVertexCache", triangles, measure(triangles, [&]() {
+			MeshOptimizer::optimizeVertexCache(optimized.data(), indices.data(), indices.size(), vertexCount);
+		}));
+		std::vector<uint32_t> overdraw(optimized.size());
+		report("MeshOptimizer::optimizeOverdraw", triangles, measure(triangles, [&]() {
+			MeshOptimizer::optimizeOverdraw(overdraw.data(), optimized.data(), optimized.size(), vertices.data(), vertexCount, 4 * sizeof(float));
+		}));
+		report("MeshOptimizer::optimizeVertexFetchRemap", triangles, measure(triangles, [&]() {
+			gSink = gSink + MeshOptimizer::optimizeVertexFetchRemap(remap, overdraw.data(), overdraw.size(), vertexCount);
+		}));
+
+		const MeshOptimizer::VertexCacheStats before = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+		const MeshOptimizer::VertexCacheStats cache = MeshOptimizer::analyzeVertexCache(optimized.data(), optimized.size(), vertexCount);
+		const MeshOptimizer::VertexCacheStats after = MeshOptimizer::analyzeVertexCache(overdraw.data(), overdraw.size(), vertexCount);
+		printf("%-40s %8zu   %zu of %zu vertices, acmr %.3f -> %.3f -> %.3f, atvr %.3f -> %.3f -> %.3f, %s\n",
+			"MeshOptimizer/vertex_cache", triangles, vertexCount, soupVertices,
+			before.acmr, cache.acmr, after.acmr, before.atvr, cache.atvr, after.atvr,
+			MeshOptimizer::sameTriangles(indices.data(), overdraw.data(), indices.size()) ? "same triangles" : "TRIANGLES DIFFER");
+	}
+
+	// same as MaterialVulkan::expandShaderText, but sized up front.
+	std::string expandShaderTextReserved(Material& m, const std::string& shaderText, Material::ShaderType type)
+	{
+		static const char version[] = "\n\n #version 450\n";
+		size_t size = sizeof(version) + shaderText.size();
+		for (auto& define : m.shaderDefines[type])
+			size += define.size() + 1;
+		std::string result;
+		result.reserve(size);
+		result += version;
+		for (auto& define : m.shaderDefines[type])
+		{
+			result += define;
+			result += '\n';
+		}
+		result += shaderText;
+		return result;
+	}
+
+	void benchShaderExpansion(const std::string& filter, size_t defineCount)
+	{
+		MaterialVulkan material("microbench");
+		for (size_t i = 0; i < defineCount; i++)
+			material.addDefine("#define DEFINE_" + std::to_string(i) + " " + std::to_string(i), Material::ShaderType::VS);
+		std::string shaderText(4096, ' ');
+
+		if (selected(filter, "expandShaderText"))
+		{
+			report("expandShaderText", defineCount, measure(1, [&]() {
+				std::string expanded = material.expandShaderText(shaderText, Material::ShaderType::VS);
+				gSink = gSink + expanded.size();
+			}));
+		}
+		if (selected(filter, "expandShaderText/reserved"))
+		{
+			report("expandShaderText/reserved", defineCount, measure(1, [&]() {
+				std::string expanded = expandShaderTextReserved(material, shaderText, Material::ShaderType::VS);
+				gSink = gSink + expanded.size();
+			}));
+		}
+	}
+
+	std::vector<size_t> parseSizes(const char* text)
+	{
+		std::vector<size_t> sizes;
+		std::string s = text;
+		size_t start = 0;
+		while (start < s.size())
+		{
+			size_t end = s.find(',', start);
+			if (end == std::string::npos)
+				end = s.size();
+			if (end > start)
+				sizes.push_back((size_t)atoll(s.substr(start, end - start).c_str()));
+			start = end + 1;
+		}
+		return sizes;
+	}
+}
+
+int microbenchMain(int argc, char* argv[])
+{
+	std::string filter;
+	std::vector<size_t> sizes = { 100, 1000, 10000, 100000 };
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if (arg == "--sizes" && i + 1 < argc)
+			sizes = parseSizes(argv[++i]);
+	}
+
+	printf("%-40s %8s %12s %12s %14s\n", "benchmark", "size", "ns/op", "allocs/op", "cache-miss/op");
+	for (size_t n : sizes)
+	{
+		benchSubmit(filter, n);
+		benchDispatch(filter, n);
+		benchSort(filter, n, 4);
+		benchSort(filter, n, 64);
+		benchBindVertexBuffers(filter, n);
+		benchScenePass(filter, n);
+		benchCull(filter, n);
+		benchConstantBuffers(filter, n);
+		benchMeshOptimizer(filter, n);
+	}
+	for (size_t defines : { 1, 8, 64 })
+		benchShaderExpansion(filter, defines);
+	return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+/*
+ CPU-only microbenchmarks of the renderer hot paths (submit, virtual,
+ direct and batched submit calls, draw list sorting, vertex buffer
+ binding lookups, a scene pass through Mesh objects and through the
+ RenderableStore, frustum and occlusion culling, constant buffer updates, the
+ updateScene loop, the TransformBatch kernel, TransformHierarchy updates,
+ the MeshOptimizer passes and shader text expansion) at several input sizes.
+ No window or GPU is created.
+
+ Prints ns/op, allocations/op (AllocationTracker) and (on Linux, through perf_event_open)
+ cache misses/op.
+
+ --microbench [--filter name] [--sizes 100,1000,...]
+
+ --filter dispatch --sizes 10000,100000,1000000 compares the submit
+ dispatch from 10k to 1M draws.
+*/
+int microbenchMain(int argc, char* argv[]);
@@ -0,0 +1,39 @@
+#include <string.h>
+#include "ConstantBufferNull.h"
+#include "NullRenderer.h"
+
+ConstantBufferNull::ConstantBufferNull(std::string NAME, unsigned int location)
+{
+	name = NAME;
+	this->location = location;
+	id = NullRenderer::nextId();
+}
+
+ConstantBufferNull::~ConstantBufferNull()
+{
+}
+
+void ConstantBufferNull::setData(const void* data, size_t size, Material* m, unsigned int location)
+{
+	this->size = size < MAX_SIZE ? size : MAX_SIZE;
+	memcpy(buff, data, this->size);
+	FrameStats::current.uniformBytes += this->size;
+	source = nullptr;
+}
+
+void ConstantBufferNull::attach(const float* translation)
+{
+	source = (const unsigned char*)translation;
+	size = sizeof(float) * 4;
+}
+
+void ConstantBufferNull::bind(Material*)
+{
+	if (NullRenderer::stream)
+	{
+		NullRenderer::stream->writeOp(CommandStream::BIND_CONSTANT);
+		NullRenderer::stream->writeU32(id);
+		NullRenderer::stream->writeU32(location);
+		NullRenderer::stream->writeBytes(source ? source : buff, size);
+	}
+}
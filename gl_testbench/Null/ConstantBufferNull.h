@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+#include "../ConstantBuffer.h"
+
+class ConstantBufferNull final : public ConstantBuffer
+{
+public:
+	ConstantBufferNull(std::string NAME, unsigned int location);
+	~ConstantBufferNull();
+	void setData(const void* data, size_t size, Material* m, unsigned int location);
+	void bind(Material*);
+	// records the float4 at translation (a slot of the renderer's per-draw
+	// array) instead of its own data, until the next setData.
+	void attach(const float* translation);
+
+	uint32_t id;
+private:
+	std::string name;
+	unsigned int location;
+	// the testbench only uses float4 blocks, larger updates are truncated.
+	static const size_t MAX_SIZE = 64;
+	unsigned char buff[MAX_SIZE];
+	size_t size = 0;
+	const unsigned char* source = nullptr;
+};
@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "IndexBufferNull.h"
+#include "NullRenderer.h"
+#include "../MemoryTracker.h"
+
+IndexBufferNull::IndexBufferNull(size_t size, IndexBuffer::FORMAT format) : IndexBuffer(format)
+{
+	totalSize = size;
+	memory = (unsigned char*)malloc(size);
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory, MemoryTracker::SYSTEM_MEMORY, size);
+	id = NullRenderer::nextId();
+}
+
+IndexBufferNull::~IndexBufferNull()
+{
+	MemoryTracker::release(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory);
+	free(memory);
+}
+
+void IndexBufferNull::setData(const void* data, size_t size, size_t offset)
+{
+	if (offset + size > totalSize)
+	{
+		fprintf(stderr, "IndexBufferNull::setData out of range\n");
+		exit(-1);
+	}
+	memcpy(memory + offset, data, size);
+	FrameStats::current.stagingBytes += size;
+}
+
+void IndexBufferNull::bind(size_t offset)
+{
+	if (NullRenderer::stream)
+	{
+		NullRenderer::stream->writeOp(CommandStream::BIND_INDEX_BUFFER);
+		NullRenderer::stream->writeU32(id);
+		NullRenderer::stream->writeU64(offset);
+		NullRenderer::stream->writeU32((uint32_t)getIndexSize());
+	}
+}
+
+size_t IndexBufferNull::getSize()
+{
+	return totalSize;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include "../IndexBuffer.h"
+
+class IndexBufferNull final : public IndexBuffer
+{
+public:
+	IndexBufferNull(size_t size, IndexBuffer::FORMAT format);
+	~IndexBufferNull();
+
+	void setData(const void* data, size_t size, size_t offset);
+	size_t getSize();
+	// writes BIND_INDEX_BUFFER to the stream.
+	void bind(size_t offset);
+
+	uint32_t id;
+private:
+	size_t totalSize;
+	// CPU copy, stands in for the GPU buffer.
+	unsigned char* memory;
+};
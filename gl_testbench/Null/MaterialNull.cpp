@@ -0,0 +1,73 @@
+#include "MaterialNull.h"
+#include "NullRenderer.h"
+
+MaterialNull::MaterialNull(const std::string& name) : name(name)
+{
+	id = NullRenderer::nextId();
+}
+
+MaterialNull::~MaterialNull()
+{
+	for (auto cb : constantBuffers)
+		delete cb.second;
+}
+
+void MaterialNull::setShader(const std::string& shaderFileName, ShaderType type)
+{
+	shaderFileNames[type] = shaderFileName;
+}
+
+void MaterialNull::removeShader(ShaderType type)
+{
+	shaderFileNames.erase(type);
+}
+
+void MaterialNull::setDiffuse(Color c)
+{
+	color = c;
+}
+
+// nothing to compile, only checks that both stages (or a compute shader) are set.
+int MaterialNull::compileMaterial(std::string& errString)
+{
+	// a compute material, createComputeTechnique turns it down.
+	if (shaderFileNames.find(ShaderType::CS) != shaderFileNames.end())
+		return 0;
+	if (shaderFileNames.find(ShaderType::VS) == shaderFileNames.end() ||
+		shaderFileNames.find(ShaderType::PS) == shaderFileNames.end())
+	{
+		errString = "Material " + name + " needs a vertex and a fragment shader";
+		return -1;
+	}
+	isValid = true;
+	return 0;
+}
+
+void MaterialNull::addConstantBuffer(std::string name, unsigned int location)
+{
+	constantBuffers[location] = new ConstantBufferNull(name, location);
+}
+
+void MaterialNull::updateConstantBuffer(const void* data, size_t size, unsigned int location)
+{
+	constantBuffers[location]->setData(data, size, this, location);
+}
+
+int MaterialNull::enable()
+{
+	FrameStats::current.pipelineBinds++;
+	if (NullRenderer::stream)
+	{
+		NullRenderer::stream->writeOp(CommandStream::ENABLE_MATERIAL);
+		NullRenderer::stream->writeU32(id);
+	}
+	for (auto cb : constantBuffers)
+	{
+		cb.second->bind(this);
+	}
+	return 0;
+}
+
+void MaterialNull::disable()
+{
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+#include "../Material.h"
+#include "ConstantBufferNull.h"
+
+class MaterialNull final : public Material
+{
+public:
+	MaterialNull(const std::string& name);
+	~MaterialNull();
+
+	void setShader(const std::string& shaderFileName, ShaderType type);
+	void removeShader(ShaderType type);
+	void setDiffuse(Color c);
+	int compileMaterial(std::string& errString);
+	void addConstantBuffer(std::string name, unsigned int location);
+	void updateConstantBuffer(const void* data, size_t size, unsigned int location);
+	int enable();
+	void disable();
+
+	uint32_t id;
+private:
+	std::string name;
+	std::map<unsigned int, ConstantBufferNull*> constantBuffers;
+};
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include "NullRenderer.h"
+#include "MaterialNull.h"
+#include "TechniqueNull.h"
+#include "RenderStateNull.h"
+#include "VertexBufferNull.h"
+#include "IndexBufferNull.h"
+#include "ConstantBufferNull.h"
+#include "Texture2DNull.h"
+#include "Sampler2DNull.h"
+#include "../Mesh.h"
+#include "../TransformBatch.h"
+#include "../Profiler.h"
+#include "../StaticBackend.h"
+
+CommandStream* NullRenderer::stream = nullptr;
+uint32_t NullRenderer::lastId = 0;
+
+NullRenderer::NullRenderer()
+{
+	// ids restart with every renderer, so separate runs record identical streams.
+	lastId = 0;
+}
+
+NullRenderer::~NullRenderer()
+{
+}
+
+Material* NullRenderer::makeMaterial(const std::string& name)
+{
+	return new MaterialNull(name);
+}
+
+Mesh* NullRenderer::makeMesh()
+{
+	return new Mesh();
+}
+
+VertexBuffer* NullRenderer::makeVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	return new VertexBufferNull(size, usage);
+}
+
+Texture2D* NullRenderer::makeTexture2D()
+{
+	return new Texture2DNull();
+}
+
+Sampler2D* NullRenderer::makeSampler2D()
+{
+	return new Sampler2DNull();
+}
+
+RenderState* NullRenderer::makeRenderState()
+{
+	return new RenderStateNull();
+}
+
+std::string NullRenderer::getShaderPath()
+{
+	return std::string("../assets/GL45/");
+}
+
+std::string NullRenderer::getShaderExtension()
+{
+	return std::string(".glsl");
+}
+
+ConstantBuffer* NullRenderer::makeConstantBuffer(std::string NAME, unsigned int location)
+{
+	return new ConstantBufferNull(NAME, location);
+}
+
+Technique* NullRenderer::makeTechnique(Material* m, RenderState* r)
+{
+	return new TechniqueNull(m, r);
+}
+
+MeshHandle NullRenderer::createMesh()
+{
+	return meshPool.create<Mesh>();
+}
+
+VertexBufferHandle NullRenderer::createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	return vertexBufferPool.create<VertexBufferNull>(size, usage);
+}
+
+IndexBufferHandle NullRenderer::createIndexBuffer(size_t size, IndexBuffer::FORMAT format)
+{
+	return indexBufferPool.create<IndexBufferNull>(size, format);
+}
+
+Texture2DHandle NullRenderer::createTexture2D()
+{
+	return texturePool.create<Texture2DNull>();
+}
+
+Sampler2DHandle NullRenderer::createSampler2D()
+{
+	return samplerPool.create<Sampler2DNull>();
+}
+
+MaterialHandle NullRenderer::createMaterial(const std::string& name)
+{
+	return materialPool.create<MaterialNull>(name);
+}
+
+TechniqueHandle NullRenderer::createTechnique(MaterialHandle m, RenderState* r)
+{
+	return techniquePool.create<TechniqueNull>(get(m), r);
+}
+
+int NullRenderer::initialize(unsigned int width, unsigned int height, bool headless)
+{
+	return 0;
+}
+
+void NullRenderer::setWinTitle(const char* title)
+{
+}
+
+void NullRenderer::present()
+{
+	PROFILE_ZONE("present");
+	FrameStats::endFrame();
+	if (stream)
+		stream->writeOp(CommandStream::PRESENT);
+}
+
+int NullRenderer::shutdown()
+{
+	stream = nullptr;
+	return 0;
+}
+
+void NullRenderer::setClearColor(float r, float g, float b, float a)
+{
+	clearColor[0] = r; clearColor[1] = g; clearColor[2] = b; clearColor[3] = a;
+}
+
+void NullRenderer::clearBuffer(unsigned int flag)
+{
+	if (stream)
+	{
+		stream->writeOp(CommandStream::CLEAR);
+		stream->writeU32(flag);
+	}
+}
+
+void NullRenderer::setRenderState(RenderState* ps)
+{
+	direct<RenderStateNull>(ps)->set();
+}
+
+void NullRenderer::submit(Mesh* mesh)
+{
+	FrameStats::current.drawsSubmitted++;
+	drawList.push_back(mesh);
+}
+
+void NullRenderer::submit(Mesh* const* meshes, size_t count)
+{
+	PROFILE_ZONE("submit");
+	FrameStats::current.drawsSubmitted += count;
+	drawList.insert(drawList.end(), meshes, meshes + count);
+}
+
+void NullRenderer::attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source)
+{
+	translations.assign(meshes.size() * 4, 0.0f);
+	for (size_t i = 0; i < meshes.size(); i++)
+		((ConstantBufferNull*)meshes[i]->txBuffer)->attach(&translations[i * 4]);
+}
+
+void NullRenderer::updateTransforms(const TransformBatch& batch)
+{
+	const size_t count = std::min(batch.size(), translations.size() / 4);
+	batch.write(translations.data(), 4 * sizeof(float), count);
+	FrameStats::current.uniformBytes += count * 4 * sizeof(float);
+}
+
+/*
+ Same work per mesh as the GL backend: enable the technique, bind textures,
+ vertex buffers and the translation, then draw. PER_TECHNIQUE orders by
+ technique id (stable, so the stream is deterministic) and only enables a
+ technique when it changes.
+*/
+void NullRenderer::frame()
+{
+	PROFILE_ZONE("frame");
+	submitRetained();
+	if (submission == SUBMISSION::PER_TECHNIQUE)
+		std::stable_sort(drawList.begin(), drawList.end(), TechniqueNull::sortMesh);
+
+	Technique* current = nullptr;
+	for (auto mesh : drawList)
+	{
+		if (submission != SUBMISSION::PER_TECHNIQUE || mesh->technique != current)
+		{
+			current = mesh->technique;
+			direct<TechniqueNull>(current)->enable(this);
+		}
+		for (auto t : mesh->textures)
+		{
+			direct<Texture2DNull>(t.second)->bind(t.first);
+		}
+		for (auto& element : mesh->geometryBuffers)
+		{
+			const Mesh::VertexBufferBind& vb = element.second;
+			direct<VertexBufferNull>(vb.buffer)->bind(vb.offset, vb.numElements * vb.sizeElement, element.first);
+		}
+		direct<ConstantBufferNull>(mesh->txBuffer)->bind(current->getMaterial());
+
+		FrameStats::current.drawsIssued++;
+		if (mesh->indexBuffer.buffer)
+		{
+			// not virtual, no direct<> needed.
+			static_cast<IndexBufferNull*>(mesh->indexBuffer.buffer)->bind(mesh->indexBuffer.offset);
+			if (stream)
+			{
+				stream->writeOp(CommandStream::DRAW_INDEXED);
+				stream->writeU32((uint32_t)mesh->indexBuffer.count);
+			}
+		}
+		else if (stream)
+		{
+			stream->writeOp(CommandStream::DRAW);
+			stream->writeU32((uint32_t)mesh->geometryBuffers[POSITION].numElements);
+		}
+	}
+	drawList.clear();
+	if (stream)
+		stream->writeOp(CommandStream::FRAME);
+}
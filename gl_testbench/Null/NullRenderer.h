@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include "../Renderer.h"
+#include "../CommandStream.h"
+
+/*
+ Backend without any driver calls. Runs the same submission and per-draw
+ binding logic as the real backends, so timing it measures the cost of the
+ testbench abstraction alone. Optionally every bind/draw is recorded into a
+ CommandStream, which makes frames from different submission strategies
+ comparable byte by byte.
+*/
+class NullRenderer final : public Renderer
+{
+public:
+	// recording target of all Null objects, nullptr when not recording.
+	static CommandStream* stream;
+
+	NullRenderer();
+	~NullRenderer();
+
+	Material* makeMaterial(const std::string& name);
+	Mesh* makeMesh();
+	VertexBuffer* makeVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage);
+	Texture2D* makeTexture2D();
+	Sampler2D* makeSampler2D();
+	RenderState* makeRenderState();
+	std::string getShaderPath();
+	std::string getShaderExtension();
+	ConstantBuffer* makeConstantBuffer(std::string NAME, unsigned int location);
+	Technique* makeTechnique(Material*, RenderState*);
+	MeshHandle createMesh();
+	VertexBufferHandle createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage);
+	IndexBufferHandle createIndexBuffer(size_t size, IndexBuffer::FORMAT format);
+	Texture2DHandle createTexture2D();
+	Sampler2DHandle createSampler2D();
+	MaterialHandle createMaterial(const std::string& name);
+	TechniqueHandle createTechnique(MaterialHandle m, RenderState* r);
+
+	int initialize(unsigned int width = 800, unsigned int height = 600, bool headless = false);
+	void setWinTitle(const char* title);
+	void present();
+	int shutdown();
+
+	void setClearColor(float, float, float, float);
+	void clearBuffer(unsigned int);
+	void setRenderState(RenderState* ps);
+	// submit(MeshHandle) of Renderer.
+	using Renderer::submit;
+	void submit(Mesh* mesh);
+	void submit(Mesh* const* meshes, size_t count);
+	void frame();
+	// translations live in one array, see Renderer::attachTransforms.
+	void attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source = TRANSFORMS::CPU);
+	void updateTransforms(const TransformBatch& batch);
+
+	// start/stop recording into recording (not owned).
+	void setRecording(CommandStream* recording) { stream = recording; };
+
+	// ids for the recorded stream, in creation order.
+	static uint32_t nextId() { return ++lastId; };
+private:
+	static uint32_t lastId;
+	std::vector<Mesh*> drawList;
+	// float4 per attached mesh, recorded by its constant buffer.
+	std::vector<float> translations;
+	float clearColor[4] = { 0,0,0,0 };
+};
@@ -0,0 +1,26 @@
+#include "RenderStateNull.h"
+#include "NullRenderer.h"
+
+RenderStateNull::RenderStateNull()
+{
+	id = NullRenderer::nextId();
+}
+
+RenderStateNull::~RenderStateNull()
+{
+}
+
+void RenderStateNull::setWireFrame(bool wireframe)
+{
+	this->wireframe = wireframe;
+}
+
+void RenderStateNull::set()
+{
+	if (NullRenderer::stream)
+	{
+		NullRenderer::stream->writeOp(CommandStream::SET_RENDER_STATE);
+		NullRenderer::stream->writeU32(id);
+		NullRenderer::stream->writeU32(wireframe);
+	}
+}
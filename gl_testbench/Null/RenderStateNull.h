@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+#include "../RenderState.h"
+
+class RenderStateNull final : public RenderState
+{
+public:
+	RenderStateNull();
+	~RenderStateNull();
+	void setWireFrame(bool);
+	void set();
+
+	uint32_t id;
+private:
+	bool wireframe = false;
+};
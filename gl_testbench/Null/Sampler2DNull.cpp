@@ -0,0 +1,25 @@
+#include "Sampler2DNull.h"
+
+Sampler2DNull::Sampler2DNull()
+{
+}
+
+Sampler2DNull::~Sampler2DNull()
+{
+}
+
+void Sampler2DNull::setMagFilter(FILTER filter)
+{
+	magFilter = filter;
+}
+
+void Sampler2DNull::setMinFilter(FILTER filter)
+{
+	minFilter = filter;
+}
+
+void Sampler2DNull::setWrap(WRAPPING s, WRAPPING t)
+{
+	wrapS = s;
+	wrapT = t;
+}
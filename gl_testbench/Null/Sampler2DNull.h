@@ -0,0 +1,15 @@
+#pragma once
+#include "../Sampler2D.h"
+
+class Sampler2DNull final : public Sampler2D
+{
+public:
+	Sampler2DNull();
+	~Sampler2DNull();
+	void setMagFilter(FILTER filter);
+	void setMinFilter(FILTER filter);
+	void setWrap(WRAPPING s, WRAPPING t);
+
+	FILTER magFilter = LINEAR, minFilter = LINEAR;
+	WRAPPING wrapS = CLAMP, wrapT = CLAMP;
+};
@@ -0,0 +1,25 @@
+#include "TechniqueNull.h"
+#include "NullRenderer.h"
+#include "MaterialNull.h"
+#include "../StaticBackend.h"
+#include "../Mesh.h"
+
+TechniqueNull::TechniqueNull(Material* m, RenderState* r) : Technique(m, r)
+{
+	id = NullRenderer::nextId();
+}
+
+TechniqueNull::~TechniqueNull()
+{
+}
+
+void TechniqueNull::enable(Renderer* renderer)
+{
+	direct<NullRenderer>(renderer)->setRenderState(renderState);
+	direct<MaterialNull>(material)->enable();
+}
+
+bool TechniqueNull::sortMesh(const Mesh* meshA, const Mesh* meshB)
+{
+	return ((TechniqueNull*)meshA->technique)->id < ((TechniqueNull*)meshB->technique)->id;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "../Technique.h"
+
+class Mesh;
+
+class TechniqueNull final : public Technique
+{
+public:
+	TechniqueNull(Material* m, RenderState* r);
+	~TechniqueNull();
+	// the same as Technique::enable, on the Null classes (see StaticBackend.h).
+	void enable(Renderer* renderer);
+
+	static bool sortMesh(const Mesh* meshA, const Mesh* meshB);
+
+	uint32_t id;
+};
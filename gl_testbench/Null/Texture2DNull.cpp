@@ -0,0 +1,28 @@
+#include "Texture2DNull.h"
+#include "NullRenderer.h"
+
+Texture2DNull::Texture2DNull()
+{
+	id = NullRenderer::nextId();
+}
+
+Texture2DNull::~Texture2DNull()
+{
+}
+
+int Texture2DNull::loadFromFile(std::string filename)
+{
+	this->filename = filename;
+	return 0;
+}
+
+void Texture2DNull::bind(unsigned int slot)
+{
+	FrameStats::current.textureBinds++;
+	if (NullRenderer::stream)
+	{
+		NullRenderer::stream->writeOp(CommandStream::BIND_TEXTURE);
+		NullRenderer::stream->writeU32(id);
+		NullRenderer::stream->writeU32(slot);
+	}
+}
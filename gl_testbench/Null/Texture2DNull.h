@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+#include "../Texture2D.h"
+
+class Texture2DNull final : public Texture2D
+{
+public:
+	Texture2DNull();
+	~Texture2DNull();
+
+	// the image is not decoded, only the file name is kept.
+	int loadFromFile(std::string filename);
+	void bind(unsigned int slot);
+
+	uint32_t id;
+private:
+	std::string filename;
+};
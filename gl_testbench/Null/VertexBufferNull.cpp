@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "VertexBufferNull.h"
+#include "NullRenderer.h"
+#include "../MemoryTracker.h"
+
+VertexBufferNull::VertexBufferNull(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	totalSize = size;
+	memory = (unsigned char*)malloc(size);
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory, MemoryTracker::SYSTEM_MEMORY, size);
+	id = NullRenderer::nextId();
+}
+
+VertexBufferNull::~VertexBufferNull()
+{
+	MemoryTracker::release(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory);
+	free(memory);
+}
+
+void VertexBufferNull::setData(const void* data, size_t size, size_t offset)
+{
+	if (offset + size > totalSize)
+	{
+		fprintf(stderr, "VertexBufferNull::setData out of range\n");
+		exit(-1);
+	}
+	memcpy(memory + offset, data, size);
+	FrameStats::current.stagingBytes += size;
+}
+
+void VertexBufferNull::bind(size_t offset, size_t size, unsigned int location)
+{
+	FrameStats::current.vertexBufferBinds++;
+	if (NullRenderer::stream)
+	{
+		NullRenderer::stream->writeOp(CommandStream::BIND_VERTEX_BUFFER);
+		NullRenderer::stream->writeU32(id);
+		NullRenderer::stream->writeU64(offset);
+		NullRenderer::stream->writeU64(size);
+		NullRenderer::stream->writeU32(location);
+	}
+}
+
+void VertexBufferNull::unbind()
+{
+}
+
+size_t VertexBufferNull::getSize()
+{
+	return totalSize;
+}
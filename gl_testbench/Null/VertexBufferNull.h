@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include "../VertexBuffer.h"
+
+class VertexBufferNull final : public VertexBuffer
+{
+public:
+	VertexBufferNull(size_t size, VertexBuffer::DATA_USAGE usage);
+	~VertexBufferNull();
+
+	void setData(const void* data, size_t size, size_t offset);
+	void bind(size_t offset, size_t size, unsigned int location);
+	void unbind();
+	size_t getSize();
+
+	uint32_t id;
+private:
+	size_t totalSize;
+	// CPU copy, stands in for the GPU buffer.
+	unsigned char* memory;
+};
@@ -0,0 +1,307 @@
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include "OcclusionCuller.h"
+#include "FrameStats.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define OCCLUSION_CULLER_SSE
+#include <emmintrin.h>
+#endif
+
+const int OcclusionCuller::WIDTH;
+const int OcclusionCuller::HEIGHT;
+const int OcclusionCuller::TILE;
+const int OcclusionCuller::BLOCK;
+
+namespace {
+	const int TILES_X = OcclusionCuller::WIDTH / OcclusionCuller::TILE;
+	const int TILES_Y = OcclusionCuller::HEIGHT / OcclusionCuller::TILE;
+	const int BLOCKS_PER_TILE = OcclusionCuller::TILE / OcclusionCuller::BLOCK;
+	// clip w below this counts as on or behind the eye.
+	const float MIN_W = 1e-6f;
+}
+
+OcclusionCuller::OcclusionCuller()
+{
+	bins.resize(TILES_X * TILES_Y);
+	depth.assign(WIDTH * HEIGHT, 1.0f);
+	int width = WIDTH / BLOCK, height = HEIGHT / BLOCK;
+	while (true)
+	{
+		Level level;
+		level.width = width;
+		level.height = height;
+		level.nearest.assign(width * height, 1.0f);
+		level.farthest.assign(width * height, 1.0f);
+		levels.push_back(level);
+		if (width == 1 && height == 1)
+			break;
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+	}
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+void OcclusionCuller::setOccluders(const glm::vec3* vertices, size_t count)
+{
+	occluders.assign(vertices, vertices + count - count % 3);
+	triangles.reserve(occluders.size() / 3);
+}
+
+void OcclusionCuller::clearOccluders()
+{
+	occluders.clear();
+}
+
+/*
+ Pixel coordinates (y down, centers at .5), counter clockwise. Edge i goes
+ from vertex i to i + 1 and is positive on the side of the third vertex.
+ The depth plane is raised by half its gradient: the farthest depth the
+ triangle has inside the pixel instead of the one at its center.
+*/
+bool OcclusionCuller::setup(const glm::vec4 clip[3], Triangle& tri)
+{
+	float x[3], y[3], z[3];
+	for (int i = 0; i < 3; i++)
+	{
+		if (clip[i].w < MIN_W || clip[i].z < -clip[i].w)
+			return false;
+		x[i] = (clip[i].x / clip[i].w * 0.5f + 0.5f) * WIDTH;
+		y[i] = (0.5f - clip[i].y / clip[i].w * 0.5f) * HEIGHT;
+		z[i] = clip[i].z / clip[i].w * 0.5f + 0.5f;
+	}
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (fabsf(area) < 1e-6f)
+		return false;
+	if (area < 0.0f)
+	{
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(z[1], z[2]);
+		area = -area;
+	}
+
+	tri.depthA = tri.depthB = tri.depthC = 0.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		const int j = (i + 1) % 3;
+		const float a = y[i] - y[j];
+		const float b = x[j] - x[i];
+		const float c = -(a * x[i] + b * y[i]);
+		tri.edgeA[i] = a;
+		tri.edgeB[i] = b;
+		tri.edgeC[i] = c;
+		// edge i over the area is the weight of the vertex opposite to it.
+		const float w = z[(i + 2) % 3] / area;
+		tri.depthA += a * w;
+		tri.depthB += b * w;
+		tri.depthC += c * w;
+	}
+	tri.depthC += 0.5f * (fabsf(tri.depthA) + fabsf(tri.depthB));
+
+	tri.minX = std::max((int)floorf(std::min({ x[0], x[1], x[2] })), 0);
+	tri.minY = std::max((int)floorf(std::min({ y[0], y[1], y[2] })), 0);
+	tri.maxX = std::min((int)ceilf(std::max({ x[0], x[1], x[2] })), WIDTH) - 1;
+	tri.maxY = std::min((int)ceilf(std::max({ y[0], y[1], y[2] })), HEIGHT) - 1;
+	return tri.minX <= tri.maxX && tri.minY <= tri.maxY;
+}
+
+void OcclusionCuller::rasterizeTile(size_t tile)
+{
+	const int tileX = (int)(tile % TILES_X) * TILE;
+	const int tileY = (int)(tile / TILES_X) * TILE;
+	for (int y = tileY; y < tileY + TILE; y++)
+		std::fill(&depth[y * WIDTH + tileX], &depth[y * WIDTH + tileX] + TILE, 1.0f);
+
+	for (uint32_t index : bins[tile])
+	{
+		const Triangle& tri = triangles[index];
+		// whole groups of 4 pixels, the edges reject the ones outside.
+		const int x0 = std::max(tri.minX, tileX) & ~3;
+		const int x1 = std::min(tri.maxX, tileX + TILE - 1);
+		const int y0 = std::max(tri.minY, tileY);
+		const int y1 = std::min(tri.maxY, tileY + TILE - 1);
+		for (int y = y0; y <= y1; y++)
+		{
+			const float cy = y + 0.5f;
+			float* row = &depth[y * WIDTH];
+#ifdef OCCLUSION_CULLER_SSE
+			const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			const __m128 zero = _mm_setzero_ps();
+			__m128 a[3], rowC[3];
+			for (int i = 0; i < 3; i++)
+			{
+				a[i] = _mm_set1_ps(tri.edgeA[i]);
+				rowC[i] = _mm_set1_ps(tri.edgeB[i] * cy + tri.edgeC[i]);
+			}
+			const __m128 depthA = _mm_set1_ps(tri.depthA);
+			const __m128 depthC = _mm_set1_ps(tri.depthB * cy + tri.depthC);
+			for (int x = x0; x <= x1; x += 4)
+			{
+				const __m128 cx = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+				__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a[0], cx), rowC[0]), zero);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a[1], cx), rowC[1]), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a[2], cx), rowC[2]), zero));
+				const __m128 z = _mm_add_ps(_mm_mul_ps(depthA, cx), depthC);
+				const __m128 old = _mm_loadu_ps(row + x);
+				const __m128 nearer = _mm_min_ps(old, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+			}
+#else
+			for (int x = x0; x <= x1; x++)
+			{
+				const float cx = x + 0.5f;
+				bool inside = true;
+				for (int i = 0; i < 3; i++)
+					inside = inside && tri.edgeA[i] * cx + tri.edgeB[i] * cy + tri.edgeC[i] >= 0.0f;
+				if (inside)
+					row[x] = std::min(row[x], tri.depthA * cx + tri.depthB * cy + tri.depthC);
+			}
+#endif
+		}
+	}
+
+	// level 0 blocks of the tile.
+	Level& blocks = levels[0];
+	for (int by = 0; by < BLOCKS_PER_TILE; by++)
+	{
+		for (int bx = 0; bx < BLOCKS_PER_TILE; bx++)
+		{
+			const int px = tileX + bx * BLOCK;
+			const int py = tileY + by * BLOCK;
+			float nearest = 1.0f, farthest = 0.0f;
+			for (int y = py; y < py + BLOCK; y++)
+			{
+				for (int x = px; x < px + BLOCK; x++)
+				{
+					nearest = std::min(nearest, depth[y * WIDTH + x]);
+					farthest = std::max(farthest, depth[y * WIDTH + x]);
+				}
+			}
+			const int b = (py / BLOCK) * blocks.width + px / BLOCK;
+			blocks.nearest[b] = nearest;
+			blocks.farthest[b] = farthest;
+		}
+	}
+}
+
+void OcclusionCuller::reduceLevel(size_t level)
+{
+	const Level& below = levels[level - 1];
+	Level& l = levels[level];
+	for (int y = 0; y < l.height; y++)
+	{
+		for (int x = 0; x < l.width; x++)
+		{
+			float nearest = 1.0f, farthest = 0.0f;
+			for (int sy = 2 * y; sy < std::min(2 * y + 2, below.height); sy++)
+			{
+				for (int sx = 2 * x; sx < std::min(2 * x + 2, below.width); sx++)
+				{
+					nearest = std::min(nearest, below.nearest[sy * below.width + sx]);
+					farthest = std::max(farthest, below.farthest[sy * below.width + sx]);
+				}
+			}
+			l.nearest[y * l.width + x] = nearest;
+			l.farthest[y * l.width + x] = farthest;
+		}
+	}
+}
+
+void OcclusionCuller::render(const glm::mat4& matrix)
+{
+	PROFILE_ZONE("renderOcclusion");
+	const auto start = std::chrono::steady_clock::now();
+	viewProjection = matrix;
+
+	triangles.clear();
+	for (auto& bin : bins)
+		bin.clear();
+	for (size_t v = 0; v + 2 < occluders.size(); v += 3)
+	{
+		const glm::vec4 clip[3] = {
+			matrix * glm::vec4(occluders[v], 1.0f),
+			matrix * glm::vec4(occluders[v + 1], 1.0f),
+			matrix * glm::vec4(occluders[v + 2], 1.0f) };
+		Triangle tri;
+		if (!setup(clip, tri))
+			continue;
+		const uint32_t index = (uint32_t)triangles.size();
+		triangles.push_back(tri);
+		for (int ty = tri.minY / TILE; ty <= tri.maxY / TILE; ty++)
+			for (int tx = tri.minX / TILE; tx <= tri.maxX / TILE; tx++)
+				bins[ty * TILES_X + tx].push_back(index);
+	}
+
+	JobSystem::shared().parallelFor(bins.size(), [this](size_t tile) {
+		rasterizeTile(tile);
+	});
+	for (size_t level = 1; level < levels.size(); level++)
+		reduceLevel(level);
+
+	FrameStats::current.occluderTriangles += (uint32_t)triangles.size();
+	FrameStats::current.occlusionMicros += (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+bool OcclusionCuller::visible(const Aabb& box) const
+{
+	if (box.empty())
+		return true;
+	const glm::vec4 xs[2] = { viewProjection[0] * box.min.x, viewProjection[0] * box.max.x };
+	const glm::vec4 ys[2] = { viewProjection[1] * box.min.y, viewProjection[1] * box.max.y };
+	const glm::vec4 zs[2] = { viewProjection[2] * box.min.z + viewProjection[3], viewProjection[2] * box.max.z + viewProjection[3] };
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, boxDepth = FLT_MAX;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		const glm::vec4 clip = xs[corner & 1] + ys[(corner >> 1) & 1] + zs[corner >> 2];
+		if (clip.w < MIN_W || clip.z < -clip.w)
+			return true;
+		const float x = (clip.x / clip.w * 0.5f + 0.5f) * WIDTH;
+		const float y = (0.5f - clip.y / clip.w * 0.5f) * HEIGHT;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		boxDepth = std::min(boxDepth, clip.z / clip.w * 0.5f + 0.5f);
+	}
+	// off screen is for the frustum test.
+	if (maxX <= 0.0f || maxY <= 0.0f || minX >= WIDTH || minY >= HEIGHT)
+		return true;
+
+	// blocks under the pixels the rectangle touches.
+	const int bx0 = std::max((int)floorf(minX), 0) / BLOCK;
+	const int by0 = std::max((int)floorf(minY), 0) / BLOCK;
+	const int bx1 = std::max(std::min((int)ceilf(maxX), WIDTH) - 1, 0) / BLOCK;
+	const int by1 = std::max(std::min((int)ceilf(maxY), HEIGHT) - 1, 0) / BLOCK;
+	size_t level = 0;
+	while (level + 1 < levels.size() && ((bx1 >> level) - (bx0 >> level) > 1 || (by1 >> level) - (by0 >> level) > 1))
+		level++;
+
+	for (size_t l = level + 1; l-- > 0;)
+	{
+		const Level& texels = levels[l];
+		bool hidden = true;
+		for (int y = by0 >> l; y <= by1 >> l; y++)
+		{
+			for (int x = bx0 >> l; x <= bx1 >> l; x++)
+			{
+				const int t = y * texels.width + x;
+				// in front of every occluder there, finer levels cannot hide it either.
+				if (texels.nearest[t] >= boxDepth)
+					return true;
+				if (texels.farthest[t] >= boxDepth)
+					hidden = false;
+			}
+		}
+		if (hidden)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+/*
+ CPU occlusion culling against a small depth buffer. The occluders (world
+ space triangles, set once) are rasterized every frame into WIDTH x HEIGHT
+ pixels, one job per TILE x TILE tile on JobSystem::shared() and 4 pixels
+ per SSE instruction, then the buffer is reduced into a hierarchy of the
+ nearest and farthest depth per block: BLOCK x BLOCK pixels at level 0,
+ 2 x 2 blocks of the level below at each level above.
+
+	culler.setOccluders(triangles, 3 * count);
+	culler.render(camera.getConstants().viewProjection);
+	if (culler.visible(mesh->bounds)) ...        // or scene.cull(frustum, visible, &culler)
+
+ visible() projects the box to a screen rectangle and its nearest depth,
+ and walks the hierarchy from the level where the rectangle is a couple of
+ blocks wide down: the box is hidden when it is behind the farthest depth
+ of every block it covers, and visible as soon as it is in front of the
+ nearest depth of one of them.
+
+ Coverage is sampled at pixel centers like the GPU does, so the edge of
+ an occluder can be off by half a pixel of this buffer (inner coverage
+ would leave a line of holes along every edge the triangles share). The
+ depth a pixel takes is the farthest the triangle has inside it.
+ Triangles crossing the near plane are skipped, and boxes crossing it
+ are visible. Depth is GL window depth (NDC z * 0.5 + 0.5).
+ Runs on the CPU only, so it works the same on every backend and driver
+ (lavapipe and llvmpipe included), without waiting on GPU queries.
+*/
+class OcclusionCuller
+{
+public:
+	static const int WIDTH = 256;
+	static const int HEIGHT = 128;
+	static const int TILE = 32;
+	static const int BLOCK = 8;
+
+	OcclusionCuller();
+	~OcclusionCuller();
+
+	// 3 vertices per triangle, either winding.
+	void setOccluders(const glm::vec3* vertices, size_t count);
+	void clearOccluders();
+	size_t occluderTriangles() const { return occluders.size() / 3; };
+
+	// rasterizes the occluders, adds its time to FrameStats::current.
+	void render(const glm::mat4& viewProjection);
+	// thread safe between render() calls.
+	bool visible(const Aabb& box) const;
+
+	// depth of the last render(), WIDTH per row, 1 where no occluder.
+	const float* getDepthBuffer() const { return depth.data(); };
+private:
+	// edge functions and depth plane in pixels, see setup().
+	struct Triangle {
+		float edgeA[3], edgeB[3], edgeC[3];
+		float depthA, depthB, depthC;
+		int minX, minY, maxX, maxY;
+	};
+	struct Level {
+		int width, height;
+		std::vector<float> nearest, farthest;
+	};
+
+	static bool setup(const glm::vec4 clip[3], Triangle& tri);
+	void rasterizeTile(size_t tile);
+	void reduceLevel(size_t level);
+
+	std::vector<glm::vec3> occluders;
+	std::vector<Triangle> triangles;
+	std::vector<std::vector<uint32_t>> bins;
+	std::vector<float> depth;
+	std::vector<Level> levels;
+	glm::mat4 viewProjection;
+};
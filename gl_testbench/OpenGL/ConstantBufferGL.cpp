@@ -1,5 +1,8 @@
+#include <string.h>
 #include "ConstantBufferGL.h"
 #include "MaterialGL.h"
+#include "../FrameStats.h"
+#include "../MemoryTracker.h"
 
 ConstantBufferGL::ConstantBufferGL(std::string NAME, unsigned int location) 
 {
@@ -17,6 +20,7 @@ ConstantBufferGL::~ConstantBufferGL()
 {
 	if (handle != 0)
 	{
+		MemoryTracker::release(MemoryTracker::CATEGORY::CONSTANT, handle);
 		glDeleteBuffers(1, &handle);
 		handle = 0;
 	};
@@ -25,11 +29,15 @@ ConstantBufferGL::~ConstantBufferGL()
 // this allows us to not know in advance the type of the receiving end, vec3, vec4, etc.
 void ConstantBufferGL::setData(const void* data, size_t size, Material* m, unsigned int location)
 {
+	if (perDrawBuffer != 0 || handle == 0)
+		revision++;
+	perDrawBuffer = 0;
 	if (handle == 0)
 	{
 		glGenBuffers(1, &handle);
 		glBindBuffer(GL_UNIFORM_BUFFER, handle);
 		glBufferData(GL_UNIFORM_BUFFER, size, data, GL_STATIC_DRAW);
+		MemoryTracker::allocate(MemoryTracker::CATEGORY::CONSTANT, handle, MemoryTracker::DRIVER_MEMORY, size);
 	}
 	else
 		glBindBuffer(GL_UNIFORM_BUFFER, handle);
@@ -37,6 +45,9 @@ void ConstantBufferGL::setData(const void* data, size_t size, Material* m, unsig
 	void* dest = glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
 	memcpy(dest, data, size);
 	glUnmapBuffer(GL_UNIFORM_BUFFER);
+	FrameStats::current.bufferMaps++;
+	FrameStats::current.bufferUnmaps++;
+	FrameStats::current.uniformBytes += size;
 
 	//if (buff == nullptr)
 	//{
@@ -62,8 +73,34 @@ void ConstantBufferGL::setData(const void* data, size_t size, Material* m, unsig
 	glBindBuffer(GL_UNIFORM_BUFFER,0);
 }
 
+void ConstantBufferGL::getRange(GLuint& buffer, GLintptr& offset, GLsizeiptr& size) const
+{
+	if (perDrawBuffer)
+	{
+		buffer = perDrawBuffer;
+		offset = perDrawOffset;
+		size = 4 * sizeof(float);
+		return;
+	}
+	buffer = handle;
+	offset = 0;
+	size = 0;
+}
+
+void ConstantBufferGL::attach(GLuint buffer, GLintptr offset)
+{
+	perDrawBuffer = buffer;
+	perDrawOffset = offset;
+	revision++;
+}
+
 void ConstantBufferGL::bind(Material* m)
 {
+	if (perDrawBuffer)
+	{
+		glBindBufferRange(GL_UNIFORM_BUFFER, location, perDrawBuffer, perDrawOffset, 4 * sizeof(float));
+		return;
+	}
 	glBindBuffer(GL_UNIFORM_BUFFER, handle);
 	glBindBufferBase(GL_UNIFORM_BUFFER, location, handle);
 }
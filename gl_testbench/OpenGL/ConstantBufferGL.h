@@ -9,6 +9,12 @@ public:
 	~ConstantBufferGL();
 	void setData(const void* data, size_t size, Material* m, unsigned int location);
 	void bind(Material*);
+	// binds offset of buffer (a slot of the renderer's per-draw buffer)
+	// instead of its own buffer, until the next setData.
+	void attach(GLuint buffer, GLintptr offset);
+	// what bind() binds at getLocation(), size 0 for the whole buffer.
+	void getRange(GLuint& buffer, GLintptr& offset, GLsizeiptr& size) const;
+	GLuint getLocation() const { return location; };
 
 private:
 
@@ -18,5 +24,7 @@ private:
 	GLuint index;
 	void* buff = nullptr;
 	void* lastMat;
+	GLuint perDrawBuffer = 0;
+	GLintptr perDrawOffset = 0;
 };
 
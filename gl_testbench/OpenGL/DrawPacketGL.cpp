@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "DrawPacketGL.h"
+#include "ConstantBufferGL.h"
+#include "VertexBufferGL.h"
+#include "IndexBufferGL.h"
+#include "Texture2DGL.h"
+#include "Sampler2DGL.h"
+#include "../Mesh.h"
+#include "../FrameStats.h"
+
+const uint32_t DrawPacketGL::MAX_STREAMS;
+const uint32_t DrawPacketGL::MAX_TEXTURES;
+const GLint DrawPacketGL::NO_FIRST_VERTEX;
+
+void DrawPacketGL::compile(Mesh* mesh, DrawPacketGL& packet)
+{
+	if (mesh->geometryBuffers.size() > MAX_STREAMS || mesh->textures.size() > MAX_TEXTURES)
+	{
+		fprintf(stderr, "mesh with %zu streams and %zu textures does not fit a draw packet\n",
+			mesh->geometryBuffers.size(), mesh->textures.size());
+		exit(-1);
+	}
+	packet.technique = mesh->technique;
+	// the count of stream 0, as frame() always did.
+	auto first = mesh->geometryBuffers.find(0);
+	packet.vertexCount = first == mesh->geometryBuffers.end() ? 0 : (GLsizei)first->second.numElements;
+
+	IndexBufferGL* ib = (IndexBufferGL*)mesh->indexBuffer.buffer;
+	packet.indexBuffer = ib ? ib->getHandle() : 0;
+	packet.indexType = ib ? ib->getType() : GL_UNSIGNED_INT;
+	packet.indexOffset = ib ? (GLintptr)mesh->indexBuffer.offset : 0;
+	if (ib)
+		packet.vertexCount = (GLsizei)mesh->indexBuffer.count;
+
+	packet.streamCount = 0;
+	packet.firstVertex = NO_FIRST_VERTEX;
+	for (auto& g : mesh->geometryBuffers)
+	{
+		const uint32_t s = packet.streamCount++;
+		packet.streamLocations[s] = g.first;
+		packet.streamBuffers[s] = ((VertexBufferGL*)g.second.buffer)->getHandle();
+		packet.streamOffsets[s] = g.second.offset;
+		packet.streamSizes[s] = g.second.numElements * g.second.sizeElement;
+		const bool whole = g.second.sizeElement != 0 && g.second.offset % g.second.sizeElement == 0;
+		const GLint first = !whole ? NO_FIRST_VERTEX : (GLint)(g.second.offset / g.second.sizeElement);
+		if (s == 0)
+			packet.firstVertex = first;
+		else if (first != packet.firstVertex)
+			packet.firstVertex = NO_FIRST_VERTEX;
+	}
+
+	packet.textureCount = 0;
+	for (auto& t : mesh->textures)
+	{
+		const uint32_t s = packet.textureCount++;
+		packet.textureSlots[s] = t.first;
+		packet.textures[s] = (Texture2DGL*)t.second;
+	}
+
+	ConstantBufferGL* cb = (ConstantBufferGL*)mesh->txBuffer;
+	packet.uniformLocation = cb->getLocation();
+	cb->getRange(packet.uniformBuffer, packet.uniformOffset, packet.uniformSize);
+	packet.firstInstance = packet.uniformSize ? (GLuint)(packet.uniformOffset / (4 * sizeof(float))) : 0;
+
+	packet.meshRevision = mesh->getRevision();
+	packet.constantsRevision = cb->getRevision();
+}
+
+void DrawPacketGL::bindTextures() const
+{
+	// the same calls Texture2DGL::bind makes.
+	glBindTexture(GL_TEXTURE_2D, 0);
+	for (uint32_t t = 0; t < textureCount; t++)
+	{
+		const GLuint slot = textureSlots[t];
+		glActiveTexture(GL_TEXTURE0 + slot);
+		glBindTexture(GL_TEXTURE_2D, textures[t]->textureHandle);
+		FrameStats::current.textureBinds++;
+		const Sampler2DGL* s = (const Sampler2DGL*)textures[t]->sampler;
+		if (s != nullptr)
+			Sampler2DGL::bind(slot, s);
+	}
+}
+
+void DrawPacketGL::draw() const
+{
+	// and the ones Mesh::bindIAVertexBuffer and ConstantBufferGL::bind make.
+	bindTextures();
+	for (uint32_t s = 0; s < streamCount; s++)
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, streamLocations[s], streamBuffers[s], streamOffsets[s], streamSizes[s]);
+	FrameStats::current.vertexBufferBinds += streamCount;
+	if (uniformSize)
+		glBindBufferRange(GL_UNIFORM_BUFFER, uniformLocation, uniformBuffer, uniformOffset, uniformSize);
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+		glBindBufferBase(GL_UNIFORM_BUFFER, uniformLocation, uniformBuffer);
+	}
+	// gl_BaseInstanceARB indexes the translation buffer (TRANSLATION_BUFFER).
+	if (indexBuffer)
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		if (firstInstance)
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES, vertexCount, indexType, (const void*)indexOffset, 1, firstInstance);
+		else
+			glDrawElements(GL_TRIANGLES, vertexCount, indexType, (const void*)indexOffset);
+	}
+	else if (firstInstance)
+		glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, vertexCount, 1, firstInstance);
+	else
+		glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+	FrameStats::current.drawsIssued++;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <GL/glew.h>
+
+class Mesh;
+class Technique;
+class Texture2DGL;
+
+/*
+ Everything OpenGLRenderer::frame() needs to draw one mesh, resolved to GL
+ names and ranges by compile(), so the draw loop does no map lookups and
+ no virtual calls (the technique is enabled when it changes).
+
+ MeshGL keeps its packet and recompiles it when the revision of the mesh
+ or of its translation buffer changes, submit copies it into the frame's
+ draw list.
+*/
+struct DrawPacketGL
+{
+	static const uint32_t MAX_STREAMS = 4;
+	static const uint32_t MAX_TEXTURES = 2;
+	static const GLint NO_FIRST_VERTEX = -1;
+
+	Technique* technique;
+	// the index count of indexed meshes.
+	GLsizei vertexCount;
+	// of every stream when they are bound whole, NO_FIRST_VERTEX when the
+	// offsets do not agree (see OpenGLRenderer::setGpuCulling).
+	GLint firstVertex;
+
+	// element array of Mesh::setIndexBuffer, indexBuffer 0 draws the
+	// vertices in order. The pulling shaders read gl_VertexID, which is the
+	// index in an indexed draw, so they need no change.
+	GLuint indexBuffer;
+	GLenum indexType;
+	GLintptr indexOffset;
+
+	// vertex pulling, shader storage ranges.
+	uint32_t streamCount;
+	GLuint streamLocations[MAX_STREAMS];
+	GLuint streamBuffers[MAX_STREAMS];
+	GLintptr streamOffsets[MAX_STREAMS];
+	GLsizeiptr streamSizes[MAX_STREAMS];
+
+	// name and sampler are read when drawing, they may be set after compile.
+	uint32_t textureCount;
+	GLuint textureSlots[MAX_TEXTURES];
+	const Texture2DGL* textures[MAX_TEXTURES];
+
+	// translation block, uniformSize 0 binds the whole buffer.
+	GLuint uniformLocation;
+	GLuint uniformBuffer;
+	GLintptr uniformOffset;
+	GLsizeiptr uniformSize;
+	// float4 index of an attached translation, the base instance of the
+	// draw for shaders reading the translation buffer (TRANSLATION_BUFFER).
+	GLuint firstInstance;
+
+	// revisions of the mesh and its txBuffer the packet was compiled from.
+	unsigned int meshRevision;
+	unsigned int constantsRevision;
+
+	// exits when the mesh has more than MAX_STREAMS streams or MAX_TEXTURES textures.
+	static void compile(Mesh* mesh, DrawPacketGL& packet);
+	void bindTextures() const;
+	// binds the textures, streams and translation and draws.
+	void draw() const;
+
+	// the PER_TECHNIQUE order of OpenGLRenderer::frame().
+	static bool byTechnique(const DrawPacketGL& a, const DrawPacketGL& b) { return std::less<Technique*>()(a.technique, b.technique); };
+};
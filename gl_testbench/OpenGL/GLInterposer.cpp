@@ -0,0 +1,187 @@
+#include <stdint.h>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <GL/glew.h>
+#include "GLInterposer.h"
+#include "../ApiTrace.h"
+
+namespace {
+	// the driver's entry points, as loaded by glewInit.
+	PFNGLUSEPROGRAMPROC realUseProgram;
+	PFNGLACTIVETEXTUREPROC realActiveTexture;
+	PFNGLBINDBUFFERPROC realBindBuffer;
+	PFNGLBINDBUFFERBASEPROC realBindBufferBase;
+	PFNGLBINDBUFFERRANGEPROC realBindBufferRange;
+	PFNGLBINDSAMPLERPROC realBindSampler;
+	PFNGLSAMPLERPARAMETERIPROC realSamplerParameteri;
+	PFNGLMAPBUFFERPROC realMapBuffer;
+	PFNGLMAPBUFFERRANGEPROC realMapBufferRange;
+	PFNGLUNMAPBUFFERPROC realUnmapBuffer;
+
+	// what the context has bound, as far as the wrappers have seen.
+	GLuint program = 0;
+	GLenum activeTexture = GL_TEXTURE0;
+	std::map<GLenum, GLuint> buffers;
+	// buffer, offset, size; size 0 for glBindBufferBase.
+	std::map<std::pair<GLenum, GLuint>, std::tuple<GLuint, GLintptr, GLsizeiptr>> indexedBuffers;
+	std::map<GLuint, GLuint> samplers;
+	std::map<std::pair<GLuint, GLenum>, GLint> samplerParameters;
+	// the byte ranges of the buffer mapped in frame, and whether the last map was redundant.
+	struct Mapped {
+		uint64_t frame;
+		std::vector<std::pair<GLintptr, GLintptr>> ranges;
+	};
+	std::map<GLuint, Mapped> mapped;
+	std::map<GLuint, bool> redundantMap;
+
+	// a map is redundant when it overlaps one of the buffer earlier this frame.
+	bool mapRange(GLuint buffer, GLintptr offset, GLintptr end)
+	{
+		const uint64_t frame = ApiTrace::active->frame();
+		Mapped& m = mapped[buffer];
+		if (m.frame != frame)
+		{
+			m.frame = frame;
+			m.ranges.clear();
+		}
+		bool redundant = false;
+		for (auto& r : m.ranges)
+			redundant |= offset < r.second && r.first < end;
+		m.ranges.push_back(std::make_pair(offset, end));
+		redundantMap[buffer] = redundant;
+		return redundant;
+	}
+
+	void GLAPIENTRY traceUseProgram(GLuint p)
+	{
+		ApiTrace::active->call("glUseProgram", API_CALL_SITE(), p == program, { p });
+		program = p;
+		realUseProgram(p);
+	}
+
+	void GLAPIENTRY traceActiveTexture(GLenum texture)
+	{
+		ApiTrace::active->call("glActiveTexture", API_CALL_SITE(), texture == activeTexture, { texture });
+		activeTexture = texture;
+		realActiveTexture(texture);
+	}
+
+	void GLAPIENTRY traceBindBuffer(GLenum target, GLuint buffer)
+	{
+		auto found = buffers.find(target);
+		bool redundant = found != buffers.end() && found->second == buffer;
+		ApiTrace::active->call("glBindBuffer", API_CALL_SITE(), redundant, { target, buffer });
+		buffers[target] = buffer;
+		realBindBuffer(target, buffer);
+	}
+
+	// indexed binds also bind the buffer to the generic target.
+	bool bindIndexed(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+	{
+		auto key = std::make_pair(target, index);
+		auto value = std::make_tuple(buffer, offset, size);
+		auto found = indexedBuffers.find(key);
+		bool redundant = found != indexedBuffers.end() && found->second == value;
+		indexedBuffers[key] = value;
+		buffers[target] = buffer;
+		return redundant;
+	}
+
+	void GLAPIENTRY traceBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+	{
+		bool redundant = bindIndexed(target, index, buffer, 0, 0);
+		ApiTrace::active->call("glBindBufferBase", API_CALL_SITE(), redundant, { target, index, buffer });
+		realBindBufferBase(target, index, buffer);
+	}
+
+	void GLAPIENTRY traceBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+	{
+		bool redundant = bindIndexed(target, index, buffer, offset, size);
+		ApiTrace::active->call("glBindBufferRange", API_CALL_SITE(), redundant,
+			{ target, index, buffer, (uint64_t)offset, (uint64_t)size });
+		realBindBufferRange(target, index, buffer, offset, size);
+	}
+
+	void GLAPIENTRY traceBindSampler(GLuint unit, GLuint sampler)
+	{
+		auto found = samplers.find(unit);
+		bool redundant = found != samplers.end() && found->second == sampler;
+		ApiTrace::active->call("glBindSampler", API_CALL_SITE(), redundant, { unit, sampler });
+		samplers[unit] = sampler;
+		realBindSampler(unit, sampler);
+	}
+
+	void GLAPIENTRY traceSamplerParameteri(GLuint sampler, GLenum pname, GLint param)
+	{
+		auto key = std::make_pair(sampler, pname);
+		auto found = samplerParameters.find(key);
+		bool redundant = found != samplerParameters.end() && found->second == param;
+		ApiTrace::active->call("glSamplerParameteri", API_CALL_SITE(), redundant, { sampler, pname, (uint64_t)param });
+		samplerParameters[key] = param;
+		realSamplerParameteri(sampler, pname, param);
+	}
+
+	void* GLAPIENTRY traceMapBuffer(GLenum target, GLenum access)
+	{
+		GLuint buffer = buffers[target];
+		// the whole buffer.
+		bool redundant = mapRange(buffer, 0, PTRDIFF_MAX);
+		ApiTrace::active->call("glMapBuffer", API_CALL_SITE(), redundant, { target, buffer, access });
+		return realMapBuffer(target, access);
+	}
+
+	void* GLAPIENTRY traceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+	{
+		GLuint buffer = buffers[target];
+		bool redundant = mapRange(buffer, offset, offset + length);
+		ApiTrace::active->call("glMapBufferRange", API_CALL_SITE(), redundant,
+			{ target, buffer, (uint64_t)offset, (uint64_t)length, access });
+		return realMapBufferRange(target, offset, length, access);
+	}
+
+	GLboolean GLAPIENTRY traceUnmapBuffer(GLenum target)
+	{
+		GLuint buffer = buffers[target];
+		// an unmap is redundant exactly when its map was.
+		ApiTrace::active->call("glUnmapBuffer", API_CALL_SITE(), redundantMap[buffer], { target, buffer });
+		return realUnmapBuffer(target);
+	}
+}
+
+void installGLInterposer()
+{
+	// glewInit of a new context reloads the table: start over.
+	if (ApiTrace::active == nullptr || __glewUseProgram == traceUseProgram)
+		return;
+	program = 0;
+	activeTexture = GL_TEXTURE0;
+	buffers.clear();
+	indexedBuffers.clear();
+	samplers.clear();
+	samplerParameters.clear();
+	mapped.clear();
+	redundantMap.clear();
+
+	realUseProgram = __glewUseProgram;
+	realActiveTexture = __glewActiveTexture;
+	realBindBuffer = __glewBindBuffer;
+	realBindBufferBase = __glewBindBufferBase;
+	realBindBufferRange = __glewBindBufferRange;
+	realBindSampler = __glewBindSampler;
+	realSamplerParameteri = __glewSamplerParameteri;
+	realMapBuffer = __glewMapBuffer;
+	realMapBufferRange = __glewMapBufferRange;
+	realUnmapBuffer = __glewUnmapBuffer;
+
+	__glewUseProgram = traceUseProgram;
+	__glewActiveTexture = traceActiveTexture;
+	__glewBindBuffer = traceBindBuffer;
+	__glewBindBufferBase = traceBindBufferBase;
+	__glewBindBufferRange = traceBindBufferRange;
+	__glewBindSampler = traceBindSampler;
+	__glewSamplerParameteri = traceSamplerParameteri;
+	__glewMapBuffer = traceMapBuffer;
+	__glewMapBufferRange = traceMapBufferRange;
+	__glewUnmapBuffer = traceUnmapBuffer;
+}
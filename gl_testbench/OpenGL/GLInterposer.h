@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+ Replaces the GLEW entry points the backend calls per frame with wrappers
+ that report to ApiTrace::active. A call counts as redundant when it sets
+ state that is already set:
+
+	glUseProgram			same program
+	glActiveTexture			same unit
+	glBindBuffer			same buffer on the target
+	glBindBufferBase/Range	same buffer (and range) on the indexed target
+	glBindSampler			same sampler on the unit
+	glSamplerParameteri		same value for the parameter
+	glMapBuffer				buffer already mapped this frame
+	glMapBufferRange		range overlaps one already mapped this frame
+	glUnmapBuffer			its map was redundant
+
+ Only GLEW's function table can be swapped; GL 1.1 functions (glBindTexture,
+ glTexParameteri, glDrawArrays) are linked directly and stay untraced.
+ Object names are not forgotten on delete, a recycled name may look
+ redundant once.
+
+ Call after glewInit(), with ApiTrace::active set.
+*/
+void installGLInterposer();
@@ -0,0 +1,47 @@
+#include "GpuProfilerGL.h"
+
+GpuProfilerGL::GpuProfilerGL()
+{
+	queries.resize(LATENCY * MAX_MARKS);
+	glGenQueries((GLsizei)queries.size(), queries.data());
+	ticks.resize(MAX_MARKS);
+}
+
+GpuProfilerGL::~GpuProfilerGL()
+{
+	glDeleteQueries((GLsizei)queries.size(), queries.data());
+}
+
+void GpuProfilerGL::beginFrame()
+{
+	frameCount++;
+	const uint32_t slot = (uint32_t)(frameCount % LATENCY);
+	const uint32_t count = pendingMarks(slot);
+	if (count > 0)
+	{
+		// the marks complete in order, the last one being available is enough.
+		GLint available = 0;
+		glGetQueryObjectiv(queries[slot * MAX_MARKS + count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			for (uint32_t i = 0; i < count; i++)
+				glGetQueryObjectui64v(queries[slot * MAX_MARKS + i], GL_QUERY_RESULT, &ticks[i]);
+			resolve(slot, ticks.data(), 1.0);
+		}
+		else
+			drop(slot);
+	}
+	beginMarks(frameCount);
+}
+
+void GpuProfilerGL::mark(uint32_t scope)
+{
+	uint32_t query = nextMark(scope);
+	if (query != NO_QUERY)
+		glQueryCounter(queries[query], GL_TIMESTAMP);
+}
+
+void GpuProfilerGL::end()
+{
+	glQueryCounter(queries[endMark()], GL_TIMESTAMP);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <vector>
+#include <GL/glew.h>
+#include "../GpuProfiler.h"
+
+/*
+ GL_TIMESTAMP counters (glQueryCounter), LATENCY * MAX_MARKS query objects.
+ Timestamps instead of GL_TIME_ELAPSED queries, which cannot overlap, so
+ the technique intervals and the whole frame come from the same marks.
+*/
+class GpuProfilerGL : public GpuProfiler
+{
+public:
+	GpuProfilerGL();
+	~GpuProfilerGL();
+
+	// reads back the frame recorded LATENCY frames ago, starts the next one.
+	void beginFrame();
+	void mark(uint32_t scope);
+	void end();
+private:
+	std::vector<GLuint> queries;
+	uint64_t frameCount = 0;
+	std::vector<uint64_t> ticks;
+};
@@ -0,0 +1,34 @@
+#include "IndexBufferGL.h"
+#include <assert.h>
+#include "../FrameStats.h"
+#include "../MemoryTracker.h"
+
+IndexBufferGL::IndexBufferGL(size_t size, FORMAT format) : IndexBuffer(format)
+{
+	totalSize = size;
+	glGenBuffers(1, &_handle);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _handle);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, _handle, MemoryTracker::DRIVER_MEMORY, size);
+}
+
+IndexBufferGL::~IndexBufferGL()
+{
+	MemoryTracker::release(MemoryTracker::CATEGORY::VERTEX, _handle);
+	glDeleteBuffers(1, &_handle);
+}
+
+void IndexBufferGL::setData(const void* data, size_t size, size_t offset)
+{
+	assert(size + offset <= totalSize);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _handle);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+	FrameStats::current.stagingBytes += size;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+size_t IndexBufferGL::getSize()
+{
+	return totalSize;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <GL/glew.h>
+#include "../IndexBuffer.h"
+
+/*
+ GL_ELEMENT_ARRAY_BUFFER of DrawPacketGL::draw. Filled through
+ GL_COPY_WRITE_BUFFER, so setData does not change the element array
+ binding of the draws.
+*/
+class IndexBufferGL :
+	public IndexBuffer
+{
+public:
+	IndexBufferGL(size_t size, IndexBuffer::FORMAT format);
+	~IndexBufferGL();
+
+	void setData(const void* data, size_t size, size_t offset);
+	size_t getSize();
+	GLuint getHandle() const { return _handle; };
+	// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+	GLenum getType() const { return getFormat() == FORMAT::UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; };
+
+private:
+	size_t totalSize;
+	GLuint _handle;
+};
@@ -1,4 +1,7 @@
+#ifdef _WIN32
+#define NOMINMAX
 #include <windows.h>
+#endif
 #include <streambuf>
 #include <sstream>
 #include <istream>
@@ -6,8 +9,12 @@
 #include <vector>
 #include <set>
 #include <assert.h>
+#include <string.h>
 
 #include "MaterialGL.h"
+#include "../Profiler.h"
+#include "../FrameStats.h"
+#include "../MemoryTracker.h"
 
 typedef unsigned int uint;
 
@@ -83,6 +90,7 @@ MaterialGL::~MaterialGL()
 	for (auto shaderObject : shaderObjects) {
 		glDeleteShader(shaderObject);
 	};
+	MemoryTracker::release(MemoryTracker::CATEGORY::PIPELINE, program);
 	glDeleteProgram(program);
 };
 
@@ -172,30 +180,45 @@ int MaterialGL::compileShader(ShaderType type, std::string& errString)
 
 int MaterialGL::compileMaterial(std::string& errString)
 {
+	PROFILE_ZONE("compileMaterial");
+	// a compute program has its CS and nothing else.
+	const bool compute = shaderFileNames.find(ShaderType::CS) != shaderFileNames.end();
 	// remove all shaders.
 	removeShader(ShaderType::VS);
 	removeShader(ShaderType::PS);
+	removeShader(ShaderType::CS);
 
 	// compile shaders
 	std::string err;
-	if (compileShader(ShaderType::VS, err) < 0) {
-		errString = err;
-		exit(-1);
-	};
-	if (compileShader(ShaderType::PS, err) < 0) {
-		errString = err;
-		exit(-1);
-	};
+	for (ShaderType type : compute ? std::vector<ShaderType>{ ShaderType::CS } : std::vector<ShaderType>{ ShaderType::VS, ShaderType::PS })
+	{
+		if (compileShader(type, err) < 0) {
+			errString = err;
+			return -1;
+		};
+	}
 	
 	// try to link the program
 	// link shader program (connect vs and ps)
 	if (program != 0)
+	{
+		MemoryTracker::release(MemoryTracker::CATEGORY::PIPELINE, program);
 		glDeleteProgram(program);
+	}
 
 	program = glCreateProgram();
-	glAttachShader(program, shaderObjects[(GLuint)ShaderType::VS]);
-	glAttachShader(program, shaderObjects[(GLuint)ShaderType::PS]);
+	if (compute)
+		glAttachShader(program, shaderObjects[(GLuint)ShaderType::CS]);
+	else
+	{
+		glAttachShader(program, shaderObjects[(GLuint)ShaderType::VS]);
+		glAttachShader(program, shaderObjects[(GLuint)ShaderType::PS]);
+	}
 	glLinkProgram(program);
+	// the driver's copy of the program, a lower bound of what it keeps.
+	GLint binaryLength = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::PIPELINE, program, MemoryTracker::DRIVER_MEMORY, binaryLength);
 
 	std::string err2;
 	INFO_OUT(program, Program);
@@ -208,6 +231,7 @@ int MaterialGL::enable() {
 	if (program == 0 || isValid == false)
 		return -1;
 	glUseProgram(program);
+	FrameStats::current.pipelineBinds++;
 
 	for (auto cb : constantBuffers)
 	{
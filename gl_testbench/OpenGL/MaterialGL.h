@@ -6,6 +6,7 @@
 
 class OpenGLRenderer;
 
+#ifdef _WIN32
 #define DBOUTW( s )\
 {\
 std::wostringstream os_;\
@@ -19,6 +20,11 @@ std::ostringstream os_;\
 os_ << s;\
 OutputDebugString( os_.str().c_str() );\
 }
+#else
+// the debugger output window is Windows only.
+#define DBOUTW( s ) {}
+#define DBOUT( s ) {}
+#endif
 
 // use X = {Program or Shader}
 #define INFO_OUT(S,X) { \
@@ -1,6 +1,17 @@
 #include "MeshGL.h"
+#include "../ConstantBuffer.h"
 
 // Mesh::DATA_USAGE is an enum { STATIC, DYNAMIC, DONTCARE };
 
 MeshGL::MeshGL() {}
 MeshGL::~MeshGL() {}
+
+const DrawPacketGL& MeshGL::getPacket()
+{
+	if (!compiled || packet.meshRevision != getRevision() || packet.constantsRevision != txBuffer->getRevision())
+	{
+		DrawPacketGL::compile(this, packet);
+		compiled = true;
+	}
+	return packet;
+}
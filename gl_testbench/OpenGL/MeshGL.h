@@ -1,7 +1,8 @@
 #pragma once
 #include <unordered_map>
-#include <gl\glew.h>
+#include <GL/glew.h>
 #include "../Mesh.h"
+#include "DrawPacketGL.h"
 
 class MeshGL :
 	public Mesh
@@ -9,5 +10,10 @@ class MeshGL :
 public:
 	MeshGL();
 	~MeshGL();
-};
 
+	// the compiled packet, recompiled first if the mesh changed.
+	const DrawPacketGL& getPacket();
+private:
+	DrawPacketGL packet;
+	bool compiled = false;
+};
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <algorithm>
 #include "OpenGLRenderer.h"
 #include <GL/glew.h>
 
@@ -8,8 +9,14 @@
 #include "ResourceBindingGL.h"
 #include "RenderStateGL.h"
 #include "VertexBufferGL.h"
+#include "IndexBufferGL.h"
 #include "ConstantBufferGL.h"
 #include "Texture2DGL.h"
+#include "../Profiler.h"
+#include "../ApiTrace.h"
+#include "../MemoryTracker.h"
+#include "../TransformBatch.h"
+#include "GLInterposer.h"
 
 OpenGLRenderer::OpenGLRenderer()
 {
@@ -21,7 +28,34 @@ OpenGLRenderer::~OpenGLRenderer()
 
 int OpenGLRenderer::shutdown()
 {
+	delete gpuProfiler;
+	gpuProfiler = nullptr;
+	// its material, technique and buffers are in the pools.
+	delete gpuCuller;
+	gpuCuller = nullptr;
+	gpuCulling = false;
+	if (perDrawBuffer)
+	{
+		MemoryTracker::release(MemoryTracker::CATEGORY::CONSTANT, perDrawBuffer);
+		glDeleteBuffers(1, &perDrawBuffer);
+		perDrawBuffer = 0;
+	}
+	if (headless)
+		destroyOffscreenTargets();
+#ifndef _WIN32
+	if (eglDisplay != EGL_NO_DISPLAY)
+	{
+		eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (eglSurface != EGL_NO_SURFACE)
+			eglDestroySurface(eglDisplay, eglSurface);
+		eglDestroyContext(eglDisplay, eglContext);
+		eglTerminate(eglDisplay);
+	}
+	else
+#endif
 	SDL_GL_DeleteContext(context);
+	if (window)
+		SDL_DestroyWindow(window);
 	SDL_Quit();
 	return 0;
 }
@@ -45,7 +79,7 @@ ConstantBuffer* OpenGLRenderer::makeConstantBuffer(std::string NAME, unsigned in
 }
 
 std::string OpenGLRenderer::getShaderPath() {
-	return std::string("..\\assets\\GL45\\");
+	return std::string("../assets/GL45/");
 }
 
 std::string OpenGLRenderer::getShaderExtension() {
@@ -65,6 +99,70 @@ Technique* OpenGLRenderer::makeTechnique(Material* m, RenderState* r) {
 	return t;
 }
 
+MeshHandle OpenGLRenderer::createMesh()
+{
+	return meshPool.create<MeshGL>();
+}
+
+VertexBufferHandle OpenGLRenderer::createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	return vertexBufferPool.create<VertexBufferGL>(size, usage);
+}
+
+Texture2DHandle OpenGLRenderer::createTexture2D()
+{
+	return texturePool.create<Texture2DGL>();
+}
+
+Sampler2DHandle OpenGLRenderer::createSampler2D()
+{
+	return samplerPool.create<Sampler2DGL>();
+}
+
+MaterialHandle OpenGLRenderer::createMaterial(const std::string& name)
+{
+	return materialPool.create<MaterialGL>(name);
+}
+
+TechniqueHandle OpenGLRenderer::createTechnique(MaterialHandle m, RenderState* r)
+{
+	return techniquePool.create<Technique>(get(m), r);
+}
+
+IndexBufferHandle OpenGLRenderer::createIndexBuffer(size_t size, IndexBuffer::FORMAT format)
+{
+	return indexBufferPool.create<IndexBufferGL>(size, format);
+}
+
+ComputeTechniqueHandle OpenGLRenderer::createComputeTechnique(MaterialHandle m)
+{
+	// the draws read what the passes write through gl_BaseInstanceARB
+	// (TRANSLATION_BUFFER), without it the caller stays on the CPU.
+	if (!GLEW_ARB_shader_draw_parameters)
+		return ComputeTechniqueHandle();
+	return computePool.create<ComputeTechnique>(get(m));
+}
+
+void OpenGLRenderer::dispatch(ComputeTechnique* technique, uint32_t x, uint32_t y, uint32_t z)
+{
+	PROFILE_ZONE("dispatch");
+	technique->getMaterial()->enable();
+	for (auto& s : technique->getStorageBuffers())
+	{
+		VertexBufferGL* buffer = (VertexBufferGL*)s.second.buffer;
+		const size_t size = s.second.size ? s.second.size : buffer->getSize() - s.second.offset;
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, s.first, buffer->getHandle(), s.second.offset, size);
+	}
+	if (technique->getTransformSlot() != ComputeTechnique::NO_SLOT)
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, technique->getTransformSlot(), perDrawBuffer);
+	FrameStats::current.vertexBufferBinds += technique->getStorageBuffers().size();
+	glDispatchCompute(x, y, z);
+	// the draws read the results as uniforms or storage (translations,
+	// vertices) or indirect commands.
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+	FrameStats::current.dispatches++;
+}
+
 RenderState* OpenGLRenderer::makeRenderState() { 
 	RenderStateGL* newRS = new RenderStateGL();
 	newRS->setGlobalWireFrame(&this->globalWireframeMode);
@@ -73,15 +171,153 @@ RenderState* OpenGLRenderer::makeRenderState() {
 }
 
 void OpenGLRenderer::setWinTitle(const char* title) {
-	SDL_SetWindowTitle(this->window, title);
+	// the hidden window used for headless on Windows is never shown
+	if (this->window && !headless)
+		SDL_SetWindowTitle(this->window, title);
 }
 
-int OpenGLRenderer::initialize(unsigned int width, unsigned int height) {
+#ifndef _WIN32
+/*
+ Headless context through EGL. Prefers the Mesa surfaceless platform so no
+ X server/Wayland compositor is needed, falls back to the default display
+ with a small pbuffer. Everything is rendered into the offscreen FBOs anyway.
+*/
+int OpenGLRenderer::createHeadlessContext(unsigned int width, unsigned int height)
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (eglDisplay == EGL_NO_DISPLAY)
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+	{
+		fprintf(stderr, "Error EGL: cannot initialize display\n");
+		return -1;
+	}
+
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint numConfigs = 0;
+	eglChooseConfig(eglDisplay, configAttribs, &config, 1, &numConfigs);
+	bool hasConfig = numConfigs > 0;
+	if (!hasConfig)
+	{
+		// surfaceless platform has no pbuffer configs, take any GL config.
+		const EGLint anyAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+		eglChooseConfig(eglDisplay, anyAttribs, &config, 1, &numConfigs);
+		hasConfig = numConfigs > 0;
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+	const EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+		EGL_NONE
+	};
+	eglContext = eglCreateContext(eglDisplay, hasConfig ? config : (EGLConfig)0, EGL_NO_CONTEXT, contextAttribs);
+	if (eglContext == EGL_NO_CONTEXT)
+	{
+		fprintf(stderr, "Error EGL: cannot create a 4.5 context (0x%x)\n", eglGetError());
+		return -1;
+	}
 
-	if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+	if (hasConfig)
+	{
+		const EGLint pbufferAttribs[] = { EGL_WIDTH, (EGLint)width, EGL_HEIGHT, (EGLint)height, EGL_NONE };
+		eglSurface = eglCreatePbufferSurface(eglDisplay, config, pbufferAttribs);
+	}
+	if (!eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext))
+	{
+		fprintf(stderr, "Error EGL: cannot make context current (0x%x)\n", eglGetError());
+		return -1;
+	}
+	return 0;
+}
+#else
+/*
+ WGL needs a window to create a context, use a hidden one. Nothing is ever
+ drawn into it, rendering goes to the offscreen FBOs.
+*/
+int OpenGLRenderer::createHeadlessContext(unsigned int width, unsigned int height)
+{
+	window = SDL_CreateWindow("OpenGL", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+	context = SDL_GL_CreateContext(window);
+	if (context == nullptr)
 	{
 		fprintf(stderr, "%s", SDL_GetError());
-		exit(-1);
+		return -1;
+	}
+	SDL_GL_MakeCurrent(window, context);
+	return 0;
+}
+#endif
+
+void OpenGLRenderer::createOffscreenTargets(unsigned int width, unsigned int height)
+{
+	glGenFramebuffers(OFFSCREEN_TARGETS, offscreenFBO);
+	glGenTextures(OFFSCREEN_TARGETS, offscreenColor);
+	glGenRenderbuffers(OFFSCREEN_TARGETS, offscreenDepth);
+	for (int i = 0; i < OFFSCREEN_TARGETS; i++)
+	{
+		glBindTexture(GL_TEXTURE_2D, offscreenColor[i]);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, offscreenDepth[i]);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		// renderbuffer names are a namespace of their own, kept apart from the textures.
+		MemoryTracker::allocate(MemoryTracker::CATEGORY::RENDER_TARGET, offscreenColor[i], MemoryTracker::DRIVER_MEMORY, (uint64_t)width * height * 4);
+		MemoryTracker::allocate(MemoryTracker::CATEGORY::RENDER_TARGET, offscreenDepth[i] | (1ull << 32), MemoryTracker::DRIVER_MEMORY, (uint64_t)width * height * 4);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, offscreenFBO[i]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, offscreenColor[i], 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, offscreenDepth[i]);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			fprintf(stderr, "Error GL: offscreen framebuffer incomplete\n");
+			exit(-1);
+		}
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	currentTarget = 0;
+	glBindFramebuffer(GL_FRAMEBUFFER, offscreenFBO[currentTarget]);
+}
+
+void OpenGLRenderer::destroyOffscreenTargets()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	for (int i = 0; i < OFFSCREEN_TARGETS; i++)
+	{
+		MemoryTracker::release(MemoryTracker::CATEGORY::RENDER_TARGET, offscreenColor[i]);
+		MemoryTracker::release(MemoryTracker::CATEGORY::RENDER_TARGET, offscreenDepth[i] | (1ull << 32));
+	}
+	glDeleteFramebuffers(OFFSCREEN_TARGETS, offscreenFBO);
+	glDeleteTextures(OFFSCREEN_TARGETS, offscreenColor);
+	glDeleteRenderbuffers(OFFSCREEN_TARGETS, offscreenDepth);
+}
+
+int OpenGLRenderer::initialize(unsigned int width, unsigned int height, bool headless) {
+
+	this->headless = headless;
+	// headless does not need video, on Linux SDL is only used for timing.
+	Uint32 sdlFlags = SDL_INIT_EVERYTHING;
+#ifndef _WIN32
+	if (headless)
+		sdlFlags = SDL_INIT_TIMER | SDL_INIT_EVENTS;
+#endif
+	if (SDL_Init(sdlFlags) != 0)
+	{
+		fprintf(stderr, "%s", SDL_GetError());
+		return -1;
 	}
 	// Request an OpenGL 4.5 context (should be core)
 	SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
@@ -92,14 +328,27 @@ int OpenGLRenderer::initialize(unsigned int width, unsigned int height) {
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 	SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
 
-	window = SDL_CreateWindow("OpenGL", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_OPENGL);
-	context = SDL_GL_CreateContext(window);
+	if (headless)
+	{
+		if (createHeadlessContext(width, height) != 0)
+			return -1;
+	}
+	else
+	{
+		window = SDL_CreateWindow("OpenGL", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_OPENGL);
+		context = SDL_GL_CreateContext(window);
+		if (context == nullptr)
+		{
+			fprintf(stderr, "%s", SDL_GetError());
+			return -1;
+		}
 
-	SDL_GL_MakeCurrent(window, context);
+		SDL_GL_MakeCurrent(window, context);
 
-	int major, minor;
-	SDL_GL_GetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, &major);
-	SDL_GL_GetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, &minor);
+		int major, minor;
+		SDL_GL_GetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, &major);
+		SDL_GL_GetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, &minor);
+	}
 
 	glClearColor(1.0f, 0.0f, 0.0f, 0.0f);
 	glEnable(GL_DEPTH_TEST);
@@ -111,10 +360,22 @@ int OpenGLRenderer::initialize(unsigned int width, unsigned int height) {
 
 	glewExperimental = GL_TRUE;
 	GLenum err = glewInit();
-	if (GLEW_OK != err)
+	// on an EGL context GLEW may complain about missing GLX, the GL entry
+	// points are loaded regardless.
+	if (GLEW_OK != err && !headless)
 	{
 		fprintf(stderr, "Error GLEW: %s\n", glewGetErrorString(err));
 	}
+	installGLInterposer();
+
+	if (headless)
+		createOffscreenTargets(width, height);
+
+	if (GLEW_ARB_timer_query || GLEW_VERSION_3_3)
+	{
+		gpuProfiler = new GpuProfilerGL();
+		clearScope = gpuProfiler->scope("clear");
+	}
 
 	return 0;
 }
@@ -124,71 +385,243 @@ int OpenGLRenderer::initialize(unsigned int width, unsigned int height) {
  TODO.
 */
 
-int perMat = 1;
 void OpenGLRenderer::submit(Mesh* mesh) 
 {
-	if (perMat) {
-		drawList2[mesh->technique].push_back(mesh);
-	}
-	else
-		drawList.push_back(mesh);
+	FrameStats::current.drawsSubmitted++;
+	drawList.push_back(((MeshGL*)mesh)->getPacket());
 };
 
+void OpenGLRenderer::submit(Mesh* const* meshes, size_t count)
+{
+	PROFILE_ZONE("submit");
+	FrameStats::current.drawsSubmitted += count;
+	drawList.reserve(drawList.size() + count);
+	for (size_t i = 0; i < count; i++)
+		drawList.push_back(((MeshGL*)meshes[i])->getPacket());
+}
+
+void OpenGLRenderer::attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source)
+{
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	perDrawStride = ((4 * sizeof(float) + alignment - 1) / alignment) * alignment;
+	perDrawCount = meshes.size();
+	if (perDrawBuffer == 0)
+		glGenBuffers(1, &perDrawBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, perDrawBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, perDrawCount * perDrawStride, nullptr, source == TRANSFORMS::GPU ? GL_DYNAMIC_COPY : GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::CONSTANT, perDrawBuffer, MemoryTracker::DRIVER_MEMORY,
+		perDrawCount * perDrawStride, perDrawCount * 4 * sizeof(float));
+	for (size_t i = 0; i < meshes.size(); i++)
+		((ConstantBufferGL*)meshes[i]->txBuffer)->attach(perDrawBuffer, i * perDrawStride);
+	cullRecordsDirty = true;
+	// the translation ranges of the retained packets moved.
+	renderables.recompile([](Mesh* mesh, uint64_t& key, DrawPacketGL& packet) {
+		packet = ((MeshGL*)mesh)->getPacket();
+		key = (uintptr_t)packet.technique;
+	});
+}
+
+uint32_t OpenGLRenderer::addRenderable(Mesh* mesh)
+{
+	const DrawPacketGL& packet = ((MeshGL*)mesh)->getPacket();
+	cullRecordsDirty = true;
+	return renderables.add((uintptr_t)packet.technique, mesh, packet);
+}
+
+void OpenGLRenderer::updateRenderable(uint32_t id)
+{
+	if (!renderables.valid(id))
+		return;
+	const DrawPacketGL& packet = ((MeshGL*)renderables.mesh(id))->getPacket();
+	renderables.update(id, (uintptr_t)packet.technique, packet);
+	cullRecordsDirty = true;
+}
+
+void OpenGLRenderer::removeRenderable(uint32_t id)
+{
+	renderables.remove(id);
+	cullRecordsDirty = true;
+}
+
+bool OpenGLRenderer::setGpuCulling(const Frustum* frustum)
+{
+	if (frustum == nullptr)
+	{
+		gpuCulling = false;
+		return true;
+	}
+	if (!GLEW_ARB_indirect_parameters || !GLEW_ARB_shader_draw_parameters)
+		return false;
+	if (gpuCuller == nullptr)
+	{
+		gpuCuller = new GpuCuller();
+		if (!gpuCuller->initialize(this))
+		{
+			delete gpuCuller;
+			gpuCuller = nullptr;
+			return false;
+		}
+	}
+	cullFrustum = *frustum;
+	gpuCulling = true;
+	return true;
+}
+
+// the packets draw the same streams (bound whole) and textures, and read an attached translation.
+static bool drawsIndirect(const DrawPacketGL& packet, const DrawPacketGL& first, GLuint translations)
+{
+	// the commands are glDrawArraysIndirect ones.
+	if (packet.indexBuffer || packet.firstVertex == DrawPacketGL::NO_FIRST_VERTEX || packet.uniformBuffer != translations || packet.uniformSize == 0)
+		return false;
+	if (packet.streamCount != first.streamCount || packet.textureCount != first.textureCount)
+		return false;
+	for (uint32_t s = 0; s < packet.streamCount; s++)
+		if (packet.streamLocations[s] != first.streamLocations[s] || packet.streamBuffers[s] != first.streamBuffers[s])
+			return false;
+	for (uint32_t t = 0; t < packet.textureCount; t++)
+		if (packet.textureSlots[t] != first.textureSlots[t] || packet.textures[t] != first.textures[t])
+			return false;
+	return true;
+}
+
+void OpenGLRenderer::buildCullRecords()
+{
+	PROFILE_ZONE("buildCullRecords");
+	std::vector<GpuCuller::Record> records;
+	const auto& buckets = renderables.getBuckets();
+	indirectBuckets.assign(buckets.size(), { 0, 0 });
+	for (uint32_t b = 0; b < buckets.size(); b++)
+	{
+		const auto& bucket = buckets[b];
+		bool indirect = !bucket.packets.empty() && perDrawBuffer != 0;
+		for (uint32_t i = 0; indirect && i < bucket.packets.size(); i++)
+			indirect = drawsIndirect(bucket.packets[i], bucket.packets[0], perDrawBuffer) && !renderables.mesh(bucket.ids[i])->bounds.empty();
+		if (!indirect)
+			continue;
+		const uint32_t first = (uint32_t)records.size();
+		indirectBuckets[b] = { first, (uint32_t)bucket.packets.size() };
+		for (uint32_t i = 0; i < bucket.packets.size(); i++)
+		{
+			const DrawPacketGL& packet = bucket.packets[i];
+			const Aabb& bounds = renderables.mesh(bucket.ids[i])->bounds;
+			records.push_back({ { bounds.min.x, bounds.min.y, bounds.min.z }, (uint32_t)packet.vertexCount,
+				{ bounds.max.x, bounds.max.y, bounds.max.z }, (uint32_t)packet.firstVertex,
+				packet.firstInstance, b, first, 0 });
+		}
+	}
+	gpuCuller->setRecords(records, (uint32_t)buckets.size());
+	cullRecordsDirty = false;
+}
+
+void OpenGLRenderer::drawIndirect(const DrawPacketGL& packet, uint32_t bucket, const IndirectBucket& records)
+{
+	packet.bindTextures();
+	for (uint32_t s = 0; s < packet.streamCount; s++)
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, packet.streamLocations[s], packet.streamBuffers[s]);
+	FrameStats::current.vertexBufferBinds += packet.streamCount;
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, ((VertexBufferGL*)gpuCuller->getCommands())->getHandle());
+	glBindBuffer(GL_PARAMETER_BUFFER_ARB, ((VertexBufferGL*)gpuCuller->getCounts())->getHandle());
+	glMultiDrawArraysIndirectCountARB(GL_TRIANGLES, (const void*)(uintptr_t)(records.first * GpuCuller::COMMAND_SIZE),
+		(GLintptr)(bucket * sizeof(uint32_t)), (GLsizei)records.count, 0);
+	FrameStats::current.indirectDraws++;
+}
+
+void OpenGLRenderer::drawRenderables()
+{
+	PROFILE_ZONE("drawRenderables");
+	if (gpuCulling)
+	{
+		if (cullRecordsDirty)
+			buildCullRecords();
+		gpuCuller->cull(cullFrustum);
+	}
+	// the translations of the shaders reading them as storage (TRANSLATION_BUFFER).
+	if (perDrawBuffer)
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TRANSLATION, perDrawBuffer);
+	const auto& buckets = renderables.getBuckets();
+	for (uint32_t b = 0; b < buckets.size(); b++)
+	{
+		const auto& bucket = buckets[b];
+		if (bucket.packets.empty())
+			continue;
+		Technique* technique = bucket.packets[0].technique;
+		if (gpuProfiler)
+			gpuProfiler->mark(gpuProfiler->techniqueScope(technique));
+		technique->enable(this);
+		if (gpuCulling && indirectBuckets[b].count)
+		{
+			drawIndirect(bucket.packets[0], b, indirectBuckets[b]);
+			continue;
+		}
+		for (const DrawPacketGL& packet : bucket.packets)
+			packet.draw();
+	}
+}
+
+void OpenGLRenderer::updateTransforms(const TransformBatch& batch)
+{
+	const size_t count = std::min(batch.size(), perDrawCount);
+	if (count == 0)
+		return;
+	glBindBuffer(GL_UNIFORM_BUFFER, perDrawBuffer);
+	// invalidating orphans the storage the draws of the last frame may still read.
+	void* dest = glMapBufferRange(GL_UNIFORM_BUFFER, 0, count * perDrawStride, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	// the GPU reads it, nothing on the CPU does.
+	batch.write(dest, perDrawStride, count, true);
+	glUnmapBuffer(GL_UNIFORM_BUFFER);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	FrameStats::current.bufferMaps++;
+	FrameStats::current.bufferUnmaps++;
+	FrameStats::current.uniformBytes += count * 4 * sizeof(float);
+}
+
 /*
  Naive implementation, no re-ordering, checking for state changes, etc.
  TODO.
 */
 void OpenGLRenderer::frame() 
 {
-	if (perMat!=1) {
-
-		for (auto mesh : drawList)
-		{
-			mesh->technique->enable(this);
-			size_t numberElements = mesh->geometryBuffers[0].numElements;
-			glBindTexture(GL_TEXTURE_2D, 0);
-			for (auto t : mesh->textures)
-			{
-				// we do not really know here if the sampler has been
-				// defined in the shader.
-				t.second->bind(t.first);
-			}
-			for (auto element : mesh->geometryBuffers) {
-				mesh->bindIAVertexBuffer(element.first);
-			}
-			mesh->txBuffer->bind(mesh->technique->getMaterial());
-			glDrawArrays(GL_TRIANGLES, 0, numberElements);
-		}
-		drawList.clear();
-	}
-	else 
+	PROFILE_ZONE("frame");
+	drawRenderables();
+	// one sort of the frame's packets instead of a bucket lookup per submit,
+	// stable so meshes of a technique keep their submit order.
+	if (submission == SUBMISSION::PER_TECHNIQUE)
+		std::stable_sort(drawList.begin(), drawList.end(), DrawPacketGL::byTechnique);
+
+	Technique* lastTechnique = nullptr;
+	for (const DrawPacketGL& packet : drawList)
 	{
-		for (auto work : drawList2)
+		if (packet.technique != lastTechnique)
 		{
-			work.first->enable(this);
-			for (auto mesh : work.second)
-			{
-				size_t numberElements = mesh->geometryBuffers[0].numElements;
-				glBindTexture(GL_TEXTURE_2D, 0);
-				for (auto t : mesh->textures)
-				{
-					// we do not really know here if the sampler has been
-					// defined in the shader.
-					t.second->bind(t.first);
-				}
-				for (auto element : mesh->geometryBuffers) {
-					mesh->bindIAVertexBuffer(element.first);
-				}
-				mesh->txBuffer->bind(work.first->getMaterial());
-				glDrawArrays(GL_TRIANGLES, 0, numberElements);
-			}
+			if (gpuProfiler)
+				gpuProfiler->mark(gpuProfiler->techniqueScope(packet.technique));
+			lastTechnique = packet.technique;
+			lastTechnique->enable(this);
 		}
-		drawList2.clear();
+		packet.draw();
 	}
+	// keeps its capacity for the next frame.
+	drawList.clear();
+	if (gpuProfiler)
+		gpuProfiler->end();
 };
 
 void OpenGLRenderer::present()
 {
+	PROFILE_ZONE("present");
+	FrameStats::endFrame();
+	if (ApiTrace::active)
+		ApiTrace::active->endFrame();
+	if (headless)
+	{
+		// nothing to show, move on to the next offscreen target.
+		glFlush();
+		currentTarget = (currentTarget + 1) % OFFSCREEN_TARGETS;
+		glBindFramebuffer(GL_FRAMEBUFFER, offscreenFBO[currentTarget]);
+		return;
+	}
 	SDL_GL_SwapWindow(window);
 };
 
@@ -200,6 +633,11 @@ void OpenGLRenderer::setClearColor(float r, float g, float b, float a)
 
 void OpenGLRenderer::clearBuffer(unsigned int flag) 
 {
+	if (gpuProfiler)
+	{
+		gpuProfiler->beginFrame();
+		gpuProfiler->mark(clearScope);
+	}
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	return;
 	// using is only valid inside the function!
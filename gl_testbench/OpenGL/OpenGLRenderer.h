@@ -1,10 +1,18 @@
 #pragma once
 
 #include "../Renderer.h"
+#include "GpuProfilerGL.h"
+#include "DrawPacketGL.h"
+#include "../RetainedList.h"
+#include "../GpuCuller.h"
 
 #include <SDL.h>
 #include <GL/glew.h>
 //#include <SDL_opengl.h>
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 #pragma comment(lib, "opengl32.lib")
 #pragma comment(lib,"glew32.lib")
@@ -13,7 +21,7 @@
 
 
 
-class OpenGLRenderer : public Renderer
+class OpenGLRenderer final : public Renderer
 {
 public:
 	OpenGLRenderer();
@@ -27,12 +35,23 @@ public:
 //	ResourceBinding* makeResourceBinding();
 	RenderState* makeRenderState();
 	Technique* makeTechnique(Material* m, RenderState* r);
+	MeshHandle createMesh();
+	VertexBufferHandle createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage);
+	Texture2DHandle createTexture2D();
+	Sampler2DHandle createSampler2D();
+	MaterialHandle createMaterial(const std::string& name);
+	TechniqueHandle createTechnique(MaterialHandle m, RenderState* r);
+	IndexBufferHandle createIndexBuffer(size_t size, IndexBuffer::FORMAT format);
+	// runs right away, glMemoryBarrier orders it before the draws. No handle
+	// without ARB_shader_draw_parameters.
+	ComputeTechniqueHandle createComputeTechnique(MaterialHandle m);
+	void dispatch(ComputeTechnique* technique, uint32_t x, uint32_t y = 1, uint32_t z = 1);
 	Texture2D* makeTexture2D();
 	Sampler2D* makeSampler2D();
 	std::string getShaderPath();
 	std::string getShaderExtension();
 
-	int initialize(unsigned int width = 640, unsigned int height = 480);
+	int initialize(unsigned int width = 640, unsigned int height = 480, bool headless = false);
 	void setWinTitle(const char* title);
 	int shutdown();
 
@@ -40,16 +59,73 @@ public:
 	void clearBuffer(unsigned int);
 //	void setRenderTarget(RenderTarget* rt); // complete parameters
 	void setRenderState(RenderState* ps);
+	// submit(MeshHandle) of Renderer.
+	using Renderer::submit;
 	void submit(Mesh* mesh);
+	void submit(Mesh* const* meshes, size_t count);
+	// retained packets, bucketed by technique and drawn before the submitted meshes.
+	uint32_t addRenderable(Mesh* mesh);
+	void updateRenderable(uint32_t id);
+	void removeRenderable(uint32_t id);
 	void frame();
 	void present();
+	// one uniform buffer for every translation, see Renderer::attachTransforms.
+	void attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source = TRANSFORMS::CPU);
+	void updateTransforms(const TransformBatch& batch);
+	size_t getTransformStride() const { return perDrawStride; };
+	// ARB_indirect_parameters and ARB_shader_draw_parameters, see Renderer::setGpuCulling.
+	bool setGpuCulling(const Frustum* frustum);
+
+	GpuProfiler* getGpuProfiler() { return gpuProfiler; };
 
 private:
-	SDL_Window* window;
-	SDL_GLContext context;
+	SDL_Window* window = nullptr;
+	SDL_GLContext context = nullptr;
+
+	// headless mode renders into offscreen framebuffers instead of the window.
+	// present() rotates between them.
+	static const int OFFSCREEN_TARGETS = 2;
+	bool headless = false;
+	int currentTarget = 0;
+	GLuint offscreenFBO[OFFSCREEN_TARGETS] = { 0 };
+	GLuint offscreenColor[OFFSCREEN_TARGETS] = { 0 };
+	GLuint offscreenDepth[OFFSCREEN_TARGETS] = { 0 };
+	int createHeadlessContext(unsigned int width, unsigned int height);
+	void createOffscreenTargets(unsigned int width, unsigned int height);
+	void destroyOffscreenTargets();
+#ifndef _WIN32
+	// surfaceless / pbuffer EGL context (Mesa llvmpipe), no display needed.
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+	EGLContext eglContext = EGL_NO_CONTEXT;
+	EGLSurface eglSurface = EGL_NO_SURFACE;
+#endif
+
+	// packets copied from the submitted meshes, see DrawPacketGL.
+	std::vector<DrawPacketGL> drawList;
+	RetainedList<DrawPacketGL> renderables;
+	void drawRenderables();
+
+	// setGpuCulling: the culling pass, and by bucket of renderables the
+	// records of its packets, count 0 when they are drawn one by one.
+	struct IndirectBucket {
+		uint32_t first, count;
+	};
+	GpuCuller* gpuCuller = nullptr;
+	bool gpuCulling = false;
+	Frustum cullFrustum;
+	std::vector<IndirectBucket> indirectBuckets;
+	bool cullRecordsDirty = true;
+	void buildCullRecords();
+	void drawIndirect(const DrawPacketGL& packet, uint32_t bucket, const IndirectBucket& records);
+
+	// float4 per attached mesh, perDrawStride apart (GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT).
+	GLuint perDrawBuffer = 0;
+	GLsizeiptr perDrawStride = 0;
+	size_t perDrawCount = 0;
 
-	std::vector<Mesh*> drawList;
-	std::unordered_map<Technique*, std::vector<Mesh*>> drawList2;
+	// GL_TIMESTAMP marks around the clear and each technique bucket.
+	GpuProfilerGL* gpuProfiler = nullptr;
+	uint32_t clearScope = 0;
 	
 	bool globalWireframeMode = false;
 
@@ -7,6 +7,9 @@
 GLuint wrapMap[2] = { GL_REPEAT, GL_CLAMP };
 GLuint filterMap[2] = { GL_NEAREST, GL_LINEAR };
 
+const GLuint Sampler2DGL::MAX_SLOTS;
+GLuint Sampler2DGL::bound[Sampler2DGL::MAX_SLOTS] = {};
+
 
 Sampler2DGL::Sampler2DGL()
 {
@@ -14,27 +17,50 @@ Sampler2DGL::Sampler2DGL()
 	// defaults
 	minFilter = magFilter = GL_NEAREST;
 	wrapS = wrapT = GL_CLAMP;
+	glSamplerParameteri(samplerHandler, GL_TEXTURE_MAG_FILTER, magFilter);
+	glSamplerParameteri(samplerHandler, GL_TEXTURE_MIN_FILTER, minFilter);
+	glSamplerParameteri(samplerHandler, GL_TEXTURE_WRAP_S, wrapS);
+	glSamplerParameteri(samplerHandler, GL_TEXTURE_WRAP_T, wrapT);
 }
 
 Sampler2DGL::~Sampler2DGL()
 {
+	// deleting unbinds it from every unit, and GL may reuse the name.
+	for (GLuint& s : bound)
+		if (s == samplerHandler)
+			s = 0;
 	glDeleteSamplers(1, &samplerHandler);
 }
 
 void Sampler2DGL::setMagFilter(FILTER filter)
 {
 	magFilter = filterMap[filter];
+	glSamplerParameteri(samplerHandler, GL_TEXTURE_MAG_FILTER, magFilter);
 }
 
 
 void Sampler2DGL::setMinFilter(FILTER filter) 
 {
 	minFilter = filterMap[filter];
+	glSamplerParameteri(samplerHandler, GL_TEXTURE_MIN_FILTER, minFilter);
 }
 
 void Sampler2DGL::setWrap(WRAPPING s, WRAPPING t)
 {
 	wrapS = wrapMap[s];
 	wrapT = wrapMap[t];
+	glSamplerParameteri(samplerHandler, GL_TEXTURE_WRAP_S, wrapS);
+	glSamplerParameteri(samplerHandler, GL_TEXTURE_WRAP_T, wrapT);
+}
+
+void Sampler2DGL::bind(GLuint slot, const Sampler2DGL* sampler)
+{
+	if (slot < MAX_SLOTS)
+	{
+		if (bound[slot] == sampler->samplerHandler)
+			return;
+		bound[slot] = sampler->samplerHandler;
+	}
+	glBindSampler(slot, sampler->samplerHandler);
 }
 
@@ -7,12 +7,18 @@ class Sampler2DGL :
 public:
 	Sampler2DGL();
 	~Sampler2DGL();
+	// the setters write the sampler object, binding it sets no parameters.
 	void setMagFilter(FILTER filter);
 	void setMinFilter(FILTER filter);
 	void setWrap(WRAPPING s, WRAPPING t);
 
+	// glBindSampler, skipped when the unit already has this sampler.
+	static void bind(GLuint slot, const Sampler2DGL* sampler);
+
 	GLuint magFilter, minFilter, wrapS, wrapT;
 	GLuint samplerHandler = 0;
 private:
+	static const GLuint MAX_SLOTS = 16;
+	// the sampler bound to each unit by bind, 0 when unknown.
+	static GLuint bound[MAX_SLOTS];
 };
-
@@ -2,6 +2,9 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "../Profiler.h"
+#include "../FrameStats.h"
+#include "../MemoryTracker.h"
 
 Texture2DGL::Texture2DGL() {}
 
@@ -9,6 +12,7 @@ Texture2DGL::~Texture2DGL()
 {
 	if (textureHandle != 0)
 	{
+		MemoryTracker::release(MemoryTracker::CATEGORY::TEXTURE, textureHandle);
 		glDeleteTextures(1, &textureHandle);
 		fprintf(stderr,"texture deleted\n");
 	};
@@ -18,6 +22,7 @@ Texture2DGL::~Texture2DGL()
 // else return -1
 int Texture2DGL::loadFromFile(std::string filename)
 {
+	PROFILE_ZONE("loadTexture");
 	int w, h, bpp;
 	unsigned char* rgb = stbi_load(filename.c_str(), &w, &h, &bpp, STBI_rgb_alpha);
 	if (rgb == nullptr)
@@ -29,6 +34,7 @@ int Texture2DGL::loadFromFile(std::string filename)
 	// not 0
 	if (textureHandle)
 	{
+		MemoryTracker::release(MemoryTracker::CATEGORY::TEXTURE, textureHandle);
 		glDeleteTextures(1, &textureHandle);
 	};
 
@@ -47,8 +53,12 @@ int Texture2DGL::loadFromFile(std::string filename)
 //	else if (bpp == 4)
 	// for now only RGBA
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgb);
+	FrameStats::current.stagingBytes += (uint64_t)w * h * 4;
 
 	glGenerateMipmap(GL_TEXTURE_2D);
+	// the mip chain adds a third.
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::TEXTURE, textureHandle, MemoryTracker::DRIVER_MEMORY,
+		(uint64_t)w * h * 4 * 4 / 3, (uint64_t)w * h * 4);
 
 	// unbind texture
 	glBindTexture(GL_TEXTURE_2D, 0);
@@ -61,14 +71,8 @@ void Texture2DGL::bind(unsigned int slot)
 {
 	glActiveTexture(GL_TEXTURE0 + slot);
 	glBindTexture(GL_TEXTURE_2D, textureHandle);
+	FrameStats::current.textureBinds++;
 
 	if (this->sampler != nullptr)
-	{
-		Sampler2DGL* s = (Sampler2DGL*)this->sampler;
-		glBindSampler(slot, s->samplerHandler);
-		glSamplerParameteri(s->samplerHandler, GL_TEXTURE_MAG_FILTER, s->magFilter);
-		glSamplerParameteri(s->samplerHandler, GL_TEXTURE_MIN_FILTER, s->minFilter);
-		glSamplerParameteri(s->samplerHandler, GL_TEXTURE_WRAP_S, s->wrapS);
-		glSamplerParameteri(s->samplerHandler, GL_TEXTURE_WRAP_T, s->wrapT);
-	}
+		Sampler2DGL::bind(slot, (Sampler2DGL*)this->sampler);
 }
@@ -1,6 +1,10 @@
 #include "VertexBufferGL.h"
 #include "MeshGL.h"
 #include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include "../FrameStats.h"
+#include "../MemoryTracker.h"
 
 GLuint VertexBufferGL::usageMapping[3] = { GL_STATIC_COPY, GL_DYNAMIC_COPY, GL_DONT_CARE };
 
@@ -16,10 +20,12 @@ VertexBufferGL::VertexBufferGL(size_t size, DATA_USAGE usage) {
 	glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, usageMapping[usage]);
 	unbind();
 	_handle = newSSBO;
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, _handle, MemoryTracker::DRIVER_MEMORY, size);
 }
 
 VertexBufferGL::~VertexBufferGL()
 {
+	MemoryTracker::release(MemoryTracker::CATEGORY::VERTEX, _handle);
 	glDeleteBuffers(1, &_handle);
 }
 
@@ -32,6 +38,39 @@ void VertexBufferGL::setData(const void* data, size_t size,  size_t offset)
 
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _handle);
 	glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+	FrameStats::current.stagingBytes += size;
+	unbind();
+}
+
+void VertexBufferGL::setData(const Write* writes, size_t count)
+{
+	if (count == 0)
+		return;
+	size_t first = writes[0].offset, end = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		assert(writes[i].size + writes[i].offset <= totalSize);
+		first = std::min(first, writes[i].offset);
+		end = std::max(end, writes[i].offset + writes[i].size);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _handle);
+	// no invalidate, the bytes between the writes are kept.
+	char* mapped = (char*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, first, end - first, GL_MAP_WRITE_BIT);
+	for (size_t i = 0; i < count; i++)
+	{
+		if (mapped)
+			memcpy(mapped + writes[i].offset - first, writes[i].data, writes[i].size);
+		else
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, writes[i].offset, writes[i].size, writes[i].data);
+		FrameStats::current.stagingBytes += writes[i].size;
+	}
+	if (mapped)
+	{
+		glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+		FrameStats::current.bufferMaps++;
+		FrameStats::current.bufferUnmaps++;
+	}
 	unbind();
 }
 
@@ -41,6 +80,7 @@ void VertexBufferGL::setData(const void* data, size_t size,  size_t offset)
 void VertexBufferGL::bind(size_t offset, size_t size, unsigned int location) {
 	assert(offset + size <= totalSize);
 	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, location, _handle, offset, size);
+	FrameStats::current.vertexBufferBinds++;
 }
 
 inline void VertexBufferGL::unbind() {
@@ -11,9 +11,12 @@ public:
 	~VertexBufferGL();
 	
 	void setData(const void* data, size_t size, size_t offset);
+	// maps the range covered by the writes once.
+	void setData(const Write* writes, size_t count);
 	void bind(size_t offset, size_t size, unsigned int location);
 	void unbind();
 	size_t getSize();
+	GLuint getHandle() const { return _handle; };
 
 	static GLuint usageMapping[3];
 
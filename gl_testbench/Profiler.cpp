@@ -0,0 +1,124 @@
+#ifdef TESTBENCH_PROFILE
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "Profiler.h"
+
+namespace {
+	struct Event {
+		const char* name;
+		uint64_t start, end;
+	};
+
+	// written only by its thread, read by writeChromeTrace.
+	struct ThreadRing {
+		uint32_t id;
+		const char* name;
+		std::atomic<uint64_t> head;
+		Event events[Profiler::RING_SIZE];
+	};
+
+	std::mutex registryLock;
+	// rings outlive their threads, so zones of finished workers can still be exported.
+	std::vector<ThreadRing*> rings;
+	thread_local ThreadRing* localRing = nullptr;
+
+	ThreadRing* threadRing()
+	{
+		if (localRing == nullptr)
+		{
+			ThreadRing* ring = new ThreadRing();
+			ring->name = nullptr;
+			ring->head = 0;
+			std::lock_guard<std::mutex> lock(registryLock);
+			ring->id = (uint32_t)rings.size() + 1;
+			rings.push_back(ring);
+			localRing = ring;
+		}
+		return localRing;
+	}
+}
+
+uint64_t Profiler::now()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end)
+{
+	ThreadRing* ring = threadRing();
+	const uint64_t head = ring->head.load(std::memory_order_relaxed);
+	Event& e = ring->events[head & (RING_SIZE - 1)];
+	e.name = name;
+	e.start = start;
+	e.end = end;
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const char* name)
+{
+	threadRing()->name = name;
+}
+
+int Profiler::writeChromeTrace(const std::string& filename)
+{
+	struct Track {
+		uint32_t id;
+		const char* name;
+		std::vector<Event> events;
+	};
+	std::vector<Track> tracks;
+	{
+		std::lock_guard<std::mutex> lock(registryLock);
+		for (auto ring : rings)
+		{
+			Track track;
+			track.id = ring->id;
+			track.name = ring->name;
+			const uint64_t head = ring->head.load(std::memory_order_acquire);
+			uint64_t first = head > RING_SIZE ? head - RING_SIZE : 0;
+			for (uint64_t i = first; i < head; i++)
+				track.events.push_back(ring->events[i & (RING_SIZE - 1)]);
+			// the owner kept writing while we copied: drop what it may have overwritten.
+			const uint64_t after = ring->head.load(std::memory_order_acquire);
+			if (after >= RING_SIZE && after - RING_SIZE + 1 > first)
+			{
+				size_t stale = (size_t)std::min<uint64_t>(after - RING_SIZE + 1 - first, track.events.size());
+				track.events.erase(track.events.begin(), track.events.begin() + stale);
+			}
+			tracks.push_back(track);
+		}
+	}
+
+	FILE* f = fopen(filename.c_str(), "w");
+	if (f == nullptr)
+		return -1;
+
+	uint64_t origin = UINT64_MAX;
+	for (auto& t : tracks)
+		for (auto& e : t.events)
+			origin = std::min(origin, e.start);
+
+	fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool firstEvent = true;
+	for (auto& t : tracks)
+	{
+		fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			firstEvent ? "" : ",\n", t.id, t.name ? t.name : "thread");
+		firstEvent = false;
+		for (auto& e : t.events)
+		{
+			fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				e.name, t.id, (e.start - origin) / 1000.0, (e.end - e.start) / 1000.0);
+		}
+	}
+	fprintf(f, "\n]}\n");
+	fclose(f);
+	return 0;
+}
+
+#endif
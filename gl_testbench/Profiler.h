@@ -0,0 +1,71 @@
+#pragma once
+
+/*
+ Scoped CPU zones for the hot paths:
+
+	void Renderer::frame()
+	{
+		PROFILE_ZONE("frame");
+		...
+	}
+
+ Every thread writes its zones into its own ring buffer (single writer, no
+ locks), writeChromeTrace() exports what is still in the rings as Chrome
+ trace JSON (chrome://tracing, ui.perfetto.dev), one track per thread.
+
+ Only compiled with TESTBENCH_PROFILE defined (the Debug configurations,
+ or -DTESTBENCH_PROFILE=ON with CMake), otherwise PROFILE_ZONE and
+ PROFILE_THREAD expand to nothing. A zone is two clock reads, a ring write
+ and the AllocationTracker bookkeeping, so they sit on passes, not on
+ every draw, and Release builds leave them out of the measurements.
+ Zone names must be string literals, only the pointer is stored.
+ Zones are also what AllocationTracker charges allocations to.
+*/
+#ifdef TESTBENCH_PROFILE
+
+#include <stdint.h>
+#include <string>
+#include "AllocationTracker.h"
+
+class Profiler
+{
+public:
+	// zones kept per thread, older ones are overwritten.
+	static const uint32_t RING_SIZE = 1 << 16;
+
+	// nanoseconds, steady clock.
+	static uint64_t now();
+	static void record(const char* name, uint64_t start, uint64_t end);
+	// name of the calling thread's track in the trace.
+	static void setThreadName(const char* name);
+	// returns 0 on success, -1 if the file cannot be written.
+	static int writeChromeTrace(const std::string& filename);
+};
+
+class ProfileZone
+{
+public:
+	ProfileZone(const char* name) : name(name), parent(AllocationTracker::enterZone(name)), start(Profiler::now()) {};
+	~ProfileZone()
+	{
+		Profiler::record(name, start, Profiler::now());
+		AllocationTracker::leaveZone(parent);
+	};
+private:
+	const char* name;
+	// enclosing zone of this thread, allocations are charged to it again once this one ends.
+	const char* parent;
+	uint64_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_THREAD(name)
+
+#endif
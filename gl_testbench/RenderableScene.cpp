@@ -0,0 +1,111 @@
+#include "RenderableScene.h"
+#include "Mesh.h"
+#include "IA.h"
+#include "TransformBatch.h"
+#include "OcclusionCuller.h"
+#include "FrameStats.h"
+#include "Profiler.h"
+
+void RenderableScene::read(Mesh* mesh, RenderableStore::Renderable& r)
+{
+	r.mesh = mesh;
+	r.bounds = mesh->bounds;
+	r.technique = renderables.techniqueId(mesh->technique);
+	auto position = mesh->geometryBuffers.find(POSITION);
+	if (position != mesh->geometryBuffers.end())
+	{
+		const Mesh::VertexBufferBind& vb = position->second;
+		r.geometry.buffer = renderables.bufferId(vb.buffer);
+		r.geometry.first = (uint32_t)(vb.sizeElement ? vb.offset / vb.sizeElement : 0);
+		r.geometry.count = (uint32_t)vb.numElements;
+	}
+	auto texture = mesh->textures.find(DIFFUSE_SLOT);
+	r.texture = texture != mesh->textures.end() ? renderables.textureId(texture->second) : RenderableStore::NONE;
+}
+
+void RenderableScene::addMesh(Mesh* mesh)
+{
+	if (entities.find(mesh) != entities.end())
+	{
+		updateMesh(mesh);
+		return;
+	}
+	RenderableStore::Renderable r;
+	read(mesh, r);
+	entities[mesh] = renderables.create(r);
+}
+
+void RenderableScene::updateMesh(Mesh* mesh)
+{
+	auto found = entities.find(mesh);
+	if (found == entities.end())
+		return;
+	// keeps what the mesh does not know: node and constants.
+	RenderableStore::Renderable r = renderables.get(found->second);
+	read(mesh, r);
+	renderables.set(found->second, r);
+}
+
+void RenderableScene::removeMesh(Mesh* mesh)
+{
+	auto found = entities.find(mesh);
+	if (found == entities.end())
+		return;
+	renderables.destroy(found->second);
+	entities.erase(found);
+}
+
+uint32_t RenderableScene::entity(Mesh* mesh) const
+{
+	auto found = entities.find(mesh);
+	return found != entities.end() ? found->second : RenderableStore::NONE;
+}
+
+void RenderableScene::clear()
+{
+	for (auto& e : entities)
+		renderables.destroy(e.second);
+	entities.clear();
+}
+
+void RenderableScene::setTranslations(const TransformBatch& batch)
+{
+	const size_t size = batch.size();
+	const float* x = batch.x();
+	const float* y = batch.y();
+	const float* z = batch.z();
+	renderables.forEach(RenderableStore::CONSTANTS, [&](const RenderableStore::View& v) {
+		for (size_t i = 0; i < v.count; i++)
+		{
+			const uint32_t e = v.entities[i];
+			if (e < size)
+				v.constants[i] = glm::vec4(x[e], y[e], z[e], 0.0f);
+		}
+	});
+}
+
+void RenderableScene::cull(const Frustum& frustum, std::vector<Mesh*>& visible, const OcclusionCuller* occlusion)
+{
+	PROFILE_ZONE("cull");
+	uint32_t tests = 0, culled = 0;
+	renderables.forEach(RenderableStore::ALWAYS, [&](const RenderableStore::View& v) {
+		for (size_t i = 0; i < v.count; i++)
+		{
+			const Aabb box = v.bounds[i].translated(glm::vec3(v.constants[i]));
+			if (!frustum.intersects(box))
+				continue;
+			if (occlusion != nullptr)
+			{
+				tests++;
+				if (!occlusion->visible(box))
+				{
+					culled++;
+					continue;
+				}
+			}
+			visible.push_back(v.meshes[i]);
+		}
+	});
+	FrameStats::current.occlusionTests += tests;
+	FrameStats::current.occlusionCulled += culled;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "Scene.h"
+#include "RenderableStore.h"
+
+class TransformBatch;
+class OcclusionCuller;
+
+/*
+ Scene on top of a RenderableStore. addMesh makes a renderable from what the
+ mesh knows (technique, POSITION vertex range, DIFFUSE_SLOT texture and
+ Mesh::bounds), updateMesh reads them again. The translation is not part
+ of Mesh, it is the xyz of the CONSTANTS component:
+
+	scene.store().constants(scene.entity(mesh)) = glm::vec4(t, 0.0f);
+	scene.setTranslations(batch);         // or every one, batch[entity]
+	scene.cull(camera.getFrustum(), visible);
+
+ cull() tests every box in store order, a linear pass over the BOUNDS and
+ CONSTANTS arrays with no tree to keep; BvhScene skips whole subtrees
+ instead. With an OcclusionCuller the boxes inside the frustum are tested
+ against its depth buffer too, and the tests go to FrameStats::current.
+ Other passes iterate store() directly, the testbench submits the MESH
+ array of each archetype as one batch.
+*/
+class RenderableScene : public Scene
+{
+public:
+	void addMesh(Mesh* mesh);
+	void updateMesh(Mesh* mesh);
+	void removeMesh(Mesh* mesh);
+	// NONE for a mesh that was not added.
+	uint32_t entity(Mesh* mesh) const;
+	void clear();
+
+	// the xyz of every CONSTANTS from batch, entity e gets batch[e] when e < batch.size().
+	void setTranslations(const TransformBatch& batch);
+	// appends the meshes whose translated box intersects frustum (and is not hidden) to visible.
+	void cull(const Frustum& frustum, std::vector<Mesh*>& visible, const OcclusionCuller* occlusion = nullptr);
+
+	RenderableStore& store() { return renderables; };
+private:
+	void read(Mesh* mesh, RenderableStore::Renderable& r);
+
+	RenderableStore renderables;
+	std::unordered_map<Mesh*, uint32_t> entities;
+};
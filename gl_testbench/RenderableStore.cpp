@@ -0,0 +1,170 @@
+#include "RenderableStore.h"
+
+const uint32_t RenderableStore::NONE;
+const uint32_t RenderableStore::ALWAYS;
+
+RenderableStore::View RenderableStore::Archetype::view()
+{
+	View v;
+	v.components = components;
+	v.count = entities.size();
+	v.entities = entities.data();
+	v.nodes = (components & NODE) ? nodes.data() : nullptr;
+	v.bounds = bounds.data();
+	v.techniques = techniques.data();
+	v.geometry = geometry.data();
+	v.textures = (components & TEXTURE) ? textures.data() : nullptr;
+	v.constants = constants.data();
+	v.meshes = meshes.data();
+	return v;
+}
+
+void RenderableStore::Archetype::push(uint32_t entity, const Renderable& r)
+{
+	entities.push_back(entity);
+	if (components & NODE)
+		nodes.push_back(r.node);
+	bounds.push_back(r.bounds);
+	techniques.push_back(r.technique);
+	geometry.push_back(r.geometry);
+	if (components & TEXTURE)
+		textures.push_back(r.texture);
+	constants.push_back(r.constants);
+	meshes.push_back(r.mesh);
+}
+
+RenderableStore::Renderable RenderableStore::Archetype::get(size_t row) const
+{
+	Renderable r;
+	if (components & NODE)
+		r.node = nodes[row];
+	r.bounds = bounds[row];
+	r.technique = techniques[row];
+	r.geometry = geometry[row];
+	if (components & TEXTURE)
+		r.texture = textures[row];
+	r.constants = constants[row];
+	r.mesh = meshes[row];
+	return r;
+}
+
+template <typename T>
+static void moveLast(std::vector<T>& v, size_t row)
+{
+	if (v.empty())
+		return;
+	v[row] = v.back();
+	v.pop_back();
+}
+
+uint32_t RenderableStore::Archetype::remove(size_t row)
+{
+	const bool last = row + 1 == entities.size();
+	moveLast(entities, row);
+	moveLast(nodes, row);
+	moveLast(bounds, row);
+	moveLast(techniques, row);
+	moveLast(geometry, row);
+	moveLast(textures, row);
+	moveLast(constants, row);
+	moveLast(meshes, row);
+	return last ? NONE : entities[row];
+}
+
+uint32_t RenderableStore::componentsOf(const Renderable& r)
+{
+	return ALWAYS | (r.node != NONE ? (uint32_t)NODE : 0u) | (r.texture != NONE ? (uint32_t)TEXTURE : 0u);
+}
+
+uint32_t RenderableStore::archetypeFor(uint32_t components)
+{
+	for (size_t a = 0; a < archetypes.size(); a++)
+		if (archetypes[a].components == components)
+			return (uint32_t)a;
+	archetypes.push_back(Archetype());
+	archetypes.back().components = components;
+	return (uint32_t)archetypes.size() - 1;
+}
+
+void RenderableStore::insert(uint32_t entity, const Renderable& r)
+{
+	const uint32_t a = archetypeFor(componentsOf(r));
+	locations[entity].archetype = a;
+	locations[entity].row = (uint32_t)archetypes[a].entities.size();
+	archetypes[a].push(entity, r);
+}
+
+void RenderableStore::erase(uint32_t entity)
+{
+	Location& l = locations[entity];
+	const uint32_t moved = archetypes[l.archetype].remove(l.row);
+	if (moved != NONE)
+		locations[moved].row = l.row;
+	l.archetype = NONE;
+}
+
+uint32_t RenderableStore::create(const Renderable& r)
+{
+	uint32_t entity;
+	if (freeIds.empty())
+	{
+		entity = (uint32_t)locations.size();
+		locations.push_back({ NONE, 0 });
+	}
+	else
+	{
+		entity = freeIds.back();
+		freeIds.pop_back();
+	}
+	insert(entity, r);
+	live++;
+	return entity;
+}
+
+void RenderableStore::destroy(uint32_t entity)
+{
+	if (entity >= locations.size() || locations[entity].archetype == NONE)
+		return;
+	erase(entity);
+	freeIds.push_back(entity);
+	live--;
+}
+
+RenderableStore::Renderable RenderableStore::get(uint32_t entity) const
+{
+	const Location& l = locations[entity];
+	return archetypes[l.archetype].get(l.row);
+}
+
+void RenderableStore::set(uint32_t entity, const Renderable& r)
+{
+	Location& l = locations[entity];
+	Archetype& a = archetypes[l.archetype];
+	if (a.components != componentsOf(r))
+	{
+		erase(entity);
+		insert(entity, r);
+		return;
+	}
+	if (a.components & NODE)
+		a.nodes[l.row] = r.node;
+	a.bounds[l.row] = r.bounds;
+	a.techniques[l.row] = r.technique;
+	a.geometry[l.row] = r.geometry;
+	if (a.components & TEXTURE)
+		a.textures[l.row] = r.texture;
+	a.constants[l.row] = r.constants;
+	a.meshes[l.row] = r.mesh;
+}
+
+glm::vec4& RenderableStore::constants(uint32_t entity)
+{
+	const Location& l = locations[entity];
+	return archetypes[l.archetype].constants[l.row];
+}
+
+RenderableStore::Bounds& RenderableStore::bounds(uint32_t entity)
+{
+	const Location& l = locations[entity];
+	return archetypes[l.archetype].bounds[l.row];
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+class Mesh;
+class Technique;
+class Texture2D;
+class VertexBuffer;
+
+/*
+ Renderables as component arrays. Renderables with the same set of
+ components (an archetype) share one array per component, so a pass over
+ a component streams contiguous memory instead of chasing Mesh pointers.
+
+ Every renderable has BOUNDS, TECHNIQUE, GEOMETRY, CONSTANTS and MESH,
+ NODE and TEXTURE are optional: a renderable moves to another archetype
+ when set() adds or removes one.
+
+	store.forEach(RenderableStore::NODE, [&](const RenderableStore::View& v) {
+		for (size_t i = 0; i < v.count; i++)
+			v.constants[i] = hierarchy.world(v.nodes[i])[3];
+	});
+
+ Techniques, textures and vertex buffers are referred to by small dense
+ ids (techniqueId() and friends), so the arrays hold no pointers to
+ follow. Removing a renderable moves the last one of its archetype into
+ the hole, entity ids stay valid.
+*/
+class RenderableStore
+{
+public:
+	static const uint32_t NONE = 0xffffffff;
+
+	enum COMPONENT : uint32_t {
+		// TransformHierarchy node.
+		NODE = 1,
+		BOUNDS = 2,
+		TECHNIQUE = 4,
+		GEOMETRY = 8,
+		TEXTURE = 16,
+		// float4 of the TRANSLATION block.
+		CONSTANTS = 32,
+		// the Mesh the renderable was made from, for Renderer::submit.
+		MESH = 64
+	};
+	static const uint32_t ALWAYS = BOUNDS | TECHNIQUE | GEOMETRY | CONSTANTS | MESH;
+
+	// box around the renderable, before its translation (Mesh::bounds).
+	typedef Aabb Bounds;
+
+	// vertices [first, first + count) of a vertex buffer.
+	struct GeometryRange {
+		uint32_t buffer, first, count;
+	};
+
+	// one renderable, NODE and TEXTURE are present unless NONE.
+	struct Renderable {
+		uint32_t node = NONE;
+		Bounds bounds;
+		uint32_t technique = NONE;
+		GeometryRange geometry = { NONE, 0, 0 };
+		uint32_t texture = NONE;
+		glm::vec4 constants = glm::vec4(0.0f);
+		Mesh* mesh = nullptr;
+	};
+
+	// the arrays of one archetype, nullptr for the components it does not have.
+	struct View {
+		uint32_t components;
+		size_t count;
+		const uint32_t* entities;
+		uint32_t* nodes;
+		Bounds* bounds;
+		uint32_t* techniques;
+		GeometryRange* geometry;
+		uint32_t* textures;
+		glm::vec4* constants;
+		Mesh** meshes;
+	};
+
+	uint32_t create(const Renderable& r);
+	void destroy(uint32_t entity);
+	Renderable get(uint32_t entity) const;
+	void set(uint32_t entity, const Renderable& r);
+	// live renderables.
+	size_t size() const { return live; };
+
+	glm::vec4& constants(uint32_t entity);
+	Bounds& bounds(uint32_t entity);
+
+	// calls fn with the View of every non-empty archetype that has all of components.
+	template <typename F>
+	void forEach(uint32_t components, F fn)
+	{
+		for (auto& a : archetypes)
+			if ((a.components & components) == components && !a.entities.empty())
+				fn(a.view());
+	};
+
+	uint32_t techniqueId(Technique* technique) { return idOf(techniques, technique); };
+	uint32_t textureId(Texture2D* texture) { return idOf(textures, texture); };
+	uint32_t bufferId(VertexBuffer* buffer) { return idOf(buffers, buffer); };
+	Technique* technique(uint32_t id) const { return techniques[id]; };
+	Texture2D* texture(uint32_t id) const { return textures[id]; };
+	VertexBuffer* buffer(uint32_t id) const { return buffers[id]; };
+private:
+	struct Archetype {
+		uint32_t components;
+		std::vector<uint32_t> entities, nodes, techniques, textures;
+		std::vector<Bounds> bounds;
+		std::vector<GeometryRange> geometry;
+		std::vector<glm::vec4> constants;
+		std::vector<Mesh*> meshes;
+
+		View view();
+		void push(uint32_t entity, const Renderable& r);
+		Renderable get(size_t row) const;
+		// returns the entity moved into row, NONE if row was the last one.
+		uint32_t remove(size_t row);
+	};
+
+	struct Location {
+		uint32_t archetype;
+		uint32_t row;
+	};
+
+	static uint32_t componentsOf(const Renderable& r);
+	uint32_t archetypeFor(uint32_t components);
+	void insert(uint32_t entity, const Renderable& r);
+	void erase(uint32_t entity);
+
+	template <typename T>
+	static uint32_t idOf(std::vector<T*>& table, T* p)
+	{
+		for (size_t i = 0; i < table.size(); i++)
+			if (table[i] == p)
+				return (uint32_t)i;
+		table.push_back(p);
+		return (uint32_t)table.size() - 1;
+	};
+
+	std::vector<Archetype> archetypes;
+	// by entity id, archetype NONE for free ids.
+	std::vector<Location> locations;
+	std::vector<uint32_t> freeIds;
+	size_t live = 0;
+
+	std::vector<Technique*> techniques;
+	std::vector<Texture2D*> textures;
+	std::vector<VertexBuffer*> buffers;
+};
@@ -1,6 +1,12 @@
+#include <algorithm>
 #include "OpenGL/OpenGLRenderer.h"
 #include "Vulkan/VulkanRenderer.h"
+#include "Null/NullRenderer.h"
+#include "Software/SoftwareRenderer.h"
 #include "Renderer.h"
+#include "Mesh.h"
+#include "TransformBatch.h"
+#include "IA.h"
 
 
 Renderer* Renderer::makeRenderer(BACKEND option)
@@ -9,4 +15,81 @@ Renderer* Renderer::makeRenderer(BACKEND option)
 		return new OpenGLRenderer();
 	else if (option == BACKEND::VULKAN)
 		return new VulkanRenderer();
-}
\ No newline at end of file
+	else if (option == BACKEND::NULL_RENDERER)
+		return new NullRenderer();
+	else if (option == BACKEND::SOFTWARE)
+		return new SoftwareRenderer();
+	return nullptr;
+}
+
+void Renderer::attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source)
+{
+	transformMeshes = meshes;
+}
+
+void Renderer::updateTransforms(const TransformBatch& batch)
+{
+	const size_t count = std::min(batch.size(), transformMeshes.size());
+	transformScratch.resize(count * 4);
+	batch.write(transformScratch.data(), 4 * sizeof(float), count);
+	for (size_t i = 0; i < count; i++)
+	{
+		Mesh* m = transformMeshes[i];
+		m->txBuffer->setData(&transformScratch[i * 4], 4 * sizeof(float), m->technique->getMaterial(), TRANSLATION);
+	}
+}
+
+void Renderer::submit(Mesh* const* meshes, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		submit(meshes[i]);
+}
+
+void Renderer::destroy(VertexBufferHandle h)
+{
+	VertexBuffer* buffer = vertexBufferPool.get(h);
+	if (buffer != nullptr && buffer->refCount() > 0)
+		fprintf(stderr, "Destroying a vertex buffer still bound to %u meshes\n", buffer->refCount());
+	vertexBufferPool.destroy(h);
+}
+
+void Renderer::destroy(IndexBufferHandle h)
+{
+	IndexBuffer* buffer = indexBufferPool.get(h);
+	if (buffer != nullptr && buffer->refCount() > 0)
+		fprintf(stderr, "Destroying an index buffer still bound to %u meshes\n", buffer->refCount());
+	indexBufferPool.destroy(h);
+}
+
+uint32_t Renderer::addRenderable(Mesh* mesh)
+{
+	if (freeRetained.empty())
+	{
+		retained.push_back(mesh);
+		return (uint32_t)retained.size() - 1;
+	}
+	uint32_t id = freeRetained.back();
+	freeRetained.pop_back();
+	retained[id] = mesh;
+	return id;
+}
+
+void Renderer::updateRenderable(uint32_t id)
+{
+	// submitted again every frame, nothing to refresh.
+}
+
+void Renderer::removeRenderable(uint32_t id)
+{
+	if (id >= retained.size() || retained[id] == nullptr)
+		return;
+	retained[id] = nullptr;
+	freeRetained.push_back(id);
+}
+
+void Renderer::submitRetained()
+{
+	for (auto mesh : retained)
+		if (mesh != nullptr)
+			submit(mesh);
+}
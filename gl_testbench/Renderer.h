@@ -1,21 +1,41 @@
 #pragma once
 
 #include <unordered_map>
+#ifdef _WIN32
+// std::min and std::max, not the macros.
+#define NOMINMAX
 #include <Windows.h>
+#endif
 
 #include "RenderState.h"
 #include "Technique.h"
 #include "ConstantBuffer.h"
 #include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "FrameStats.h"
+#include "HandlePool.h"
+#include "Mesh.h"
+#include "Texture2D.h"
+#include "Sampler2D.h"
+#include "ComputeTechnique.h"
 
-class Mesh;
-class Texture2D;
-class Sampler2D;
+class GpuProfiler;
+class TransformBatch;
+struct Frustum;
 
 //CRITICAL_SECTION protectHere;
 //#define LOCK EnterCriticalSection(&protectHere)
 //#define UNLOCK LeaveCriticalSection(&protectHere)
 
+typedef Handle<Mesh> MeshHandle;
+typedef Handle<VertexBuffer> VertexBufferHandle;
+typedef Handle<IndexBuffer> IndexBufferHandle;
+typedef Handle<Texture2D> Texture2DHandle;
+typedef Handle<Sampler2D> Sampler2DHandle;
+typedef Handle<Material> MaterialHandle;
+typedef Handle<Technique> TechniqueHandle;
+typedef Handle<ComputeTechnique> ComputeTechniqueHandle;
+
 namespace CLEAR_BUFFER_FLAGS {
 	static const int COLOR = 1;
 	static const int DEPTH = 2;
@@ -24,10 +44,17 @@ namespace CLEAR_BUFFER_FLAGS {
 
 class Renderer {
 public:
-	enum class BACKEND { GL45, VULKAN, DX11, DX12 };
+	// NULL_RENDERER: no driver calls at all, see Null/NullRenderer.h
+	// SOFTWARE: CPU rasterizer, see Software/SoftwareRenderer.h
+	enum class BACKEND { GL45, VULKAN, DX11, DX12, NULL_RENDERER, SOFTWARE };
+	// order in which submitted meshes are drawn by frame().
+	// PER_TECHNIQUE groups meshes so each technique is enabled once per frame.
+	enum class SUBMISSION { UNSORTED, PER_TECHNIQUE };
+	// who writes the attached translations, see attachTransforms.
+	enum class TRANSFORMS { CPU, GPU };
 
 	/*
-	Return concrete objects of the BACKEND
+	Return concrete objects of the BACKEND, owned by the caller (delete them).
 	*/
 	static Renderer* makeRenderer(BACKEND backend);
 	virtual Material* makeMaterial(const std::string& name) = 0;
@@ -41,8 +68,56 @@ public:
 	virtual ConstantBuffer* makeConstantBuffer(std::string NAME, unsigned int location) = 0;
 	virtual Technique* makeTechnique(Material*, RenderState*) = 0;
 
+	/*
+	 Pooled objects of the BACKEND, see HandlePool.h. They live in the
+	 renderer's pools until destroy(), get() resolves a handle (nullptr once
+	 destroyed). Destroy them before shutdown().
+	*/
+	virtual MeshHandle createMesh() = 0;
+	virtual VertexBufferHandle createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage) = 0;
+	virtual Texture2DHandle createTexture2D() = 0;
+	virtual Sampler2DHandle createSampler2D() = 0;
+	virtual MaterialHandle createMaterial(const std::string& name) = 0;
+	virtual TechniqueHandle createTechnique(MaterialHandle m, RenderState* r) = 0;
+	// no handle when the backend only draws vertex streams (the default).
+	virtual IndexBufferHandle createIndexBuffer(size_t size, IndexBuffer::FORMAT format) { return IndexBufferHandle(); };
+
+	Mesh* get(MeshHandle h) const { return meshPool.get(h); };
+	VertexBuffer* get(VertexBufferHandle h) const { return vertexBufferPool.get(h); };
+	IndexBuffer* get(IndexBufferHandle h) const { return indexBufferPool.get(h); };
+	Texture2D* get(Texture2DHandle h) const { return texturePool.get(h); };
+	Sampler2D* get(Sampler2DHandle h) const { return samplerPool.get(h); };
+	Material* get(MaterialHandle h) const { return materialPool.get(h); };
+	Technique* get(TechniqueHandle h) const { return techniquePool.get(h); };
+	ComputeTechnique* get(ComputeTechniqueHandle h) const { return computePool.get(h); };
+
+	void destroy(MeshHandle h) { meshPool.destroy(h); };
+	void destroy(VertexBufferHandle h);
+	void destroy(IndexBufferHandle h);
+	void destroy(Texture2DHandle h) { texturePool.destroy(h); };
+	void destroy(Sampler2DHandle h) { samplerPool.destroy(h); };
+	void destroy(MaterialHandle h) { materialPool.destroy(h); };
+	void destroy(TechniqueHandle h) { techniquePool.destroy(h); };
+	void destroy(ComputeTechniqueHandle h) { computePool.destroy(h); };
+
+	/*
+	 Compute, see ComputeTechnique.h. createComputeTechnique takes a material
+	 compiled from a CS only, and returns no handle when the backend has no
+	 compute (the default) or its draws cannot read what the pass writes.
+	 dispatch runs x * y * z work groups before the draws of the frame, and
+	 makes its storage writes visible to them.
+	*/
+	virtual ComputeTechniqueHandle createComputeTechnique(MaterialHandle m) { return ComputeTechniqueHandle(); };
+	virtual void dispatch(ComputeTechnique* technique, uint32_t x, uint32_t y = 1, uint32_t z = 1) {};
+
 	Renderer() { /*InitializeCriticalSection(&protectHere);*/ };
-	virtual int initialize(unsigned int width = 800, unsigned int height = 600) = 0;
+	virtual ~Renderer() {};
+	/*
+	 headless: no window (and no surface/swapchain), the backend renders into
+	 offscreen targets that are rotated by present(). Works without a display.
+	 -1 (after printing why) when there is no window or context to render to.
+	*/
+	virtual int initialize(unsigned int width = 800, unsigned int height = 600, bool headless = false) = 0;
 	virtual void setWinTitle(const char* title) = 0;
 	virtual void present() = 0;
 	virtual int shutdown() = 0;
@@ -53,7 +128,85 @@ public:
 	virtual void setRenderState(RenderState* ps) = 0;
 	// submit work (to render) to the renderer.
 	virtual void submit(Mesh* mesh) = 0;
+	void submit(MeshHandle mesh) { submit(meshPool.get(mesh)); };
+	/*
+	 submit(meshes[i]) for the count meshes, one call for the batch. The
+	 default loops over submit(Mesh*), backends append the whole batch.
+	*/
+	virtual void submit(Mesh* const* meshes, size_t count);
+
+	/*
+	 Retained draws. addRenderable returns an id and the mesh is drawn by
+	 every frame() until removeRenderable, without a submit per frame. Call
+	 updateRenderable after changing the mesh (technique, buffers, textures),
+	 translations written through updateTransforms need nothing. submit()
+	 stays for draws of a single frame.
+	 The default keeps the meshes and submits them all in submitRetained(),
+	 backends with persistent draw lists override all three.
+	*/
+	virtual uint32_t addRenderable(Mesh* mesh);
+	virtual void updateRenderable(uint32_t id);
+	virtual void removeRenderable(uint32_t id);
 	virtual void frame() = 0;
+
+	/*
+	 Batched translations. attachTransforms gives meshes[i] (its txBuffer)
+	 slot i of the backend's per-draw translation buffer, call it again when
+	 the meshes change. updateTransforms then writes the batch into that
+	 buffer in one pass, without a setData per mesh. A later setData on an
+	 attached buffer detaches it again.
+	 With TRANSFORMS::GPU a compute technique writes the buffer instead
+	 (ComputeTechnique::setTransformBuffer) and updateTransforms is not
+	 called. Backends without compute ignore it.
+	 The default keeps the list and calls setData per mesh.
+	*/
+	virtual void attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source = TRANSFORMS::CPU);
+	virtual void updateTransforms(const TransformBatch& batch);
+	// bytes from one translation of the buffer to the next.
+	virtual size_t getTransformStride() const { return 4 * sizeof(float); };
+
+	/*
+	 GPU-driven retained draws. With a frustum, frame() culls the retained
+	 renderables on the GPU (see GpuCuller.h) and draws the visible ones of
+	 each technique bucket with one indirect multi draw, whose count the
+	 culling pass wrote. The renderables must be attached (attachTransforms),
+	 their materials read the translation buffer (TRANSLATION_BUFFER) and
+	 the meshes of a bucket share their buffers and textures, buckets that
+	 do not are drawn one by one as before. The frustum is copied, call it
+	 again when it changes; nullptr draws every renderable again.
+	 false when the backend cannot (the default): no compute or no indirect
+	 count draws.
+	*/
+	virtual bool setGpuCulling(const Frustum* frustum) { return false; };
+
+	void setSubmission(SUBMISSION s) { submission = s; };
+	SUBMISSION getSubmission() { return submission; };
+
+	// GPU timings per pass and technique, nullptr if the backend has none.
+	virtual GpuProfiler* getGpuProfiler() { return nullptr; };
+
+	// API calls of the last presented frame (and the frames before), see FrameStats.h.
+	const FrameStats& getFrameStats() const { return FrameStats::last(); };
+	std::vector<FrameStats> getFrameStatsHistory() const { return FrameStats::history(); };
 	
 	BACKEND IMPL;
+protected:
+	SUBMISSION submission = SUBMISSION::PER_TECHNIQUE;
+
+	HandlePool<Mesh> meshPool;
+	HandlePool<VertexBuffer> vertexBufferPool;
+	HandlePool<IndexBuffer> indexBufferPool;
+	HandlePool<Texture2D> texturePool;
+	HandlePool<Sampler2D> samplerPool;
+	HandlePool<Material> materialPool;
+	HandlePool<Technique> techniquePool;
+	HandlePool<ComputeTechnique> computePool;
+	// submits the default retained meshes, called by frame() of backends that do not override addRenderable.
+	void submitRetained();
+private:
+	std::vector<Mesh*> transformMeshes;
+	// by renderable id, nullptr for free ids.
+	std::vector<Mesh*> retained;
+	std::vector<uint32_t> freeRetained;
+	std::vector<float> transformScratch;
 };
@@ -0,0 +1,156 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class Mesh;
+
+/*
+ The retained renderables of a backend, as draw packets in buckets. A
+ bucket holds the packets of one key (the technique) and the buckets are
+ kept sorted by key, so frame() walks them in order without sorting or
+ copying anything. add, update and remove touch one bucket: the cost of a
+ change does not depend on how many renderables there are (except adding
+ the first packet of a new key, which renumbers the buckets after it).
+
+	uint32_t id = retained.add(key, mesh, packet);
+	retained.update(id, key, packet);   // moves buckets if the key changed
+	retained.remove(id);                // last packet of the bucket fills the hole
+
+ Ids are reused after remove.
+*/
+template <typename Packet>
+class RetainedList
+{
+public:
+	static const uint32_t NONE = 0xffffffff;
+
+	struct Bucket {
+		uint64_t key;
+		std::vector<Packet> packets;
+		// renderable id of each packet.
+		std::vector<uint32_t> ids;
+	};
+
+	uint32_t add(uint64_t key, Mesh* mesh, const Packet& packet)
+	{
+		uint32_t id;
+		if (freeIds.empty())
+		{
+			id = (uint32_t)locations.size();
+			locations.push_back({ NONE, 0, nullptr });
+		}
+		else
+		{
+			id = freeIds.back();
+			freeIds.pop_back();
+		}
+		locations[id].mesh = mesh;
+		insert(id, key, packet);
+		live++;
+		return id;
+	};
+
+	void update(uint32_t id, uint64_t key, const Packet& packet)
+	{
+		Location& l = locations[id];
+		if (buckets[l.bucket].key == key)
+		{
+			buckets[l.bucket].packets[l.row] = packet;
+			return;
+		}
+		erase(id);
+		insert(id, key, packet);
+	};
+
+	void remove(uint32_t id)
+	{
+		if (!valid(id))
+			return;
+		erase(id);
+		locations[id].mesh = nullptr;
+		freeIds.push_back(id);
+		live--;
+	};
+
+	bool valid(uint32_t id) const { return id < locations.size() && locations[id].bucket != NONE; };
+	Mesh* mesh(uint32_t id) const { return locations[id].mesh; };
+	size_t size() const { return live; };
+	// empty buckets stay until clear(), skip them.
+	const std::vector<Bucket>& getBuckets() const { return buckets; };
+
+	// compile(mesh, key, packet) for every renderable, when all packets are stale.
+	template <typename Compile>
+	void recompile(Compile compile)
+	{
+		for (uint32_t id = 0; id < locations.size(); id++)
+		{
+			if (!valid(id))
+				continue;
+			uint64_t key;
+			Packet packet;
+			compile(locations[id].mesh, key, packet);
+			update(id, key, packet);
+		}
+	};
+
+	void clear()
+	{
+		buckets.clear();
+		locations.clear();
+		freeIds.clear();
+		live = 0;
+	};
+private:
+	struct Location {
+		uint32_t bucket;
+		uint32_t row;
+		Mesh* mesh;
+	};
+
+	void insert(uint32_t id, uint64_t key, const Packet& packet)
+	{
+		uint32_t b = 0;
+		while (b < buckets.size() && buckets[b].key < key)
+			b++;
+		if (b == buckets.size() || buckets[b].key != key)
+		{
+			// the buckets after b move up one.
+			for (auto& l : locations)
+				if (l.bucket != NONE && l.bucket >= b)
+					l.bucket++;
+			Bucket bucket;
+			bucket.key = key;
+			buckets.insert(buckets.begin() + b, bucket);
+		}
+		Location& l = locations[id];
+		l.bucket = b;
+		l.row = (uint32_t)buckets[b].packets.size();
+		buckets[b].packets.push_back(packet);
+		buckets[b].ids.push_back(id);
+	};
+
+	void erase(uint32_t id)
+	{
+		Location& l = locations[id];
+		Bucket& bucket = buckets[l.bucket];
+		const uint32_t last = (uint32_t)bucket.ids.size() - 1;
+		if (l.row != last)
+		{
+			bucket.packets[l.row] = bucket.packets[last];
+			bucket.ids[l.row] = bucket.ids[last];
+			locations[bucket.ids[l.row]].row = l.row;
+		}
+		bucket.packets.pop_back();
+		bucket.ids.pop_back();
+		l.bucket = NONE;
+	};
+
+	std::vector<Bucket> buckets;
+	// by id, bucket NONE for free ids.
+	std::vector<Location> locations;
+	std::vector<uint32_t> freeIds;
+	size_t live = 0;
+};
+
+template <typename Packet> const uint32_t RetainedList<Packet>::NONE;
@@ -0,0 +1,28 @@
+#include <string.h>
+#include "ConstantBufferSoftware.h"
+#include "SoftwareRenderer.h"
+
+ConstantBufferSoftware::ConstantBufferSoftware(std::string NAME, unsigned int location)
+{
+	name = NAME;
+	this->location = location;
+}
+
+ConstantBufferSoftware::~ConstantBufferSoftware()
+{
+}
+
+void ConstantBufferSoftware::setData(const void* data, size_t size, Material* m, unsigned int location)
+{
+	memcpy(this->data, data, size < sizeof(this->data) ? size : sizeof(this->data));
+	source = nullptr;
+	FrameStats::current.uniformBytes += size < sizeof(this->data) ? size : sizeof(this->data);
+}
+
+void ConstantBufferSoftware::bind(Material*)
+{
+	if (location == TRANSLATION)
+		memcpy(SoftwareRenderer::bound.translate, source ? source : data, sizeof(data));
+	else if (location == DIFFUSE_TINT)
+		memcpy(SoftwareRenderer::bound.tint, data, sizeof(data));
+}
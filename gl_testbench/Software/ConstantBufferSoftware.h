@@ -0,0 +1,21 @@
+#pragma once
+#include "../ConstantBuffer.h"
+
+class ConstantBufferSoftware final : public ConstantBuffer
+{
+public:
+	ConstantBufferSoftware(std::string NAME, unsigned int location);
+	~ConstantBufferSoftware();
+	void setData(const void* data, size_t size, Material* m, unsigned int location);
+	// copies the vec4 into the bound state of its location.
+	void bind(Material*);
+	// binds the float4 at translation (a slot of the renderer's per-draw
+	// array) instead of its own data, until the next setData.
+	void attach(const float* translation) { source = translation; };
+private:
+	std::string name;
+	unsigned int location;
+	// both blocks of the testbench shaders are a single vec4.
+	float data[4] = { 0,0,0,0 };
+	const float* source = nullptr;
+};
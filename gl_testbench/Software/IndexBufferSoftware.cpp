@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "IndexBufferSoftware.h"
+#include "SoftwareRenderer.h"
+#include "../MemoryTracker.h"
+
+IndexBufferSoftware::IndexBufferSoftware(size_t size, IndexBuffer::FORMAT format) : IndexBuffer(format)
+{
+	totalSize = size;
+	memory = (unsigned char*)malloc(size);
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory, MemoryTracker::SYSTEM_MEMORY, size);
+}
+
+IndexBufferSoftware::~IndexBufferSoftware()
+{
+	MemoryTracker::release(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory);
+	free(memory);
+}
+
+void IndexBufferSoftware::setData(const void* data, size_t size, size_t offset)
+{
+	if (offset + size > totalSize)
+	{
+		fprintf(stderr, "IndexBufferSoftware::setData out of range\n");
+		exit(-1);
+	}
+	memcpy(memory + offset, data, size);
+	FrameStats::current.stagingBytes += size;
+}
+
+void IndexBufferSoftware::bind(size_t offset)
+{
+	const size_t size = offset < totalSize ? totalSize - offset : 0;
+	SoftwareRenderer::bound.indices = size ? memory + offset : nullptr;
+	SoftwareRenderer::bound.indexSize = getIndexSize();
+	SoftwareRenderer::bound.indexCount = size / getIndexSize();
+}
+
+size_t IndexBufferSoftware::getSize()
+{
+	return totalSize;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "../IndexBuffer.h"
+
+class IndexBufferSoftware final : public IndexBuffer
+{
+public:
+	IndexBufferSoftware(size_t size, IndexBuffer::FORMAT format);
+	~IndexBufferSoftware();
+
+	void setData(const void* data, size_t size, size_t offset);
+	// points the bound indices at offset, up to the end of the buffer.
+	void bind(size_t offset);
+	size_t getSize();
+private:
+	size_t totalSize;
+	unsigned char* memory;
+};
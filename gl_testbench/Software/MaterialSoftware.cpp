@@ -0,0 +1,78 @@
+#include "MaterialSoftware.h"
+#include "SoftwareRenderer.h"
+
+MaterialSoftware::MaterialSoftware(const std::string& name) : name(name)
+{
+}
+
+MaterialSoftware::~MaterialSoftware()
+{
+	for (auto cb : constantBuffers)
+		delete cb.second;
+}
+
+void MaterialSoftware::setShader(const std::string& shaderFileName, ShaderType type)
+{
+	shaderFileNames[type] = shaderFileName;
+}
+
+void MaterialSoftware::removeShader(ShaderType type)
+{
+	shaderFileNames.erase(type);
+}
+
+void MaterialSoftware::setDiffuse(Color c)
+{
+	color = c;
+}
+
+/*
+ FragmentShader.glsl samples myTex only when DIFFUSE_SLOT is defined,
+ that is the only variation the kernels need to know about.
+*/
+int MaterialSoftware::compileMaterial(std::string& errString)
+{
+	// a compute material, createComputeTechnique turns it down.
+	if (shaderFileNames.find(ShaderType::CS) != shaderFileNames.end())
+		return 0;
+	if (shaderFileNames.find(ShaderType::VS) == shaderFileNames.end() ||
+		shaderFileNames.find(ShaderType::PS) == shaderFileNames.end())
+	{
+		errString = "Material " + name + " needs a vertex and a fragment shader";
+		return -1;
+	}
+	kernel = KERNEL::TINTED;
+	for (auto& define : shaderDefines[ShaderType::PS])
+	{
+		if (define.find("#define DIFFUSE_SLOT") != std::string::npos)
+			kernel = KERNEL::TEXTURED;
+	}
+	isValid = true;
+	return 0;
+}
+
+void MaterialSoftware::addConstantBuffer(std::string name, unsigned int location)
+{
+	constantBuffers[location] = new ConstantBufferSoftware(name, location);
+}
+
+void MaterialSoftware::updateConstantBuffer(const void* data, size_t size, unsigned int location)
+{
+	constantBuffers[location]->setData(data, size, this, location);
+}
+
+int MaterialSoftware::enable()
+{
+	FrameStats::current.pipelineBinds++;
+	SoftwareRenderer::bound.kernel = kernel;
+	SoftwareRenderer::bound.layout = &vertexLayout;
+	for (auto cb : constantBuffers)
+	{
+		cb.second->bind(this);
+	}
+	return 0;
+}
+
+void MaterialSoftware::disable()
+{
+}
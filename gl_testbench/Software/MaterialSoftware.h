@@ -0,0 +1,29 @@
+#pragma once
+#include "../Material.h"
+#include "Rasterizer.h"
+#include "ConstantBufferSoftware.h"
+
+/*
+ No shader compilation: compileMaterial picks the C++ kernel matching the
+ defines the testbench would compile the GLSL with.
+*/
+class MaterialSoftware final : public Material
+{
+public:
+	MaterialSoftware(const std::string& name);
+	~MaterialSoftware();
+
+	void setShader(const std::string& shaderFileName, ShaderType type);
+	void removeShader(ShaderType type);
+	void setDiffuse(Color c);
+	int compileMaterial(std::string& errString);
+	void addConstantBuffer(std::string name, unsigned int location);
+	void updateConstantBuffer(const void* data, size_t size, unsigned int location);
+	int enable();
+	void disable();
+
+	KERNEL kernel = KERNEL::TINTED;
+private:
+	std::string name;
+	std::map<unsigned int, ConstantBufferSoftware*> constantBuffers;
+};
@@ -0,0 +1,286 @@
+#include <math.h>
+#include <algorithm>
+#include "Rasterizer.h"
+#include "Texture2DSoftware.h"
+#include "../Renderer.h"
+#include "../Profiler.h"
+#include "../MemoryTracker.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+/*
+ Thin wrappers so the triangle loop is written once for SSE2 and AVX2.
+*/
+#if defined(__AVX2__)
+static const int LANES = 8;
+typedef __m256 vfloat;
+typedef __m256i vint;
+static inline vfloat vset(float f) { return _mm256_set1_ps(f); }
+static inline vfloat vramp() { return _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat vmin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+static inline vfloat vand(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+static inline vfloat vor(vfloat a, vfloat b) { return _mm256_or_ps(a, b); }
+static inline vfloat vgt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline vfloat veq(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+static inline vfloat vlt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline int vmask(vfloat a) { return _mm256_movemask_ps(a); }
+static inline vfloat vload(const float* p) { return _mm256_loadu_ps(p); }
+static inline void vstore(float* p, vfloat a) { _mm256_storeu_ps(p, a); }
+static inline vfloat vselect(vfloat a, vfloat b, vfloat m) { return _mm256_blendv_ps(a, b, m); }
+static inline vint viload(const uint32_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+static inline void vistore(uint32_t* p, vint a) { _mm256_storeu_si256((__m256i*)p, a); }
+static inline vint viset(uint32_t v) { return _mm256_set1_epi32((int)v); }
+static inline vint viselect(vint a, vint b, vfloat m) { return _mm256_blendv_epi8(a, b, _mm256_castps_si256(m)); }
+#else
+static const int LANES = 4;
+typedef __m128 vfloat;
+typedef __m128i vint;
+static inline vfloat vset(float f) { return _mm_set1_ps(f); }
+static inline vfloat vramp() { return _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f); }
+static inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+static inline vfloat vand(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+static inline vfloat vor(vfloat a, vfloat b) { return _mm_or_ps(a, b); }
+static inline vfloat vgt(vfloat a, vfloat b) { return _mm_cmpgt_ps(a, b); }
+static inline vfloat veq(vfloat a, vfloat b) { return _mm_cmpeq_ps(a, b); }
+static inline vfloat vlt(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+static inline int vmask(vfloat a) { return _mm_movemask_ps(a); }
+static inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+static inline void vstore(float* p, vfloat a) { _mm_storeu_ps(p, a); }
+static inline vfloat vselect(vfloat a, vfloat b, vfloat m) { return _mm_or_ps(_mm_andnot_ps(m, a), _mm_and_ps(m, b)); }
+static inline vint viload(const uint32_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline void vistore(uint32_t* p, vint a) { _mm_storeu_si128((__m128i*)p, a); }
+static inline vint viset(uint32_t v) { return _mm_set1_epi32((int)v); }
+static inline vint viselect(vint a, vint b, vfloat m)
+{
+	__m128i mi = _mm_castps_si128(m);
+	return _mm_or_si128(_mm_andnot_si128(mi, a), _mm_and_si128(mi, b));
+}
+#endif
+
+Rasterizer::Rasterizer()
+{
+	tileJob = [this](size_t tile) { rasterizeTile(tile); };
+}
+
+Rasterizer::~Rasterizer()
+{
+	MemoryTracker::release(MemoryTracker::CATEGORY::RENDER_TARGET, (uint64_t)this);
+}
+
+void Rasterizer::resize(unsigned int w, unsigned int h)
+{
+	width = w;
+	height = h;
+	tilesX = (int)((w + TILE_SIZE - 1) / TILE_SIZE);
+	tilesY = (int)((h + TILE_SIZE - 1) / TILE_SIZE);
+	// padding to whole tiles lets the SIMD loop run past the right edge.
+	pitch = tilesX * TILE_SIZE;
+	colorBuffer.assign((size_t)pitch * tilesY * TILE_SIZE, 0);
+	depthBuffer.assign((size_t)pitch * tilesY * TILE_SIZE, 1.0f);
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::RENDER_TARGET, (uint64_t)this, MemoryTracker::SYSTEM_MEMORY,
+		colorBuffer.size() * sizeof(uint32_t) + depthBuffer.size() * sizeof(float), (uint64_t)w * h * (sizeof(uint32_t) + sizeof(float)));
+	bins.assign((size_t)tilesX * tilesY, std::vector<uint32_t>());
+	triangles.clear();
+}
+
+void Rasterizer::clear(unsigned int flags, uint32_t color, float depth)
+{
+	pendingClear |= flags;
+	if (flags & CLEAR_BUFFER_FLAGS::COLOR)
+		clearColor = color;
+	if (flags & CLEAR_BUFFER_FLAGS::DEPTH)
+		clearDepth = depth;
+}
+
+void Rasterizer::addTriangle(const float pos[3][4], const float uv[3][2], const TriangleSoftware& state)
+{
+	TriangleSoftware tri = state;
+	for (int i = 0; i < 3; i++)
+	{
+		const float invW = 1.0f / pos[i][3];
+		tri.x[i] = (pos[i][0] * invW * 0.5f + 0.5f) * width;
+		tri.y[i] = (0.5f - pos[i][1] * invW * 0.5f) * height;
+		tri.z[i] = pos[i][2] * invW * 0.5f + 0.5f;
+		tri.u[i] = uv[i][0];
+		tri.v[i] = uv[i][1];
+	}
+	// no culling (same as the GL backend), flip clockwise triangles.
+	const float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.y[1] - tri.y[0]) * (tri.x[2] - tri.x[0]);
+	if (area == 0.0f || area != area)
+		return;
+	if (area < 0.0f)
+	{
+		std::swap(tri.x[1], tri.x[2]); std::swap(tri.y[1], tri.y[2]); std::swap(tri.z[1], tri.z[2]);
+		std::swap(tri.u[1], tri.u[2]); std::swap(tri.v[1], tri.v[2]);
+	}
+
+	const float minX = std::min(tri.x[0], std::min(tri.x[1], tri.x[2]));
+	const float maxX = std::max(tri.x[0], std::max(tri.x[1], tri.x[2]));
+	const float minY = std::min(tri.y[0], std::min(tri.y[1], tri.y[2]));
+	const float maxY = std::max(tri.y[0], std::max(tri.y[1], tri.y[2]));
+	tri.minX = std::max((int)floorf(minX), 0);
+	tri.minY = std::max((int)floorf(minY), 0);
+	tri.maxX = std::min((int)ceilf(maxX), (int)width - 1);
+	tri.maxY = std::min((int)ceilf(maxY), (int)height - 1);
+	if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+		return;
+
+	const uint32_t index = (uint32_t)triangles.size();
+	triangles.push_back(tri);
+	for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ty++)
+	{
+		for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; tx++)
+		{
+			bins[ty * tilesX + tx].push_back(index);
+		}
+	}
+}
+
+void Rasterizer::render(JobSystem& jobs)
+{
+	jobs.parallelFor(bins.size(), tileJob);
+	pendingClear = 0;
+	triangles.clear();
+	for (auto& bin : bins)
+		bin.clear();
+}
+
+void Rasterizer::rasterizeTile(size_t tile)
+{
+	PROFILE_ZONE("rasterizeTile");
+	const int tx = (int)(tile % tilesX) * TILE_SIZE;
+	const int ty = (int)(tile / tilesX) * TILE_SIZE;
+
+	if (pendingClear & CLEAR_BUFFER_FLAGS::COLOR)
+	{
+		for (int y = ty; y < ty + TILE_SIZE; y++)
+			std::fill_n(&colorBuffer[(size_t)y * pitch + tx], TILE_SIZE, clearColor);
+	}
+	if (pendingClear & CLEAR_BUFFER_FLAGS::DEPTH)
+	{
+		for (int y = ty; y < ty + TILE_SIZE; y++)
+			std::fill_n(&depthBuffer[(size_t)y * pitch + tx], TILE_SIZE, clearDepth);
+	}
+
+	for (uint32_t index : bins[tile])
+	{
+		const TriangleSoftware& tri = triangles[index];
+		const int x0 = std::max(tri.minX, tx);
+		const int y0 = std::max(tri.minY, ty);
+		const int x1 = std::min(tri.maxX, tx + TILE_SIZE - 1);
+		const int y1 = std::min(tri.maxY, ty + TILE_SIZE - 1);
+		if (tri.kernel == KERNEL::TEXTURED)
+		{
+			if (tri.wireframe)
+				drawTriangle<KERNEL::TEXTURED, true>(tri, x0, y0, x1, y1);
+			else
+				drawTriangle<KERNEL::TEXTURED, false>(tri, x0, y0, x1, y1);
+		}
+		else
+		{
+			if (tri.wireframe)
+				drawTriangle<KERNEL::TINTED, true>(tri, x0, y0, x1, y1);
+			else
+				drawTriangle<KERNEL::TINTED, false>(tri, x0, y0, x1, y1);
+		}
+	}
+}
+
+/*
+ Edge i is opposite vertex i, E_i(p) = A_i * x + B_i * y + C_i is positive
+ inside. Pixels exactly on an edge belong to the triangle only for top-left
+ edges. Wireframe keeps the pixels within one pixel of an edge.
+*/
+template<KERNEL K, bool WIREFRAME>
+void Rasterizer::drawTriangle(const TriangleSoftware& tri, int x0, int y0, int x1, int y1)
+{
+	float A[3], B[3], C[3];
+	vfloat topLeft[3], invLen[3];
+	for (int i = 0; i < 3; i++)
+	{
+		const int a = (i + 1) % 3, b = (i + 2) % 3;
+		A[i] = tri.y[a] - tri.y[b];
+		B[i] = tri.x[b] - tri.x[a];
+		C[i] = tri.x[a] * tri.y[b] - tri.x[b] * tri.y[a];
+		const bool isTopLeft = A[i] > 0.0f || (A[i] == 0.0f && B[i] < 0.0f);
+		topLeft[i] = isTopLeft ? veq(vset(0.0f), vset(0.0f)) : vset(0.0f);
+		invLen[i] = vset(1.0f / sqrtf(A[i] * A[i] + B[i] * B[i]));
+	}
+	const float area = C[0] + C[1] + C[2];
+	const vfloat invArea = vset(1.0f / area);
+	const vfloat zero = vset(0.0f);
+	const vfloat z0 = vset(tri.z[0]), z1 = vset(tri.z[1]), z2 = vset(tri.z[2]);
+	const vint flat = viset(tri.color);
+
+	alignas(32) float us[LANES], vs[LANES];
+	alignas(32) uint32_t texels[LANES];
+
+	const int startX = x0 & ~(LANES - 1);
+	for (int y = y0; y <= y1; y++)
+	{
+		const float py = y + 0.5f;
+		float* depthRow = &depthBuffer[(size_t)y * pitch];
+		uint32_t* colorRow = &colorBuffer[(size_t)y * pitch];
+		vfloat rowE[3];
+		for (int i = 0; i < 3; i++)
+			rowE[i] = vset(B[i] * py + C[i]);
+
+		for (int x = startX; x <= x1; x += LANES)
+		{
+			const vfloat px = vadd(vset((float)x), vramp());
+			vfloat e[3];
+			vfloat inside = veq(zero, zero);
+			for (int i = 0; i < 3; i++)
+			{
+				e[i] = vadd(vmul(vset(A[i]), px), rowE[i]);
+				inside = vand(inside, vor(vgt(e[i], zero), vand(veq(e[i], zero), topLeft[i])));
+			}
+			if (vmask(inside) == 0)
+				continue;
+			if (WIREFRAME)
+			{
+				const vfloat d = vmin(vmul(e[0], invLen[0]), vmin(vmul(e[1], invLen[1]), vmul(e[2], invLen[2])));
+				inside = vand(inside, vlt(d, vset(1.0f)));
+			}
+
+			const vfloat b0 = vmul(e[0], invArea);
+			const vfloat b1 = vmul(e[1], invArea);
+			const vfloat b2 = vmul(e[2], invArea);
+			const vfloat z = vadd(vmul(b0, z0), vadd(vmul(b1, z1), vmul(b2, z2)));
+			const vfloat depth = vload(depthRow + x);
+			const vfloat pass = vand(inside, vlt(z, depth));
+			const int mask = vmask(pass);
+			if (mask == 0)
+				continue;
+			vstore(depthRow + x, vselect(depth, z, pass));
+
+			vint color = flat;
+			if (K == KERNEL::TEXTURED)
+			{
+				vstore(us, vadd(vmul(b0, vset(tri.u[0])), vadd(vmul(b1, vset(tri.u[1])), vmul(b2, vset(tri.u[2])))));
+				vstore(vs, vadd(vmul(b0, vset(tri.v[0])), vadd(vmul(b1, vset(tri.v[1])), vmul(b2, vset(tri.v[2])))));
+				for (int l = 0; l < LANES; l++)
+				{
+					if ((mask >> l) & 1)
+					{
+						const uint32_t t = tri.texture->sample(us[l], vs[l], tri.wrapS, tri.wrapT);
+						const uint32_t r = ((t & 0xff) * tri.tint[0]) >> 8;
+						const uint32_t g = (((t >> 8) & 0xff) * tri.tint[1]) >> 8;
+						const uint32_t b = (((t >> 16) & 0xff) * tri.tint[2]) >> 8;
+						texels[l] = r | (g << 8) | (b << 16) | (t & 0xff000000);
+					}
+				}
+				color = viload(texels);
+			}
+			vistore(colorRow + x, viselect(viload(colorRow + x), color, pass));
+		}
+	}
+}
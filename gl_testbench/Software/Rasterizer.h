@@ -0,0 +1,82 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "../JobSystem.h"
+#include "../Sampler2D.h"
+
+class Texture2DSoftware;
+
+/*
+ The two shader paths of the testbench as C++ kernels: VertexShader +
+ FragmentShader without DIFFUSE_SLOT (tint only) and with it (texture * tint).
+*/
+enum class KERNEL : uint8_t { TINTED = 0, TEXTURED = 1 };
+
+/*
+ Triangle after vertex processing, in pixels (y down, pixel centers at .5),
+ depth in [0,1]. Vertices are counter clockwise on screen.
+*/
+struct TriangleSoftware {
+	float x[3], y[3], z[3];
+	float u[3], v[3];
+	// packed RGBA8 for TINTED, 0..256 multipliers for TEXTURED.
+	uint32_t color;
+	uint16_t tint[3];
+	KERNEL kernel;
+	bool wireframe;
+	const Texture2DSoftware* texture;
+	WRAPPING wrapS, wrapT;
+	int minX, minY, maxX, maxY;
+};
+
+/*
+ Tile based rasterizer. addTriangle bins every triangle into the
+ TILE_SIZE x TILE_SIZE tiles its bounding box touches, render() then runs
+ one job per tile: pending clear, then the binned triangles in submission
+ order. A tile is only touched by one thread and keeps the submission order,
+ so the image does not depend on the thread count.
+
+ Edge functions and depth are evaluated 4 (SSE2) or 8 (AVX2) pixels at a time.
+*/
+class Rasterizer
+{
+public:
+	static const int TILE_SIZE = 64;
+
+	Rasterizer();
+	~Rasterizer();
+
+	void resize(unsigned int width, unsigned int height);
+	// deferred to the tile jobs of the next render().
+	void clear(unsigned int flags, uint32_t color, float depth);
+	// positions in normalized device coordinates.
+	void addTriangle(const float pos[3][4], const float uv[3][2], const TriangleSoftware& state);
+	void render(JobSystem& jobs);
+
+	unsigned int getWidth() const { return width; };
+	unsigned int getHeight() const { return height; };
+	// pixels per row of the color and depth buffers (a whole number of tiles).
+	unsigned int getPitch() const { return pitch; };
+	const uint32_t* getColorBuffer() const { return colorBuffer.data(); };
+	const float* getDepthBuffer() const { return depthBuffer.data(); };
+private:
+	void rasterizeTile(size_t tile);
+	template<KERNEL K, bool WIREFRAME>
+	void drawTriangle(const TriangleSoftware& tri, int x0, int y0, int x1, int y1);
+
+	unsigned int width = 0, height = 0, pitch = 0;
+	int tilesX = 0, tilesY = 0;
+	std::vector<uint32_t> colorBuffer;
+	std::vector<float> depthBuffer;
+
+	std::vector<TriangleSoftware> triangles;
+	std::vector<std::vector<uint32_t>> bins;
+
+	unsigned int pendingClear = 0;
+	uint32_t clearColor = 0;
+	float clearDepth = 1.0f;
+
+	// built once, so render() does not allocate.
+	std::function<void(size_t)> tileJob;
+};
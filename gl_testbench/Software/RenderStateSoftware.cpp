@@ -0,0 +1,20 @@
+#include "RenderStateSoftware.h"
+#include "SoftwareRenderer.h"
+
+RenderStateSoftware::RenderStateSoftware()
+{
+}
+
+RenderStateSoftware::~RenderStateSoftware()
+{
+}
+
+void RenderStateSoftware::setWireFrame(bool wireframe)
+{
+	this->wireframe = wireframe;
+}
+
+void RenderStateSoftware::set()
+{
+	SoftwareRenderer::bound.wireframe = wireframe;
+}
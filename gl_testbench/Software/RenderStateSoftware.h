@@ -0,0 +1,13 @@
+#pragma once
+#include "../RenderState.h"
+
+class RenderStateSoftware final : public RenderState
+{
+public:
+	RenderStateSoftware();
+	~RenderStateSoftware();
+	void setWireFrame(bool);
+	void set();
+private:
+	bool wireframe = false;
+};
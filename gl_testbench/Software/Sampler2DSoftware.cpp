@@ -0,0 +1,25 @@
+#include "Sampler2DSoftware.h"
+
+Sampler2DSoftware::Sampler2DSoftware()
+{
+}
+
+Sampler2DSoftware::~Sampler2DSoftware()
+{
+}
+
+void Sampler2DSoftware::setMagFilter(FILTER filter)
+{
+	magFilter = filter;
+}
+
+void Sampler2DSoftware::setMinFilter(FILTER filter)
+{
+	minFilter = filter;
+}
+
+void Sampler2DSoftware::setWrap(WRAPPING s, WRAPPING t)
+{
+	wrapS = s;
+	wrapT = t;
+}
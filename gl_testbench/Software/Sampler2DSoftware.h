@@ -0,0 +1,15 @@
+#pragma once
+#include "../Sampler2D.h"
+
+class Sampler2DSoftware final : public Sampler2D
+{
+public:
+	Sampler2DSoftware();
+	~Sampler2DSoftware();
+	void setMagFilter(FILTER filter);
+	void setMinFilter(FILTER filter);
+	void setWrap(WRAPPING s, WRAPPING t);
+
+	FILTER magFilter = LINEAR, minFilter = LINEAR;
+	WRAPPING wrapS = CLAMP, wrapT = CLAMP;
+};
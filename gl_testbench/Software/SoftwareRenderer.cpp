@@ -0,0 +1,325 @@
+#include <algorithm>
+#include "SoftwareRenderer.h"
+#include "MaterialSoftware.h"
+#include "TechniqueSoftware.h"
+#include "RenderStateSoftware.h"
+#include "VertexBufferSoftware.h"
+#include "IndexBufferSoftware.h"
+#include "ConstantBufferSoftware.h"
+#include "Texture2DSoftware.h"
+#include "Sampler2DSoftware.h"
+#include "../Mesh.h"
+#include "../TransformBatch.h"
+#include "../Profiler.h"
+#include "../StaticBackend.h"
+
+SoftwareRenderer::DrawState SoftwareRenderer::bound;
+
+static uint32_t packColor(float r, float g, float b, float a)
+{
+	auto byte = [](float f) { return (uint32_t)(std::min(std::max(f, 0.0f), 1.0f) * 255.0f + 0.5f); };
+	return byte(r) | (byte(g) << 8) | (byte(b) << 16) | (byte(a) << 24);
+}
+
+SoftwareRenderer::SoftwareRenderer()
+{
+	bound = DrawState();
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+}
+
+Material* SoftwareRenderer::makeMaterial(const std::string& name)
+{
+	return new MaterialSoftware(name);
+}
+
+Mesh* SoftwareRenderer::makeMesh()
+{
+	return new Mesh();
+}
+
+VertexBuffer* SoftwareRenderer::makeVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	return new VertexBufferSoftware(size, usage);
+}
+
+Texture2D* SoftwareRenderer::makeTexture2D()
+{
+	return new Texture2DSoftware();
+}
+
+Sampler2D* SoftwareRenderer::makeSampler2D()
+{
+	return new Sampler2DSoftware();
+}
+
+RenderState* SoftwareRenderer::makeRenderState()
+{
+	return new RenderStateSoftware();
+}
+
+// the GLSL files are not compiled, the kernels are picked from the defines.
+std::string SoftwareRenderer::getShaderPath()
+{
+	return std::string("../assets/GL45/");
+}
+
+std::string SoftwareRenderer::getShaderExtension()
+{
+	return std::string(".glsl");
+}
+
+ConstantBuffer* SoftwareRenderer::makeConstantBuffer(std::string NAME, unsigned int location)
+{
+	return new ConstantBufferSoftware(NAME, location);
+}
+
+Technique* SoftwareRenderer::makeTechnique(Material* m, RenderState* r)
+{
+	return new TechniqueSoftware(m, r);
+}
+
+MeshHandle SoftwareRenderer::createMesh()
+{
+	return meshPool.create<Mesh>();
+}
+
+VertexBufferHandle SoftwareRenderer::createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	return vertexBufferPool.create<VertexBufferSoftware>(size, usage);
+}
+
+IndexBufferHandle SoftwareRenderer::createIndexBuffer(size_t size, IndexBuffer::FORMAT format)
+{
+	return indexBufferPool.create<IndexBufferSoftware>(size, format);
+}
+
+Texture2DHandle SoftwareRenderer::createTexture2D()
+{
+	return texturePool.create<Texture2DSoftware>();
+}
+
+Sampler2DHandle SoftwareRenderer::createSampler2D()
+{
+	return samplerPool.create<Sampler2DSoftware>();
+}
+
+MaterialHandle SoftwareRenderer::createMaterial(const std::string& name)
+{
+	return materialPool.create<MaterialSoftware>(name);
+}
+
+TechniqueHandle SoftwareRenderer::createTechnique(MaterialHandle m, RenderState* r)
+{
+	return techniquePool.create<TechniqueSoftware>(get(m), r);
+}
+
+int SoftwareRenderer::initialize(unsigned int width, unsigned int height, bool headless)
+{
+	this->headless = headless;
+	if (!headless)
+	{
+		if (SDL_Init(SDL_INIT_VIDEO) != 0)
+		{
+			fprintf(stderr, "%s", SDL_GetError());
+			return -1;
+		}
+		window = SDL_CreateWindow("Software", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, 0);
+		if (window == nullptr)
+		{
+			fprintf(stderr, "%s", SDL_GetError());
+			return -1;
+		}
+	}
+	rasterizer.resize(width, height);
+	jobs = new JobSystem();
+	return 0;
+}
+
+void SoftwareRenderer::setWinTitle(const char* title)
+{
+	if (window)
+		SDL_SetWindowTitle(window, title);
+}
+
+void SoftwareRenderer::present()
+{
+	PROFILE_ZONE("present");
+	FrameStats::endFrame();
+	if (window == nullptr)
+		return;
+	SDL_Surface* surface = SDL_GetWindowSurface(window);
+	if (surface == nullptr)
+		return;
+	SDL_LockSurface(surface);
+	SDL_ConvertPixels(rasterizer.getWidth(), rasterizer.getHeight(),
+		SDL_PIXELFORMAT_ABGR8888, rasterizer.getColorBuffer(), rasterizer.getPitch() * sizeof(uint32_t),
+		surface->format->format, surface->pixels, surface->pitch);
+	SDL_UnlockSurface(surface);
+	SDL_UpdateWindowSurface(window);
+}
+
+int SoftwareRenderer::shutdown()
+{
+	delete jobs;
+	jobs = nullptr;
+	if (window)
+	{
+		SDL_DestroyWindow(window);
+		window = nullptr;
+		SDL_Quit();
+	}
+	return 0;
+}
+
+void SoftwareRenderer::setClearColor(float r, float g, float b, float a)
+{
+	clearColor = packColor(r, g, b, a);
+}
+
+void SoftwareRenderer::clearBuffer(unsigned int flag)
+{
+	rasterizer.clear(flag, clearColor, 1.0f);
+}
+
+void SoftwareRenderer::setRenderState(RenderState* ps)
+{
+	direct<RenderStateSoftware>(ps)->set();
+}
+
+void SoftwareRenderer::submit(Mesh* mesh)
+{
+	FrameStats::current.drawsSubmitted++;
+	drawList.push_back(mesh);
+}
+
+void SoftwareRenderer::submit(Mesh* const* meshes, size_t count)
+{
+	PROFILE_ZONE("submit");
+	FrameStats::current.drawsSubmitted += count;
+	drawList.insert(drawList.end(), meshes, meshes + count);
+}
+
+void SoftwareRenderer::attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source)
+{
+	translations.assign(meshes.size() * 4, 0.0f);
+	for (size_t i = 0; i < meshes.size(); i++)
+		((ConstantBufferSoftware*)meshes[i]->txBuffer)->attach(&translations[i * 4]);
+}
+
+void SoftwareRenderer::updateTransforms(const TransformBatch& batch)
+{
+	const size_t count = std::min(batch.size(), translations.size() / 4);
+	batch.write(translations.data(), 4 * sizeof(float), count);
+	FrameStats::current.uniformBytes += count * 4 * sizeof(float);
+}
+
+/*
+ Binds exactly like the other backends, then draw() runs the vertex stage
+ on the bound streams and bins the triangles. Shading happens in
+ rasterizer.render(), one job per tile.
+*/
+void SoftwareRenderer::frame()
+{
+	PROFILE_ZONE("frame");
+	submitRetained();
+	if (submission == SUBMISSION::PER_TECHNIQUE)
+		std::stable_sort(drawList.begin(), drawList.end(), TechniqueSoftware::sortMesh);
+
+	Technique* current = nullptr;
+	for (auto mesh : drawList)
+	{
+		if (submission != SUBMISSION::PER_TECHNIQUE || mesh->technique != current)
+		{
+			current = mesh->technique;
+			direct<TechniqueSoftware>(current)->enable(this);
+		}
+		bound.texture = nullptr;
+		for (auto t : mesh->textures)
+		{
+			direct<Texture2DSoftware>(t.second)->bind(t.first);
+		}
+		for (auto& element : mesh->geometryBuffers)
+		{
+			const Mesh::VertexBufferBind& vb = element.second;
+			direct<VertexBufferSoftware>(vb.buffer)->bind(vb.offset, vb.numElements * vb.sizeElement, element.first);
+		}
+		direct<ConstantBufferSoftware>(mesh->txBuffer)->bind(current->getMaterial());
+		bound.indices = nullptr;
+		if (mesh->indexBuffer.buffer)
+		{
+			static_cast<IndexBufferSoftware*>(mesh->indexBuffer.buffer)->bind(mesh->indexBuffer.offset);
+			draw(mesh->indexBuffer.count);
+		}
+		else
+			draw(mesh->geometryBuffers[POSITION].numElements);
+		FrameStats::current.drawsIssued++;
+	}
+	drawList.clear();
+	PROFILE_ZONE("rasterize");
+	rasterizer.render(*jobs);
+}
+
+/*
+ VertexShader.glsl: gl_Position = position_in[gl_VertexID] + translate,
+ uv passed through, both decoded as the material's VertexLayout says.
+ Triangle list, vertexCount indices when indices are bound (gl_VertexID is
+ the index); triangles with an index past the streams are dropped.
+*/
+void SoftwareRenderer::draw(size_t vertexCount)
+{
+	const VertexLayout::Attribute* position = bound.layout ? bound.layout->find(POSITION) : nullptr;
+	const VertexLayout::Attribute* uv = bound.layout ? bound.layout->find(TEXTCOORD) : nullptr;
+	if (position == nullptr || position->stream > TEXTCOORD || bound.streams[position->stream] == nullptr)
+		return;
+	const unsigned char* positions = bound.streams[position->stream] + position->offset;
+	const size_t positionStride = bound.layout->getStride(position->stream);
+	const size_t vertices = bound.streamSizes[position->stream] / positionStride;
+	const bool indexed = bound.indices != nullptr;
+	vertexCount = std::min(vertexCount, indexed ? bound.indexCount : vertices);
+	const bool textured = bound.kernel == KERNEL::TEXTURED && bound.texture != nullptr &&
+		uv != nullptr && uv->stream <= TEXTCOORD && bound.streams[uv->stream] != nullptr &&
+		bound.streamSizes[uv->stream] >= (indexed ? vertices : vertexCount) * bound.layout->getStride(uv->stream);
+	const unsigned char* uvs = textured ? bound.streams[uv->stream] + uv->offset : nullptr;
+	const size_t uvStride = textured ? bound.layout->getStride(uv->stream) : 0;
+	auto fetch = [&](size_t n) -> size_t {
+		if (!indexed)
+			return n;
+		return bound.indexSize == sizeof(uint16_t) ? ((const uint16_t*)bound.indices)[n] : ((const uint32_t*)bound.indices)[n];
+	};
+
+	TriangleSoftware state;
+	state.kernel = textured ? KERNEL::TEXTURED : KERNEL::TINTED;
+	state.wireframe = bound.wireframe;
+	state.texture = bound.texture;
+	state.wrapS = bound.wrapS;
+	state.wrapT = bound.wrapT;
+	state.color = packColor(bound.tint[0], bound.tint[1], bound.tint[2], 1.0f);
+	for (int c = 0; c < 3; c++)
+		state.tint[c] = (uint16_t)(std::min(std::max(bound.tint[c], 0.0f), 1.0f) * 256.0f + 0.5f);
+
+	float pos[3][4];
+	float texcoord[3][2] = {};
+	float value[4];
+	for (size_t v = 0; v + 2 < vertexCount; v += 3)
+	{
+		size_t index[3] = { fetch(v), fetch(v + 1), fetch(v + 2) };
+		if (index[0] >= vertices || index[1] >= vertices || index[2] >= vertices)
+			continue;
+		for (int i = 0; i < 3; i++)
+		{
+			VertexLayout::unpack(position->format, positions + index[i] * positionStride, value);
+			for (int c = 0; c < 4; c++)
+				pos[i][c] = value[c] + bound.translate[c];
+			if (textured)
+			{
+				VertexLayout::unpack(uv->format, uvs + index[i] * uvStride, value);
+				texcoord[i][0] = value[0];
+				texcoord[i][1] = value[1];
+			}
+		}
+		rasterizer.addTriangle(pos, texcoord, state);
+	}
+}
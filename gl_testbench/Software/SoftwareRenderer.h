@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <SDL.h>
+#include "../Renderer.h"
+#include "../IA.h"
+#include "../JobSystem.h"
+#include "Rasterizer.h"
+
+class Texture2DSoftware;
+
+/*
+ CPU rasterizer backend. No GPU or driver is involved, the image only
+ depends on the submitted work, so every machine renders the same pixels.
+
+ Resources write what they bind into SoftwareRenderer::bound, the same
+ way the GL backend binds into the GL context; frame() turns each draw and
+ the bound state into triangles for the Rasterizer, which shades the
+ screen tiles on a JobSystem.
+
+ With a window the color buffer is copied to the window surface in
+ present(), headless keeps it in memory (getColorBuffer).
+*/
+class SoftwareRenderer final : public Renderer
+{
+public:
+	// the "pipeline state" resources bind into.
+	struct DrawState {
+		const unsigned char* streams[TEXTCOORD + 1];
+		size_t streamSizes[TEXTCOORD + 1];
+		// nullptr draws the streams in order.
+		const unsigned char* indices;
+		size_t indexSize, indexCount;
+		float translate[4];
+		float tint[4];
+		KERNEL kernel;
+		// of the enabled material, where draw finds position and uv.
+		const VertexLayout* layout;
+		bool wireframe;
+		const Texture2DSoftware* texture;
+		WRAPPING wrapS, wrapT;
+	};
+	static DrawState bound;
+
+	SoftwareRenderer();
+	~SoftwareRenderer();
+
+	Material* makeMaterial(const std::string& name);
+	Mesh* makeMesh();
+	VertexBuffer* makeVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage);
+	Texture2D* makeTexture2D();
+	Sampler2D* makeSampler2D();
+	RenderState* makeRenderState();
+	std::string getShaderPath();
+	std::string getShaderExtension();
+	ConstantBuffer* makeConstantBuffer(std::string NAME, unsigned int location);
+	Technique* makeTechnique(Material*, RenderState*);
+	MeshHandle createMesh();
+	VertexBufferHandle createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage);
+	IndexBufferHandle createIndexBuffer(size_t size, IndexBuffer::FORMAT format);
+	Texture2DHandle createTexture2D();
+	Sampler2DHandle createSampler2D();
+	MaterialHandle createMaterial(const std::string& name);
+	TechniqueHandle createTechnique(MaterialHandle m, RenderState* r);
+
+	int initialize(unsigned int width = 800, unsigned int height = 600, bool headless = false);
+	void setWinTitle(const char* title);
+	void present();
+	int shutdown();
+
+	void setClearColor(float, float, float, float);
+	void clearBuffer(unsigned int);
+	void setRenderState(RenderState* ps);
+	// submit(MeshHandle) of Renderer.
+	using Renderer::submit;
+	void submit(Mesh* mesh);
+	void submit(Mesh* const* meshes, size_t count);
+	void frame();
+	// translations live in one array, see Renderer::attachTransforms.
+	void attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source = TRANSFORMS::CPU);
+	void updateTransforms(const TransformBatch& batch);
+
+	// RGBA8 rows of getPitch() pixels, valid after frame().
+	const uint32_t* getColorBuffer() const { return rasterizer.getColorBuffer(); };
+	unsigned int getPitch() const { return rasterizer.getPitch(); };
+private:
+	void draw(size_t vertexCount);
+
+	SDL_Window* window = nullptr;
+	bool headless = false;
+
+	JobSystem* jobs = nullptr;
+	Rasterizer rasterizer;
+	std::vector<Mesh*> drawList;
+	// float4 per attached mesh, copied to bound by its constant buffer.
+	std::vector<float> translations;
+	uint32_t clearColor = 0;
+};
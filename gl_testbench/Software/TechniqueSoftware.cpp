@@ -0,0 +1,27 @@
+#include "TechniqueSoftware.h"
+#include "SoftwareRenderer.h"
+#include "MaterialSoftware.h"
+#include "../Mesh.h"
+#include "../StaticBackend.h"
+
+uint32_t TechniqueSoftware::lastId = 0;
+
+TechniqueSoftware::TechniqueSoftware(Material* m, RenderState* r) : Technique(m, r)
+{
+	id = ++lastId;
+}
+
+TechniqueSoftware::~TechniqueSoftware()
+{
+}
+
+void TechniqueSoftware::enable(Renderer* renderer)
+{
+	direct<SoftwareRenderer>(renderer)->setRenderState(renderState);
+	direct<MaterialSoftware>(material)->enable();
+}
+
+bool TechniqueSoftware::sortMesh(const Mesh* meshA, const Mesh* meshB)
+{
+	return ((TechniqueSoftware*)meshA->technique)->id < ((TechniqueSoftware*)meshB->technique)->id;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include "../Technique.h"
+
+class Mesh;
+
+class TechniqueSoftware final : public Technique
+{
+public:
+	TechniqueSoftware(Material* m, RenderState* r);
+	~TechniqueSoftware();
+	// the same as Technique::enable, on the Software classes (see StaticBackend.h).
+	void enable(Renderer* renderer);
+
+	// creation order, keeps PER_TECHNIQUE sorting deterministic.
+	static bool sortMesh(const Mesh* meshA, const Mesh* meshB);
+
+	uint32_t id;
+private:
+	static uint32_t lastId;
+};
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include "stb_image.h"
+#include "Texture2DSoftware.h"
+#include "Sampler2DSoftware.h"
+#include "SoftwareRenderer.h"
+#include "../Profiler.h"
+#include "../MemoryTracker.h"
+
+// spreads the bits of v to the even bit positions.
+static uint32_t spreadBits(uint32_t v)
+{
+	v &= 0x0000ffff;
+	v = (v | (v << 8)) & 0x00ff00ff;
+	v = (v | (v << 4)) & 0x0f0f0f0f;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+	return v;
+}
+
+Texture2DSoftware::Texture2DSoftware()
+{
+	// 1x1 white until something is loaded.
+	texels.assign(1, 0xffffffff);
+	mortonX.assign(1, 0);
+	mortonY.assign(1, 0);
+}
+
+Texture2DSoftware::~Texture2DSoftware()
+{
+	MemoryTracker::release(MemoryTracker::CATEGORY::TEXTURE, (uint64_t)this);
+}
+
+// return 0 if image was loaded, else -1
+int Texture2DSoftware::loadFromFile(std::string filename)
+{
+	PROFILE_ZONE("loadTexture");
+	int w, h, bpp;
+	unsigned char* rgba = stbi_load(filename.c_str(), &w, &h, &bpp, STBI_rgb_alpha);
+	if (rgba == nullptr)
+	{
+		fprintf(stderr, "Error loading texture file: %s\n", filename.c_str());
+		return -1;
+	}
+
+	width = w;
+	height = h;
+	int side = 1;
+	while (side < w || side < h)
+		side <<= 1;
+
+	mortonX.resize(w);
+	mortonY.resize(h);
+	for (int x = 0; x < w; x++)
+		mortonX[x] = spreadBits(x);
+	for (int y = 0; y < h; y++)
+		mortonY[y] = spreadBits(y) << 1;
+
+	texels.assign((size_t)side * side, 0);
+	const uint32_t* src = (const uint32_t*)rgba;
+	for (int y = 0; y < h; y++)
+		for (int x = 0; x < w; x++)
+			texels[mortonX[x] | mortonY[y]] = src[y * w + x];
+	// the square power of two padding shows up as fragmentation.
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::TEXTURE, (uint64_t)this, MemoryTracker::SYSTEM_MEMORY,
+		texels.size() * sizeof(uint32_t), (uint64_t)w * h * sizeof(uint32_t));
+
+	stbi_image_free(rgba);
+	return 0;
+}
+
+void Texture2DSoftware::bind(unsigned int slot)
+{
+	FrameStats::current.textureBinds++;
+	// the fragment kernels only read DIFFUSE_SLOT.
+	if (slot != DIFFUSE_SLOT)
+		return;
+	SoftwareRenderer::bound.texture = this;
+	Sampler2DSoftware* s = (Sampler2DSoftware*)sampler;
+	SoftwareRenderer::bound.wrapS = s ? s->wrapS : WRAPPING::CLAMP;
+	SoftwareRenderer::bound.wrapT = s ? s->wrapT : WRAPPING::CLAMP;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+#include "../Texture2D.h"
+
+/*
+ RGBA8 texture stored in Morton (Z) order, so the texels of a small screen
+ area are close in memory whatever the orientation of the triangle. The
+ image is padded to a power of two square; the Morton index of (x, y) is
+ mortonX[x] | mortonY[y].
+*/
+class Texture2DSoftware final : public Texture2D
+{
+public:
+	Texture2DSoftware();
+	~Texture2DSoftware();
+
+	int loadFromFile(std::string filename);
+	void bind(unsigned int slot);
+
+	// nearest texel, v = 0 is the first row of the image.
+	inline uint32_t sample(float u, float v, WRAPPING s, WRAPPING t) const
+	{
+		int x = (int)floorf(u * width);
+		int y = (int)floorf(v * height);
+		x = s == WRAPPING::REPEAT ? ((x % width) + width) % width : (x < 0 ? 0 : (x >= width ? width - 1 : x));
+		y = t == WRAPPING::REPEAT ? ((y % height) + height) % height : (y < 0 ? 0 : (y >= height ? height - 1 : y));
+		return texels[mortonX[x] | mortonY[y]];
+	}
+
+	int width = 1, height = 1;
+private:
+	std::vector<uint32_t> texels;
+	std::vector<uint32_t> mortonX, mortonY;
+};
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "VertexBufferSoftware.h"
+#include "SoftwareRenderer.h"
+#include "../MemoryTracker.h"
+
+VertexBufferSoftware::VertexBufferSoftware(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	totalSize = size;
+	memory = (unsigned char*)malloc(size);
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory, MemoryTracker::SYSTEM_MEMORY, size);
+}
+
+VertexBufferSoftware::~VertexBufferSoftware()
+{
+	MemoryTracker::release(MemoryTracker::CATEGORY::VERTEX, (uint64_t)memory);
+	free(memory);
+}
+
+void VertexBufferSoftware::setData(const void* data, size_t size, size_t offset)
+{
+	if (offset + size > totalSize)
+	{
+		fprintf(stderr, "VertexBufferSoftware::setData out of range\n");
+		exit(-1);
+	}
+	memcpy(memory + offset, data, size);
+	FrameStats::current.stagingBytes += size;
+}
+
+void VertexBufferSoftware::bind(size_t offset, size_t size, unsigned int location)
+{
+	FrameStats::current.vertexBufferBinds++;
+	if (location > TEXTCOORD)
+		return;
+	if (offset + size > totalSize)
+		size = offset < totalSize ? totalSize - offset : 0;
+	SoftwareRenderer::bound.streams[location] = size ? memory + offset : nullptr;
+	SoftwareRenderer::bound.streamSizes[location] = size;
+}
+
+void VertexBufferSoftware::unbind()
+{
+}
+
+size_t VertexBufferSoftware::getSize()
+{
+	return totalSize;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "../VertexBuffer.h"
+
+class VertexBufferSoftware final : public VertexBuffer
+{
+public:
+	VertexBufferSoftware(size_t size, VertexBuffer::DATA_USAGE usage);
+	~VertexBufferSoftware();
+
+	void setData(const void* data, size_t size, size_t offset);
+	// points the bound stream of location at [offset, offset + size).
+	void bind(size_t offset, size_t size, unsigned int location);
+	void unbind();
+	size_t getSize();
+private:
+	size_t totalSize;
+	unsigned char* memory;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+/*
+ Static backend builds. Define one of TESTBENCH_STATIC_NULL,
+ TESTBENCH_STATIC_SOFTWARE, TESTBENCH_STATIC_GL or TESTBENCH_STATIC_VULKAN
+ and the testbench runs that backend only: main() ignores the backend
+ argument and renderScene() calls the final renderer class instead of the
+ Renderer interface, so submit, frame and present are direct calls.
+
+ The backends reach their own objects through direct<Concrete>(p). In a
+ static build it is a static_cast to the final class, so technique,
+ material, buffer and texture binds inline into the draw loop. Otherwise
+ it returns p unchanged and the calls stay virtual: the default build
+ keeps measuring the cost of the abstraction (see Null/NullRenderer.h).
+
+	direct<TechniqueNull>(mesh->technique)->enable(this);
+
+ Only cast objects the backend made itself, Capture and the other
+ wrappers keep going through the interface.
+
+ The "Release Static Null", "Release Static Software", "Release Static GL"
+ and "Release Static Vulkan" configurations (x64) of gl_testbench.sln are
+ Release with the define; with CMake, -DTESTBENCH_STATIC=NULL and so on.
+*/
+#if defined(TESTBENCH_STATIC_NULL) + defined(TESTBENCH_STATIC_SOFTWARE) + defined(TESTBENCH_STATIC_GL) + defined(TESTBENCH_STATIC_VULKAN) > 1
+#error "define only one TESTBENCH_STATIC_ backend"
+#endif
+
+#if defined(TESTBENCH_STATIC_NULL)
+#define TESTBENCH_STATIC_BACKEND Renderer::BACKEND::NULL_RENDERER
+#elif defined(TESTBENCH_STATIC_SOFTWARE)
+#define TESTBENCH_STATIC_BACKEND Renderer::BACKEND::SOFTWARE
+#elif defined(TESTBENCH_STATIC_GL)
+#define TESTBENCH_STATIC_BACKEND Renderer::BACKEND::GL45
+#elif defined(TESTBENCH_STATIC_VULKAN)
+#define TESTBENCH_STATIC_BACKEND Renderer::BACKEND::VULKAN
+#endif
+
+#ifdef TESTBENCH_STATIC_BACKEND
+template <typename Concrete, typename Interface>
+inline Concrete* direct(Interface* p) { return static_cast<Concrete*>(p); }
+#else
+template <typename Concrete, typename Interface>
+inline Interface* direct(Interface* p) { return p; }
+#endif
@@ -1,10 +1,8 @@
-#include <iostream>
 #include "Technique.h"
 #include "Renderer.h"
 
 Technique::~Technique()
 {
-	std::cout << "destroyed technique" << std::endl;
 }
 
 void Technique::enable(Renderer* renderer)
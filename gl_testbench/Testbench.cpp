@@ -0,0 +1,645 @@
+#define _USE_MATH_DEFINES
+#include <string>
+#include <type_traits>
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+
+#include "Testbench.h"
+#include "TransformBatch.h"
+#include "TransformHierarchy.h"
+#include "MeshOptimizer.h"
+#include "RenderableScene.h"
+#include "Camera.h"
+#include "OcclusionCuller.h"
+#include "Profiler.h"
+#include "StaticBackend.h"
+
+#if defined(TESTBENCH_STATIC_NULL)
+#include "Null/NullRenderer.h"
+typedef NullRenderer StaticBackend;
+#elif defined(TESTBENCH_STATIC_SOFTWARE)
+#include "Software/SoftwareRenderer.h"
+typedef SoftwareRenderer StaticBackend;
+#elif defined(TESTBENCH_STATIC_GL)
+#include "OpenGL/OpenGLRenderer.h"
+typedef OpenGLRenderer StaticBackend;
+#elif defined(TESTBENCH_STATIC_VULKAN)
+#include "Vulkan/VulkanRenderer.h"
+typedef VulkanRenderer StaticBackend;
+#endif
+
+using namespace std;
+
+vector<Mesh*> scene;
+vector<Material*> materials;
+vector<Technique*> techniques;
+vector<Texture2D*> textures;
+vector<Sampler2D*> samplers;
+
+// the streams of vertexLayout, in the order of its bindings.
+vector<VertexBuffer*> vertexBuffers;
+
+// everything above lives in the renderer's pools, these release it.
+static vector<MeshHandle> meshHandles;
+static vector<MaterialHandle> materialHandles;
+static vector<TechniqueHandle> techniqueHandles;
+static Texture2DHandle textureHandle;
+static Sampler2DHandle samplerHandle;
+static VertexBufferHandle bufferHandles[3];
+// gConfig.indexed: the indices every mesh draws its triangle with.
+static IndexBufferHandle indexHandle;
+// Renderer::addRenderable ids of the scene, when retained.
+static vector<uint32_t> renderables;
+
+static TestbenchConfig gConfig;
+// of every material of the scene, from gConfig.interleaved and quantized.
+static VertexLayout vertexLayout;
+static Renderer* gRenderer = nullptr;
+#ifdef TESTBENCH_STATIC_BACKEND
+// gRenderer as the final class, nullptr when it is wrapped (--capture).
+static StaticBackend* staticBackend = nullptr;
+#endif
+// translation of every mesh, z is fixed at initialisation.
+static TransformBatch transforms;
+// a node per mesh under one scene root, draw i is mesh i: the CPU
+// animation sets their local translations and writeChanged fills transforms.
+static TransformHierarchy hierarchy;
+static vector<uint32_t> meshNodes;
+// the identity, the view the shaders have (see Camera.h).
+static Camera camera;
+// every mesh of scene, entity i is scene[i]: the submit pass reads its
+// MESH arrays, gConfig.cull its bounds and translations.
+static RenderableScene renderableScene;
+// the meshes gConfig.cull found visible.
+static vector<Mesh*> visible;
+// gConfig.occluderSize: the quad, what it is made of, and its depth buffer.
+static Mesh* occluder = nullptr;
+static MeshHandle occluderHandle;
+static TechniqueHandle occluderTechnique;
+static VertexBufferHandle occluderBuffers[3];
+static OcclusionCuller occlusion;
+// the occluder's own material when the scene's read GPU translations.
+static MaterialHandle occluderMaterial;
+// gConfig.gpuAnimation: the compute pass, its material and the curve it reads.
+static MaterialHandle animationMaterial;
+static ComputeTechniqueHandle animationHandle;
+static ComputeTechnique* animation = nullptr;
+static VertexBufferHandle curveBuffer;
+
+// this has to do with how the triangles are spread in the screen, not important.
+// 2 * meshCount places.
+static vector<float> xt, yt;
+
+// lissajous points
+typedef union {
+	struct { float x, y, z, w; };
+	struct { float r, g, b, a; };
+} float4;
+
+typedef union {
+	struct { float x, y; };
+	struct { float u, v; };
+} float2;
+
+/*
+ update positions of triangles in the screen changing a translation only
+*/
+void updateScene(double time)
+{
+	PROFILE_ZONE("updateScene");
+	/*
+	    Mesh i is at place (i + shift) % places of the curve: the x and y of
+	    the scene are xt and yt rotated by shift, two contiguous copies each.
+	*/
+	{
+		const size_t size = transforms.size();
+		const size_t places = xt.size();
+		if (size == 0)
+			return;
+		// same speed as the old per-frame shift at 60Hz: meshCount/100 places per frame.
+		const long long shift = (long long)(time * 60.0 * max(gConfig.meshCount / 1000.0, gConfig.meshCount / 100.0));
+		const size_t start = (size_t)(shift % (long long)places);
+		if (animation != nullptr)
+		{
+			// the same places, computed where they are drawn: x first place, y meshes, z places, w stride in float4.
+			const uint32_t constants[4] = { (uint32_t)start, (uint32_t)size, (uint32_t)places,
+				(uint32_t)(gRenderer->getTransformStride() / (4 * sizeof(float))) };
+			animation->getMaterial()->updateConstantBuffer(constants, sizeof(constants), ANIMATION);
+			gRenderer->dispatch(animation, (uint32_t)((size + 63) / 64));
+			// culling still needs them on the CPU.
+			if (!gConfig.cull)
+				return;
+		}
+		const size_t head = min(size, places - start);
+		const float* z = transforms.z();
+		for (size_t i = 0; i < size; i++)
+		{
+			const size_t place = i < head ? start + i : i - head;
+			glm::mat4 local(1.0f);
+			local[3] = glm::vec4(xt[place], yt[place], z[i], 1.0f);
+			hierarchy.setLocal(meshNodes[i], local);
+		}
+		hierarchy.update();
+		hierarchy.writeChanged(transforms);
+		if (animation == nullptr)
+			gRenderer->updateTransforms(transforms);
+		if (gConfig.cull)
+			renderableScene.setTranslations(transforms);
+	}
+	return;
+};
+
+/*
+ Backend is Renderer, or the final renderer class of a static build (see
+ StaticBackend.h), where the batch submit becomes a direct call.
+*/
+template <typename Backend>
+static void renderSceneWith(Backend* renderer)
+{
+	renderer->clearBuffer(CLEAR_BUFFER_FLAGS::COLOR | CLEAR_BUFFER_FLAGS::DEPTH);
+	if (!gConfig.retained)
+	{
+		if (gConfig.cull)
+		{
+			visible.clear();
+			if (occluder != nullptr)
+				occlusion.render(camera.getConstants().viewProjection);
+			renderableScene.cull(camera.getFrustum(), visible, occluder != nullptr ? &occlusion : nullptr);
+			renderer->submit(visible.data(), visible.size());
+		}
+		else
+		{
+			// a batch per archetype (textured or not), straight from the store.
+			renderableScene.store().forEach(RenderableStore::ALWAYS, [renderer](const RenderableStore::View& v) {
+				renderer->submit(v.meshes, v.count);
+			});
+		}
+		if (occluder != nullptr)
+			renderer->submit(occluder);
+	}
+	renderer->frame();
+	renderer->present();
+}
+
+void renderScene(Renderer* renderer)
+{
+	PROFILE_ZONE("renderScene");
+#ifdef TESTBENCH_STATIC_BACKEND
+	if (staticBackend != nullptr && renderer == gRenderer)
+		return renderSceneWith(staticBackend);
+#endif
+	renderSceneWith(renderer);
+}
+
+/*
+ count vertices in vertexLayout: the bytes of every stream, in the order
+ of getStreams.
+*/
+static vector<vector<uint8_t>> packVertices(const float4* positions, const float4* normals, const float2* uvs, size_t count)
+{
+	const vector<unsigned int> streams = vertexLayout.getStreams();
+	vector<vector<uint8_t>> data(streams.size());
+	for (size_t s = 0; s < streams.size(); s++)
+	{
+		const size_t stride = vertexLayout.getStride(streams[s]);
+		data[s].resize(count * stride);
+		for (size_t v = 0; v < count; v++)
+			for (const VertexLayout::Attribute& a : vertexLayout.getAttributes())
+			{
+				if (a.stream != streams[s])
+					continue;
+				const float uv[4] = { uvs[v].x, uvs[v].y, 0.0f, 1.0f };
+				const float* value = a.location == POSITION ? &positions[v].x : a.location == NORMAL ? &normals[v].x : uv;
+				vertexLayout.pack(a.location, value, &data[s][v * stride]);
+			}
+	}
+	return data;
+}
+
+/*
+ a material of the scene: vertex and fragment shader with the same defines,
+ and the constant buffer that tints every triangle using it. An empty
+ handle when the shaders do not compile.
+*/
+static MaterialHandle createSceneMaterial(Renderer* renderer, const std::string& name, const std::string& vs, const std::string& ps,
+	const std::string& defines, const float tint[4])
+{
+	MaterialHandle handle = renderer->createMaterial(name);
+	Material* m = renderer->get(handle);
+	m->setShader(vs, Material::ShaderType::VS);
+	m->setShader(ps, Material::ShaderType::PS);
+	m->setVertexLayout(vertexLayout);
+
+	m->addDefine(defines, Material::ShaderType::VS);
+	m->addDefine(defines, Material::ShaderType::PS);
+
+	std::string err;
+	if (m->compileMaterial(err) != 0)
+	{
+		fprintf(stderr, "%s: %s\n", name.c_str(), err.c_str());
+		renderer->destroy(handle);
+		return MaterialHandle();
+	}
+
+	// add a constant buffer to the material, to tint every triangle using this material
+	m->addConstantBuffer(DIFFUSE_TINT_NAME, DIFFUSE_TINT);
+	// no need to update anymore
+	// when material is bound, this buffer should be also bound for access.
+
+	m->updateConstantBuffer(tint, 4 * sizeof(float), DIFFUSE_TINT);
+	return handle;
+}
+
+/*
+ the compute material and technique of gConfig.gpuAnimation, false (and
+ nothing left behind) when the backend has no compute for it (no
+ createComputeTechnique handle) or the shader does not compile.
+*/
+static bool createAnimation(Renderer* renderer, const std::string& shaderPath, const std::string& shaderExtension)
+{
+	animationMaterial = renderer->createMaterial("animation");
+	Material* m = renderer->get(animationMaterial);
+	m->setShader(shaderPath + "AnimationShader" + shaderExtension, Material::ShaderType::CS);
+	m->addDefine("#define PLACES " + std::to_string(PLACES) + "\n" +
+		"#define TRANSLATION " + std::to_string(TRANSLATION) + "\n" +
+		"#define TRANSLATION_NAME " + std::string(TRANSLATION_NAME) + "\n" +
+		"#define ANIMATION " + std::to_string(ANIMATION) + "\n" +
+		"#define ANIMATION_NAME " + std::string(ANIMATION_NAME) + "\n", Material::ShaderType::CS);
+	std::string err;
+	if (m->compileMaterial(err) != 0)
+	{
+		fprintf(stderr, "animation: %s\n", err.c_str());
+		renderer->destroy(animationMaterial);
+		return false;
+	}
+	animationHandle = renderer->createComputeTechnique(animationMaterial);
+	animation = renderer->get(animationHandle);
+	if (animation == nullptr)
+	{
+		renderer->destroy(animationMaterial);
+		return false;
+	}
+	m->addConstantBuffer(ANIMATION_NAME, ANIMATION);
+
+	// x and y of the places, read by every dispatch.
+	std::vector<float> curve(2 * xt.size());
+	for (size_t p = 0; p < xt.size(); p++)
+	{
+		curve[2 * p] = xt[p];
+		curve[2 * p + 1] = yt[p];
+	}
+	curveBuffer = renderer->createVertexBuffer(curve.size() * sizeof(float), VertexBuffer::DATA_USAGE::STATIC);
+	renderer->get(curveBuffer)->setData(curve.data(), curve.size() * sizeof(float), 0);
+	animation->setStorageBuffer(PLACES, renderer->get(curveBuffer));
+	animation->setTransformBuffer(TRANSLATION);
+	return true;
+}
+
+/*
+ decides which meshes are textured, spreading them evenly over the scene.
+ 0.25 gives every 4th mesh (as the original scene did).
+*/
+static bool isTextured(int i, float fraction)
+{
+	return (int)((i + 1) * fraction + 0.25f) != (int)(i * fraction + 0.25f);
+}
+
+int initialiseTestbench(Renderer* renderer, const TestbenchConfig& config)
+{
+	gConfig = config;
+	gRenderer = renderer;
+#ifdef TESTBENCH_STATIC_BACKEND
+	// wrapped (--capture) renderers keep the interface.
+	staticBackend = dynamic_cast<StaticBackend*>(renderer);
+#endif
+	gConfig.techniqueCount = max(config.techniqueCount, 1);
+	gConfig.texturedFraction = min(max(config.texturedFraction, 0.0f), 1.0f);
+	gConfig.cull = config.cull && !config.retained;
+	gConfig.gpuCull = config.gpuCull && config.retained;
+	gConfig.gpuAnimation = config.gpuAnimation || gConfig.gpuCull;
+	typedef VertexLayout::FORMAT FORMAT;
+	const FORMAT positionFormat = gConfig.quantized ? FORMAT::HALF4 : FORMAT::FLOAT4;
+	const FORMAT normalFormat = gConfig.quantized ? FORMAT::SNORM_10_10_10_2 : FORMAT::FLOAT4;
+	const FORMAT uvFormat = gConfig.quantized ? FORMAT::HALF2 : FORMAT::FLOAT2;
+	vertexLayout = gConfig.interleaved ? VertexLayout::interleaved(positionFormat, normalFormat, uvFormat) :
+		VertexLayout::split(positionFormat, normalFormat, uvFormat);
+
+	std::string definePos = "#define POSITION " + std::to_string(POSITION) + "\n";
+	std::string defineNor = "#define NORMAL " + std::to_string(NORMAL) + "\n";
+	std::string defineUV = "#define TEXTCOORD " + std::to_string(TEXTCOORD) + "\n";
+
+	std::string defineTX = "#define TRANSLATION " + std::to_string(TRANSLATION) + "\n";
+	std::string defineTXName = "#define TRANSLATION_NAME " + std::string(TRANSLATION_NAME) + "\n";
+
+	std::string defineDiffCol = "#define DIFFUSE_TINT " + std::to_string(DIFFUSE_TINT) + "\n";
+	std::string defineDiffColName = "#define DIFFUSE_TINT_NAME " + std::string(DIFFUSE_TINT_NAME) + "\n";
+
+	std::string defineDiffuse = "#define DIFFUSE_SLOT " + std::to_string(DIFFUSE_SLOT) + "\n";
+
+	// vertex shader, fragment shader, defines
+	// shader filename extension must be asked to the renderer
+	// these strings should be constructed from the IA.h file!!!
+	// one untextured material per technique, plus a textured variant of each
+	// if any mesh is textured.
+	std::vector<std::vector<std::string>> materialDefs;
+	for (int i = 0; i < gConfig.techniqueCount; i++)
+	{
+		materialDefs.push_back({ "VertexShader", "FragmentShader", definePos + defineNor + defineUV + defineTX +
+		   defineTXName + defineDiffCol + defineDiffColName });
+	}
+	if (gConfig.texturedFraction > 0.0f)
+	{
+		for (int i = 0; i < gConfig.techniqueCount; i++)
+		{
+			materialDefs.push_back({ "VertexShader", "FragmentShader", definePos + defineNor + defineUV + defineTX +
+			   defineTXName + defineDiffCol + defineDiffColName + defineDiffuse });
+		}
+	}
+
+	const int places = 2 * gConfig.meshCount;
+	xt.resize(places);
+	yt.resize(places);
+	float degToRad = M_PI / 180.0;
+	float scale = (float)places / 359.9;
+	for (int a = 0; a < places; a++)
+	{
+		xt[a] = 0.8f * cosf(degToRad * ((float)a/scale) * 3.0);
+		yt[a] = 0.8f * sinf(degToRad * ((float)a/scale) * 2.0);
+	};
+
+	// triangle geometry:
+	float4 triPos[3] = { { 0.0f,  0.05, 0.0f, 1.0f },{ 0.05, -0.05, 0.0f, 1.0f },{ -0.05, -0.05, 0.0f, 1.0f } };
+	float4 triNor[3] = { { 0.0f,  0.0f, 1.0f, 0.0f },{ 0.0f, 0.0f, 1.0f, 0.0f },{ 0.0f, 0.0f, 1.0f, 0.0f } };
+	float2 triUV[3] =  { { 0.5f,  -0.99f },{ 1.49f, 1.1f },{ -0.51, 1.1f } };
+
+	// load Materials.
+	std::string shaderPath = renderer->getShaderPath();
+	std::string shaderExtension = renderer->getShaderExtension();
+	float diffuse[4][4] = {
+		0.0,0.0,1.0,1.0,
+		0.0,1.0,0.0,1.0,
+		1.0,1.0,1.0,1.0,
+		1.0,0.0,0.0,1.0
+	};
+
+	// the compute pass comes first, the materials depend on whether there is one.
+	if (gConfig.gpuAnimation)
+		gConfig.gpuAnimation = createAnimation(renderer, shaderPath, shaderExtension);
+	// without the define the draws of the Vulkan backend push their translation.
+	const std::string defineTXBuffer = gConfig.gpuAnimation ? "#define TRANSLATION_BUFFER\n" : "";
+
+	for (size_t i = 0; i < materialDefs.size(); i++)
+	{
+		// set material name from text file?
+		materialHandles.push_back(createSceneMaterial(renderer, "material_" + std::to_string(i),
+			shaderPath + materialDefs[i][0] + shaderExtension, shaderPath + materialDefs[i][1] + shaderExtension,
+			materialDefs[i][2] + defineTXBuffer, diffuse[i % 4]));
+		if (!materialHandles.back())
+		{
+			materialHandles.pop_back();
+			shutdownTestbench();
+			return -1;
+		}
+		materials.push_back(renderer->get(materialHandles.back()));
+	}
+
+	// technique 0 (and its textured variant) with wireframe
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		RenderState* renderState = renderer->makeRenderState();
+		renderState->setWireFrame(i % gConfig.techniqueCount == 0);
+		techniqueHandles.push_back(renderer->createTechnique(materialHandles[i], renderState));
+		techniques.push_back(renderer->get(techniqueHandles.back()));
+	}
+
+	// create texture
+	textureHandle = renderer->createTexture2D();
+	Texture2D* fatboy = renderer->get(textureHandle);
+	fatboy->loadFromFile("../assets/textures/fatboy.png");
+	samplerHandle = renderer->createSampler2D();
+	Sampler2D* sampler = renderer->get(samplerHandle);
+	sampler->setWrap(WRAPPING::REPEAT, WRAPPING::REPEAT);
+	fatboy->sampler = sampler;
+
+	textures.push_back(fatboy);
+	samplers.push_back(sampler);
+
+	// the triangle in the layout of the materials, and one vertex buffer per stream for ALL triangles
+	constexpr auto numberOfElements = std::extent<decltype(triPos)>::value;
+	const vector<unsigned int> streams = vertexLayout.getStreams();
+	const vector<vector<uint8_t>> triVertices = packVertices(triPos, triNor, triUV, numberOfElements);
+	for (size_t s = 0; s < streams.size(); s++)
+	{
+		bufferHandles[s] = renderer->createVertexBuffer(gConfig.meshCount * triVertices[s].size(), VertexBuffer::DATA_USAGE::STATIC);
+		vertexBuffers.push_back(renderer->get(bufferHandles[s]));
+	}
+	IndexBuffer* indices = nullptr;
+	if (gConfig.indexed)
+	{
+		// they count from the first vertex of each mesh's bindings, in the
+		// triangle order of MeshOptimizer, narrowed to UINT16.
+		uint32_t order[] = { 0, 1, 2 };
+		MeshOptimizer::optimizeTriangleOrder(order, 3, &triPos[0].x, numberOfElements, sizeof(float4));
+		const uint16_t triIndices[] = { (uint16_t)order[0], (uint16_t)order[1], (uint16_t)order[2] };
+		indexHandle = renderer->createIndexBuffer(sizeof(triIndices), IndexBuffer::FORMAT::UINT16);
+		indices = renderer->get(indexHandle);
+		if (indices)
+			indices->setData(triIndices, sizeof(triIndices), 0);
+		gConfig.indexed = indices != nullptr;
+	}
+
+	// the triangles of all meshes, written with one setData batch per buffer.
+	vector<vector<VertexBuffer::Write>> writes(streams.size());
+
+	// Create a mesh array with a binding per stream.
+	for (int i = 0; i < gConfig.meshCount; i++) {
+
+		meshHandles.push_back(renderer->createMesh());
+		Mesh* m = renderer->get(meshHandles.back());
+
+		for (size_t s = 0; s < streams.size(); s++)
+		{
+			size_t offset = i * triVertices[s].size();
+			writes[s].push_back({ triVertices[s].data(), triVertices[s].size(), offset });
+			m->addIAVertexBufferBinding(vertexBuffers[s], offset, numberOfElements, vertexLayout.getStride(streams[s]), streams[s]);
+		}
+		m->setBounds(triPos, numberOfElements, sizeof(float4));
+		if (indices)
+			m->setIndexBuffer(indices, 0, numberOfElements);
+
+
+		// we can create a constant buffer outside the material, for example as part of the Mesh.
+		m->txBuffer = renderer->makeConstantBuffer(std::string(TRANSLATION_NAME), TRANSLATION);
+
+		if (isTextured(i, gConfig.texturedFraction))
+		{
+			m->technique = techniques[gConfig.techniqueCount + i % gConfig.techniqueCount];
+			m->addTexture(textures[0], DIFFUSE_SLOT);
+		}
+		else
+			m->technique = techniques[i % gConfig.techniqueCount];
+
+		scene.push_back(m);
+		renderableScene.addMesh(m);
+	}
+	for (size_t s = 0; s < streams.size(); s++)
+		vertexBuffers[s]->setData(writes[s].data(), writes[s].size());
+
+	/*
+	    the occluder: two triangles at z -0.75, nearer than every mesh (their
+	    z is in (-0.5, 0]), with the first untextured material. Its technique
+	    is made last, so per technique submission draws it last as well
+	    (the Vulkan pipelines have no depth test).
+	*/
+	if (gConfig.cull && gConfig.occluderSize > 0.0f)
+	{
+		const float s = gConfig.occluderSize;
+		float4 quadPos[6] = { { -s, -s, -0.75f, 1.0f },{ s, -s, -0.75f, 1.0f },{ s, s, -0.75f, 1.0f },
+			{ -s, -s, -0.75f, 1.0f },{ s, s, -0.75f, 1.0f },{ -s, s, -0.75f, 1.0f } };
+		float4 quadNor[6];
+		float2 quadUV[6];
+		for (int v = 0; v < 6; v++)
+		{
+			quadNor[v] = triNor[0];
+			quadUV[v] = { quadPos[v].x * 0.5f + 0.5f, 0.5f - quadPos[v].y * 0.5f };
+		}
+		const vector<vector<uint8_t>> quadVertices = packVertices(quadPos, quadNor, quadUV, 6);
+		for (size_t s = 0; s < streams.size(); s++)
+		{
+			occluderBuffers[s] = renderer->createVertexBuffer(quadVertices[s].size(), VertexBuffer::DATA_USAGE::STATIC);
+			renderer->get(occluderBuffers[s])->setData(quadVertices[s].data(), quadVertices[s].size(), 0);
+		}
+
+		// it keeps a pushed translation, so not a material that reads the GPU ones.
+		MaterialHandle material = materialHandles[0];
+		if (gConfig.gpuAnimation)
+		{
+			occluderMaterial = createSceneMaterial(renderer, "occluder", shaderPath + materialDefs[0][0] + shaderExtension,
+				shaderPath + materialDefs[0][1] + shaderExtension, materialDefs[0][2], diffuse[0]);
+			if (!occluderMaterial)
+			{
+				shutdownTestbench();
+				return -1;
+			}
+			material = occluderMaterial;
+		}
+		occluderTechnique = renderer->createTechnique(material, renderer->makeRenderState());
+		occluderHandle = renderer->createMesh();
+		occluder = renderer->get(occluderHandle);
+		for (size_t s = 0; s < streams.size(); s++)
+			occluder->addIAVertexBufferBinding(renderer->get(occluderBuffers[s]), 0, 6, vertexLayout.getStride(streams[s]), streams[s]);
+		occluder->setBounds(quadPos, 6, sizeof(float4));
+		occluder->technique = renderer->get(occluderTechnique);
+		// not one of the attached translations, it keeps its own buffer at 0.
+		occluder->txBuffer = renderer->makeConstantBuffer(std::string(TRANSLATION_NAME), TRANSLATION);
+		const float origin[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		occluder->txBuffer->setData(origin, sizeof(origin), occluder->technique->getMaterial(), TRANSLATION);
+
+		glm::vec3 corners[6];
+		for (int v = 0; v < 6; v++)
+			corners[v] = glm::vec3(quadPos[v].x, quadPos[v].y, quadPos[v].z);
+		occlusion.setOccluders(corners, 6);
+	}
+
+	transforms.resize(scene.size());
+	for (size_t i = 0; i < scene.size(); i++)
+		transforms.z()[i] = i * (-1.0f / places);
+	const uint32_t root = hierarchy.create();
+	for (size_t i = 0; i < scene.size(); i++)
+	{
+		meshNodes.push_back(hierarchy.create(root));
+		hierarchy.setDraw(meshNodes.back(), (uint32_t)i);
+	}
+	renderer->attachTransforms(scene, gConfig.gpuAnimation ? Renderer::TRANSFORMS::GPU : Renderer::TRANSFORMS::CPU);
+	if (gConfig.retained)
+		for (auto m : scene)
+			renderables.push_back(renderer->addRenderable(m));
+	if (gConfig.gpuCull)
+		gConfig.gpuCull = gConfig.gpuAnimation && renderer->setGpuCulling(&camera.getFrustum());
+	return 0;
+}
+
+const TestbenchConfig& testbenchConfig()
+{
+	return gConfig;
+}
+
+void shutdownTestbench() {
+	if (gConfig.gpuCull)
+		gRenderer->setGpuCulling(nullptr);
+	for (auto id : renderables)
+		gRenderer->removeRenderable(id);
+	renderables.clear();
+	renderableScene.clear();
+	visible.clear();
+	if (occluder != nullptr)
+	{
+		occlusion.clearOccluders();
+		delete occluder->txBuffer;
+		gRenderer->destroy(occluderHandle);
+		gRenderer->destroy(occluderTechnique);
+		for (auto& b : occluderBuffers)
+		{
+			gRenderer->destroy(b);
+			b = VertexBufferHandle();
+		}
+		occluder = nullptr;
+		if (occluderMaterial)
+			gRenderer->destroy(occluderMaterial);
+		occluderMaterial = MaterialHandle();
+	}
+	if (animation != nullptr)
+	{
+		gRenderer->destroy(animationHandle);
+		gRenderer->destroy(animationMaterial);
+		gRenderer->destroy(curveBuffer);
+		animation = nullptr;
+	}
+	// destroy dynamic objects
+	for (auto m : materialHandles)
+	{
+		gRenderer->destroy(m);
+	}
+	for (auto t : techniqueHandles)
+	{
+		gRenderer->destroy(t);
+	}
+	for (auto m : meshHandles)
+	{
+		// made with makeConstantBuffer, the mesh does not own it.
+		delete gRenderer->get(m)->txBuffer;
+		gRenderer->destroy(m);
+	};
+	for (auto b : vertexBuffers)
+	{
+		assert(b->refCount() == 0);
+	}
+	for (auto& b : bufferHandles)
+	{
+		gRenderer->destroy(b);
+		b = VertexBufferHandle();
+	}
+	vertexBuffers.clear();
+	gRenderer->destroy(indexHandle);
+	indexHandle = IndexBufferHandle();
+
+	gRenderer->destroy(samplerHandle);
+	gRenderer->destroy(textureHandle);
+	meshHandles.clear();
+	materialHandles.clear();
+	techniqueHandles.clear();
+	scene.clear();
+	transforms.resize(0);
+	// nodes are never removed, the next scene starts from an empty one.
+	hierarchy = TransformHierarchy();
+	meshNodes.clear();
+	gRenderer = nullptr;
+#ifdef TESTBENCH_STATIC_BACKEND
+	staticBackend = nullptr;
+#endif
+	materials.clear();
+	techniques.clear();
+	textures.clear();
+	samplers.clear();
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include "Renderer.h"
+#include "Mesh.h"
+#include "Texture2D.h"
+#include "Sampler2D.h"
+
+/*
+ The scene the testbench renders: many small triangles moving along a
+ lissajous curve, each one a separate Mesh (so one draw call each).
+ Shared by the interactive loop in main.cpp and the benchmark harness.
+*/
+struct TestbenchConfig {
+	// one triangle (and one draw call) per mesh.
+	int meshCount = 100;
+	// fraction of the meshes that sample the diffuse texture [0,1].
+	float texturedFraction = 0.25f;
+	// number of different techniques (material + render state) in use,
+	// technique 0 is always wireframe.
+	int techniqueCount = 4;
+	// meshes are added once with Renderer::addRenderable instead of
+	// submitted every frame.
+	bool retained = false;
+	// submit only the meshes inside the camera frustum (see
+	// RenderableScene::cull), ignored when retained.
+	bool cull = false;
+	// with cull: half the width of a quad drawn in the middle of the screen,
+	// in front of every triangle, and used as the occluder of an
+	// OcclusionCuller, so the meshes behind it are not submitted. 0 for none.
+	float occluderSize = 0.0f;
+	// a compute pass (AnimationShader) writes the translations on the GPU
+	// from one uniform per frame, the CPU uploads none. Backends without
+	// compute (see Renderer::createComputeTechnique) animate on the CPU.
+	bool gpuAnimation = false;
+	// the retained renderables are culled against the camera frustum on the
+	// GPU and drawn with one indirect draw per technique (see
+	// Renderer::setGpuCulling). Needs retained, implies gpuAnimation (the
+	// translations live on the GPU). Backends that cannot draw every renderable.
+	bool gpuCull = false;
+	// every mesh draws its triangle through one shared UINT16 index buffer
+	// (Renderer::createIndexBuffer), backends without index buffers draw
+	// the streams in order. Indexed meshes are not GPU culled.
+	bool indexed = false;
+	// position, normal and uv in one vertex buffer instead of one each.
+	bool interleaved = false;
+	// half positions and uvs and 10:10:10:2 normals, 16 bytes a vertex
+	// instead of 40 (see VertexLayout.h).
+	bool quantized = false;
+};
+
+// flat scene at the application level...we don't care about this here.
+// do what ever you want in your renderer backend.
+// all these objects are loosely coupled, creation and destruction is responsibility
+// of the testbench, not of the container objects
+extern std::vector<Mesh*> scene;
+extern std::vector<Material*> materials;
+extern std::vector<Technique*> techniques;
+extern std::vector<Texture2D*> textures;
+extern std::vector<Sampler2D*> samplers;
+
+// -1 (after printing why, with everything it made deleted) when a material does not compile.
+int initialiseTestbench(Renderer* renderer, const TestbenchConfig& config = TestbenchConfig());
+/*
+ time in seconds since the start of the run. Positions only depend on time,
+ so a run with a fixed timestep always produces the same frames.
+*/
+void updateScene(double time);
+// clear, submit every (visible, when culling) mesh unless retained, frame and present.
+void renderScene(Renderer* renderer);
+// the config after initialiseTestbench's fallbacks: gpuAnimation, gpuCull and
+// indexed are false when the backend cannot do them, cull is false when retained.
+const TestbenchConfig& testbenchConfig();
+// deletes everything created by initialiseTestbench, does not shut down the renderer.
+void shutdownTestbench();
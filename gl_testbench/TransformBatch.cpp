@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <algorithm>
+#include "TransformBatch.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TRANSFORM_BATCH_SSE
+#include <emmintrin.h>
+#endif
+
+const size_t TransformBatch::CHUNK;
+const size_t TransformBatch::PARALLEL_MIN;
+
+void TransformBatch::resize(size_t count)
+{
+	this->count = count;
+	xs.resize(count, 0.0f);
+	ys.resize(count, 0.0f);
+	zs.resize(count, 0.0f);
+}
+
+void TransformBatch::writeRange(char* dst, size_t stride, size_t first, size_t end, bool streaming) const
+{
+	const float* x = xs.data();
+	const float* y = ys.data();
+	const float* z = zs.data();
+	size_t i = first;
+#ifdef TRANSFORM_BATCH_SSE
+	// mapped buffers are write-combined, streaming full float4 avoids reading them back.
+	const bool aligned = ((uintptr_t)dst & 15) == 0 && (stride & 15) == 0;
+	const bool stream = streaming && aligned;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 r0 = _mm_loadu_ps(x + i);
+		__m128 r1 = _mm_loadu_ps(y + i);
+		__m128 r2 = _mm_loadu_ps(z + i);
+		__m128 r3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		char* out = dst + i * stride;
+		if (stream)
+		{
+			_mm_stream_ps((float*)out, r0);
+			_mm_stream_ps((float*)(out + stride), r1);
+			_mm_stream_ps((float*)(out + 2 * stride), r2);
+			_mm_stream_ps((float*)(out + 3 * stride), r3);
+		}
+		else if (aligned)
+		{
+			_mm_store_ps((float*)out, r0);
+			_mm_store_ps((float*)(out + stride), r1);
+			_mm_store_ps((float*)(out + 2 * stride), r2);
+			_mm_store_ps((float*)(out + 3 * stride), r3);
+		}
+		else
+		{
+			_mm_storeu_ps((float*)out, r0);
+			_mm_storeu_ps((float*)(out + stride), r1);
+			_mm_storeu_ps((float*)(out + 2 * stride), r2);
+			_mm_storeu_ps((float*)(out + 3 * stride), r3);
+		}
+	}
+	// the streamed stores are ordered before the unmap.
+	if (stream)
+		_mm_sfence();
+#endif
+	for (; i < end; i++)
+	{
+		float* out = (float*)(dst + i * stride);
+		out[0] = x[i];
+		out[1] = y[i];
+		out[2] = z[i];
+		out[3] = 0.0f;
+	}
+}
+
+void TransformBatch::write(void* dst, size_t stride, size_t count, bool streaming) const
+{
+	PROFILE_ZONE("writeTransforms");
+	count = std::min(count, this->count);
+	if (count < PARALLEL_MIN)
+	{
+		writeRange((char*)dst, stride, 0, count, streaming);
+		return;
+	}
+	struct Pass {
+		const TransformBatch* batch;
+		char* dst;
+		size_t stride, count;
+		bool streaming;
+	} pass = { this, (char*)dst, stride, count, streaming };
+	// one capture keeps the std::function from allocating.
+	JobSystem::shared().parallelFor((count + CHUNK - 1) / CHUNK, [&pass](size_t chunk) {
+		const size_t first = chunk * CHUNK;
+		pass.batch->writeRange(pass.dst, pass.stride, first, std::min(first + CHUNK, pass.count), pass.streaming);
+	});
+}
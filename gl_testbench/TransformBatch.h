@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <vector>
+
+/*
+ Translations of many draws as three contiguous arrays (x, y, z), filled by
+ the scene and written by the renderer into its per-draw buffer in one
+ pass, see Renderer::updateTransforms.
+
+	batch.resize(scene.size());
+	memcpy(batch.x(), ...);
+	renderer->updateTransforms(batch);
+
+ write() interleaves them into float4 (x, y, z, 0) with SSE, four
+ transforms per iteration. Batches of PARALLEL_MIN or more are split in
+ CHUNK sized pieces over JobSystem::shared().
+*/
+class TransformBatch
+{
+public:
+	static const size_t CHUNK = 16384;
+	static const size_t PARALLEL_MIN = 4 * CHUNK;
+
+	// new entries are 0.
+	void resize(size_t count);
+	size_t size() const { return count; };
+
+	float* x() { return xs.data(); };
+	float* y() { return ys.data(); };
+	float* z() { return zs.data(); };
+	const float* x() const { return xs.data(); };
+	const float* y() const { return ys.data(); };
+	const float* z() const { return zs.data(); };
+
+	/*
+	 writes the first count transforms (at most size()) as float4 to dst,
+	 transform i at dst + i * stride bytes. stride is a multiple of 16.
+	 streaming is for mapped GPU memory nothing on the CPU reads back: 16
+	 byte aligned destinations then get non-temporal stores, which bypass
+	 the cache. CPU arrays read right after want them cached, the default.
+	*/
+	void write(void* dst, size_t stride, size_t count, bool streaming = false) const;
+private:
+	void writeRange(char* dst, size_t stride, size_t first, size_t end, bool streaming) const;
+
+	size_t count = 0;
+	std::vector<float> xs, ys, zs;
+};
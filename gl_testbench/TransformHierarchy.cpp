@@ -0,0 +1,191 @@
+#include <algorithm>
+#include "TransformHierarchy.h"
+#include "TransformBatch.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+const uint32_t TransformHierarchy::NONE;
+const size_t TransformHierarchy::PARALLEL_MIN;
+const size_t TransformHierarchy::CHUNK;
+
+uint32_t TransformHierarchy::create(uint32_t parent)
+{
+	const uint32_t id = (uint32_t)parents.size();
+	parents.push_back(parent);
+	depths.push_back(parent == NONE ? 0 : depths[parent] + 1);
+	// appended out of order, rebuild() moves it to its level.
+	position.push_back(id);
+	ids.push_back(id);
+	parentPositions.push_back(NONE);
+	firstChild.push_back(0);
+	childCount.push_back(0);
+	draws.push_back(NONE);
+	locals.push_back(glm::mat4(1.0f));
+	worlds.push_back(glm::mat4(1.0f));
+	queued.push_back(0);
+	layoutDirty = true;
+	return id;
+}
+
+void TransformHierarchy::setLocal(uint32_t node, const glm::mat4& local)
+{
+	locals[position[node]] = local;
+	// a rebuild recomputes everything anyway.
+	if (!layoutDirty)
+		pending.push_back(position[node]);
+}
+
+void TransformHierarchy::setDraw(uint32_t node, uint32_t draw)
+{
+	draws[position[node]] = draw;
+}
+
+/*
+ breadth first from all roots: that is depth order, and appending the
+ children of each node in turn keeps siblings together.
+*/
+void TransformHierarchy::rebuild()
+{
+	const uint32_t n = (uint32_t)parents.size();
+	std::vector<uint32_t> childStart(n + 1, 0), children(n);
+	for (uint32_t id = 0; id < n; id++)
+		if (parents[id] != NONE)
+			childStart[parents[id] + 1]++;
+	for (uint32_t id = 0; id < n; id++)
+		childStart[id + 1] += childStart[id];
+	std::vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+	for (uint32_t id = 0; id < n; id++)
+		if (parents[id] != NONE)
+			children[fill[parents[id]]++] = id;
+
+	std::vector<uint32_t> order;
+	order.reserve(n);
+	for (uint32_t id = 0; id < n; id++)
+		if (parents[id] == NONE)
+			order.push_back(id);
+	for (size_t i = 0; i < order.size(); i++)
+		for (uint32_t c = childStart[order[i]]; c < childStart[order[i] + 1]; c++)
+			order.push_back(children[c]);
+
+	std::vector<glm::mat4> sortedLocals(n);
+	std::vector<uint32_t> sortedDraws(n);
+	for (uint32_t p = 0; p < n; p++)
+	{
+		sortedLocals[p] = locals[position[order[p]]];
+		sortedDraws[p] = draws[position[order[p]]];
+	}
+	locals.swap(sortedLocals);
+	draws.swap(sortedDraws);
+	for (uint32_t p = 0; p < n; p++)
+		position[order[p]] = p;
+	ids.swap(order);
+
+	levelStart.clear();
+	for (uint32_t p = 0; p < n; p++)
+	{
+		const uint32_t id = ids[p];
+		parentPositions[p] = parents[id] == NONE ? NONE : position[parents[id]];
+		childCount[p] = childStart[id + 1] - childStart[id];
+		firstChild[p] = childCount[p] ? position[children[childStart[id]]] : 0;
+		while (levelStart.size() <= depths[id])
+			levelStart.push_back(p);
+	}
+	levelStart.push_back(n);
+
+	// every root, and so every node, is recomputed.
+	queued.assign(n, 0);
+	generation = 0;
+	pending.clear();
+	const uint32_t roots = levelStart.size() > 1 ? (uint32_t)levelStart[1] : 0;
+	for (uint32_t p = 0; p < roots; p++)
+		pending.push_back(p);
+	layoutDirty = false;
+}
+
+void TransformHierarchy::computeRange(size_t first, size_t end)
+{
+	for (size_t i = first; i < end; i++)
+	{
+		const uint32_t pos = level[i];
+		const uint32_t parent = parentPositions[pos];
+		worlds[pos] = parent == NONE ? locals[pos] : worlds[parent] * locals[pos];
+	}
+}
+
+size_t TransformHierarchy::update()
+{
+	PROFILE_ZONE("updateHierarchy");
+	if (layoutDirty)
+		rebuild();
+	changedNodes.clear();
+	if (pending.empty())
+		return 0;
+	if (++generation == 0)
+	{
+		std::fill(queued.begin(), queued.end(), 0);
+		generation = 1;
+	}
+	std::sort(pending.begin(), pending.end());
+
+	size_t recomputed = 0;
+	size_t p = 0;
+	level.clear();
+	for (size_t d = 0; d + 1 < levelStart.size(); d++)
+	{
+		// level holds the children of the last level, add the dirty nodes of this depth.
+		const size_t end = levelStart[d + 1];
+		for (; p < pending.size() && pending[p] < end; p++)
+		{
+			if (queued[pending[p]] != generation)
+			{
+				queued[pending[p]] = generation;
+				level.push_back(pending[p]);
+			}
+		}
+		if (level.empty())
+		{
+			if (p == pending.size())
+				break;
+			continue;
+		}
+
+		// parents are one level up and final, the nodes of a level are independent.
+		if (level.size() < PARALLEL_MIN)
+			computeRange(0, level.size());
+		else
+			JobSystem::shared().parallelFor((level.size() + CHUNK - 1) / CHUNK, [this](size_t chunk) {
+				computeRange(chunk * CHUNK, std::min((chunk + 1) * CHUNK, level.size()));
+			});
+		recomputed += level.size();
+
+		next.clear();
+		for (uint32_t pos : level)
+		{
+			changedNodes.push_back(ids[pos]);
+			for (uint32_t c = firstChild[pos]; c < firstChild[pos] + childCount[pos]; c++)
+			{
+				queued[c] = generation;
+				next.push_back(c);
+			}
+		}
+		level.swap(next);
+	}
+	level.clear();
+	pending.clear();
+	return recomputed;
+}
+
+void TransformHierarchy::writeChanged(TransformBatch& batch) const
+{
+	for (uint32_t id : changedNodes)
+	{
+		const uint32_t pos = position[id];
+		const uint32_t draw = draws[pos];
+		if (draw == NONE || draw >= batch.size())
+			continue;
+		const glm::mat4& w = worlds[pos];
+		batch.x()[draw] = w[3][0];
+		batch.y()[draw] = w[3][1];
+		batch.z()[draw] = w[3][2];
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <glm/glm.hpp>
+
+class TransformBatch;
+
+/*
+ Parent linked transforms. The nodes live in arrays ordered by depth, with
+ the children of one parent next to each other, so update() walks the
+ hierarchy level by level and the children of a node are one contiguous
+ range of the next level.
+
+	uint32_t body = hierarchy.create();
+	uint32_t arm = hierarchy.create(body);
+	hierarchy.setLocal(arm, glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0, 0, 1)));
+	hierarchy.update();
+	hierarchy.world(arm);
+
+ setLocal marks a node dirty. update() recomputes the world matrices of the
+ dirty nodes and of everything below them, nothing else. Levels with
+ PARALLEL_MIN or more nodes to recompute are split over JobSystem::shared().
+ Creating nodes reorders the arrays at the next update(), which then
+ recomputes every node.
+
+ Nodes bound to a draw (setDraw) feed the per-draw constants: writeChanged
+ copies their world translation into a TransformBatch for
+ Renderer::updateTransforms. The testbench shaders take a translation, the
+ whole matrix is world().
+
+ Render thread only, ids are stable and nodes are never removed.
+*/
+class TransformHierarchy
+{
+public:
+	static const uint32_t NONE = 0xffffffff;
+	static const size_t PARALLEL_MIN = 8192;
+	static const size_t CHUNK = 2048;
+
+	// identity local matrix, a root when parent is NONE.
+	uint32_t create(uint32_t parent = NONE);
+	size_t size() const { return ids.size(); };
+
+	void setLocal(uint32_t node, const glm::mat4& local);
+	const glm::mat4& local(uint32_t node) const { return locals[position[node]]; };
+	// valid after update().
+	const glm::mat4& world(uint32_t node) const { return worlds[position[node]]; };
+	uint32_t parent(uint32_t node) const { return parents[node]; };
+	uint32_t depth(uint32_t node) const { return depths[node]; };
+
+	// index of the node's entry in a TransformBatch, NONE for no draw.
+	void setDraw(uint32_t node, uint32_t draw);
+
+	// returns the number of world matrices recomputed.
+	size_t update();
+	// nodes whose world matrix was recomputed by the last update(), by depth.
+	const std::vector<uint32_t>& changed() const { return changedNodes; };
+	// translation of the world matrix into batch[draw], for the changed nodes with a draw.
+	void writeChanged(TransformBatch& batch) const;
+private:
+	void rebuild();
+	// world matrices of level[first, end).
+	void computeRange(size_t first, size_t end);
+
+	// by id.
+	std::vector<uint32_t> parents, depths, position;
+
+	// by position: depth order, children of a node contiguous.
+	std::vector<uint32_t> ids, parentPositions, firstChild, childCount, draws;
+	std::vector<glm::mat4> locals, worlds;
+	// update() generation that queued the node, so a node is recomputed once.
+	std::vector<uint32_t> queued;
+	// first position of each depth, and one past the last node.
+	std::vector<size_t> levelStart;
+	bool layoutDirty = false;
+
+	uint32_t generation = 0;
+	// positions set dirty since the last update().
+	std::vector<uint32_t> pending;
+	// positions of the level being recomputed, and of the one below.
+	std::vector<uint32_t> level, next;
+	std::vector<uint32_t> changedNodes;
+};
@@ -1 +1,7 @@
 #include "VertexBuffer.h"
+
+void VertexBuffer::setData(const Write* writes, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		setData(writes[i].data, writes[i].size, writes[i].offset);
+}
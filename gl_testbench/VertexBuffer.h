@@ -1,4 +1,7 @@
 #pragma once
+#include <atomic>
+#include <stddef.h>
+
 class VertexBuffer
 {
 public:
@@ -7,15 +10,28 @@ public:
 	VertexBuffer() {};
 	virtual ~VertexBuffer() {}
 	virtual void setData(const void* data, size_t size, size_t offset) = 0;
+
+	// one setData of a batch.
+	struct Write {
+		const void* data;
+		size_t size, offset;
+	};
+	// setData of each write, backends map or bind the buffer once for the batch.
+	virtual void setData(const Write* writes, size_t count);
 	virtual void bind(size_t offset, size_t size, unsigned int location) = 0;
 	virtual void unbind() = 0;
 	virtual size_t getSize() = 0;
-	void incRef() { refs++; };
-	void decRef() { if (refs>0) refs--; };
-	inline unsigned int refCount() { return refs; };
+	void incRef() { refs.fetch_add(1, std::memory_order_relaxed); };
+	void decRef()
+	{
+		unsigned int r = refs.load(std::memory_order_relaxed);
+		while (r > 0 && !refs.compare_exchange_weak(r, r - 1, std::memory_order_relaxed))
+			;
+	};
+	inline unsigned int refCount() { return refs.load(std::memory_order_relaxed); };
 protected:
 private:
-	//cheap ref counting
-	unsigned int refs = 0;
+	// cheap ref counting, meshes of several threads can share a buffer.
+	std::atomic<unsigned int> refs{ 0 };
 };
 
@@ -0,0 +1,195 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <glm/gtc/packing.hpp>
+#include "VertexLayout.h"
+#include "IA.h"
+
+VertexLayout VertexLayout::split(FORMAT position, FORMAT normal, FORMAT uv)
+{
+	VertexLayout layout;
+	layout.add(POSITION, position, POSITION).add(NORMAL, normal, NORMAL).add(TEXTCOORD, uv, TEXTCOORD);
+	return layout;
+}
+
+VertexLayout VertexLayout::interleaved(FORMAT position, FORMAT normal, FORMAT uv)
+{
+	VertexLayout layout;
+	layout.add(POSITION, position, POSITION).add(NORMAL, normal, POSITION).add(TEXTCOORD, uv, POSITION);
+	return layout;
+}
+
+VertexLayout& VertexLayout::add(unsigned int location, FORMAT format, unsigned int stream)
+{
+	attributes.push_back({ location, format, stream, getStride(stream) });
+	return *this;
+}
+
+const VertexLayout::Attribute* VertexLayout::find(unsigned int location) const
+{
+	for (const Attribute& a : attributes)
+		if (a.location == location)
+			return &a;
+	return nullptr;
+}
+
+std::vector<unsigned int> VertexLayout::getStreams() const
+{
+	std::vector<unsigned int> streams;
+	for (const Attribute& a : attributes)
+		if (std::find(streams.begin(), streams.end(), a.stream) == streams.end())
+			streams.push_back(a.stream);
+	std::sort(streams.begin(), streams.end());
+	return streams;
+}
+
+uint32_t VertexLayout::getStride(unsigned int stream) const
+{
+	uint32_t stride = 0;
+	for (const Attribute& a : attributes)
+		if (a.stream == stream)
+			stride = std::max(stride, a.offset + formatSize(a.format));
+	return stride;
+}
+
+uint32_t VertexLayout::getVertexSize() const
+{
+	uint32_t size = 0;
+	for (unsigned int s : getStreams())
+		size += getStride(s);
+	return size;
+}
+
+std::string VertexLayout::getDefines() const
+{
+	std::string defines = "#define VERTEX_LAYOUT\n";
+	for (const Attribute& a : attributes)
+	{
+		std::string name = a.location == POSITION ? "POSITION" :
+			a.location == NORMAL ? "NORMAL" :
+			a.location == TEXTCOORD ? "TEXTCOORD" : "ATTRIBUTE" + std::to_string(a.location);
+		defines += "#define " + name + "_FORMAT " + std::to_string((int)a.format) + "\n" +
+			"#define " + name + "_STREAM " + std::to_string(a.stream) + "\n" +
+			"#define " + name + "_OFFSET " + std::to_string(a.offset / 4) + "\n" +
+			"#define " + name + "_STRIDE " + std::to_string(getStride(a.stream) / 4) + "\n";
+	}
+	return defines;
+}
+
+uint32_t VertexLayout::formatSize(FORMAT format)
+{
+	switch (format)
+	{
+	case FORMAT::FLOAT4: return 16;
+	case FORMAT::FLOAT2: return 8;
+	case FORMAT::HALF4: return 8;
+	default: return 4;
+	}
+}
+
+void VertexLayout::pack(unsigned int location, const float* value, void* vertex) const
+{
+	const Attribute* a = find(location);
+	if (a != nullptr)
+		pack(a->format, value, (uint8_t*)vertex + a->offset);
+}
+
+void VertexLayout::pack(FORMAT format, const float* value, void* out)
+{
+	switch (format)
+	{
+	case FORMAT::FLOAT4:
+		memcpy(out, value, 16);
+		break;
+	case FORMAT::FLOAT2:
+		memcpy(out, value, 8);
+		break;
+	case FORMAT::HALF4:
+	{
+		uint64_t p = glm::packHalf4x16(glm::vec4(value[0], value[1], value[2], value[3]));
+		memcpy(out, &p, 8);
+		break;
+	}
+	case FORMAT::HALF2:
+	{
+		uint32_t p = glm::packHalf2x16(glm::vec2(value[0], value[1]));
+		memcpy(out, &p, 4);
+		break;
+	}
+	case FORMAT::SNORM_10_10_10_2:
+	{
+		uint32_t p = glm::packSnorm3x10_1x2(glm::vec4(value[0], value[1], value[2], value[3]));
+		memcpy(out, &p, 4);
+		break;
+	}
+	case FORMAT::OCTAHEDRAL:
+	{
+		// onto the octahedron |x| + |y| + |z| = 1, the lower half folded over the upper.
+		float l1 = fabsf(value[0]) + fabsf(value[1]) + fabsf(value[2]);
+		float x = l1 > 0.0f ? value[0] / l1 : 0.0f;
+		float y = l1 > 0.0f ? value[1] / l1 : 0.0f;
+		if (value[2] < 0.0f)
+		{
+			float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = fx;
+			y = fy;
+		}
+		uint32_t p = glm::packSnorm2x16(glm::vec2(x, y));
+		memcpy(out, &p, 4);
+		break;
+	}
+	case FORMAT::UNORM8x4:
+	{
+		uint32_t p = glm::packUnorm4x8(glm::vec4(value[0], value[1], value[2], value[3]));
+		memcpy(out, &p, 4);
+		break;
+	}
+	}
+}
+
+void VertexLayout::unpack(FORMAT format, const void* in, float* value)
+{
+	glm::vec4 v(0.0f, 0.0f, 0.0f, 1.0f);
+	uint32_t p;
+	memcpy(&p, in, 4);
+	switch (format)
+	{
+	case FORMAT::FLOAT4:
+		memcpy(&v.x, in, 16);
+		break;
+	case FORMAT::FLOAT2:
+		memcpy(&v.x, in, 8);
+		break;
+	case FORMAT::HALF4:
+	{
+		uint64_t p64;
+		memcpy(&p64, in, 8);
+		v = glm::unpackHalf4x16(p64);
+		break;
+	}
+	case FORMAT::HALF2:
+		v.x = glm::unpackHalf2x16(p).x;
+		v.y = glm::unpackHalf2x16(p).y;
+		break;
+	case FORMAT::SNORM_10_10_10_2:
+		v = glm::unpackSnorm3x10_1x2(p);
+		break;
+	case FORMAT::OCTAHEDRAL:
+	{
+		glm::vec2 e = glm::unpackSnorm2x16(p);
+		glm::vec3 n(e.x, e.y, 1.0f - fabsf(e.x) - fabsf(e.y));
+		if (n.z < 0.0f)
+		{
+			n.x = (1.0f - fabsf(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+			n.y = (1.0f - fabsf(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+		}
+		v = glm::vec4(glm::normalize(n), 0.0f);
+		break;
+	}
+	case FORMAT::UNORM8x4:
+		v = glm::unpackUnorm4x8(p);
+		break;
+	}
+	memcpy(value, &v.x, 16);
+}
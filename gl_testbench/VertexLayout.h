@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ Where and how the vertex attributes of the meshes drawn with a material
+ are stored: the stream (the binding of Mesh::addIAVertexBufferBinding)
+ each attribute is read from, its byte offset in the vertex of that stream
+ and its format. Set it on the material before compileMaterial and
+ createTechnique, the shaders and the Vulkan vertex input state follow it.
+
+	// position, normal and uv in the stream bound at POSITION, 16 bytes a vertex
+	VertexLayout layout = VertexLayout::interleaved(VertexLayout::FORMAT::HALF4,
+		VertexLayout::FORMAT::SNORM_10_10_10_2, VertexLayout::FORMAT::HALF2);
+	material->setVertexLayout(layout);
+	for (size_t v = 0; v < count; v++)
+	{
+		uint8_t* vertex = data + v * layout.getStride(POSITION);
+		layout.pack(POSITION, &positions[v].x, vertex);
+		layout.pack(NORMAL, &normals[v].x, vertex);
+		...
+	}
+	mesh->addIAVertexBufferBinding(buffer, 0, count, layout.getStride(POSITION), POSITION);
+
+ Every format is a multiple of 4 bytes, the GL shaders pull the streams as
+ uint words. HALF and SNORM are glm/gtc/packing.hpp's: SNORM_10_10_10_2 is
+ x, y and z in 10 bits and w in 2 from the low bits, OCTAHEDRAL a unit
+ vector folded onto the octahedron in two snorm16 (w 0). Half positions
+ keep 11 bits of mantissa, enough for a scene a few hundred units across.
+ Normals take every format, uvs the ones without a decode of their own
+ (not SNORM_10_10_10_2 or OCTAHEDRAL), positions all but OCTAHEDRAL.
+ The default, split(), is the float layout of 40 bytes a vertex.
+*/
+class VertexLayout
+{
+public:
+	// the shaders' FORMAT_ values are these, in this order.
+	enum class FORMAT { FLOAT4, FLOAT2, HALF4, HALF2, SNORM_10_10_10_2, OCTAHEDRAL, UNORM8x4 };
+
+	struct Attribute {
+		unsigned int location;
+		FORMAT format;
+		unsigned int stream;
+		uint32_t offset;
+	};
+
+	// one stream per attribute, bound at the attribute's location.
+	static VertexLayout split(FORMAT position = FORMAT::FLOAT4, FORMAT normal = FORMAT::FLOAT4, FORMAT uv = FORMAT::FLOAT2);
+	// all of them in the stream bound at POSITION.
+	static VertexLayout interleaved(FORMAT position, FORMAT normal, FORMAT uv);
+
+	// location goes after whatever stream already holds.
+	VertexLayout& add(unsigned int location, FORMAT format, unsigned int stream);
+
+	const std::vector<Attribute>& getAttributes() const { return attributes; };
+	// nullptr when the layout does not have location.
+	const Attribute* find(unsigned int location) const;
+	// the bindings in use, in increasing order.
+	std::vector<unsigned int> getStreams() const;
+	uint32_t getStride(unsigned int stream) const;
+	// all streams together.
+	uint32_t getVertexSize() const;
+
+	// <ATTRIBUTE>_FORMAT, _STREAM, _OFFSET and _STRIDE (4 byte words) per attribute, for the vertex shader.
+	std::string getDefines() const;
+
+	static uint32_t formatSize(FORMAT format);
+	// value is 4 floats (uv zw are ignored), written at the offset of location in vertex.
+	void pack(unsigned int location, const float* value, void* vertex) const;
+	static void pack(FORMAT format, const float* value, void* out);
+	// what the vertex shader sees: missing components are z 0 and w 1, as a vertex fetch.
+	static void unpack(FORMAT format, const void* in, float* value);
+private:
+	std::vector<Attribute> attributes;
+};
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "ComputeTechniqueVulkan.h"
+#include "VulkanRenderer.h"
+#include "MaterialVulkan.h"
+#include "VertexBufferVulkan.h"
+#include "../FrameStats.h"
+
+const uint32_t ComputeTechniqueVulkan::PUSH_BYTES;
+
+ComputeTechniqueVulkan::ComputeTechniqueVulkan(Material* m) : ComputeTechnique(m)
+{
+}
+
+ComputeTechniqueVulkan::~ComputeTechniqueVulkan()
+{
+	release();
+}
+
+void ComputeTechniqueVulkan::release()
+{
+	vkDestroyPipeline(VulkanRenderer::device, pipeline, nullptr);
+	vkDestroyPipelineLayout(VulkanRenderer::device, layout, nullptr);
+	vkDestroyDescriptorPool(VulkanRenderer::device, pool, nullptr);
+	vkDestroyDescriptorSetLayout(VulkanRenderer::device, setLayout, nullptr);
+	pipeline = VK_NULL_HANDLE;
+	layout = VK_NULL_HANDLE;
+	pool = VK_NULL_HANDLE;
+	setLayout = VK_NULL_HANDLE;
+	set = VK_NULL_HANDLE;
+}
+
+void ComputeTechniqueVulkan::build(VkBuffer transforms)
+{
+	release();
+
+	// every slot, the transform slot included, is a storage buffer.
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+	std::vector<VkDescriptorBufferInfo> buffers;
+	VkDescriptorSetLayoutBinding binding = {};
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	binding.descriptorCount = 1;
+	binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	for (auto& s : storage)
+	{
+		binding.binding = s.first;
+		bindings.push_back(binding);
+		VertexBufferVulkan* buffer = (VertexBufferVulkan*)s.second.buffer;
+		buffers.push_back({ buffer->getHandle(), s.second.offset, s.second.size ? s.second.size : VK_WHOLE_SIZE });
+	}
+	if (transformSlot != NO_SLOT)
+	{
+		if (transforms == VK_NULL_HANDLE)
+		{
+			fprintf(stderr, "compute technique writes the translations, attach them with TRANSFORMS::GPU first\n");
+			exit(-1);
+		}
+		binding.binding = transformSlot;
+		bindings.push_back(binding);
+		buffers.push_back({ transforms, 0, VK_WHOLE_SIZE });
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = (uint32_t)bindings.size();
+	layoutInfo.pBindings = bindings.data();
+	if (FAILED(vkCreateDescriptorSetLayout(VulkanRenderer::device, &layoutInfo, nullptr, &setLayout)))
+	{
+		fprintf(stderr, "failed to create compute descriptor set layout!\n");
+		exit(-1);
+	}
+
+	VkPushConstantRange pushRange = {};
+	pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushRange.offset = 0;
+	pushRange.size = PUSH_BYTES;
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &setLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+	if (FAILED(vkCreatePipelineLayout(VulkanRenderer::device, &pipelineLayoutInfo, nullptr, &layout)))
+	{
+		fprintf(stderr, "failed to create compute pipeline layout!\n");
+		exit(-1);
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage = ((MaterialVulkan*)material)->getShaderStages()[(int)Material::ShaderType::CS];
+	pipelineInfo.layout = layout;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineInfo.basePipelineIndex = -1;
+	if (FAILED(vkCreateComputePipelines(VulkanRenderer::device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline)))
+	{
+		fprintf(stderr, "failed to create compute pipeline!\n");
+		exit(-1);
+	}
+
+	if (bindings.empty())
+		return;
+	VkDescriptorPoolSize poolSize = {};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = (uint32_t)bindings.size();
+	VkDescriptorPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = 1;
+	if (FAILED(vkCreateDescriptorPool(VulkanRenderer::device, &poolInfo, nullptr, &pool)))
+	{
+		fprintf(stderr, "failed to create compute descriptor pool!\n");
+		exit(-1);
+	}
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = pool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &setLayout;
+	if (FAILED(vkAllocateDescriptorSets(VulkanRenderer::device, &allocInfo, &set)))
+	{
+		fprintf(stderr, "failed to allocate compute descriptor set!\n");
+		exit(-1);
+	}
+
+	std::vector<VkWriteDescriptorSet> writes(bindings.size());
+	for (size_t i = 0; i < bindings.size(); i++)
+	{
+		writes[i] = {};
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = set;
+		writes[i].dstBinding = bindings[i].binding;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].pBufferInfo = &buffers[i];
+	}
+	VulkanRenderer::vk.UpdateDescriptorSets(VulkanRenderer::device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+	FrameStats::current.descriptorWrites++;
+}
+
+void ComputeTechniqueVulkan::record(VkCommandBuffer commandBuffer, VkBuffer transforms, uint32_t x, uint32_t y, uint32_t z)
+{
+	if (builtRevision != revision || (transformSlot != NO_SLOT && builtTransforms != transforms))
+	{
+		build(transforms);
+		builtRevision = revision;
+		builtTransforms = transforms;
+	}
+
+	VulkanRenderer::vk.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	FrameStats::current.pipelineBinds++;
+	if (set != VK_NULL_HANDLE)
+		VulkanRenderer::vk.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+
+	uint32_t pushOffset = 0;
+	for (auto& cb : ((MaterialVulkan*)material)->getConstantBuffers())
+	{
+		VkShaderStageFlags stage;
+		uint32_t offset, size;
+		const void* data;
+		cb.second->getPushRange(stage, offset, size, data);
+		if (size == 0)
+			continue;
+		if (pushOffset + size > PUSH_BYTES)
+		{
+			fprintf(stderr, "constant buffers of a compute material over %u bytes\n", PUSH_BYTES);
+			exit(-1);
+		}
+		VulkanRenderer::vk.CmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, pushOffset, size, data);
+		FrameStats::current.pushConstantBytes += size;
+		pushOffset += size;
+	}
+
+	VulkanRenderer::vk.CmdDispatch(commandBuffer, x, y, z);
+	FrameStats::current.dispatches++;
+}
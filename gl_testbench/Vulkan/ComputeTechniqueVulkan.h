@@ -0,0 +1,36 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "../ComputeTechnique.h"
+
+/*
+ Compute pipeline with a layout of its own: one storage buffer descriptor
+ per binding slot of the technique, and the material's constant buffers
+ as COMPUTE push constants, one after the other from offset 0 (at most
+ PUSH_BYTES). The shader declares them with layout(push_constant).
+ Layout, pipeline and descriptors are made by the first record() after a
+ binding changed.
+*/
+class ComputeTechniqueVulkan : public ComputeTechnique
+{
+public:
+	// the minimum maxPushConstantsSize, GpuCuller pushes 112.
+	static const uint32_t PUSH_BYTES = 128;
+
+	ComputeTechniqueVulkan(Material* m);
+	~ComputeTechniqueVulkan();
+
+	// transforms is the renderer's translation buffer, VK_NULL_HANDLE when it has none.
+	void record(VkCommandBuffer commandBuffer, VkBuffer transforms, uint32_t x, uint32_t y, uint32_t z);
+private:
+	void build(VkBuffer transforms);
+	void release();
+
+	VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+	VkPipelineLayout layout = VK_NULL_HANDLE;
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkDescriptorPool pool = VK_NULL_HANDLE;
+	VkDescriptorSet set = VK_NULL_HANDLE;
+	// what the pipeline and descriptors were built for.
+	unsigned int builtRevision = ~0u;
+	VkBuffer builtTransforms = VK_NULL_HANDLE;
+};
@@ -1,12 +1,14 @@
+#include <string.h>
 #include "ConstantBufferVulkan.h"
 #include "VulkanRenderer.h"
-#include <vulkan\vulkan.h>
+#include <vulkan/vulkan.h>
 #include "../IA.h"
 ConstantBufferVulkan::ConstantBufferVulkan(std::string NAME, unsigned int location)
 {
 	name = NAME;
 	this->location = location;
-	buff = malloc(sizeof(float)*4);
+	capacity = sizeof(float) * 4;
+	buff = malloc(capacity);
 }
 
 ConstantBufferVulkan::~ConstantBufferVulkan()
@@ -16,27 +18,65 @@ ConstantBufferVulkan::~ConstantBufferVulkan()
 
 void ConstantBufferVulkan::setData(const void * data, size_t size, Material * m, unsigned int location)
 {
-	float x = ((float*)data)[0];
+	if (size > capacity)
+	{
+		capacity = size;
+		buff = realloc(buff, capacity);
+	}
 	memcpy(buff, data, size);
+	if (source != nullptr || instance != 0 || this->size != size)
+		revision++;
 	this->size = size;
+	source = nullptr;
+	instance = 0;
 }
 
-void ConstantBufferVulkan::bind(Material *)
+void ConstantBufferVulkan::attach(const float* translation)
 {
-	VkShaderStageFlagBits vkLocation;
-	int offset = 0;
+	source = translation;
+	size = sizeof(float) * 4;
+	instance = 0;
+	revision++;
+}
+
+void ConstantBufferVulkan::attachInstance(uint32_t index)
+{
+	source = nullptr;
+	size = 0;
+	instance = index;
+	revision++;
+}
+
+void ConstantBufferVulkan::getPushRange(VkShaderStageFlags& stage, uint32_t& offset, uint32_t& size, const void*& data) const
+{
+	// other locations have no push constant range.
+	stage = 0;
+	offset = 0;
 	switch (location)
 	{
 	case TRANSLATION:
 		offset = 0;
-		vkLocation = VK_SHADER_STAGE_VERTEX_BIT;
+		stage = VK_SHADER_STAGE_VERTEX_BIT;
 		break;
 	case DIFFUSE_TINT:
 		offset = sizeof(float) * 4;
-		vkLocation = VK_SHADER_STAGE_FRAGMENT_BIT;
+		stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 		break;
 	default:
 		break;
 	}
-	vkCmdPushConstants(*VulkanRenderer::currentBuffer, VulkanRenderer::pipelineLayout, vkLocation, offset, size, buff);
+	size = (uint32_t)this->size;
+	data = source ? source : buff;
+}
+
+void ConstantBufferVulkan::bind(Material *)
+{
+	VkShaderStageFlags stage;
+	uint32_t offset, size;
+	const void* data;
+	getPushRange(stage, offset, size, data);
+	if (size == 0)
+		return;
+	VulkanRenderer::vk.CmdPushConstants(*VulkanRenderer::currentBuffer, VulkanRenderer::pipelineLayout, stage, offset, size, data);
+	FrameStats::current.pushConstantBytes += size;
 }
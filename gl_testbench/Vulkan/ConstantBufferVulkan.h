@@ -1,4 +1,5 @@
 #pragma once
+#include <vulkan/vulkan.h>
 #include "../ConstantBuffer.h"
 
 class ConstantBufferVulkan : public ConstantBuffer
@@ -8,10 +9,23 @@ public:
 	~ConstantBufferVulkan();
 	void setData(const void* data, size_t size, Material* m, unsigned int location);
 	void bind(Material*);
+	// pushes the float4 at translation (a slot of the renderer's per-draw
+	// array) instead of its own data, until the next setData.
+	void attach(const float* translation);
+	// pushes nothing, the shader reads slot index of the renderer's
+	// translation storage buffer (the draw's first instance).
+	void attachInstance(uint32_t index);
+	uint32_t getInstance() const { return instance; };
+	// the push constant range bind() writes.
+	void getPushRange(VkShaderStageFlags& stage, uint32_t& offset, uint32_t& size, const void*& data) const;
 private:
 	std::string name;
 	int location;
-	size_t size;
+	size_t size = 0;
+	// bytes allocated at buff, grows with setData.
+	size_t capacity = 0;
 	void* buff = nullptr;
+	const float* source = nullptr;
+	uint32_t instance = 0;
 	void* lastMat;
 };
\ No newline at end of file
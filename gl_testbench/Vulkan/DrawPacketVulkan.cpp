@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "DrawPacketVulkan.h"
+#include "VulkanRenderer.h"
+#include "TechniqueVulkan.h"
+#include "VertexBufferVulkan.h"
+#include "IndexBufferVulkan.h"
+#include "ConstantBufferVulkan.h"
+#include "../Mesh.h"
+#include "../FrameStats.h"
+
+const uint32_t DrawPacketVulkan::MAX_STREAMS;
+const uint32_t DrawPacketVulkan::MAX_TEXTURES;
+const uint32_t DrawPacketVulkan::NO_FIRST_VERTEX;
+
+void DrawPacketVulkan::compile(Mesh* mesh, DrawPacketVulkan& packet)
+{
+	if (mesh->geometryBuffers.size() > MAX_STREAMS || mesh->textures.size() > MAX_TEXTURES)
+	{
+		fprintf(stderr, "mesh with %zu streams and %zu textures does not fit a draw packet\n",
+			mesh->geometryBuffers.size(), mesh->textures.size());
+		exit(-1);
+	}
+	packet.technique = mesh->technique;
+	packet.techniqueId = ((TechniqueVulkan*)mesh->technique)->id;
+	// the count of stream 0, as frame() always did.
+	auto first = mesh->geometryBuffers.find(0);
+	packet.vertexCount = first == mesh->geometryBuffers.end() ? 0 : (uint32_t)first->second.numElements;
+
+	IndexBufferVulkan* ib = (IndexBufferVulkan*)mesh->indexBuffer.buffer;
+	packet.indexBuffer = ib ? ib->getHandle() : VK_NULL_HANDLE;
+	packet.indexOffset = ib ? mesh->indexBuffer.offset : 0;
+	packet.indexType = ib ? ib->getType() : VK_INDEX_TYPE_UINT32;
+	if (ib)
+		packet.vertexCount = (uint32_t)mesh->indexBuffer.count;
+
+	packet.streamCount = 0;
+	packet.firstVertex = NO_FIRST_VERTEX;
+	for (auto& g : mesh->geometryBuffers)
+	{
+		const uint32_t s = packet.streamCount++;
+		packet.streamLocations[s] = g.first;
+		packet.streamBuffers[s] = ((VertexBufferVulkan*)g.second.buffer)->getHandle();
+		packet.streamOffsets[s] = g.second.offset;
+		// the binding strides of the pipelines are the element sizes.
+		const bool whole = g.second.sizeElement != 0 && g.second.offset % g.second.sizeElement == 0;
+		const uint32_t first = !whole ? NO_FIRST_VERTEX : (uint32_t)(g.second.offset / g.second.sizeElement);
+		if (s == 0)
+			packet.firstVertex = first;
+		else if (first != packet.firstVertex)
+			packet.firstVertex = NO_FIRST_VERTEX;
+	}
+
+	packet.textureCount = 0;
+	for (auto& t : mesh->textures)
+	{
+		const uint32_t s = packet.textureCount++;
+		packet.textureSlots[s] = t.first;
+		packet.textures[s] = t.second;
+	}
+
+	ConstantBufferVulkan* cb = (ConstantBufferVulkan*)mesh->txBuffer;
+	cb->getPushRange(packet.pushStage, packet.pushOffset, packet.pushSize, packet.pushData);
+	packet.firstInstance = cb->getInstance();
+
+	packet.meshRevision = mesh->getRevision();
+	packet.constantsRevision = cb->getRevision();
+}
+
+void DrawPacketVulkan::record(VkCommandBuffer commandBuffer) const
+{
+	// the same calls ConstantBufferVulkan::bind and VertexBufferVulkan::bind make.
+	if (pushSize)
+	{
+		VulkanRenderer::vk.CmdPushConstants(commandBuffer, VulkanRenderer::pipelineLayout, pushStage, pushOffset, pushSize, pushData);
+		FrameStats::current.pushConstantBytes += pushSize;
+	}
+	for (uint32_t s = 0; s < streamCount; s++)
+		VulkanRenderer::vk.CmdBindVertexBuffers(commandBuffer, streamLocations[s], 1, &streamBuffers[s], &streamOffsets[s]);
+	FrameStats::current.vertexBufferBinds += streamCount;
+	if (indexBuffer != VK_NULL_HANDLE)
+	{
+		VulkanRenderer::vk.CmdBindIndexBuffer(commandBuffer, indexBuffer, indexOffset, indexType);
+		VulkanRenderer::vk.CmdDrawIndexed(commandBuffer, vertexCount, 1, 0, 0, firstInstance);
+	}
+	else
+		VulkanRenderer::vk.CmdDraw(commandBuffer, vertexCount, 1, 0, firstInstance);
+	FrameStats::current.drawsIssued++;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+class Mesh;
+class Technique;
+class Texture2D;
+
+/*
+ Everything VulkanRenderer::frame() records for one mesh, resolved to
+ VkBuffers, offsets and the push constant range by compile(), so the
+ recording loop does no map lookups and no virtual calls (the pipeline is
+ bound when the technique changes).
+
+ MeshVulkan keeps its packet and recompiles it when the revision of the
+ mesh or of its translation buffer changes, submit copies it into the
+ frame's draw list.
+*/
+struct DrawPacketVulkan
+{
+	static const uint32_t MAX_STREAMS = 4;
+	static const uint32_t MAX_TEXTURES = 2;
+	static const uint32_t NO_FIRST_VERTEX = 0xffffffff;
+
+	Technique* technique;
+	// TechniqueVulkan::id, the PER_TECHNIQUE sort key.
+	int techniqueId;
+	// the index count of indexed meshes.
+	uint32_t vertexCount;
+	// of every stream when they are bound from offset 0, NO_FIRST_VERTEX
+	// when the offsets do not agree (see VulkanRenderer::setGpuCulling).
+	uint32_t firstVertex;
+
+	// Mesh::setIndexBuffer, VK_NULL_HANDLE draws the vertices in order.
+	VkBuffer indexBuffer;
+	VkDeviceSize indexOffset;
+	VkIndexType indexType;
+
+	uint32_t streamCount;
+	uint32_t streamLocations[MAX_STREAMS];
+	VkBuffer streamBuffers[MAX_STREAMS];
+	VkDeviceSize streamOffsets[MAX_STREAMS];
+
+	// bound into the descriptor set before recording, not per draw.
+	uint32_t textureCount;
+	uint32_t textureSlots[MAX_TEXTURES];
+	Texture2D* textures[MAX_TEXTURES];
+
+	// translation push constants, data is read when recording. No push
+	// (size 0) when the translation is read from firstInstance instead.
+	VkShaderStageFlags pushStage;
+	uint32_t pushOffset;
+	uint32_t pushSize;
+	const void* pushData;
+	uint32_t firstInstance;
+
+	// revisions of the mesh and its txBuffer the packet was compiled from.
+	unsigned int meshRevision;
+	unsigned int constantsRevision;
+
+	// exits when the mesh has more than MAX_STREAMS streams or MAX_TEXTURES textures.
+	static void compile(Mesh* mesh, DrawPacketVulkan& packet);
+	// binds the streams (and indices), pushes the translation and draws.
+	void record(VkCommandBuffer commandBuffer) const;
+
+	static bool byTechnique(const DrawPacketVulkan& a, const DrawPacketVulkan& b) { return a.techniqueId < b.techniqueId; };
+};
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "GpuProfilerVulkan.h"
+#include "VulkanRenderer.h"
+
+// timestamp bits of the first graphics queue family, 0 if none.
+static uint32_t graphicsTimestampBits()
+{
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(VulkanRenderer::physicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> families(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(VulkanRenderer::physicalDevice, &count, families.data());
+	for (auto& family : families)
+	{
+		if (family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+			return family.timestampValidBits;
+	}
+	return 0;
+}
+
+bool GpuProfilerVulkan::isSupported()
+{
+	return graphicsTimestampBits() > 0;
+}
+
+GpuProfilerVulkan::GpuProfilerVulkan()
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(VulkanRenderer::physicalDevice, &properties);
+	nsPerTick = properties.limits.timestampPeriod;
+	uint32_t bits = graphicsTimestampBits();
+	validMask = bits >= 64 ? ~0ull : (1ull << bits) - 1;
+
+	VkQueryPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = LATENCY * MAX_MARKS;
+	if (FAILED(vkCreateQueryPool(VulkanRenderer::device, &poolInfo, nullptr, &queryPool)))
+	{
+		fprintf(stderr, "failed to create timestamp query pool!\n");
+		exit(-1);
+	}
+	ticks.resize(MAX_MARKS);
+}
+
+GpuProfilerVulkan::~GpuProfilerVulkan()
+{
+	vkDestroyQueryPool(VulkanRenderer::device, queryPool, nullptr);
+}
+
+void GpuProfilerVulkan::beginFrame()
+{
+	frameCount++;
+	const uint32_t slot = (uint32_t)(frameCount % LATENCY);
+	const uint32_t count = pendingMarks(slot);
+	if (count > 0)
+	{
+		// no VK_QUERY_RESULT_WAIT_BIT: not ready means the frame is dropped.
+		VkResult res = vkGetQueryPoolResults(VulkanRenderer::device, queryPool, slot * MAX_MARKS, count,
+			count * sizeof(uint64_t), ticks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (res == VK_SUCCESS)
+		{
+			for (uint32_t i = 0; i < count; i++)
+				ticks[i] &= validMask;
+			resolve(slot, ticks.data(), nsPerTick);
+		}
+		else
+			drop(slot);
+	}
+	beginMarks(frameCount);
+}
+
+void GpuProfilerVulkan::begin(VkCommandBuffer cmd, uint32_t scope)
+{
+	beginMarks(frameCount);
+	vkCmdResetQueryPool(cmd, queryPool, currentSlot() * MAX_MARKS, MAX_MARKS);
+	uint32_t query = nextMark(scope);
+	if (query != NO_QUERY)
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, query);
+}
+
+void GpuProfilerVulkan::mark(VkCommandBuffer cmd, uint32_t scope)
+{
+	uint32_t query = nextMark(scope);
+	if (query != NO_QUERY)
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, query);
+}
+
+void GpuProfilerVulkan::end(VkCommandBuffer cmd)
+{
+	vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, endMark());
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <vulkan/vulkan.h>
+#include "../GpuProfiler.h"
+
+/*
+ Timestamp query pool with LATENCY * MAX_MARKS queries. Every command
+ buffer recorded for a frame writes the same marks, only the submitted one
+ produces results.
+*/
+class GpuProfilerVulkan : public GpuProfiler
+{
+public:
+	GpuProfilerVulkan();
+	~GpuProfilerVulkan();
+
+	// false if the device has no timestamps on graphics queues.
+	static bool isSupported();
+
+	// reads back the frame recorded LATENCY frames ago, starts the next one.
+	void beginFrame();
+	// resets the frame's queries, must be recorded outside a render pass.
+	void begin(VkCommandBuffer cmd, uint32_t scope);
+	// closes the previous interval once all earlier commands have finished.
+	void mark(VkCommandBuffer cmd, uint32_t scope);
+	void end(VkCommandBuffer cmd);
+private:
+	VkQueryPool queryPool = VK_NULL_HANDLE;
+	double nsPerTick = 1.0;
+	uint64_t validMask = ~0ull;
+	uint64_t frameCount = 0;
+	std::vector<uint64_t> ticks;
+};
@@ -0,0 +1,73 @@
+#include <string.h>
+#include "IndexBufferVulkan.h"
+#include "VulkanRenderer.h"
+#include "../MemoryTracker.h"
+
+IndexBufferVulkan::IndexBufferVulkan(size_t size, IndexBuffer::FORMAT format) : IndexBuffer(format)
+{
+	bufferSize = size;
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (FAILED(vkCreateBuffer(VulkanRenderer::device, &bufferInfo, nullptr, &indexBuffer)))
+	{
+		fprintf(stderr, "failed to create index buffer!\n");
+		exit(-1);
+	}
+
+	VkMemoryRequirements memRequirements;
+	vkGetBufferMemoryRequirements(VulkanRenderer::device, indexBuffer, &memRequirements);
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = memRequirements.size;
+	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	if (FAILED(vkAllocateMemory(VulkanRenderer::device, &allocInfo, nullptr, &indexBufferMemory)))
+	{
+		fprintf(stderr, "failed to allocate buffer memory!\n");
+		exit(-1);
+	}
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, (uint64_t)indexBufferMemory, allocInfo.memoryTypeIndex, memRequirements.size, size);
+
+	vkBindBufferMemory(VulkanRenderer::device, indexBuffer, indexBufferMemory, 0);
+}
+
+IndexBufferVulkan::~IndexBufferVulkan()
+{
+	vkDestroyBuffer(VulkanRenderer::device, indexBuffer, nullptr);
+	vkFreeMemory(VulkanRenderer::device, indexBufferMemory, nullptr);
+	MemoryTracker::release(MemoryTracker::CATEGORY::VERTEX, (uint64_t)indexBufferMemory);
+}
+
+void IndexBufferVulkan::setData(const void* data, size_t size, size_t offset)
+{
+	void* vkData;
+	VulkanRenderer::vk.MapMemory(VulkanRenderer::device, indexBufferMemory, offset, size, 0, &vkData);
+	memcpy(vkData, data, size);
+	VulkanRenderer::vk.UnmapMemory(VulkanRenderer::device, indexBufferMemory);
+	FrameStats::current.bufferMaps++;
+	FrameStats::current.bufferUnmaps++;
+	FrameStats::current.stagingBytes += size;
+}
+
+size_t IndexBufferVulkan::getSize()
+{
+	return bufferSize;
+}
+
+uint32_t IndexBufferVulkan::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+{
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(VulkanRenderer::physicalDevice, &memProperties);
+	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+	fprintf(stderr, "failed to find suitable memory type!\n");
+	exit(-1);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "../IndexBuffer.h"
+#include <vulkan/vulkan.h>
+
+// host visible, setData maps it like VertexBufferVulkan.
+class IndexBufferVulkan : public IndexBuffer
+{
+public:
+	IndexBufferVulkan(size_t size, IndexBuffer::FORMAT format);
+	~IndexBufferVulkan();
+
+	void setData(const void* data, size_t size, size_t offset);
+	size_t getSize();
+	VkBuffer getHandle() const { return indexBuffer; };
+	VkIndexType getType() const { return getFormat() == FORMAT::UINT16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32; };
+
+private:
+	size_t bufferSize;
+	VkBuffer indexBuffer;
+	VkDeviceMemory indexBufferMemory;
+	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+};
@@ -1,5 +1,8 @@
 #include "MaterialVulkan.h"
+#ifdef _WIN32
+#define NOMINMAX
 #include <windows.h>
+#endif
 #include <streambuf>
 #include <sstream>
 #include <istream>
@@ -7,9 +10,11 @@
 #include <vector>
 #include <set>
 #include <assert.h>
-#include <shaderc\shaderc.hpp>
+#include <shaderc/shaderc.hpp>
+#include "../MemoryTracker.h"
 #include <iostream>
 #include "VulkanRenderer.h"
+#include "../Profiler.h"
 #include "../IA.h"
 
 MaterialVulkan::MaterialVulkan(const std::string& name)
@@ -23,6 +28,7 @@ MaterialVulkan::~MaterialVulkan()
 {
 	removeShader(ShaderType::VS);
 	removeShader(ShaderType::PS);
+	removeShader(ShaderType::CS);
 }
 
 void MaterialVulkan::setShader(const std::string & shaderFileName, ShaderType type)
@@ -39,6 +45,7 @@ void MaterialVulkan::removeShader(ShaderType type)
 	if (shaderObjects[(int)type] != NULL)
 	{
 		vkDestroyShaderModule(VulkanRenderer::device, shaderObjects[(int)type], nullptr);
+		MemoryTracker::release(MemoryTracker::CATEGORY::PIPELINE, (uint64_t)shaderObjects[(int)type]);
 		shaderObjects[(int)type] = NULL;
 		shaderStages[(int)type] = {};
 	}
@@ -51,21 +58,36 @@ void MaterialVulkan::setDiffuse(Color c)
 
 int MaterialVulkan::compileMaterial(std::string & errString)
 {
+	PROFILE_ZONE("compileMaterial");
 	//Remove existing shaders
 	removeShader(ShaderType::VS);
 	removeShader(ShaderType::PS);
+	removeShader(ShaderType::CS);
 
 	// compile shaders
 	std::string err;
+	// a compute material has its CS and nothing else.
+	if (shaderFileNames.find(ShaderType::CS) != shaderFileNames.end())
+	{
+		if (compileShader(ShaderType::CS, err) < 0) {
+			errString = err;
+			return -1;
+		};
+		VkPipelineShaderStageCreateInfo computeShaderStageInfo = {};
+		computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		computeShaderStageInfo.module = shaderObjects[(int)ShaderType::CS];
+		computeShaderStageInfo.pName = "main";
+		shaderStages[(int)ShaderType::CS] = computeShaderStageInfo;
+		return 0;
+	}
 	if (compileShader(ShaderType::VS, err) < 0) {
 		errString = err;
-		fprintf(stderr, "%s", errString.c_str());
-		exit(-1);
+		return -1;
 	};
 	if (compileShader(ShaderType::PS, err) < 0) {
 		errString = err;
-		fprintf(stderr, "%s", errString.c_str());
-		exit(-1);
+		return -1;
 	};
 	
 	//link the shaders
@@ -176,6 +198,8 @@ int MaterialVulkan::compileShader(ShaderType type, std::string & errString)
 	}
 	
 	shaderObjects[(int)type] = shaderModule;
+	// what the driver keeps of it is unknown, the SPIR-V size is a lower bound.
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::PIPELINE, (uint64_t)shaderModule, MemoryTracker::DRIVER_MEMORY, createInfo.codeSize);
 	
 	return 0;
 }
@@ -198,18 +222,13 @@ std::vector<VkVertexInputBindingDescription> MaterialVulkan::getBindingDescripti
 	std::vector<VkVertexInputBindingDescription> bindingDescriptions;
 
 	VkVertexInputBindingDescription bindingDescription = {};
-	bindingDescription.binding = POSITION;
-	bindingDescription.stride = sizeof(float)*4;
 	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-	bindingDescriptions.push_back(bindingDescription);
-
-	bindingDescription.binding = TEXTCOORD;
-	bindingDescription.stride = sizeof(float) * 2;
-	bindingDescriptions.push_back(bindingDescription);
-
-	bindingDescription.binding = NORMAL;
-	bindingDescription.stride = sizeof(float) * 4;
-	bindingDescriptions.push_back(bindingDescription);
+	for (unsigned int stream : vertexLayout.getStreams())
+	{
+		bindingDescription.binding = stream;
+		bindingDescription.stride = vertexLayout.getStride(stream);
+		bindingDescriptions.push_back(bindingDescription);
+	}
 
 	return bindingDescriptions;
 }
@@ -219,23 +238,29 @@ std::vector<VkVertexInputAttributeDescription> MaterialVulkan::getAttributeDescr
 	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
 
 	VkVertexInputAttributeDescription attributeDescription = {};
-	attributeDescription.binding = POSITION;
-	attributeDescription.location = POSITION;
-	attributeDescription.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-	attributeDescription.offset = 0;
-	attributeDescriptions.push_back(attributeDescription);
-
-	attributeDescription.binding = TEXTCOORD;
-	attributeDescription.location = TEXTCOORD;
-	attributeDescription.format = VK_FORMAT_R32G32_SFLOAT;
-	attributeDescription.offset = 0;
-	attributeDescriptions.push_back(attributeDescription);
-
-	attributeDescription.binding = NORMAL;
-	attributeDescription.location = NORMAL;
-	attributeDescription.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-	attributeDescription.offset = 0;
-	attributeDescriptions.push_back(attributeDescription);
+	for (const VertexLayout::Attribute& a : vertexLayout.getAttributes())
+	{
+		attributeDescription.binding = a.stream;
+		attributeDescription.location = a.location;
+		attributeDescription.format = getVertexFormat(a.format);
+		attributeDescription.offset = a.offset;
+		attributeDescriptions.push_back(attributeDescription);
+	}
 
 	return attributeDescriptions;
 }
+
+VkFormat MaterialVulkan::getVertexFormat(VertexLayout::FORMAT format)
+{
+	switch (format)
+	{
+	case VertexLayout::FORMAT::FLOAT4: return VK_FORMAT_R32G32B32A32_SFLOAT;
+	case VertexLayout::FORMAT::FLOAT2: return VK_FORMAT_R32G32_SFLOAT;
+	case VertexLayout::FORMAT::HALF4: return VK_FORMAT_R16G16B16A16_SFLOAT;
+	case VertexLayout::FORMAT::HALF2: return VK_FORMAT_R16G16_SFLOAT;
+	// A2B10G10R10_SNORM_PACK32 is optional as a vertex format, the shader decodes the word.
+	case VertexLayout::FORMAT::SNORM_10_10_10_2: return VK_FORMAT_R32_UINT;
+	case VertexLayout::FORMAT::OCTAHEDRAL: return VK_FORMAT_R16G16_SNORM;
+	default: return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
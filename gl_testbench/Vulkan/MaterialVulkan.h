@@ -1,7 +1,7 @@
 #pragma once
 #include "../Material.h"
 #include "ConstantBufferVulkan.h"
-#include <vulkan\vulkan.h>
+#include <vulkan/vulkan.h>
 #include <vector>
 class MaterialVulkan : public Material
 {
@@ -22,16 +22,21 @@ public:
 	int enable();
 	void disable();
 
+	// VS and PS, or CS alone for a compute material.
 	VkPipelineShaderStageCreateInfo* getShaderStages();
+	const std::map<unsigned int, ConstantBufferVulkan*>& getConstantBuffers() const { return constantBuffers; };
 
 	std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
 	std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+	// the format of the vertex input of an attribute of the layout.
+	static VkFormat getVertexFormat(VertexLayout::FORMAT format);
+
+	// defines + GLSL version + source, public for the microbenchmarks.
+	std::string expandShaderText(std::string& shaderText, ShaderType type);
 private:
 	int compileShader(ShaderType type, std::string& errString);
 	VkShaderModule shaderObjects[4] = { NULL, NULL, NULL, NULL };
-	VkPipelineShaderStageCreateInfo shaderStages[4];
-	
-	std::string expandShaderText(std::string& shaderText, ShaderType type);
+	VkPipelineShaderStageCreateInfo shaderStages[4] = {};
 
 	std::map<unsigned int, ConstantBufferVulkan*> constantBuffers;
 };
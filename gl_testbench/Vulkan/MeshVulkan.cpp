@@ -1,5 +1,6 @@
 #include "MeshVulkan.h"
-#include "TechniqueVulkan.h"
+#include "../ConstantBuffer.h"
+
 MeshVulkan::MeshVulkan()
 {
 }
@@ -8,7 +9,12 @@ MeshVulkan::~MeshVulkan()
 {
 }
 
-bool MeshVulkan::sortMesh(const Mesh * meshA, const Mesh * meshB)
+const DrawPacketVulkan& MeshVulkan::getPacket()
 {
-	return ((TechniqueVulkan*)meshA->technique)->id	< ((TechniqueVulkan*)meshB->technique)->id;
+	if (!compiled || packet.meshRevision != getRevision() || packet.constantsRevision != txBuffer->getRevision())
+	{
+		DrawPacketVulkan::compile(this, packet);
+		compiled = true;
+	}
+	return packet;
 }
@@ -1,11 +1,16 @@
 #pragma once
 #include "../Mesh.h"
+#include "DrawPacketVulkan.h"
+
 class MeshVulkan : public Mesh
 {
 public:
 	MeshVulkan();
 	~MeshVulkan();
 
-	static bool sortMesh(const Mesh* meshA, const Mesh* meshB);
-
+	// the compiled packet, recompiled first if the mesh changed.
+	const DrawPacketVulkan& getPacket();
+private:
+	DrawPacketVulkan packet;
+	bool compiled = false;
 };
@@ -1,6 +1,6 @@
 #pragma once
 #include "../RenderState.h"
-#include <vulkan\vulkan.h>
+#include <vulkan/vulkan.h>
 
 class RenderStateVulkan : public RenderState
 {
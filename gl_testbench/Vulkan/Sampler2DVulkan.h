@@ -1,5 +1,5 @@
 #include "../Sampler2D.h"
-#include <vulkan\vulkan.h>
+#include <vulkan/vulkan.h>
 class Sampler2DVulkan : public Sampler2D
 {
 public:
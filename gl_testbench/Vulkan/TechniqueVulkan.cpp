@@ -73,6 +73,7 @@ TechniqueVulkan::~TechniqueVulkan()
 void TechniqueVulkan::enable(Renderer * renderer)
 {
 	currentTechnique = this;
-	vkCmdBindPipeline(*((VulkanRenderer*)renderer)->currentBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+	VulkanRenderer::vk.CmdBindPipeline(*((VulkanRenderer*)renderer)->currentBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+	FrameStats::current.pipelineBinds++;
 	material->enable();
 }
\ No newline at end of file
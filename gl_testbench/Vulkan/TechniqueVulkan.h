@@ -2,7 +2,7 @@
 
 #include "MaterialVulkan.h"
 #include "../Technique.h"
-#include <vulkan\vulkan.h>
+#include <vulkan/vulkan.h>
 
 class TechniqueVulkan : public Technique
 {
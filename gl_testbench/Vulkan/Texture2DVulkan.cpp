@@ -1,6 +1,9 @@
+#include <string.h>
 #include "Texture2DVulkan.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "Sampler2DVulkan.h"
+#include "../Profiler.h"
+#include "../FrameStats.h"
 
 Texture2DVulkan::Texture2DVulkan()
 {
@@ -13,10 +16,12 @@ Texture2DVulkan::~Texture2DVulkan()
 	vkDestroyImageView(VulkanRenderer::device, textureImageView, nullptr);
 	vkDestroyImage(VulkanRenderer::device, textureImage, nullptr);
 	vkFreeMemory(VulkanRenderer::device, textureImageMemory, nullptr);
+	MemoryTracker::release(MemoryTracker::CATEGORY::TEXTURE, (uint64_t)textureImageMemory);
 }
 
 int Texture2DVulkan::loadFromFile(std::string filename)
 {
+	PROFILE_ZONE("loadTexture");
 	int texWidth, texHeight, texChannels;
 	stbi_uc* pixels = stbi_load(filename.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
@@ -32,17 +37,20 @@ int Texture2DVulkan::loadFromFile(std::string filename)
 	VkDeviceMemory stagingBufferMemory;
 
 	createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | 
-			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, MemoryTracker::CATEGORY::STAGING);
 
 	void* data;
-	vkMapMemory(VulkanRenderer::device, stagingBufferMemory, 0, imageSize, 0, &data);
+	VulkanRenderer::vk.MapMemory(VulkanRenderer::device, stagingBufferMemory, 0, imageSize, 0, &data);
 	memcpy(data, pixels, static_cast<size_t>(imageSize)); // copy pixels to gpu
-	vkUnmapMemory(VulkanRenderer::device, stagingBufferMemory);
+	VulkanRenderer::vk.UnmapMemory(VulkanRenderer::device, stagingBufferMemory);
+	FrameStats::current.bufferMaps++;
+	FrameStats::current.bufferUnmaps++;
+	FrameStats::current.stagingBytes += imageSize;
 	
 	stbi_image_free(pixels);
 
 	createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT 
-		| VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+		| VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory, MemoryTracker::CATEGORY::TEXTURE);
 
 
 	transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
@@ -53,7 +61,9 @@ int Texture2DVulkan::loadFromFile(std::string filename)
 
 	vkDestroyBuffer(VulkanRenderer::device, stagingBuffer, nullptr);
 	vkFreeMemory(VulkanRenderer::device, stagingBufferMemory, nullptr);
+	MemoryTracker::release(MemoryTracker::CATEGORY::STAGING, (uint64_t)stagingBufferMemory);
 	textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_UNORM);
+	return 0;
 
 
 }
@@ -61,7 +71,8 @@ int Texture2DVulkan::loadFromFile(std::string filename)
 
 
 void Texture2DVulkan::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, 
-	VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+	VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
+	MemoryTracker::CATEGORY category)
 {
 	VkImageCreateInfo imageInfo = {};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -103,6 +114,7 @@ void Texture2DVulkan::createImage(uint32_t width, uint32_t height, VkFormat form
 		fprintf(stderr, "Failed to allocate image memory!");
 		exit(-1);
 	}
+	MemoryTracker::allocate(category, (uint64_t)imageMemory, allocInfo.memoryTypeIndex, memRequirements.size, (uint64_t)width * height * 4);
 
 
 
@@ -126,7 +138,7 @@ VkCommandBuffer Texture2DVulkan::beginSingleTimeCommands()
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	VulkanRenderer::vk.BeginCommandBuffer(commandBuffer, &beginInfo);
 
 	return commandBuffer;
 
@@ -134,6 +146,7 @@ VkCommandBuffer Texture2DVulkan::beginSingleTimeCommands()
 
 void Texture2DVulkan::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 {
+	PROFILE_ZONE("endSingleTimeCommands");
 	vkEndCommandBuffer(commandBuffer);
 
 	VkSubmitInfo submitInfo = {};
@@ -141,8 +154,13 @@ void Texture2DVulkan::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 
-	vkQueueSubmit(VulkanRenderer::graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(VulkanRenderer::graphicsQueue);
+	VulkanRenderer::vk.QueueSubmit(VulkanRenderer::graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	{
+		PROFILE_ZONE("vkQueueWaitIdle");
+		vkQueueWaitIdle(VulkanRenderer::graphicsQueue);
+	}
+	FrameStats::current.queueSubmits++;
+	FrameStats::current.queueWaits++;
 
 	vkFreeCommandBuffers(VulkanRenderer::device, VulkanRenderer::commandPool, 1, &commandBuffer);
 }
@@ -217,11 +235,14 @@ void Texture2DVulkan::bind(unsigned int slot)
 	descriptorWrite.pImageInfo = &imageInfo;
 
 
-	vkUpdateDescriptorSets(VulkanRenderer::device, 1, &descriptorWrite, 0, nullptr);
+	VulkanRenderer::vk.UpdateDescriptorSets(VulkanRenderer::device, 1, &descriptorWrite, 0, nullptr);
+	FrameStats::current.descriptorWrites++;
+	FrameStats::current.textureBinds++;
 }
 
 
-void Texture2DVulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) 
+void Texture2DVulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+	MemoryTracker::CATEGORY category)
 {
 	VkBufferCreateInfo bufferInfo = {};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -246,6 +267,7 @@ void Texture2DVulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
 		fprintf(stderr, "Failed to allocate memory");
 		exit(-1);
 	}
+	MemoryTracker::allocate(category, (uint64_t)bufferMemory, allocInfo.memoryTypeIndex, memRequirements.size, size);
 
 	vkBindBufferMemory(VulkanRenderer::device, buffer, bufferMemory, 0);
 }
@@ -3,8 +3,9 @@
 #include "../Texture2D.h"
 
 #include <stb_image.h>
-#include <vulkan\vulkan.h>
+#include <vulkan/vulkan.h>
 #include "VulkanRenderer.h"
+#include "../MemoryTracker.h"
 
 
 class Texture2DVulkan : public Texture2D
@@ -23,12 +24,13 @@ public:
 
 private:
 	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
-		VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+		VkBuffer& buffer, VkDeviceMemory& bufferMemory, MemoryTracker::CATEGORY category);
 
 	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
 	void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, 
-		VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+		VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory,
+		MemoryTracker::CATEGORY category);
 
 
 	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
@@ -1,6 +1,9 @@
+#include <string.h>
+#include <algorithm>
 #include "VertexBufferVulkan.h"
 #include "VulkanRenderer.h"
 #include "TechniqueVulkan.h"
+#include "../MemoryTracker.h"
 VertexBufferVulkan::VertexBufferVulkan(size_t size, VertexBuffer::DATA_USAGE usage)
 {
 	
@@ -10,7 +13,8 @@ VertexBufferVulkan::VertexBufferVulkan(size_t size, VertexBuffer::DATA_USAGE usa
 	VkBufferCreateInfo bufferInfo = {};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bufferInfo.size = vkBufferSize;
-	bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+	// storage and indirect as well, for compute techniques and GpuCuller.
+	bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	if (FAILED(vkCreateBuffer(VulkanRenderer::device, &bufferInfo, nullptr, &vertexBuffer)))
 	{
@@ -31,6 +35,7 @@ VertexBufferVulkan::VertexBufferVulkan(size_t size, VertexBuffer::DATA_USAGE usa
 		fprintf(stderr, "failed to allocate buffer memory!\n");
 		exit(-1);
 	}
+	MemoryTracker::allocate(MemoryTracker::CATEGORY::VERTEX, (uint64_t)vertexBufferMemory, allocInfo.memoryTypeIndex, memRequirements.size, size);
 
 	vkBindBufferMemory(VulkanRenderer::device, vertexBuffer, vertexBufferMemory, 0);
 	
@@ -40,21 +45,48 @@ VertexBufferVulkan::~VertexBufferVulkan()
 {
 	vkDestroyBuffer(VulkanRenderer::device, vertexBuffer, nullptr);
 	vkFreeMemory(VulkanRenderer::device, vertexBufferMemory, nullptr);
+	MemoryTracker::release(MemoryTracker::CATEGORY::VERTEX, (uint64_t)vertexBufferMemory);
 }
 
 void VertexBufferVulkan::setData(const void * data, size_t size, size_t offset)
 {
 	void* vkData;
-	auto result = vkMapMemory(VulkanRenderer::device, vertexBufferMemory, offset, size, 0, &vkData);
+	auto result = VulkanRenderer::vk.MapMemory(VulkanRenderer::device, vertexBufferMemory, offset, size, 0, &vkData);
 	memcpy(vkData, data, size);
-	vkUnmapMemory(VulkanRenderer::device, vertexBufferMemory);
+	VulkanRenderer::vk.UnmapMemory(VulkanRenderer::device, vertexBufferMemory);
+	FrameStats::current.bufferMaps++;
+	FrameStats::current.bufferUnmaps++;
+	FrameStats::current.stagingBytes += size;
+}
+
+void VertexBufferVulkan::setData(const Write* writes, size_t count)
+{
+	if (count == 0)
+		return;
+	VkDeviceSize first = writes[0].offset, end = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		first = std::min(first, (VkDeviceSize)writes[i].offset);
+		end = std::max(end, (VkDeviceSize)(writes[i].offset + writes[i].size));
+	}
+	char* vkData;
+	VulkanRenderer::vk.MapMemory(VulkanRenderer::device, vertexBufferMemory, first, end - first, 0, (void**)&vkData);
+	for (size_t i = 0; i < count; i++)
+	{
+		memcpy(vkData + (writes[i].offset - first), writes[i].data, writes[i].size);
+		FrameStats::current.stagingBytes += writes[i].size;
+	}
+	VulkanRenderer::vk.UnmapMemory(VulkanRenderer::device, vertexBufferMemory);
+	FrameStats::current.bufferMaps++;
+	FrameStats::current.bufferUnmaps++;
 }
 
 void VertexBufferVulkan::bind(size_t offset, size_t size, unsigned int location)
 {
 	VkBuffer vertexBuffers[] = { vertexBuffer };
 	VkDeviceSize offsets[] = { offset };
-	vkCmdBindVertexBuffers(*VulkanRenderer::currentBuffer, location, 1, vertexBuffers, offsets);
+	VulkanRenderer::vk.CmdBindVertexBuffers(*VulkanRenderer::currentBuffer, location, 1, vertexBuffers, offsets);
+	FrameStats::current.vertexBufferBinds++;
 }
 
 void VertexBufferVulkan::unbind()
@@ -1,5 +1,5 @@
 #include "../VertexBuffer.h"
-#include <vulkan\vulkan.h>
+#include <vulkan/vulkan.h>
 class VertexBufferVulkan : public VertexBuffer
 {
 public:
@@ -7,9 +7,12 @@ public:
 	~VertexBufferVulkan();
 
 	void setData(const void* data, size_t size, size_t offset);
+	// maps the range covered by the writes once.
+	void setData(const Write* writes, size_t count);
 	void bind(size_t offset, size_t size, unsigned int location);
 	void unbind();
 	size_t getSize();
+	VkBuffer getHandle() const { return vertexBuffer; };
 
 private:
 	size_t bufferSize;
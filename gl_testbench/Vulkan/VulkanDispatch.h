@@ -0,0 +1,24 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+/*
+ Commands of the per-frame path. The backend calls them through
+ VulkanRenderer::vk instead of the loader's exports, so
+ installVulkanInterposer() can wrap them without a layer.
+*/
+struct VulkanDispatch {
+	PFN_vkBeginCommandBuffer BeginCommandBuffer = vkBeginCommandBuffer;
+	PFN_vkCmdBindPipeline CmdBindPipeline = vkCmdBindPipeline;
+	PFN_vkCmdBindDescriptorSets CmdBindDescriptorSets = vkCmdBindDescriptorSets;
+	PFN_vkCmdBindVertexBuffers CmdBindVertexBuffers = vkCmdBindVertexBuffers;
+	PFN_vkCmdBindIndexBuffer CmdBindIndexBuffer = vkCmdBindIndexBuffer;
+	PFN_vkCmdPushConstants CmdPushConstants = vkCmdPushConstants;
+	PFN_vkCmdDraw CmdDraw = vkCmdDraw;
+	PFN_vkCmdDrawIndexed CmdDrawIndexed = vkCmdDrawIndexed;
+	PFN_vkCmdDispatch CmdDispatch = vkCmdDispatch;
+	PFN_vkCmdPipelineBarrier CmdPipelineBarrier = vkCmdPipelineBarrier;
+	PFN_vkUpdateDescriptorSets UpdateDescriptorSets = vkUpdateDescriptorSets;
+	PFN_vkMapMemory MapMemory = vkMapMemory;
+	PFN_vkUnmapMemory UnmapMemory = vkUnmapMemory;
+	PFN_vkQueueSubmit QueueSubmit = vkQueueSubmit;
+};
@@ -0,0 +1,246 @@
+#include <string.h>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "VulkanInterposer.h"
+#include "../ApiTrace.h"
+
+namespace {
+	VulkanDispatch real;
+
+	// handles as report arguments, non-dispatchable handles are integers on 32 bit.
+	template <typename T>
+	uint64_t arg(T handle) { return (uint64_t)handle; }
+
+	struct PushRange {
+		VkPipelineLayout layout;
+		VkShaderStageFlags stages;
+		uint32_t offset;
+		std::vector<uint8_t> bytes;
+	};
+
+	// what a command buffer has recorded since vkBeginCommandBuffer.
+	struct CommandState {
+		std::map<VkPipelineBindPoint, VkPipeline> pipelines;
+		std::map<uint32_t, VkDescriptorSet> sets;
+		std::map<uint32_t, std::pair<VkBuffer, VkDeviceSize>> vertexBuffers;
+		// no buffer bound yet, so the first bind is never redundant.
+		std::tuple<VkBuffer, VkDeviceSize, VkIndexType> indexBuffer = std::make_tuple(VkBuffer(VK_NULL_HANDLE), VkDeviceSize(0), VK_INDEX_TYPE_UINT32);
+		std::vector<PushRange> pushConstants;
+	};
+	std::map<VkCommandBuffer, CommandState> commands;
+
+	// image view, sampler and layout per set, binding and array element.
+	std::map<std::tuple<VkDescriptorSet, uint32_t, uint32_t>, std::tuple<VkImageView, VkSampler, VkImageLayout>> imageDescriptors;
+
+	struct Mapping {
+		VkDeviceSize offset, size;
+		uint64_t frame;
+		bool redundant;
+	};
+	std::map<VkDeviceMemory, Mapping> mappings;
+
+	VKAPI_ATTR VkResult VKAPI_CALL traceBeginCommandBuffer(VkCommandBuffer cmd, const VkCommandBufferBeginInfo* info)
+	{
+		ApiTrace::active->call("vkBeginCommandBuffer", API_CALL_SITE(), false, { arg(cmd) });
+		commands[cmd] = CommandState();
+		return real.BeginCommandBuffer(cmd, info);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdBindPipeline(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipeline pipeline)
+	{
+		CommandState& state = commands[cmd];
+		auto found = state.pipelines.find(bindPoint);
+		bool redundant = found != state.pipelines.end() && found->second == pipeline;
+		ApiTrace::active->call("vkCmdBindPipeline", API_CALL_SITE(), redundant, { arg(cmd), (uint64_t)bindPoint, arg(pipeline) });
+		state.pipelines[bindPoint] = pipeline;
+		real.CmdBindPipeline(cmd, bindPoint, pipeline);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdBindDescriptorSets(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout,
+		uint32_t firstSet, uint32_t setCount, const VkDescriptorSet* sets, uint32_t dynamicOffsetCount, const uint32_t* dynamicOffsets)
+	{
+		CommandState& state = commands[cmd];
+		bool redundant = dynamicOffsetCount == 0;
+		for (uint32_t i = 0; i < setCount; i++)
+		{
+			auto found = state.sets.find(firstSet + i);
+			redundant = redundant && found != state.sets.end() && found->second == sets[i];
+			state.sets[firstSet + i] = sets[i];
+		}
+		ApiTrace::active->call("vkCmdBindDescriptorSets", API_CALL_SITE(), redundant,
+			{ arg(cmd), arg(layout), firstSet, setCount, setCount ? arg(sets[0]) : 0 });
+		real.CmdBindDescriptorSets(cmd, bindPoint, layout, firstSet, setCount, sets, dynamicOffsetCount, dynamicOffsets);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdBindVertexBuffers(VkCommandBuffer cmd, uint32_t firstBinding, uint32_t bindingCount,
+		const VkBuffer* buffers, const VkDeviceSize* offsets)
+	{
+		CommandState& state = commands[cmd];
+		bool redundant = true;
+		for (uint32_t i = 0; i < bindingCount; i++)
+		{
+			auto binding = std::make_pair(buffers[i], offsets[i]);
+			auto found = state.vertexBuffers.find(firstBinding + i);
+			redundant = redundant && found != state.vertexBuffers.end() && found->second == binding;
+			state.vertexBuffers[firstBinding + i] = binding;
+		}
+		ApiTrace::active->call("vkCmdBindVertexBuffers", API_CALL_SITE(), redundant,
+			{ arg(cmd), firstBinding, bindingCount, bindingCount ? arg(buffers[0]) : 0, bindingCount ? offsets[0] : 0 });
+		real.CmdBindVertexBuffers(cmd, firstBinding, bindingCount, buffers, offsets);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdBindIndexBuffer(VkCommandBuffer cmd, VkBuffer buffer, VkDeviceSize offset, VkIndexType type)
+	{
+		CommandState& state = commands[cmd];
+		auto binding = std::make_tuple(buffer, offset, type);
+		bool redundant = state.indexBuffer == binding;
+		state.indexBuffer = binding;
+		ApiTrace::active->call("vkCmdBindIndexBuffer", API_CALL_SITE(), redundant, { arg(cmd), arg(buffer), offset, (uint64_t)type });
+		real.CmdBindIndexBuffer(cmd, buffer, offset, type);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdPushConstants(VkCommandBuffer cmd, VkPipelineLayout layout, VkShaderStageFlags stages,
+		uint32_t offset, uint32_t size, const void* values)
+	{
+		CommandState& state = commands[cmd];
+		bool redundant = false;
+		PushRange* range = nullptr;
+		for (auto& r : state.pushConstants)
+		{
+			if (r.layout == layout && r.stages == stages && r.offset == offset && r.bytes.size() == size)
+			{
+				range = &r;
+				break;
+			}
+		}
+		if (range)
+			redundant = memcmp(range->bytes.data(), values, size) == 0;
+		else
+		{
+			state.pushConstants.push_back(PushRange());
+			range = &state.pushConstants.back();
+			range->layout = layout;
+			range->stages = stages;
+			range->offset = offset;
+			range->bytes.resize(size);
+		}
+		memcpy(range->bytes.data(), values, size);
+		ApiTrace::active->call("vkCmdPushConstants", API_CALL_SITE(), redundant, { arg(cmd), arg(layout), stages, offset, size });
+		real.CmdPushConstants(cmd, layout, stages, offset, size, values);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdDraw(VkCommandBuffer cmd, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+	{
+		ApiTrace::active->call("vkCmdDraw", API_CALL_SITE(), false, { arg(cmd), vertexCount, instanceCount, firstVertex, firstInstance });
+		real.CmdDraw(cmd, vertexCount, instanceCount, firstVertex, firstInstance);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdDrawIndexed(VkCommandBuffer cmd, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex,
+		int32_t vertexOffset, uint32_t firstInstance)
+	{
+		ApiTrace::active->call("vkCmdDrawIndexed", API_CALL_SITE(), false,
+			{ arg(cmd), indexCount, instanceCount, firstIndex, (uint64_t)vertexOffset, firstInstance });
+		real.CmdDrawIndexed(cmd, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdDispatch(VkCommandBuffer cmd, uint32_t x, uint32_t y, uint32_t z)
+	{
+		ApiTrace::active->call("vkCmdDispatch", API_CALL_SITE(), false, { arg(cmd), x, y, z });
+		real.CmdDispatch(cmd, x, y, z);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceCmdPipelineBarrier(VkCommandBuffer cmd, VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages,
+		VkDependencyFlags flags, uint32_t memoryBarrierCount, const VkMemoryBarrier* memoryBarriers,
+		uint32_t bufferBarrierCount, const VkBufferMemoryBarrier* bufferBarriers,
+		uint32_t imageBarrierCount, const VkImageMemoryBarrier* imageBarriers)
+	{
+		ApiTrace::active->call("vkCmdPipelineBarrier", API_CALL_SITE(), false,
+			{ arg(cmd), srcStages, dstStages, memoryBarrierCount, bufferBarrierCount, imageBarrierCount });
+		real.CmdPipelineBarrier(cmd, srcStages, dstStages, flags, memoryBarrierCount, memoryBarriers,
+			bufferBarrierCount, bufferBarriers, imageBarrierCount, imageBarriers);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceUpdateDescriptorSets(VkDevice device, uint32_t writeCount, const VkWriteDescriptorSet* writes,
+		uint32_t copyCount, const VkCopyDescriptorSet* copies)
+	{
+		// buffer and texel buffer writes, and copies, are not tracked: never redundant.
+		bool redundant = writeCount > 0 && copyCount == 0;
+		for (uint32_t w = 0; w < writeCount; w++)
+		{
+			const VkWriteDescriptorSet& write = writes[w];
+			if (write.pImageInfo == nullptr)
+			{
+				redundant = false;
+				continue;
+			}
+			for (uint32_t i = 0; i < write.descriptorCount; i++)
+			{
+				auto key = std::make_tuple(write.dstSet, write.dstBinding, write.dstArrayElement + i);
+				auto value = std::make_tuple(write.pImageInfo[i].imageView, write.pImageInfo[i].sampler, write.pImageInfo[i].imageLayout);
+				auto found = imageDescriptors.find(key);
+				redundant = redundant && found != imageDescriptors.end() && found->second == value;
+				imageDescriptors[key] = value;
+			}
+		}
+		ApiTrace::active->call("vkUpdateDescriptorSets", API_CALL_SITE(), redundant,
+			{ writeCount, copyCount, writeCount ? arg(writes[0].dstSet) : 0, writeCount ? writes[0].dstBinding : 0 });
+		real.UpdateDescriptorSets(device, writeCount, writes, copyCount, copies);
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL traceMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size,
+		VkMemoryMapFlags flags, void** data)
+	{
+		const uint64_t frame = ApiTrace::active->frame();
+		auto found = mappings.find(memory);
+		bool redundant = found != mappings.end() && found->second.frame == frame &&
+			found->second.offset == offset && found->second.size == size;
+		ApiTrace::active->call("vkMapMemory", API_CALL_SITE(), redundant, { arg(memory), offset, size });
+		Mapping& m = mappings[memory];
+		m.offset = offset;
+		m.size = size;
+		m.frame = frame;
+		m.redundant = redundant;
+		return real.MapMemory(device, memory, offset, size, flags, data);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL traceUnmapMemory(VkDevice device, VkDeviceMemory memory)
+	{
+		// an unmap is redundant exactly when its map was.
+		auto found = mappings.find(memory);
+		bool redundant = found != mappings.end() && found->second.redundant;
+		ApiTrace::active->call("vkUnmapMemory", API_CALL_SITE(), redundant, { arg(memory) });
+		real.UnmapMemory(device, memory);
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL traceQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence)
+	{
+		ApiTrace::active->call("vkQueueSubmit", API_CALL_SITE(), false, { arg(queue), submitCount });
+		return real.QueueSubmit(queue, submitCount, submits, fence);
+	}
+}
+
+void installVulkanInterposer(VulkanDispatch& vk)
+{
+	if (ApiTrace::active == nullptr || vk.CmdBindPipeline == traceCmdBindPipeline)
+		return;
+	real = vk;
+	commands.clear();
+	imageDescriptors.clear();
+	mappings.clear();
+
+	vk.BeginCommandBuffer = traceBeginCommandBuffer;
+	vk.CmdBindPipeline = traceCmdBindPipeline;
+	vk.CmdBindDescriptorSets = traceCmdBindDescriptorSets;
+	vk.CmdBindVertexBuffers = traceCmdBindVertexBuffers;
+	vk.CmdBindIndexBuffer = traceCmdBindIndexBuffer;
+	vk.CmdPushConstants = traceCmdPushConstants;
+	vk.CmdDraw = traceCmdDraw;
+	vk.CmdDrawIndexed = traceCmdDrawIndexed;
+	vk.CmdDispatch = traceCmdDispatch;
+	vk.CmdPipelineBarrier = traceCmdPipelineBarrier;
+	vk.UpdateDescriptorSets = traceUpdateDescriptorSets;
+	vk.MapMemory = traceMapMemory;
+	vk.UnmapMemory = traceUnmapMemory;
+	vk.QueueSubmit = traceQueueSubmit;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "VulkanDispatch.h"
+
+/*
+ Wraps the commands of a VulkanDispatch with versions that report to
+ ApiTrace::active. Recorded state is tracked per command buffer and
+ forgotten at vkBeginCommandBuffer. A call counts as redundant when:
+
+	vkCmdBindPipeline			same pipeline at the bind point
+	vkCmdBindDescriptorSets		same sets at the same indices, no dynamic offsets
+	vkCmdBindVertexBuffers		same buffers and offsets at the bindings
+	vkCmdPushConstants			same bytes at the same range
+	vkUpdateDescriptorSets		every write stores what the descriptor holds
+	vkMapMemory/vkUnmapMemory	same range already mapped this frame
+
+ vkCmdDraw, vkQueueSubmit and vkBeginCommandBuffer are only counted.
+ Call before recording, with ApiTrace::active set.
+*/
+void installVulkanInterposer(VulkanDispatch& vk);
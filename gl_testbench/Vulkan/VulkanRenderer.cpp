@@ -2,15 +2,23 @@
 #include <SDL_vulkan.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "MaterialVulkan.h"
 #include "TechniqueVulkan.h"
 #include "RenderStateVulkan.h"
 #include "VertexBufferVulkan.h"
+#include "IndexBufferVulkan.h"
 #include "ConstantBufferVulkan.h"
 #include "Texture2DVulkan.h"
+#include "../Profiler.h"
+#include "../ApiTrace.h"
+#include "../MemoryTracker.h"
+#include "VulkanInterposer.h"
 #include "Sampler2DVulkan.h"
 #include "MeshVulkan.h"
+#include "ComputeTechniqueVulkan.h"
 #include "../Mesh.h"
+#include "../TransformBatch.h"
 
 VkDevice VulkanRenderer::device;
 VkExtent2D VulkanRenderer::swapChainExtent;
@@ -22,6 +30,7 @@ VkDescriptorSet VulkanRenderer::descriptorSet;
 VkCommandBuffer* VulkanRenderer::currentBuffer;
 VkCommandPool VulkanRenderer::commandPool;
 VkQueue VulkanRenderer::graphicsQueue;
+VulkanDispatch VulkanRenderer::vk;
 
 VKAPI_ATTR VkBool32 VKAPI_CALL VulkanRenderer::debugCallback(
 	VkDebugReportFlagsEXT flags,
@@ -99,7 +108,7 @@ RenderState * VulkanRenderer::makeRenderState()
 
 std::string VulkanRenderer::getShaderPath()
 {
-	return std::string("..\\assets\\VK\\");
+	return std::string("../assets/VK/");
 }
 
 std::string VulkanRenderer::getShaderExtension()
@@ -117,20 +126,100 @@ Technique * VulkanRenderer::makeTechnique(Material* m, RenderState* r)
 	return new TechniqueVulkan(m, r);
 }
 
-int VulkanRenderer::initialize(unsigned int width, unsigned int height)
+MeshHandle VulkanRenderer::createMesh()
 {
+	return meshPool.create<MeshVulkan>();
+}
+
+VertexBufferHandle VulkanRenderer::createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage)
+{
+	return vertexBufferPool.create<VertexBufferVulkan>(size, usage);
+}
+
+IndexBufferHandle VulkanRenderer::createIndexBuffer(size_t size, IndexBuffer::FORMAT format)
+{
+	return indexBufferPool.create<IndexBufferVulkan>(size, format);
+}
+
+Texture2DHandle VulkanRenderer::createTexture2D()
+{
+	return texturePool.create<Texture2DVulkan>();
+}
+
+Sampler2DHandle VulkanRenderer::createSampler2D()
+{
+	return samplerPool.create<Sampler2DVulkan>();
+}
+
+MaterialHandle VulkanRenderer::createMaterial(const std::string& name)
+{
+	return materialPool.create<MaterialVulkan>(name);
+}
+
+TechniqueHandle VulkanRenderer::createTechnique(MaterialHandle m, RenderState* r)
+{
+	return techniquePool.create<TechniqueVulkan>(get(m), r);
+}
+
+ComputeTechniqueHandle VulkanRenderer::createComputeTechnique(MaterialHandle m)
+{
+	return computePool.create<ComputeTechniqueVulkan>(get(m));
+}
+
+void VulkanRenderer::dispatch(ComputeTechnique* technique, uint32_t x, uint32_t y, uint32_t z)
+{
+	dispatches.push_back({ technique, x, y, z });
+}
+
+int VulkanRenderer::initialize(unsigned int width, unsigned int height, bool headless)
+{
+	this->headless = headless;
+	if (headless)
+		deviceExtensions.clear();
 	initWindow(width, height);
+	// installed before anything is recorded, so the tracked state is complete.
+	vk = VulkanDispatch();
+	installVulkanInterposer(vk);
 	initVulkan();
 	return 0;
 }
 
 void VulkanRenderer::setWinTitle(const char * title)
 {
-	SDL_SetWindowTitle(this->window, title);
+	if (this->window)
+		SDL_SetWindowTitle(this->window, title);
 }
 
 void VulkanRenderer::present()
 {
+	PROFILE_ZONE("present");
+	if (headless)
+	{
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffers[offscreenIndex];
+		if (FAILED(vk.QueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE)))
+		{
+			fprintf(stderr, "failed to submit draw command buffer!\n");
+			exit(-1);
+		}
+		{
+			PROFILE_ZONE("vkQueueWaitIdle");
+			vkQueueWaitIdle(graphicsQueue);
+		}
+		FrameStats::current.queueSubmits++;
+		FrameStats::current.queueWaits++;
+		FrameStats::endFrame();
+		if (ApiTrace::active)
+			ApiTrace::active->endFrame();
+		if (hasMemoryBudget)
+			updateMemoryHeaps();
+		offscreenIndex = (offscreenIndex + 1) % OFFSCREEN_IMAGES;
+		drawList.clear();
+		return;
+	}
+
 	uint32_t imageIndex;
 	vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
 
@@ -150,7 +239,7 @@ void VulkanRenderer::present()
 	submitInfo.signalSemaphoreCount = 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
-	if (FAILED(vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE)))
+	if (FAILED(vk.QueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE)))
 	{
 		fprintf(stderr, "failed to submit draw command buffer!\n");
 		exit(-1);
@@ -168,13 +257,30 @@ void VulkanRenderer::present()
 	presentInfo.pImageIndices = &imageIndex;
 
 	vkQueuePresentKHR(presentQueue, &presentInfo);
-	vkQueueWaitIdle(presentQueue);
+	{
+		PROFILE_ZONE("vkQueueWaitIdle");
+		vkQueueWaitIdle(presentQueue);
+	}
+	FrameStats::current.queueSubmits++;
+	FrameStats::current.queueWaits++;
+	FrameStats::endFrame();
+	if (ApiTrace::active)
+		ApiTrace::active->endFrame();
+	if (hasMemoryBudget)
+		updateMemoryHeaps();
 	drawList.clear();
 }
 
 int VulkanRenderer::shutdown()
 {
 	vkDeviceWaitIdle(device);
+	delete gpuProfiler;
+	gpuProfiler = nullptr;
+	// its material, technique and buffers are in the pools.
+	delete gpuCuller;
+	gpuCuller = nullptr;
+	gpuCulling = false;
+	releaseTransformBuffer();
 	vkDestroyDescriptorPool(device, descriptorPool, nullptr);
 	vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 	vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
@@ -192,11 +298,25 @@ int VulkanRenderer::shutdown()
 		vkDestroyImageView(device, imageView, nullptr);
 
 	DestroyDebugReportCallbackEXT(instance, callback, nullptr);
-	vkDestroySwapchainKHR(device, swapChain, nullptr);
-	vkDestroySurfaceKHR(instance, surface, nullptr);
+	if (headless)
+	{
+		for (size_t i = 0; i < swapChainImages.size(); i++)
+		{
+			vkDestroyImage(device, swapChainImages[i], nullptr);
+			vkFreeMemory(device, offscreenMemory[i], nullptr);
+			MemoryTracker::release(MemoryTracker::CATEGORY::RENDER_TARGET, (uint64_t)offscreenMemory[i]);
+		}
+	}
+	else
+	{
+		vkDestroySwapchainKHR(device, swapChain, nullptr);
+		vkDestroySurfaceKHR(instance, surface, nullptr);
+	}
 	vkDestroyDevice(device, nullptr);
 
 	vkDestroyInstance(instance, nullptr);
+	// allows initializing a new renderer afterwards (benchmark scenarios).
+	physicalDevice = VK_NULL_HANDLE;
 	SDL_Quit();
 	return 0;
 }
@@ -208,85 +328,352 @@ void VulkanRenderer::setClearColor(float r, float g, float b, float a)
 
 void VulkanRenderer::clearBuffer(unsigned int)
 {
+	PROFILE_ZONE("clearBuffer");
 	vkResetCommandPool(device, commandPool, VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT);
+	if (gpuProfiler)
+		gpuProfiler->beginFrame();
 	for (size_t i = 0; i < commandBuffers.size(); i++)
 	{
 		VkCommandBufferBeginInfo beginInfo = {};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
 
-		vkBeginCommandBuffer(commandBuffers[i], &beginInfo);
+		vk.BeginCommandBuffer(commandBuffers[i], &beginInfo);
+		if (gpuProfiler)
+			gpuProfiler->begin(commandBuffers[i], clearScope);
+		// the render pass begins in frame(), after the dispatches.
+	}
+}
 
-		VkRenderPassBeginInfo renderPassInfo = {};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = renderPass;
-		renderPassInfo.framebuffer = swapChainFramebuffers[i];
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = swapChainExtent;
+void VulkanRenderer::setRenderState(RenderState * ps)
+{
+}
 
-		renderPassInfo.clearValueCount = 1;
-		renderPassInfo.pClearValues = &clearColor;
+void VulkanRenderer::submit(Mesh * mesh)
+{
+	FrameStats::current.drawsSubmitted++;
+	drawList.push_back(((MeshVulkan*)mesh)->getPacket());
+}
 
-		vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+void VulkanRenderer::submit(Mesh* const* meshes, size_t count)
+{
+	PROFILE_ZONE("submit");
+	FrameStats::current.drawsSubmitted += count;
+	drawList.reserve(drawList.size() + count);
+	for (size_t i = 0; i < count; i++)
+		drawList.push_back(((MeshVulkan*)meshes[i])->getPacket());
+}
 
+void VulkanRenderer::attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source)
+{
+	releaseTransformBuffer();
+	if (source == TRANSFORMS::GPU)
+	{
+		translations.clear();
+		VkBufferCreateInfo bufferInfo = {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = std::max<size_t>(meshes.size(), 1) * 4 * sizeof(float);
+		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (FAILED(vkCreateBuffer(device, &bufferInfo, nullptr, &transformBuffer)))
+		{
+			fprintf(stderr, "failed to create translation buffer!\n");
+			exit(-1);
+		}
+		VkMemoryRequirements memRequirements;
+		vkGetBufferMemoryRequirements(device, transformBuffer, &memRequirements);
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = memRequirements.size;
+		// only the GPU reads and writes it.
+		allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (FAILED(vkAllocateMemory(device, &allocInfo, nullptr, &transformMemory)))
+		{
+			fprintf(stderr, "failed to allocate translation buffer memory!\n");
+			exit(-1);
+		}
+		MemoryTracker::allocate(MemoryTracker::CATEGORY::CONSTANT, (uint64_t)transformMemory, allocInfo.memoryTypeIndex,
+			memRequirements.size, bufferInfo.size);
+		vkBindBufferMemory(device, transformBuffer, transformMemory, 0);
+
+		VkDescriptorBufferInfo info = { transformBuffer, 0, VK_WHOLE_SIZE };
+		VkWriteDescriptorSet write = {};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = descriptorSet;
+		write.dstBinding = TRANSLATION;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write.pBufferInfo = &info;
+		vk.UpdateDescriptorSets(device, 1, &write, 0, nullptr);
+		FrameStats::current.descriptorWrites++;
+		for (size_t i = 0; i < meshes.size(); i++)
+			((ConstantBufferVulkan*)meshes[i]->txBuffer)->attachInstance((uint32_t)i);
+	}
+	else
+	{
+		translations.assign(meshes.size() * 4, 0.0f);
+		for (size_t i = 0; i < meshes.size(); i++)
+			((ConstantBufferVulkan*)meshes[i]->txBuffer)->attach(&translations[i * 4]);
 	}
+	cullRecordsDirty = true;
+	// the push constant data of the retained packets moved.
+	renderables.recompile([](Mesh* mesh, uint64_t& key, DrawPacketVulkan& packet) {
+		packet = ((MeshVulkan*)mesh)->getPacket();
+		key = (uint64_t)packet.techniqueId;
+	});
 }
 
-void VulkanRenderer::setRenderState(RenderState * ps)
+uint32_t VulkanRenderer::addRenderable(Mesh* mesh)
 {
+	const DrawPacketVulkan& packet = ((MeshVulkan*)mesh)->getPacket();
+	renderableTexturesDirty = true;
+	cullRecordsDirty = true;
+	return renderables.add((uint64_t)packet.techniqueId, mesh, packet);
 }
 
-void VulkanRenderer::submit(Mesh * mesh)
+void VulkanRenderer::updateRenderable(uint32_t id)
+{
+	if (!renderables.valid(id))
+		return;
+	const DrawPacketVulkan& packet = ((MeshVulkan*)renderables.mesh(id))->getPacket();
+	renderables.update(id, (uint64_t)packet.techniqueId, packet);
+	renderableTexturesDirty = true;
+	cullRecordsDirty = true;
+}
+
+void VulkanRenderer::removeRenderable(uint32_t id)
+{
+	renderables.remove(id);
+	renderableTexturesDirty = true;
+	cullRecordsDirty = true;
+}
+
+bool VulkanRenderer::setGpuCulling(const Frustum* frustum)
+{
+	if (frustum == nullptr)
+	{
+		gpuCulling = false;
+		return true;
+	}
+	if (!hasIndirectCount || transformBuffer == VK_NULL_HANDLE)
+		return false;
+	if (gpuCuller == nullptr)
+	{
+		gpuCuller = new GpuCuller();
+		if (!gpuCuller->initialize(this))
+		{
+			delete gpuCuller;
+			gpuCuller = nullptr;
+			return false;
+		}
+	}
+	cullFrustum = *frustum;
+	gpuCulling = true;
+	return true;
+}
+
+// the packets record the same streams (bound from 0) and textures, and read their translation by instance.
+static bool recordsIndirect(const DrawPacketVulkan& packet, const DrawPacketVulkan& first)
+{
+	// the commands are vkCmdDrawIndirect ones.
+	if (packet.indexBuffer != VK_NULL_HANDLE || packet.firstVertex == DrawPacketVulkan::NO_FIRST_VERTEX || packet.pushSize != 0)
+		return false;
+	if (packet.streamCount != first.streamCount || packet.textureCount != first.textureCount)
+		return false;
+	for (uint32_t s = 0; s < packet.streamCount; s++)
+		if (packet.streamLocations[s] != first.streamLocations[s] || packet.streamBuffers[s] != first.streamBuffers[s])
+			return false;
+	for (uint32_t t = 0; t < packet.textureCount; t++)
+		if (packet.textureSlots[t] != first.textureSlots[t] || packet.textures[t] != first.textures[t])
+			return false;
+	return true;
+}
+
+void VulkanRenderer::buildCullRecords()
+{
+	PROFILE_ZONE("buildCullRecords");
+	std::vector<GpuCuller::Record> records;
+	const auto& buckets = renderables.getBuckets();
+	indirectBuckets.assign(buckets.size(), { 0, 0 });
+	for (uint32_t b = 0; b < buckets.size(); b++)
+	{
+		const auto& bucket = buckets[b];
+		bool indirect = !bucket.packets.empty();
+		for (uint32_t i = 0; indirect && i < bucket.packets.size(); i++)
+			indirect = recordsIndirect(bucket.packets[i], bucket.packets[0]) && !renderables.mesh(bucket.ids[i])->bounds.empty();
+		if (!indirect)
+			continue;
+		const uint32_t first = (uint32_t)records.size();
+		indirectBuckets[b] = { first, (uint32_t)bucket.packets.size() };
+		for (uint32_t i = 0; i < bucket.packets.size(); i++)
+		{
+			const DrawPacketVulkan& packet = bucket.packets[i];
+			const Aabb& bounds = renderables.mesh(bucket.ids[i])->bounds;
+			records.push_back({ { bounds.min.x, bounds.min.y, bounds.min.z }, packet.vertexCount,
+				{ bounds.max.x, bounds.max.y, bounds.max.z }, packet.firstVertex,
+				packet.firstInstance, b, first, 0 });
+		}
+	}
+	gpuCuller->setRecords(records, (uint32_t)buckets.size());
+	cullRecordsDirty = false;
+}
+
+void VulkanRenderer::recordIndirect(VkCommandBuffer commandBuffer, const DrawPacketVulkan& packet, uint32_t bucket, const IndirectBucket& records)
 {
-	drawList.push_back(mesh);
+	const VkDeviceSize zero = 0;
+	for (uint32_t s = 0; s < packet.streamCount; s++)
+		vk.CmdBindVertexBuffers(commandBuffer, packet.streamLocations[s], 1, &packet.streamBuffers[s], &zero);
+	FrameStats::current.vertexBufferBinds += packet.streamCount;
+	drawIndirectCount(commandBuffer, ((VertexBufferVulkan*)gpuCuller->getCommands())->getHandle(), records.first * GpuCuller::COMMAND_SIZE,
+		((VertexBufferVulkan*)gpuCuller->getCounts())->getHandle(), bucket * sizeof(uint32_t), records.count, GpuCuller::COMMAND_SIZE);
+	FrameStats::current.indirectDraws++;
+}
+
+void VulkanRenderer::recordRenderables(VkCommandBuffer commandBuffer)
+{
+	const bool culling = gpuCulling && transformBuffer != VK_NULL_HANDLE;
+	const auto& buckets = renderables.getBuckets();
+	for (uint32_t b = 0; b < buckets.size(); b++)
+	{
+		const auto& bucket = buckets[b];
+		if (bucket.packets.empty())
+			continue;
+		Technique* technique = bucket.packets[0].technique;
+		if (gpuProfiler)
+			gpuProfiler->mark(commandBuffer, gpuProfiler->techniqueScope(technique));
+		technique->enable(this);
+		if (culling && indirectBuckets[b].count)
+		{
+			recordIndirect(commandBuffer, bucket.packets[0], b, indirectBuckets[b]);
+			continue;
+		}
+		for (const DrawPacketVulkan& packet : bucket.packets)
+			packet.record(commandBuffer);
+	}
+}
+
+void VulkanRenderer::releaseTransformBuffer()
+{
+	if (transformBuffer == VK_NULL_HANDLE)
+		return;
+	vkDestroyBuffer(device, transformBuffer, nullptr);
+	vkFreeMemory(device, transformMemory, nullptr);
+	MemoryTracker::release(MemoryTracker::CATEGORY::CONSTANT, (uint64_t)transformMemory);
+	transformBuffer = VK_NULL_HANDLE;
+	transformMemory = VK_NULL_HANDLE;
+}
+
+void VulkanRenderer::updateTransforms(const TransformBatch& batch)
+{
+	const size_t count = std::min(batch.size(), translations.size() / 4);
+	batch.write(translations.data(), 4 * sizeof(float), count);
 }
 
 void VulkanRenderer::frame()
 {
-	for (int j = 0; j < 4; j++)
+	PROFILE_ZONE("frame");
+	// there is a single descriptor set, so the texture can only be bound
+	// once per frame, before recording.
+	if (renderableTexturesDirty)
 	{
-		auto mesh = drawList[j];
-		for (auto t : mesh->textures)
+		renderableTextures.clear();
+		for (auto& bucket : renderables.getBuckets())
+			for (const DrawPacketVulkan& packet : bucket.packets)
+				for (uint32_t t = 0; t < packet.textureCount; t++)
+					if (renderableTextures.empty() || renderableTextures.back().first != packet.textures[t])
+						renderableTextures.push_back({ packet.textures[t], packet.textureSlots[t] });
+		renderableTexturesDirty = false;
+	}
+	Texture2D* boundTexture = nullptr;
+	for (auto& t : renderableTextures)
+	{
+		t.first->bind(t.second);
+		boundTexture = t.first;
+	}
+	for (const DrawPacketVulkan& packet : drawList)
+	{
+		for (uint32_t t = 0; t < packet.textureCount; t++)
 		{
 			// we do not really know here if the sampler has been
 			// defined in the shader.
-			t.second->bind(t.first);
+			if (packet.textures[t] != boundTexture)
+			{
+				packet.textures[t]->bind(packet.textureSlots[t]);
+				boundTexture = packet.textures[t];
+			}
 		}
 	}
 
-	std::sort(drawList.begin(), drawList.end(), MeshVulkan::sortMesh);
+	if (submission == SUBMISSION::PER_TECHNIQUE)
+		std::sort(drawList.begin(), drawList.end(), DrawPacketVulkan::byTechnique);
+
+	// after the dispatches of the frame so far, it reads the translations they wrote.
+	if (gpuCulling && transformBuffer != VK_NULL_HANDLE)
+	{
+		if (cullRecordsDirty)
+			buildCullRecords();
+		gpuCuller->cull(cullFrustum);
+	}
 
 	
 	for (size_t i = 0; i < commandBuffers.size(); i++)
 	{
+		PROFILE_ZONE("record command buffer");
 		currentBuffer = &commandBuffers[i];
-		vkCmdBindDescriptorSets(*currentBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-		
-		for (int j = 0; j < drawList.size(); j++)
+		if (!dispatches.empty())
 		{
-						
-			auto mesh = drawList[j];
-			mesh->technique->enable(this);
-			size_t numberElements = mesh->geometryBuffers[0].numElements;
-			//for (auto t : mesh->textures)
-			//{
-			//	// we do not really know here if the sampler has been
-			//	// defined in the shader.
-			//	t.second->bind(t.first);
-			//}
-
-			mesh->txBuffer->bind(mesh->technique->getMaterial());
-
-			for (auto element : mesh->geometryBuffers)
+			VkMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			for (size_t d = 0; d < dispatches.size(); d++)
 			{
-				mesh->bindIAVertexBuffer(element.first);
+				// each dispatch sees the writes of the ones before (the culling reads the animated translations).
+				if (d > 0)
+				{
+					barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+					vk.CmdPipelineBarrier(*currentBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						0, 1, &barrier, 0, nullptr, 0, nullptr);
+				}
+				((ComputeTechniqueVulkan*)dispatches[d].technique)->record(*currentBuffer, transformBuffer, dispatches[d].x, dispatches[d].y, dispatches[d].z);
 			}
-			
-			vkCmdDraw(*currentBuffer, numberElements, 1, 0, 0);
+			// storage writes before the indirect commands, vertex fetches and shader reads of the draws.
+			barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+			vk.CmdPipelineBarrier(*currentBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
+		VkRenderPassBeginInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = renderPass;
+		renderPassInfo.framebuffer = swapChainFramebuffers[i];
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = swapChainExtent;
+		renderPassInfo.clearValueCount = 1;
+		renderPassInfo.pClearValues = &clearColor;
+		vkCmdBeginRenderPass(*currentBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		vk.CmdBindDescriptorSets(*currentBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+		recordRenderables(*currentBuffer);
+
+		Technique* lastTechnique = nullptr;
+		for (const DrawPacketVulkan& packet : drawList)
+		{
+			// one GPU interval and one pipeline bind per run of meshes with the same technique.
+			if (packet.technique != lastTechnique)
+			{
+				if (gpuProfiler)
+					gpuProfiler->mark(*currentBuffer, gpuProfiler->techniqueScope(packet.technique));
+				lastTechnique = packet.technique;
+				lastTechnique->enable(this);
+			}
+			packet.record(*currentBuffer);
 		}
 
 
 		vkCmdEndRenderPass(commandBuffers[i]);
+		if (gpuProfiler)
+			gpuProfiler->end(commandBuffers[i]);
 		if (FAILED(vkEndCommandBuffer(commandBuffers[i])))
 		{
 			fprintf(stderr, "failed to record command buffer!\n");
@@ -294,7 +681,7 @@ void VulkanRenderer::frame()
 		}
 	}
 	drawList.clear();
-		
+	dispatches.clear();
 }
 
 
@@ -302,22 +689,29 @@ void VulkanRenderer::initWindow(unsigned int width, unsigned int height)
 {
 	this->height = height;
 	this->width = width;
-	if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+	// headless does not open a window, so no video subsystem either.
+	if (SDL_Init(headless ? SDL_INIT_TIMER | SDL_INIT_EVENTS : SDL_INIT_EVERYTHING) != 0)
 	{
 		fprintf(stderr, "%s", SDL_GetError());
 		exit(-1);
 	}
 
-	window = SDL_CreateWindow("Vulkan", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_VULKAN);
+	if (!headless)
+		window = SDL_CreateWindow("Vulkan", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_VULKAN);
 }
 void VulkanRenderer::initVulkan()
 {
 	createInstance();
 	setupDebugCallback();
-	createSurface();
+	if (!headless)
+		createSurface();
 	pickPhysicalDevice();
 	createLogicalDevice();
-	createSwapChain();
+	initMemoryTracking();
+	if (headless)
+		createOffscreenImages();
+	else
+		createSwapChain();
 	createImageViews();
 	
 	createRenderPass();
@@ -330,6 +724,12 @@ void VulkanRenderer::initVulkan()
 	createPipelineLayout();
 	createDescriptorPool();
 	createDescriptorSet();
+
+	if (GpuProfilerVulkan::isSupported())
+	{
+		gpuProfiler = new GpuProfilerVulkan();
+		clearScope = gpuProfiler->scope("clear");
+	}
 }
 
 void VulkanRenderer::createInstance()
@@ -396,6 +796,27 @@ void VulkanRenderer::createLogicalDevice()
 	VkPhysicalDeviceFeatures deviceFeatures = {};
 	deviceFeatures.fillModeNonSolid = VK_TRUE;
 
+	// optional, only reported to MemoryTracker.
+	if (hasProperties2)
+	{
+		deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		hasMemoryBudget = checkDeviceExtensionSupport(physicalDevice);
+		if (!hasMemoryBudget)
+			deviceExtensions.pop_back();
+	}
+	// optional, for setGpuCulling.
+	VkPhysicalDeviceFeatures supported;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &supported);
+	deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	hasIndirectCount = supported.multiDrawIndirect && supported.drawIndirectFirstInstance && checkDeviceExtensionSupport(physicalDevice);
+	if (hasIndirectCount)
+	{
+		deviceFeatures.multiDrawIndirect = VK_TRUE;
+		deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+	}
+	else
+		deviceExtensions.pop_back();
+
 	VkDeviceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
@@ -420,6 +841,8 @@ void VulkanRenderer::createLogicalDevice()
 	}
 	vkGetDeviceQueue(device, indices.graphicsFamily, 0, &graphicsQueue);
 	vkGetDeviceQueue(device, indices.presentFamily, 0, &presentQueue);
+	drawIndirectCount = hasIndirectCount ? (PFN_vkCmdDrawIndirectCountKHR)vkGetDeviceProcAddr(device, "vkCmdDrawIndirectCountKHR") : nullptr;
+	hasIndirectCount = drawIndirectCount != nullptr;
 }
 
 void VulkanRenderer::createSwapChain()
@@ -570,19 +993,35 @@ bool VulkanRenderer::checkDeviceExtensionSupport(VkPhysicalDevice device)
 std::vector<const char*> VulkanRenderer::getRequiredExtensions()
 {
 	uint32_t glfwExtensionCount = 0;
-	unsigned int extensionCount;
+	unsigned int extensionCount = 0;
 
-	SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, nullptr);
+	// without a window there is no surface, so no WSI extensions are needed.
+	if (window)
+		SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, nullptr);
 
 	std::vector<const char*> extensions(extensionCount);
 
-	SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, extensions.data());
+	if (window)
+		SDL_Vulkan_GetInstanceExtensions(window, &extensionCount, extensions.data());
 
 	if (enableValidationLayers)
 	{
 		extensions.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 	}
 
+	uint32_t availableCount = 0;
+	vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, nullptr);
+	std::vector<VkExtensionProperties> available(availableCount);
+	vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, available.data());
+	for (const auto& extension : available)
+	{
+		if (strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0)
+		{
+			extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+			hasProperties2 = true;
+		}
+	}
+
 	return extensions;
 }
 
@@ -623,8 +1062,8 @@ bool VulkanRenderer::isDeviceSuitable(VkPhysicalDevice device)
 
 	QueueFamilyIndices indices = findQueueFamilies(device);
 	bool extensionsSupported = checkDeviceExtensionSupport(device);
-	bool swapChainAdequate = false;
-	if (extensionsSupported)
+	bool swapChainAdequate = headless;
+	if (extensionsSupported && !headless)
 	{
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
 		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -651,9 +1090,14 @@ VulkanRenderer::QueueFamilyIndices VulkanRenderer::findQueueFamilies(VkPhysicalD
 		if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
 			indices.graphicsFamily = i;
 
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
-		if (queueFamily.queueCount > 0 && presentSupport)
-			indices.presentFamily = i;
+		if (headless)
+			indices.presentFamily = indices.graphicsFamily;
+		else
+		{
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+			if (queueFamily.queueCount > 0 && presentSupport)
+				indices.presentFamily = i;
+		}
 
 		if (indices.isComplete())
 			break;
@@ -702,7 +1146,8 @@ void VulkanRenderer::createRenderPass()
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// offscreen images are left ready to be copied out (readback/screenshots).
+	colorAttachment.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 	VkAttachmentReference colorAttachmentRef = {};
 	colorAttachmentRef.attachment = 0;
@@ -764,6 +1209,121 @@ void VulkanRenderer::createFrameBufffers()
 	}
 }
 
+void VulkanRenderer::createOffscreenImages()
+{
+	swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	swapChainExtent = { width, height };
+	swapChainImages.resize(OFFSCREEN_IMAGES);
+	offscreenMemory.resize(OFFSCREEN_IMAGES);
+
+	for (uint32_t i = 0; i < OFFSCREEN_IMAGES; i++)
+	{
+		VkImageCreateInfo imageInfo = {};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent.width = width;
+		imageInfo.extent.height = height;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = swapChainImageFormat;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (FAILED(vkCreateImage(device, &imageInfo, nullptr, &swapChainImages[i])))
+		{
+			fprintf(stderr, "Failed to create offscreen image!\n");
+			exit(-1);
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(device, swapChainImages[i], &memRequirements);
+
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = memRequirements.size;
+		allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if (FAILED(vkAllocateMemory(device, &allocInfo, nullptr, &offscreenMemory[i])))
+		{
+			fprintf(stderr, "Failed to allocate offscreen image memory!\n");
+			exit(-1);
+		}
+		MemoryTracker::allocate(MemoryTracker::CATEGORY::RENDER_TARGET, (uint64_t)offscreenMemory[i], allocInfo.memoryTypeIndex,
+			memRequirements.size, (uint64_t)swapChainExtent.width * swapChainExtent.height * 4);
+		vkBindImageMemory(device, swapChainImages[i], offscreenMemory[i], 0);
+	}
+}
+
+uint32_t VulkanRenderer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+{
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+	fprintf(stderr, "failed to find suitable memory type!\n");
+	exit(-1);
+}
+
+// names the memory types after their property flags and reports the heaps.
+void VulkanRenderer::initMemoryTracking()
+{
+	if (hasMemoryBudget)
+		getMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+	hasMemoryBudget = hasMemoryBudget && getMemoryProperties2 != nullptr;
+
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+	{
+		const VkMemoryPropertyFlags flags = memProperties.memoryTypes[i].propertyFlags;
+		std::string name = "type " + std::to_string(i);
+		if (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+			name += " device";
+		if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+			name += " host";
+		if (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+			name += " coherent";
+		if (flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT)
+			name += " cached";
+		MemoryTracker::setMemoryType(i, memProperties.memoryTypes[i].heapIndex, name);
+	}
+	updateMemoryHeaps();
+}
+
+// without VK_EXT_memory_budget only the heap sizes are known.
+void VulkanRenderer::updateMemoryHeaps()
+{
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {};
+	budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2KHR properties = {};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+	properties.pNext = &budget;
+	if (hasMemoryBudget)
+		getMemoryProperties2(physicalDevice, &properties);
+	else
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &properties.memoryProperties);
+
+	std::vector<MemoryTracker::Heap> heaps(properties.memoryProperties.memoryHeapCount);
+	for (uint32_t i = 0; i < heaps.size(); i++)
+	{
+		heaps[i].size = properties.memoryProperties.memoryHeaps[i].size;
+		heaps[i].deviceLocal = (properties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+		if (hasMemoryBudget)
+		{
+			heaps[i].usage = budget.heapUsage[i];
+			heaps[i].budget = budget.heapBudget[i];
+		}
+	}
+	MemoryTracker::setHeaps(heaps);
+}
+
 void VulkanRenderer::createSemaphores()
 {
 	VkSemaphoreCreateInfo semaphoreInfo = {};
@@ -787,7 +1347,10 @@ void VulkanRenderer::createDescriptorPool()
 	std::vector<VkDescriptorPoolSize> poolSizes;
 	VkDescriptorPoolSize poolSize = {};
 	poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	poolSize.descriptorCount = 2;
+	poolSize.descriptorCount = 1;
+	poolSizes.push_back(poolSize);
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 1;
 	poolSizes.push_back(poolSize);
 	poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	poolSize.descriptorCount = 1;
@@ -848,8 +1411,9 @@ void VulkanRenderer::createDescriptorSetLayout()
 	//uboLayoutBinding.stageFlags = VK_SHADER_STAGE_ALL;
 	//bindings.push_back(uboLayoutBinding);
 
+	// the translations of TRANSFORMS::GPU, see attachTransforms.
 	uboLayoutBinding.binding = TRANSLATION;
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 	bindings.push_back(uboLayoutBinding);
 
@@ -988,8 +1552,8 @@ VkExtent2D VulkanRenderer::chooseSwapExtent(const VkSurfaceCapabilitiesKHR & cap
 	{
 		VkExtent2D actualExtent = { width, height };
 
-		actualExtent.width = max(capabilities.minImageExtent.width, min(capabilities.maxImageExtent.width, actualExtent.width));
-		actualExtent.height = max(capabilities.minImageExtent.height, min(capabilities.maxImageExtent.height, actualExtent.height));
+		actualExtent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actualExtent.width));
+		actualExtent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actualExtent.height));
 
 		return actualExtent;
 	}
@@ -1,7 +1,12 @@
 #pragma once
 #include <SDL.h>
-#include <vulkan\vulkan.h>
+#include <vulkan/vulkan.h>
 #include "../Renderer.h"
+#include "GpuProfilerVulkan.h"
+#include "DrawPacketVulkan.h"
+#include "../RetainedList.h"
+#include "../GpuCuller.h"
+#include "VulkanDispatch.h"
 
 
 #pragma comment(lib, "vulkan-1.lib")
@@ -17,7 +22,7 @@
 #include <algorithm>
 
 
-class VulkanRenderer :
+class VulkanRenderer final :
 	public Renderer
 {
 public:
@@ -32,6 +37,8 @@ public:
 	static VkCommandBuffer* currentBuffer;
 	static VkCommandPool commandPool;
 	static VkQueue graphicsQueue;
+	// per-frame commands, wrapped when an ApiTrace is active.
+	static VulkanDispatch vk;
 	VulkanRenderer();
 	~VulkanRenderer();
 
@@ -45,8 +52,18 @@ public:
 	std::string getShaderExtension();
 	ConstantBuffer* makeConstantBuffer(std::string NAME, unsigned int location);
 	Technique* makeTechnique(Material*, RenderState*);
+	MeshHandle createMesh();
+	VertexBufferHandle createVertexBuffer(size_t size, VertexBuffer::DATA_USAGE usage);
+	IndexBufferHandle createIndexBuffer(size_t size, IndexBuffer::FORMAT format);
+	Texture2DHandle createTexture2D();
+	Sampler2DHandle createSampler2D();
+	MaterialHandle createMaterial(const std::string& name);
+	TechniqueHandle createTechnique(MaterialHandle m, RenderState* r);
+	// recorded by frame(), before the render pass and a barrier towards the draws.
+	ComputeTechniqueHandle createComputeTechnique(MaterialHandle m);
+	void dispatch(ComputeTechnique* technique, uint32_t x, uint32_t y = 1, uint32_t z = 1);
 
-	int initialize(unsigned int width = 800, unsigned int height = 600);
+	int initialize(unsigned int width = 800, unsigned int height = 600, bool headless = false);
 	void setWinTitle(const char* title);
 	void present();
 	int shutdown();
@@ -54,8 +71,30 @@ public:
 	void setClearColor(float, float, float, float);
 	void clearBuffer(unsigned int);
 	void setRenderState(RenderState* ps);
+	// submit(MeshHandle) of Renderer.
+	using Renderer::submit;
 	void submit(Mesh* mesh);
+	void submit(Mesh* const* meshes, size_t count);
+	// retained packets, bucketed by technique id and recorded before the submitted meshes.
+	uint32_t addRenderable(Mesh* mesh);
+	void updateRenderable(uint32_t id);
+	void removeRenderable(uint32_t id);
 	void frame();
+	/*
+	 translations live in one array and are pushed per draw, see
+	 Renderer::attachTransforms. With TRANSFORMS::GPU they live in a storage
+	 buffer at binding TRANSLATION instead, the draw of slot i has first
+	 instance i (the shaders define TRANSLATION_BUFFER).
+	*/
+	void attachTransforms(const std::vector<Mesh*>& meshes, TRANSFORMS source = TRANSFORMS::CPU);
+	void updateTransforms(const TransformBatch& batch);
+	/*
+	 VK_KHR_draw_indirect_count, see Renderer::setGpuCulling. Needs the
+	 translations attached with TRANSFORMS::GPU, the culling pass reads them.
+	*/
+	bool setGpuCulling(const Frustum* frustum);
+
+	GpuProfiler* getGpuProfiler() { return gpuProfiler; };
 
 private:
 	#ifdef _DEBUG
@@ -65,7 +104,8 @@ private:
 	#endif
 	#define FAILED(x) x != VK_SUCCESS
 
-	const std::vector<const char*> deviceExtensions = {
+	// emptied in headless mode, no swapchain is created.
+	std::vector<const char*> deviceExtensions = {
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME
 	};
 
@@ -107,7 +147,7 @@ private:
 		const VkAllocationCallbacks* pAllocator);
 
 
-	SDL_Window* window;
+	SDL_Window* window = nullptr;
 	VkInstance instance;
 	VkDebugReportCallbackEXT callback;
 
@@ -123,6 +163,13 @@ private:
 	VkSwapchainKHR swapChain;
 	std::vector<VkImage> swapChainImages;
 	std::vector<VkFramebuffer> swapChainFramebuffers;
+
+	// headless: swapChainImages are plain images owned by us, present()
+	// rotates through them instead of acquiring from a swapchain.
+	static const uint32_t OFFSCREEN_IMAGES = 2;
+	bool headless = false;
+	uint32_t offscreenIndex = 0;
+	std::vector<VkDeviceMemory> offscreenMemory;
 	
 
 	std::vector<VkCommandBuffer> commandBuffers;
@@ -130,7 +177,47 @@ private:
 	VkSemaphore imageAvailableSemaphore;
 	VkSemaphore renderFinishedSemaphore;
 
-	std::vector<Mesh*> drawList;
+	// packets copied from the submitted meshes, see DrawPacketVulkan.
+	std::vector<DrawPacketVulkan> drawList;
+	RetainedList<DrawPacketVulkan> renderables;
+	// textures of the retained packets in bucket order, rebuilt after a change.
+	std::vector<std::pair<Texture2D*, uint32_t>> renderableTextures;
+	bool renderableTexturesDirty = false;
+	void recordRenderables(VkCommandBuffer commandBuffer);
+	// float4 per attached mesh, pushed by its constant buffer.
+	std::vector<float> translations;
+	// TRANSFORMS::GPU: float4 per attached mesh, written by compute.
+	VkBuffer transformBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory transformMemory = VK_NULL_HANDLE;
+	void releaseTransformBuffer();
+	struct Dispatch {
+		ComputeTechnique* technique;
+		uint32_t x, y, z;
+	};
+	// dispatches of the frame, recorded into every command buffer by frame().
+	std::vector<Dispatch> dispatches;
+	// setGpuCulling: the culling pass, and by bucket of renderables the
+	// records of its packets, count 0 when they are recorded one by one.
+	struct IndirectBucket {
+		uint32_t first, count;
+	};
+	GpuCuller* gpuCuller = nullptr;
+	bool gpuCulling = false;
+	Frustum cullFrustum;
+	std::vector<IndirectBucket> indirectBuckets;
+	bool cullRecordsDirty = true;
+	void buildCullRecords();
+	void recordIndirect(VkCommandBuffer commandBuffer, const DrawPacketVulkan& packet, uint32_t bucket, const IndirectBucket& records);
+	// VK_KHR_draw_indirect_count, with the multiDrawIndirect and drawIndirectFirstInstance features.
+	bool hasIndirectCount = false;
+	PFN_vkCmdDrawIndirectCountKHR drawIndirectCount = nullptr;
+	// nullptr if the graphics queue has no timestamps.
+	GpuProfilerVulkan* gpuProfiler = nullptr;
+	uint32_t clearScope = 0;
+	// VK_EXT_memory_budget, needs VK_KHR_get_physical_device_properties2 on the instance.
+	bool hasProperties2 = false;
+	bool hasMemoryBudget = false;
+	PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2 = nullptr;
 	VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
 
 	void initWindow(unsigned int width, unsigned int height);
@@ -157,6 +244,10 @@ private:
 	void createDescriptorSetLayout();
 	void createDescriptorSet();
 	void createPipelineLayout();
+	void createOffscreenImages();
+	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+	void initMemoryTracking();
+	void updateMemoryHeaps();
 
 
 	SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
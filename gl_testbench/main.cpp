@@ -1,36 +1,26 @@
 #include <string>
+#include <algorithm>
 #include <SDL_keyboard.h>
 #include <SDL_events.h>
 #include <SDL_timer.h>
-#include <type_traits> 
 #include <assert.h>
 
 #include "Renderer.h"
-#include "Mesh.h"
-#include "Texture2D.h"
-#include <math.h>
+#include "Testbench.h"
+#include "Benchmark.h"
+#include "Microbench.h"
+#include "Null/NullRenderer.h"
+#include "StaticBackend.h"
+#include "Capture/CaptureRenderer.h"
+#include "Capture/Replay.h"
+#include "Profiler.h"
+#include "ApiTrace.h"
+#include "MemoryTracker.h"
+#include "AllocationTracker.h"
 
 using namespace std;
 Renderer* renderer;
 
-// flat scene at the application level...we don't care about this here.
-// do what ever you want in your renderer backend.
-// all these objects are loosely coupled, creation and destruction is responsibility
-// of the testbench, not of the container objects
-vector<Mesh*> scene;
-vector<Material*> materials;
-vector<Technique*> techniques;
-vector<Texture2D*> textures;
-vector<Sampler2D*> samplers;
-
-VertexBuffer* pos;
-VertexBuffer* nor;
-VertexBuffer* uvs;
-
-// forward decls
-void updateScene();
-void renderScene();
-
 char gTitleBuff[256];
 double gLastDelta = 0.0;
 
@@ -54,261 +44,293 @@ void updateDelta()
 	gLastDelta = (lastSum / WINDOW_SIZE);
 };
 
-// TOTAL_TRIS pretty much decides how many drawcalls in a brute force approach.
-constexpr int TOTAL_TRIS = 100.0f;
-// this has to do with how the triangles are spread in the screen, not important.
-constexpr int TOTAL_PLACES = 2 * TOTAL_TRIS;
-float xt[TOTAL_PLACES], yt[TOTAL_PLACES];
-
-// lissajous points
-typedef union { 
-	struct { float x, y, z, w; };
-	struct { float r, g, b, a; };
-} float4;
+// 0 runs until the window is closed.
+long long gMaxFrames = 0;
 
-typedef union { 
-	struct { float x, y; };
-	struct { float u, v; };
-} float2;
+// --alloc-check: frames before the steady state, -1 when off.
+long long gAllocCheckWarmup = -1;
+uint64_t gSteadyFrames = 0;
+uint64_t gSteadyAllocations = 0;
+long long gFirstAllocatingFrame = -1;
 
+/*
+ called once per loop iteration. The zone table is reset when the warm-up
+ ends, so a failing check reports only what the steady state allocated.
+*/
+void checkAllocations()
+{
+	const FrameStats& stats = FrameStats::last();
+	if ((long long)stats.frame + 1 == gAllocCheckWarmup)
+		AllocationTracker::resetZones();
+	if ((long long)stats.frame < gAllocCheckWarmup)
+		return;
+	gSteadyFrames++;
+	gSteadyAllocations += stats.allocations;
+	if (stats.allocations && gFirstAllocatingFrame < 0)
+		gFirstAllocatingFrame = (long long)stats.frame;
+}
 
 void run() {
 
 	SDL_Event windowEvent;
-	while (true)
+	long long frames = 0;
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	while (gMaxFrames == 0 || frames++ < gMaxFrames)
 	{
 		if (SDL_PollEvent(&windowEvent))
 		{
 			if (windowEvent.type == SDL_QUIT) break;
 			if (windowEvent.type == SDL_KEYUP && windowEvent.key.keysym.sym == SDLK_ESCAPE) break;
+			if (windowEvent.type == SDL_KEYUP && windowEvent.key.keysym.sym == SDLK_F12)
+			{
+#ifdef TESTBENCH_PROFILE
+				if (Profiler::writeChromeTrace("trace.json") == 0)
+					fprintf(stderr, "CPU trace written to trace.json\n");
+#else
+				fprintf(stderr, "no CPU trace, this build has no zones (TESTBENCH_PROFILE is not defined)\n");
+#endif
+			}
 		}
-		updateScene();
-		renderScene();
+		updateScene((double)(SDL_GetPerformanceCounter() - startTime) / SDL_GetPerformanceFrequency());
+		renderScene(renderer);
+		updateDelta();
+		sprintf(gTitleBuff, "OpenGL - %3.0lf", gLastDelta);
+		renderer->setWinTitle(gTitleBuff);
+		if (gAllocCheckWarmup >= 0)
+			checkAllocations();
 	}
 }
 
 /*
- update positions of triangles in the screen changing a translation only
+ usage: gl_testbench [gl|vulkan|null|software] [--headless] [--frames N] [--record file] [--capture file]
+                     [--trace file] [--api-trace file] [--memory file] [--memory-budget MiB]
+                     [--allocations file] [--alloc-check warmup] [--retained] [--cull] [--occluder size]
+                     [--gpu-animation] [--gpu-cull] [--indexed] [--interleaved] [--quantized]
+        gl_testbench --bench ... (see Benchmark.h)
+        gl_testbench --microbench ... (see Microbench.h)
+        gl_testbench --replay file ... (see Capture/Replay.h)
+ headless runs without a window (EGL on Linux for GL, offscreen images for Vulkan).
+ software is the CPU rasterizer (Software/), the same image on every machine.
+ --record (null backend only) writes the command stream of the run to file.
+ --capture writes every Renderer call of the run to file, for --replay.
+ --trace (TESTBENCH_PROFILE builds: Debug, see Profiler.h) writes the CPU
+ zones as Chrome trace JSON at exit, F12 writes trace.json at any time.
+ --api-trace (gl and vulkan) counts the driver calls and writes the calls per
+ frame and the most redundant call sites to file at exit, see ApiTrace.h.
+ --memory writes live and peak resource memory per category, memory type and
+ heap to file at exit. --memory-budget warns when the resources of the scene
+ go over MiB, and when a device heap goes over 90% of its budget.
+ --allocations writes the heap allocations per frame and per CPU zone to
+ file at exit, see AllocationTracker.h.
+ --alloc-check fails the run (exit code 1) when a frame after the first
+ warmup frames allocates, and lists the zones that did. Use with --frames.
+ Both need a TESTBENCH_ALLOCATIONS build.
+ --retained adds the scene once with Renderer::addRenderable instead of
+ submitting every mesh every frame. --cull (not with --retained) submits
+ only the meshes inside the camera frustum, see RenderableScene.h. --occluder
+ (implies --cull) draws a quad of half width size over the middle of the
+ screen and skips the meshes it hides, see OcclusionCuller.h.
+ --gpu-animation moves the triangles with a compute pass, the CPU writes a
+ single uniform per frame (gl and vulkan, the other backends ignore it).
+ --gpu-cull (implies --gpu-animation, needs --retained) culls the
+ retained scene on the GPU and draws it with indirect count draws, see
+ Renderer::setGpuCulling.
+ --indexed draws every triangle through a shared index buffer, see IndexBuffer.h.
+ --interleaved keeps position, normal and uv in one vertex buffer, --quantized
+ stores them in 16 bytes instead of 40, see VertexLayout.h.
+ TESTBENCH_STATIC_ builds always run their backend, see StaticBackend.h.
 */
-void updateScene()
+int main(int argc, char *argv[])
 {
-	/*
-	    For each mesh in scene list, update their position 
-	*/
+	Renderer::BACKEND backend = Renderer::BACKEND::VULKAN;
+	bool headless = false;
+	const char* recordPath = nullptr;
+	const char* capturePath = nullptr;
+	const char* tracePath = nullptr;
+	const char* apiTracePath = nullptr;
+	const char* memoryPath = nullptr;
+	uint64_t memoryBudget = 0;
+	const char* allocationsPath = nullptr;
+	TestbenchConfig sceneConfig;
+	for (int i = 1; i < argc; i++)
 	{
-		static long long shift = 0;
-		const int size = scene.size();
-		for (int i = 0; i < size; i++)
+		std::string arg = argv[i];
+		if (arg == "--bench")
+			return benchmarkMain(argc, argv);
+		if (arg == "--microbench")
+			return microbenchMain(argc, argv);
+		if (arg == "--replay")
+			return replayMain(argc, argv);
+		if (arg == "gl")
+			backend = Renderer::BACKEND::GL45;
+		else if (arg == "vulkan")
+			backend = Renderer::BACKEND::VULKAN;
+		else if (arg == "null")
+			backend = Renderer::BACKEND::NULL_RENDERER;
+		else if (arg == "software")
+			backend = Renderer::BACKEND::SOFTWARE;
+		else if (arg == "--headless")
+			headless = true;
+		else if (arg == "--frames" && i + 1 < argc)
+			gMaxFrames = atoll(argv[++i]);
+		else if (arg == "--record" && i + 1 < argc)
+			recordPath = argv[++i];
+		else if (arg == "--capture" && i + 1 < argc)
+			capturePath = argv[++i];
+		else if (arg == "--trace" && i + 1 < argc)
+			tracePath = argv[++i];
+		else if (arg == "--api-trace" && i + 1 < argc)
+			apiTracePath = argv[++i];
+		else if (arg == "--memory" && i + 1 < argc)
+			memoryPath = argv[++i];
+		else if (arg == "--memory-budget" && i + 1 < argc)
+			memoryBudget = strtoull(argv[++i], nullptr, 10) << 20;
+		else if (arg == "--allocations" && i + 1 < argc)
+			allocationsPath = argv[++i];
+		else if (arg == "--alloc-check" && i + 1 < argc)
+			gAllocCheckWarmup = atoll(argv[++i]);
+		else if (arg == "--retained")
+			sceneConfig.retained = true;
+		else if (arg == "--cull")
+			sceneConfig.cull = true;
+		else if (arg == "--occluder" && i + 1 < argc)
 		{
-			const float4 trans { 
-				xt[(int)(float)(i + shift) % (TOTAL_PLACES)], 
-				yt[(int)(float)(i + shift) % (TOTAL_PLACES)], 
-				i * (-1.0 / TOTAL_PLACES),
-				0.0
-			};
-			scene[i]->txBuffer->setData(&trans, sizeof(trans), scene[i]->technique->getMaterial(), TRANSLATION);
+			sceneConfig.cull = true;
+			sceneConfig.occluderSize = (float)atof(argv[++i]);
 		}
-		// just to make them move...
-		shift+=max(TOTAL_TRIS / 1000.0,TOTAL_TRIS / 100.0);
+		else if (arg == "--gpu-animation")
+			sceneConfig.gpuAnimation = true;
+		else if (arg == "--gpu-cull")
+			sceneConfig.gpuCull = true;
+		else if (arg == "--indexed")
+			sceneConfig.indexed = true;
+		else if (arg == "--interleaved")
+			sceneConfig.interleaved = true;
+		else if (arg == "--quantized")
+			sceneConfig.quantized = true;
 	}
-	return;
-};
+#ifdef TESTBENCH_STATIC_BACKEND
+	backend = TESTBENCH_STATIC_BACKEND;
+#endif
 
-
-void renderScene()
-{
-	renderer->clearBuffer(CLEAR_BUFFER_FLAGS::COLOR | CLEAR_BUFFER_FLAGS::DEPTH);
-	for (auto m : scene)
+	PROFILE_THREAD("main");
+	if (allocationsPath || gAllocCheckWarmup >= 0)
 	{
-		renderer->submit(m);
+		if (!AllocationTracker::counting())
+		{
+			fprintf(stderr, "--allocations and --alloc-check need a build with TESTBENCH_ALLOCATIONS defined\n");
+			return -1;
+		}
+		AllocationTracker::setZoneTracking(true);
+#ifndef TESTBENCH_PROFILE
+		fprintf(stderr, "allocations are not charged to zones, TESTBENCH_PROFILE is not defined\n");
+#endif
 	}
-	renderer->frame();
-	renderer->present();
-	updateDelta();
-	sprintf(gTitleBuff, "OpenGL - %3.0lf", gLastDelta);
-	renderer->setWinTitle(gTitleBuff);
-}
-
-int initialiseTestbench()
-{
-	std::string definePos = "#define POSITION " + std::to_string(POSITION) + "\n";
-	std::string defineNor = "#define NORMAL " + std::to_string(NORMAL) + "\n";
-	std::string defineUV = "#define TEXTCOORD " + std::to_string(TEXTCOORD) + "\n";
-
-	std::string defineTX = "#define TRANSLATION " + std::to_string(TRANSLATION) + "\n";
-	std::string defineTXName = "#define TRANSLATION_NAME " + std::string(TRANSLATION_NAME) + "\n";
-	
-	std::string defineDiffCol = "#define DIFFUSE_TINT " + std::to_string(DIFFUSE_TINT) + "\n";
-	std::string defineDiffColName = "#define DIFFUSE_TINT_NAME " + std::string(DIFFUSE_TINT_NAME) + "\n";
-
-	std::string defineDiffuse = "#define DIFFUSE_SLOT " + std::to_string(DIFFUSE_SLOT) + "\n";
-
-	std::vector<std::vector<std::string>> materialDefs = {
-		// vertex shader, fragment shader, defines
-		// shader filename extension must be asked to the renderer
-		// these strings should be constructed from the IA.h file!!!
-
-		{ "VertexShader", "FragmentShader", definePos + defineNor + defineUV + defineTX + 
-		   defineTXName + defineDiffCol + defineDiffColName }, 
-
-		{ "VertexShader", "FragmentShader", definePos + defineNor + defineUV + defineTX + 
-		   defineTXName + defineDiffCol + defineDiffColName }, 
-
-		{ "VertexShader", "FragmentShader", definePos + defineNor + defineUV + defineTX + 
-		   defineTXName + defineDiffCol + defineDiffColName + defineDiffuse	},
-
-		{ "VertexShader", "FragmentShader", definePos + defineNor + defineUV + defineTX + 
-		   defineTXName + defineDiffCol + defineDiffColName }, 
-	};
-
-	float degToRad = M_PI / 180.0;
-	float scale = (float)TOTAL_PLACES / 359.9;
-	for (int a = 0; a < TOTAL_PLACES; a++)
-	{
-		xt[a] = 0.8f * cosf(degToRad * ((float)a/scale) * 3.0);
-		yt[a] = 0.8f * sinf(degToRad * ((float)a/scale) * 2.0);
-	};
-
-	// triangle geometry:
-	float4 triPos[3] = { { 0.0f,  0.05, 0.0f, 1.0f },{ 0.05, -0.05, 0.0f, 1.0f },{ -0.05, -0.05, 0.0f, 1.0f } };
-	float4 triNor[3] = { { 0.0f,  0.0f, 1.0f, 0.0f },{ 0.0f, 0.0f, 1.0f, 0.0f },{ 0.0f, 0.0f, 1.0f, 0.0f } };
-	float2 triUV[3] =  { { 0.5f,  -0.99f },{ 1.49f, 1.1f },{ -0.51, 1.1f } };
-
-	// load Materials.
-	std::string shaderPath = renderer->getShaderPath();
-	std::string shaderExtension = renderer->getShaderExtension();
-	float diffuse[4][4] = {
-		0.0,0.0,1.0,1.0,
-		0.0,1.0,0.0,1.0,
-		1.0,1.0,1.0,1.0,
-		1.0,0.0,0.0,1.0
-	};
-
-	for (int i = 0; i < materialDefs.size(); i++)
+	ApiTrace apiTrace;
+	if (apiTracePath)
+		ApiTrace::active = &apiTrace;
+	if (memoryBudget)
 	{
-		// set material name from text file?
-		Material* m = renderer->makeMaterial("material_" + std::to_string(i));
-		m->setShader(shaderPath + materialDefs[i][0] + shaderExtension, Material::ShaderType::VS);
-		m->setShader(shaderPath + materialDefs[i][1] + shaderExtension, Material::ShaderType::PS);
-
-		m->addDefine(materialDefs[i][2], Material::ShaderType::VS);
-		m->addDefine(materialDefs[i][2], Material::ShaderType::PS);
-
-		std::string err;
-		m->compileMaterial(err);
-
-		// add a constant buffer to the material, to tint every triangle using this material
-		m->addConstantBuffer(DIFFUSE_TINT_NAME, DIFFUSE_TINT);
-		// no need to update anymore
-		// when material is bound, this buffer should be also bound for access.
-
-		m->updateConstantBuffer(diffuse[i], 4 * sizeof(float), DIFFUSE_TINT);
-		
-		materials.push_back(m);
-	}
-	
-	// one technique with wireframe
-	RenderState* renderState1 = renderer->makeRenderState();
-	renderState1->setWireFrame(true);
-
-	// basic technique
-	techniques.push_back(renderer->makeTechnique(materials[0], renderState1));
-	techniques.push_back(renderer->makeTechnique(materials[1], renderer->makeRenderState()));
-	techniques.push_back(renderer->makeTechnique(materials[2], renderer->makeRenderState()));
-	techniques.push_back(renderer->makeTechnique(materials[3], renderer->makeRenderState()));
-	
-	// create texture
-	Texture2D* fatboy = renderer->makeTexture2D();
-	fatboy->loadFromFile("../assets/textures/fatboy.png");
-	Sampler2D* sampler = renderer->makeSampler2D();
-	sampler->setWrap(WRAPPING::REPEAT, WRAPPING::REPEAT);
-	fatboy->sampler = sampler;
-
-	textures.push_back(fatboy);
-	samplers.push_back(sampler);
-	
-	// pre-allocated one single vertex buffer for ALL triangles
-	pos = renderer->makeVertexBuffer(TOTAL_TRIS * sizeof(triPos), VertexBuffer::DATA_USAGE::STATIC);
-	nor = renderer->makeVertexBuffer(TOTAL_TRIS * sizeof(triNor), VertexBuffer::DATA_USAGE::STATIC);
-	uvs = renderer->makeVertexBuffer(TOTAL_TRIS * sizeof(triUV), VertexBuffer::DATA_USAGE::STATIC);
-
-	// Create a mesh array with 3 basic vertex buffers.
-	for (int i = 0; i < TOTAL_TRIS; i++) {
-
-		Mesh* m = renderer->makeMesh();
-		
-		constexpr auto numberOfPosElements = std::extent<decltype(triPos)>::value;
-		size_t offset = i * sizeof(triPos);
-		pos->setData(triPos, sizeof(triPos), offset);
-		m->addIAVertexBufferBinding(pos, offset, numberOfPosElements, sizeof(float4), POSITION);
-
-		constexpr auto numberOfNorElements = std::extent<decltype(triNor)>::value;
-		offset = i * sizeof(triNor);
-		nor->setData(triNor, sizeof(triNor), offset);
-		m->addIAVertexBufferBinding(nor, offset, numberOfNorElements, sizeof(float4), NORMAL);
-
-		constexpr auto numberOfUVElements = std::extent<decltype(triUV)>::value;
-		offset = i * sizeof(triUV);
-		uvs->setData(triUV, sizeof(triUV), offset);
-		m->addIAVertexBufferBinding(uvs, offset, numberOfUVElements , sizeof(float2), TEXTCOORD);
-
-		
-		// we can create a constant buffer outside the material, for example as part of the Mesh.
-		m->txBuffer = renderer->makeConstantBuffer(std::string(TRANSLATION_NAME), TRANSLATION);
-		
-		
-		m->technique = techniques[ i % 4];
-		
-		if (i % 4 == 2)
-			m->addTexture(textures[0], DIFFUSE_SLOT);
-		
-		scene.push_back(m);
+		// nothing to evict in the testbench, a real scene would drop mips or meshes here.
+		auto overBudget = [](const MemoryTracker::BudgetEvent& e) {
+			if (e.heap == MemoryTracker::NO_HEAP)
+				fprintf(stderr, "memory budget: %s at %.1f MiB, budget %.1f MiB\n", MemoryTracker::categoryName(e.category),
+					e.bytes / 1048576.0, e.budget / 1048576.0);
+			else
+				fprintf(stderr, "memory budget: heap %u at %.1f MiB, budget %.1f MiB\n", e.heap,
+					e.bytes / 1048576.0, e.budget / 1048576.0);
+		};
+		MemoryTracker::setBudget(MemoryTracker::CATEGORY::COUNT, memoryBudget, overBudget);
+		MemoryTracker::setHeapBudget(0.9, overBudget);
 	}
-	return 0;
-}
-
-void shutdown() {
-	// shutdown.
-	// delete dynamic objects
-	for (auto m : materials)
+	renderer = Renderer::makeRenderer(backend);
+	NullRenderer* nullRenderer = backend == Renderer::BACKEND::NULL_RENDERER ? (NullRenderer*)renderer : nullptr;
+	if (capturePath)
+		renderer = new CaptureRenderer(renderer, capturePath);
+	if (renderer->initialize(800,600,headless) != 0)
+		return -1;
+	renderer->setWinTitle(backend == Renderer::BACKEND::VULKAN ? "Vulkan" : "OpenGL");
+	renderer->setClearColor(0.0, 0.1, 0.1, 1.0);
+	CommandStream recording;
+	if (recordPath && nullRenderer)
+		nullRenderer->setRecording(&recording);
+	if (initialiseTestbench(renderer, sceneConfig) != 0)
 	{
-		delete(m);
+		renderer->shutdown();
+		return -1;
 	}
-	for (auto t : techniques)
+	run();
+	if (recordPath && recording.save(recordPath) != 0)
+		fprintf(stderr, "Cannot write %s\n", recordPath);
+#ifdef TESTBENCH_PROFILE
+	if (tracePath && Profiler::writeChromeTrace(tracePath) != 0)
+		fprintf(stderr, "Cannot write %s\n", tracePath);
+#else
+	if (tracePath)
+		fprintf(stderr, "--trace needs a build with TESTBENCH_PROFILE defined\n");
+#endif
+	if (memoryPath)
 	{
-		delete(t);
+		FILE* out = fopen(memoryPath, "w");
+		if (out)
+		{
+			MemoryTracker::writeReport(out);
+			fclose(out);
+		}
+		else
+			fprintf(stderr, "Cannot write %s\n", memoryPath);
 	}
-	for (auto m : scene)
+	if (apiTracePath)
 	{
-		delete(m);
-	};
-	assert(pos->refCount() == 0);
-	delete pos;
-	assert(nor->refCount() == 0);
-	delete nor;
-	assert(uvs->refCount() == 0);
-	delete uvs;
-	
-	for (auto s : samplers)
+		FILE* out = fopen(apiTracePath, "w");
+		if (out)
+		{
+			apiTrace.writeReport(out);
+			fclose(out);
+		}
+		else
+			fprintf(stderr, "Cannot write %s\n", apiTracePath);
+	}
+	if (allocationsPath)
 	{
-		delete s;
+		FILE* out = fopen(allocationsPath, "w");
+		if (out)
+		{
+			std::vector<FrameStats> frames = FrameStats::history();
+			uint64_t sum = 0, most = 0;
+			for (auto& f : frames)
+			{
+				sum += f.allocations;
+				most = std::max<uint64_t>(most, f.allocations);
+			}
+			if (!frames.empty())
+				fprintf(out, "last %zu frames: %.2f allocations per frame, at most %llu\n\n", frames.size(),
+					(double)sum / frames.size(), (unsigned long long)most);
+			AllocationTracker::writeReport(out);
+			fclose(out);
+		}
+		else
+			fprintf(stderr, "Cannot write %s\n", allocationsPath);
 	}
-
-	for (auto t : textures)
+	int status = 0;
+	if (gAllocCheckWarmup >= 0)
 	{
-		delete t;
+		if (gSteadyFrames == 0)
+		{
+			fprintf(stderr, "alloc check: no frames after the %lld warm-up frames, use --frames\n", gAllocCheckWarmup);
+			status = 1;
+		}
+		else if (gSteadyAllocations)
+		{
+			fprintf(stderr, "alloc check failed: %llu allocations in %llu steady state frames, the first in frame %lld\n",
+				(unsigned long long)gSteadyAllocations, (unsigned long long)gSteadyFrames, gFirstAllocatingFrame);
+			AllocationTracker::writeReport(stderr, gSteadyFrames);
+			status = 1;
+		}
+		else
+			fprintf(stderr, "alloc check passed: %llu frames without allocations\n", (unsigned long long)gSteadyFrames);
 	}
+	shutdownTestbench();
 	renderer->shutdown();
-};
-
-int main(int argc, char *argv[])
-{
-	renderer = Renderer::makeRenderer(Renderer::BACKEND::VULKAN);
-	renderer->initialize(800,600);
-	renderer->setWinTitle("Vulkan");
-	renderer->setClearColor(0.0, 0.1, 0.1, 1.0);
-	initialiseTestbench();
-	run();
-	shutdown();
-	return 0;
+	return status;
 };